@@ -117,19 +117,48 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
   std::vector<std::unique_ptr<BoundColumnRef>> cols;
+  std::vector<std::unique_ptr<BoundColumnRef>> included_cols;
   auto table = BindBaseTableRef(stmt->relation->relname, std::nullopt);
 
+  const auto add_column = [&](std::vector<std::unique_ptr<BoundColumnRef>> *columns, const std::string &name) {
+    auto column_ref = ResolveColumn(*table, std::vector{name});
+    for (const auto *list : {&cols, &included_cols}) {
+      for (const auto &col : *list) {
+        if (col->ToString() == column_ref->ToString()) {
+          throw bustub::Exception(fmt::format("column {} appears twice in the index", name));
+        }
+      }
+    }
+    columns->emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+  };
+
   for (auto cell = stmt->indexParams->head; cell != nullptr; cell = cell->next) {
     auto index_element = reinterpret_cast<duckdb_libpgquery::PGIndexElem *>(cell->data.ptr_value);
     if (index_element->name != nullptr) {
-      auto column_ref = ResolveColumn(*table, std::vector{std::string(index_element->name)});
-      cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      add_column(&cols, index_element->name);
     } else {
       throw NotImplementedException("create index by expr is not supported yet");
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // The grammar has no INCLUDE clause, so the included columns come as an option:
+  // CREATE INDEX ... WITH (include = 'c1, c2')
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (std::string(option->defname) != "include" || option->arg == nullptr ||
+          option->arg->type != duckdb_libpgquery::T_PGString) {
+        throw NotImplementedException(fmt::format("index option {} is not supported", option->defname));
+      }
+      const std::string names = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      for (const auto &name : StringUtil::Split(names, ',')) {
+        add_column(&included_cols, StringUtil::Strip(name, ' '));
+      }
+    }
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), stmt->unique,
+                                          std::move(included_cols));
 }
 
 }  // namespace bustub
@@ -12,23 +12,59 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // the pages an existing database file holds are taken, so new ones go after them
+  if (disk_manager_ != nullptr) {
+    const page_id_t num_pages = disk_manager_->GetNumPages();
+    const auto stride = static_cast<page_id_t>(num_instances_);
+    if (num_pages > next_page_id_) {
+      next_page_id_ += (num_pages - next_page_id_ + stride - 1) / stride * stride;
+    }
+  }
   // we allocate a consecutive memory space for the buffer pool
+  static_assert(BUSTUB_PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0);
   pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  frames_ = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, pool_size_ * BUSTUB_PAGE_SIZE));
+  page_table_ = new OpenAddressingHashTable<page_id_t, frame_id_t>(pool_size_);
+  if (replacer_type == ReplacerType::CLOCK) {
+    replacer_ = new ClockReplacer(pool_size);
+  } else {
+    replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  }
+  frame_states_ = std::make_unique<std::atomic<FrameState>[]>(pool_size_);
+  cleaned_frames_.resize(pool_size_, false);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
-    new(&pages_[i]) Page();
+    pages_[i].data_ = frames_ + i * BUSTUB_PAGE_SIZE;
+    pages_[i].ResetMemory();
+    frame_states_[i] = FrameState::READY;
   }
 
   // TODO(students): remove this line after you have implemented the buffer pool manager
@@ -38,176 +74,525 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopPageCleaner();
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    prefetch_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
   delete[] pages_;
+  std::free(frames_);  // NOLINT
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { 
-  std::scoped_lock<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::ReserveFrame(page_id_t page_id, frame_id_t *frame_id, page_id_t *victim_page_id,
+                                             BufferRing *ring) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  bool reserved = ring != nullptr && RecycleRingFrame(ring, frame_id);
+  if (reserved) {
+    UnmapVictim(*frame_id, victim_page_id);
+  }
+  if (!reserved) {
+    // A hit that found a stale page table entry may hold a pin on a free frame for a moment, so it is skipped.
+    auto free_frame =
+        std::find_if(free_list_.begin(), free_list_.end(), [&](frame_id_t frame) { return ClaimFrame(frame); });
+    if (free_frame != free_list_.end()) {
+      *frame_id = *free_frame;
+      free_list_.erase(free_frame);
+      reserved = true;
+    }
+  }
+  while (!reserved && replacer_->Evict(frame_id)) {
+    if (ClaimFrame(*frame_id)) {
+      UnmapVictim(*frame_id, victim_page_id);
+      reserved = true;
+    } else {
+      // A hit pinned the frame without the latch before marking it not evictable; track it again.
+      replacer_->RecordAccess(*frame_id);
+      replacer_->SetEvictable(*frame_id, false);
+    }
+  }
+  if (!reserved) {
+    return false;
+  }
+
+  frame_states_[*frame_id] = *victim_page_id == INVALID_PAGE_ID ? FrameState::LOADING : FrameState::EVICTING;
+  cleaned_frames_[*frame_id] = false;
+  page_table_->Insert(page_id, *frame_id);
+  replacer_->RecordAccess(*frame_id);
+  replacer_->SetEvictable(*frame_id, false);
+  pages_[*frame_id].page_id_ = page_id;
+  pages_[*frame_id].is_dirty_ = false;
+  // releases the claim, after which hits on the new page may pin the frame
+  pages_[*frame_id].pin_count_ = 1;
+  if (ring != nullptr) {
+    ring->GetPages(instance_index_, num_instances_).push_back(page_id);
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::RecycleRingFrame(BufferRing *ring, frame_id_t *frame_id) -> bool {
+  auto &ring_pages = ring->GetPages(instance_index_, num_instances_);
+  while (ring_pages.size() >= ring->GetCapacity(num_instances_)) {
+    const page_id_t oldest = ring_pages.front();
+    ring_pages.pop_front();
+    if (page_table_->Find(oldest, *frame_id) && frame_states_[*frame_id] == FrameState::READY &&
+        ClaimFrame(*frame_id)) {
+      replacer_->Remove(*frame_id);
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) -> bool {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, CLAIMED);
+}
+
+auto BufferPoolManagerInstance::PinHit(page_id_t page_id, frame_id_t frame_id, AccessType access_type) -> bool {
+  auto &page = pages_[frame_id];
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count == CLAIMED) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // The pin keeps the frame from being claimed, so its page id cannot change from here on. The page table entry may
+  // have been stale, though.
+  if (page.page_id_ != page_id) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (--page.pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+    return false;
+  }
+  if (access_type != AccessType::SCAN) {
+    replacer_->RecordAccess(frame_id);
+  }
+  if (pin_count == 0) {
+    replacer_->SetEvictable(frame_id, false);
+  }
+  if (frame_states_[frame_id] != FrameState::READY) {
+    std::unique_lock<std::mutex> lock(latch_);
+    io_cv_.wait(lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::UnmapVictim(frame_id_t frame_id, page_id_t *victim_page_id) {
+  auto &victim = pages_[frame_id];
+  page_table_->Remove(victim.GetPageId());
+  if (victim.IsDirty()) {
+    // 脏页的旧内容由调用者在释放 latch 之后写回
+    *victim_page_id = victim.GetPageId();
+    evicting_pages_.insert(*victim_page_id);
+    cleaner_stats_.dirty_evictions_++;
+    if (cleaner_running_) {
+      cleaner_cv_.notify_one();
+    }
+  } else if (cleaned_frames_[frame_id]) {
+    cleaner_stats_.stalls_avoided_++;
+  }
+}
+
+void BufferPoolManagerInstance::FinishFrameIo(frame_id_t frame_id, page_id_t victim_page_id) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    frame_states_[frame_id] = FrameState::READY;
+    if (victim_page_id != INVALID_PAGE_ID) {
+      evicting_pages_.erase(victim_page_id);
+    }
+  }
+  io_cv_.notify_all();
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  return NewPgWithHintImp(page_id, AccessType::UNKNOWN, nullptr);
+}
+
+auto BufferPoolManagerInstance::NewPgWithHintImp(page_id_t *page_id, AccessType access_type, BufferRing *ring)
+    -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+
+  const page_id_t new_page_id = AllocatePage();
+  frame_id_t frame_id;
+  page_id_t victim_page_id;
+  if (!ReserveFrame(new_page_id, &frame_id, &victim_page_id, ring)) {
+    return nullptr;
+  }
+  lock.unlock();
+
+  // 磁盘 I/O 不持有 latch
+  auto &page = pages_[frame_id];
+  if (victim_page_id != INVALID_PAGE_ID) {
+    disk_manager_->WritePage(victim_page_id, page.GetData());
+  }
+  page.ResetMemory();
+  FinishFrameIo(frame_id, victim_page_id);
 
-  if(free_list_.size() == 0 && replacer_->Size() == 0) {
-    page_id = nullptr;
-    return nullptr; 
-  }
-  //Page* new_page = new Page();
-  auto new_page_id = AllocatePage();
-  //new_page->page_id_ = new_page_id;
-  frame_id_t new_frame_id;
-  if(free_list_.size() != 0) {
-    new_frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    // replacer
-    replacer_->Evict(&new_frame_id);
-    // 若 dirty 写磁盘
-    //auto evict_page = pages_[new_frame_id];
-    if(pages_[new_frame_id].IsDirty() == true){
-      pages_[new_frame_id].is_dirty_ = false;
-      disk_manager_->WritePage(pages_[new_frame_id].GetPageId(), pages_[new_frame_id].GetData());
-    }
-    // 更新 hashtable
-    //page_table_->Remove(new_page_id); 
-    page_table_->Remove(pages_[new_frame_id].GetPageId());
-  }
-  // 更新 hashtable
-  page_table_->Insert(new_page_id, new_frame_id);
-  // 更新 replacer
-  replacer_->RecordAccess(new_frame_id);
-  replacer_->SetEvictable(new_frame_id, false);
-  // 更新 buffer pool
-  pages_[new_frame_id].ResetMemory();
-  pages_[new_frame_id].page_id_ = new_page_id;
   *page_id = new_page_id;
-  pages_[new_frame_id].pin_count_ = 1;
-  pages_[new_frame_id].is_dirty_ = false;
-  return &pages_[new_frame_id];
+  return &page;
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { 
-  std::scoped_lock<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgWithHintImp(page_id, AccessType::UNKNOWN, nullptr);
+}
 
-  frame_id_t target_frame_id;
-  if(page_table_->Find(page_id, target_frame_id) == true) {
-    replacer_->RecordAccess(target_frame_id);
-    pages_[target_frame_id].pin_count_++;
-    replacer_->SetEvictable(target_frame_id, false);
-    //std::cout << "Find success ! target_frame_id :" << target_frame_id << std::endl;
-    return &pages_[target_frame_id];
-  }
-  if(free_list_.size() == 0 && replacer_->Size() == 0) {
-    return nullptr; 
-  }
-  //Page* new_page = new Page();
-  //new_page->page_id_ = page_id;
-  //disk_manager_->ReadPage(page_id, new_page->GetData());
-
-  // 同上（NewPgImp）
-  frame_id_t new_frame_id;
-  if(free_list_.size() != 0) {
-    new_frame_id = free_list_.front();
-    free_list_.pop_front();
-    //std::cout << "free_list_ success ! target_frame_id :" << target_frame_id << std::endl;
-  } else {
-    // replacer
-    replacer_->Evict(&new_frame_id);
-    // 若 dirty 写磁盘
-    //auto evict_page = pages_[new_frame_id];
-    if(pages_[new_frame_id].IsDirty() == true){
-      pages_[new_frame_id].is_dirty_ = false;
-      disk_manager_->WritePage(pages_[new_frame_id].GetPageId(), pages_[new_frame_id].GetData());
-    }
-    // 更新 hashtable
-    //page_table_->Remove(page_id);
-    page_table_->Remove(pages_[new_frame_id].GetPageId());
-  }
-  // 更新 hashtable
-  page_table_->Insert(page_id, new_frame_id);
-  // 更新 replacer
-  replacer_->RecordAccess(new_frame_id);
-  replacer_->SetEvictable(new_frame_id, false);
-  // 更新 buffer pool
-  disk_manager_->ReadPage(page_id, pages_[new_frame_id].GetData());
-  pages_[new_frame_id].page_id_ = page_id;
-  pages_[new_frame_id].pin_count_ = 1;
-  pages_[new_frame_id].is_dirty_ = false;
-  //std::cout << "replacer success ! target_frame_id :" << target_frame_id << std::endl;
-  return &pages_[new_frame_id];
-}
-
-auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool { 
+auto BufferPoolManagerInstance::FetchPgWithHintImp(page_id_t page_id, AccessType access_type, BufferRing *ring)
+    -> Page * {
+  frame_id_t frame_id;
+  if (page_table_->Find(page_id, frame_id) && PinHit(page_id, frame_id, access_type)) {
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!page_table_->Find(page_id, frame_id)) {
+    if (evicting_pages_.count(page_id) == 0) {
+      // Miss: reserve a frame and bring the page in without holding the latch.
+      page_id_t victim_page_id;
+      if (!ReserveFrame(page_id, &frame_id, &victim_page_id, ring)) {
+        return nullptr;
+      }
+      lock.unlock();
+
+      auto &page = pages_[frame_id];
+      if (victim_page_id != INVALID_PAGE_ID) {
+        disk_manager_->WritePage(victim_page_id, page.GetData());
+      }
+      disk_manager_->ReadPage(page_id, page.GetData());
+      FinishFrameIo(frame_id, victim_page_id);
+      return &page;
+    }
+    // The previous image of this page is still being written back; reading it now would return stale data.
+    io_cv_.wait(lock);
+  }
+
+  // Hit: pin the frame first so it cannot be evicted, then wait only if another thread is still loading it. A scan
+  // passing over a page does not make it any hotter.
+  if (access_type != AccessType::SCAN) {
+    replacer_->RecordAccess(frame_id);
+  }
+  replacer_->SetEvictable(frame_id, false);
+  pages_[frame_id].pin_count_++;
+  io_cv_.wait(lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+  return &pages_[frame_id];
+}
+
+auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
-  
+
   // return false if the page could not be found in the page table
-  frame_id_t target_frame_id;
-  if(page_table_->Find(page_id, target_frame_id) == false) {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  auto &page = pages_[frame_id];
+  if (page.pin_count_ <= 0) {
     return false;
   }
-  //auto cur_page = pages_[target_frame_id];
-  if(pages_[target_frame_id].pin_count_ <= 0) { return false; }
-  pages_[target_frame_id].pin_count_--;
-  //std::cout << "pages_[target_frame_id].pin_count_" << pages_[target_frame_id].pin_count_ << std::endl;
-  if(pages_[target_frame_id].pin_count_ == 0) {replacer_->SetEvictable(target_frame_id, true);}
+  if (--page.pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
+  }
   // cannot true to false
-  if(is_dirty == true){pages_[target_frame_id].is_dirty_ = is_dirty;}
+  if (is_dirty) {
+    page.is_dirty_ = true;
+    cleaned_frames_[frame_id] = false;
+  }
   return true;
 }
 
-auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool { 
-  std::scoped_lock<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
 
   // return false if the page could not be found in the page table
-  frame_id_t target_frame_id;
-  if(page_table_->Find(page_id, target_frame_id) == false) {
-    return false;
+  frame_id_t frame_id;
+  while (true) {
+    if (!page_table_->Find(page_id, frame_id)) {
+      return false;
+    }
+    if (frame_states_[frame_id] == FrameState::READY) {
+      break;
+    }
+    io_cv_.wait(lock);
   }
-  // 若 dirty 刷盘, 同上
-  //auto evict_page = pages_[target_frame_id];
-  if(pages_[target_frame_id].IsDirty() == true){
-    pages_[target_frame_id].is_dirty_ = false;
-    disk_manager_->WritePage(pages_[target_frame_id].GetPageId(), pages_[target_frame_id].GetData());
+
+  // Pin the frame for the duration of the write so that it cannot be evicted or deleted under us. A writer that
+  // dirties the page while the flush is in progress sets is_dirty_ again, so no update can be lost.
+  auto &page = pages_[frame_id];
+  page.pin_count_++;
+  replacer_->SetEvictable(frame_id, false);
+  page.is_dirty_ = false;
+  cleaned_frames_[frame_id] = false;
+  lock.unlock();
+
+  disk_manager_->WritePage(page_id, page.GetData());
+
+  lock.lock();
+  if (--page.pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
   }
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
+  // Pin every dirty page and hand all of them to the disk manager as one batch, so a disk manager that supports it
+  // can keep all the writes in flight at once.
+  std::vector<frame_id_t> frames;
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  std::unique_lock<std::mutex> lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto &page = pages_[i];
+    if (page.GetPageId() != INVALID_PAGE_ID && page.IsDirty() && frame_states_[i] == FrameState::READY) {
+      page.pin_count_++;
+      replacer_->SetEvictable(static_cast<frame_id_t>(i), false);
+      page.is_dirty_ = false;
+      cleaned_frames_[i] = false;
+      frames.push_back(static_cast<frame_id_t>(i));
+      batch.emplace_back(page.GetPageId(), page.GetData());
+    }
+  }
+  lock.unlock();
+
+  disk_manager_->WritePages(batch);
+
+  lock.lock();
+  for (auto frame_id : frames) {
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+}
 
-  for(size_t i = 0; i < pool_size_; i++){
-    //auto cur_page = pages_[static_cast<int>(i)];
-    if(pages_[static_cast<int>(i)].GetPageId() != INVALID_PAGE_ID && pages_[static_cast<int>(i)].IsDirty() == true){
-      pages_[static_cast<int>(i)].is_dirty_ = false;
-      disk_manager_->WritePage(pages_[static_cast<int>(i)].GetPageId(), pages_[static_cast<int>(i)].GetData());
+void BufferPoolManagerInstance::PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) {
+  std::unique_lock<std::mutex> lock(latch_);
+  size_t budget = ring != nullptr ? ring->GetCapacity(num_instances_) : (free_list_.size() + replacer_->Size()) / 2;
+  const page_id_t next_page_id = next_page_id_.load();
+  size_t num_requests = 0;
+  for (auto page_id : page_ids) {
+    if (budget == 0) {
+      break;
     }
+    frame_id_t frame_id;
+    // Never map a page id that has not been allocated yet, a later NewPage() would map it a second time.
+    if (page_id < 0 || page_id >= next_page_id || page_table_->Find(page_id, frame_id) ||
+        evicting_pages_.count(page_id) > 0) {
+      continue;
+    }
+    ValidatePageId(page_id);
+    page_id_t victim_page_id;
+    if (!ReserveFrame(page_id, &frame_id, &victim_page_id, ring)) {
+      break;
+    }
+    prefetch_queue_.push_back({frame_id, page_id, victim_page_id});
+    budget--;
+    num_requests++;
+  }
+  if (num_requests == 0) {
+    return;
   }
+  if (!prefetch_running_ && !prefetch_thread_.joinable()) {
+    prefetch_running_ = true;
+    prefetch_thread_ = std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  lock.unlock();
+  prefetch_cv_.notify_one();
 }
 
-auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool { 
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return !prefetch_queue_.empty() || !prefetch_running_; });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    std::vector<PrefetchRequest> requests(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    lock.unlock();
+
+    // Write back the dirty victims first, then read all the pages in one batch.
+    std::vector<std::pair<page_id_t, const char *>> victims;
+    std::vector<std::pair<page_id_t, char *>> reads;
+    for (const auto &request : requests) {
+      if (request.victim_page_id_ != INVALID_PAGE_ID) {
+        victims.emplace_back(request.victim_page_id_, pages_[request.frame_id_].GetData());
+      }
+      reads.emplace_back(request.page_id_, pages_[request.frame_id_].GetData());
+    }
+    disk_manager_->WritePages(victims);
+    disk_manager_->ReadPages(reads);
+
+    lock.lock();
+    for (const auto &request : requests) {
+      frame_states_[request.frame_id_] = FrameState::READY;
+      if (request.victim_page_id_ != INVALID_PAGE_ID) {
+        evicting_pages_.erase(request.victim_page_id_);
+      }
+      auto &page = pages_[request.frame_id_];
+      if (--page.pin_count_ == 0) {
+        replacer_->SetEvictable(request.frame_id_, true);
+      }
+    }
+    io_cv_.notify_all();
+  }
+}
+
+auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
 
   // return true if the page could not be found in the page table
-  frame_id_t target_frame_id;
-  if(page_table_->Find(page_id, target_frame_id) == false) {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
     return true;
   }
-  //auto cur_page = pages_[target_frame_id];
-  if(pages_[target_frame_id].GetPinCount() > 0) { return false; }
-  // delete
-  // 更新 hashtable
+  auto &page = pages_[frame_id];
+  // a frame that is still doing I/O is always pinned by the thread doing it
+  if (!ClaimFrame(frame_id)) {
+    return false;
+  }
   page_table_->Remove(page_id);
-  // 更新 replacer
-  replacer_->Remove(page_id);
-  // 更新 buffer pool
-  free_list_.emplace_back(target_frame_id);
-  pages_[target_frame_id].ResetMemory();
-  pages_[target_frame_id].is_dirty_ = false;
-  pages_[target_frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[target_frame_id].pin_count_ = 0;
-  // disk
+  replacer_->Remove(frame_id);
+  free_list_.emplace_back(frame_id);
+  page.ResetMemory();
+  page.is_dirty_ = false;
+  cleaned_frames_[frame_id] = false;
+  page.page_id_ = INVALID_PAGE_ID;
+  page.pin_count_ = 0;
   DeallocatePage(page_id);
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManagerInstance::StartPageCleaner(const PageCleanerOptions &options) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  cleaner_options_ = options;
+  cleaner_running_ = true;
+  cleaner_thread_ = std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_all();
+  cleaner_thread_.join();
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  while (true) {
+    CleanPages();
+    std::unique_lock<std::mutex> lock(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    // woken up early by an eviction that had to write a dirty victim, or by StopPageCleaner()
+    cleaner_cv_.wait_for(lock, cleaner_options_.interval_);
+    if (!cleaner_running_) {
+      return;
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::IsLogPersistent(Page *page) -> bool {
+  return !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+}
+
+auto BufferPoolManagerInstance::CleanPages() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // Count the evictable frames and collect the dirty ones that may be written back.
+  size_t num_evictable = 0;
+  size_t num_clean = 0;
+  std::vector<std::pair<page_id_t, frame_id_t>> candidates;
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto &page = pages_[i];
+    if (page.GetPageId() == INVALID_PAGE_ID || page.GetPinCount() > 0 || frame_states_[i] != FrameState::READY) {
+      continue;
+    }
+    num_evictable++;
+    if (!page.IsDirty()) {
+      num_clean++;
+    } else if (IsLogPersistent(&page)) {
+      candidates.emplace_back(page.GetPageId(), static_cast<frame_id_t>(i));
+    } else {
+      cleaner_stats_.wal_skipped_++;
+    }
+  }
+  const auto target = static_cast<size_t>(std::ceil(cleaner_options_.clean_ratio_ * num_evictable));
+  if (num_clean >= target || candidates.empty()) {
+    return 0;
+  }
+  const size_t num_to_clean = std::min({target - num_clean, cleaner_options_.max_batch_size_, candidates.size()});
+
+  // Sweep the page ids in ascending order, starting from where the previous round stopped.
+  std::sort(candidates.begin(), candidates.end());
+  auto start = std::lower_bound(candidates.begin(), candidates.end(), std::make_pair(cleaner_cursor_, 0));
+  std::rotate(candidates.begin(), start, candidates.end());
+  candidates.resize(num_to_clean);
+  std::sort(candidates.begin(), candidates.end());
+
+  // Pin the pages so they cannot be evicted while being written. A writer that dirties a page in the meantime sets
+  // is_dirty_ again, so no update can be lost.
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  for (auto [page_id, frame_id] : candidates) {
+    auto &page = pages_[frame_id];
+    page.pin_count_++;
+    replacer_->SetEvictable(frame_id, false);
+    page.is_dirty_ = false;
+    batch.emplace_back(page_id, page.GetData());
+  }
+  lock.unlock();
+
+  disk_manager_->WritePages(batch);
+
+  lock.lock();
+  for (auto [page_id, frame_id] : candidates) {
+    auto &page = pages_[frame_id];
+    if (--page.pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+    cleaned_frames_[frame_id] = !page.is_dirty_;
+  }
+  size_t num_runs = 1;
+  for (size_t i = 1; i < candidates.size(); i++) {
+    if (candidates[i].first != candidates[i - 1].first + 1) {
+      num_runs++;
+    }
+  }
+  cleaner_cursor_ = candidates.back().first + 1;
+  cleaner_stats_.rounds_++;
+  cleaner_stats_.pages_cleaned_ += candidates.size();
+  cleaner_stats_.write_runs_ += num_runs;
+  return candidates.size();
+}
+
+auto BufferPoolManagerInstance::GetPageCleanerStats() -> PageCleanerStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return cleaner_stats_;
+}
+
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  const page_id_t next_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  BUSTUB_ASSERT(page_id % num_instances_ == instance_index_, "allocated pages mod back to this BPI");
+}
 
 }  // namespace bustub
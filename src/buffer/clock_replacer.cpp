@@ -14,16 +14,89 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; i++) {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  for (size_t step = 0; step < 3 * num_pages_; step++) {
+    if (size_.load() == 0) {
+      return false;
+    }
+    const size_t pos = hand_.fetch_add(1) % num_pages_;
+    auto &state = states_[pos];
+    uint8_t old_state = state.load();
+    if ((old_state & (TRACKED | EVICTABLE)) != (TRACKED | EVICTABLE)) {
+      continue;
+    }
+    if ((old_state & REFERENCED) != 0) {
+      // Second chance; losing the race to another thread only means the frame is looked at again next round.
+      state.compare_exchange_strong(old_state, static_cast<uint8_t>(old_state & ~REFERENCED));
+      continue;
+    }
+    if (state.compare_exchange_strong(old_state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(pos);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &state = states_[frame_id];
+  uint8_t old_state = state.load();
+  if ((old_state & TRACKED) != 0) {
+    // Hit path: just set the reference bit.
+    state.fetch_or(REFERENCED);
+    return;
+  }
+  // A frame seen for the first time starts out evictable.
+  while (!state.compare_exchange_weak(old_state, old_state | TRACKED | EVICTABLE | REFERENCED)) {
+    if ((old_state & TRACKED) != 0) {
+      state.fetch_or(REFERENCED);
+      return;
+    }
+  }
+  size_++;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &state = states_[frame_id];
+  uint8_t old_state = state.load();
+  uint8_t new_state;
+  do {
+    if ((old_state & TRACKED) == 0 || ((old_state & EVICTABLE) != 0) == set_evictable) {
+      return;
+    }
+    new_state = static_cast<uint8_t>(old_state ^ EVICTABLE);
+  } while (!state.compare_exchange_weak(old_state, new_state));
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &state = states_[frame_id];
+  uint8_t old_state = state.load();
+  do {
+    if ((old_state & (TRACKED | EVICTABLE)) != (TRACKED | EVICTABLE)) {
+      return;
+    }
+  } while (!state.compare_exchange_weak(old_state, 0));
+  size_--;
+}
+
+auto ClockReplacer::Size() -> size_t { return size_.load(); }
 
 }  // namespace bustub
@@ -14,143 +14,155 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames),
+      k_(k),
+      history_(num_frames * k),
+      access_count_(num_frames, 0),
+      evictable_(num_frames, false),
+      priority_(num_frames, 0),
+      heap_pos_(num_frames, NOT_IN_HEAP) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+  heap_.reserve(num_frames);
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-    std::scoped_lock<std::mutex> lock(latch_);
-    return EvictInstance(frame_id);
- }
-
-auto LRUKReplacer::EvictInstance(frame_id_t *frame_id) -> bool { 
-    //std::unique_lock<std::mutex> lock(latch_);
-    //Print_mem();
-    // there are no evictable frames
-    if (curr_size_ == 0) { return false; }
-    // 在 new_frame（+inf）里面淘汰
-    for (auto it = new_frame_.rbegin(); it != new_frame_.rend(); it++){
-        // evictable
-        if (frame_evictable_[(*it)]){
-            *frame_id = *it;
-            // delete
-            frame_timestamp_.erase(*it);
-            frame_evictable_.erase(*it);
-            frame_k_.erase(*it);
-            new_frame_umap_.erase(*it);
-            new_frame_.remove(*it);
-            curr_size_--;
-            return true;
-        }
-    }
-    // 在 cache_frame 里面淘汰
-    for (auto it = cache_frame_.begin(); it != cache_frame_.end(); it++){
-        // evictable
-        if (frame_evictable_[(*it).first]){
-            *frame_id = (*it).first;
-            // delete
-            frame_timestamp_.erase((*it).first);
-            frame_evictable_.erase((*it).first);
-            frame_k_.erase((*it).first);
-            cache_frame_umap_.erase((*it).first);
-            cache_frame_.remove(*it);
-            curr_size_--;
-            return true;
-        }
-    }
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (heap_.empty()) {
     return false;
+  }
+  *frame_id = heap_.front();
+  HeapErase(0);
+  ResetFrame(*frame_id);
+  curr_size_--;
+  return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
-    std::scoped_lock<std::mutex> lock(latch_);
-    if(frame_k_.find(frame_id) == frame_k_.end()){ frame_k_[frame_id] = 0; }
-    frame_k_[frame_id]++;
-    frame_timestamp_[frame_id].push_back(current_timestamp_);
-    current_timestamp_++;
-    auto cnt = frame_k_[frame_id];
-    // if 新加入
-    if (cnt == 1) {
-        // 满，驱逐
-        if(curr_size_ == replacer_size_){
-            frame_id_t tmp_frame;
-            EvictInstance(&tmp_frame);
-        }
-        // 未满，加入 new_
-        frame_evictable_[frame_id] = true; // 默认可驱逐
-        curr_size_++;
-        new_frame_.push_front(frame_id);
-        new_frame_umap_[frame_id] = new_frame_.begin();
-        return;
-    }
-    // 达到 k次，从 new_中加入到 cache_中
-    if (cnt == k_) {
-        new_frame_.remove(frame_id);
-        new_frame_umap_.erase(frame_id);
-        auto kth_timestamp = frame_timestamp_[frame_id].front();
-        auto new_cache = std::make_pair(frame_id, kth_timestamp);
-        auto it = std::upper_bound(cache_frame_.begin(),cache_frame_.end(),new_cache
-            ,[&](const std::pair<frame_id_t, size_t>& a, const std::pair<frame_id_t, size_t>& b) {
-                return a.second < b.second;
-            });
-        it = cache_frame_.insert(it,new_cache);
-        cache_frame_umap_[frame_id] = it;
-        return;
-    }
-    // >k 次，在 cache_中调整
-    if (cnt > k_) {
-        // 删除时间戳冗余项
-        frame_timestamp_[frame_id].erase(frame_timestamp_[frame_id].begin());
-        // 除旧
-        cache_frame_.erase(cache_frame_umap_[frame_id]);
-        // 填新
-        auto kth_timestamp = frame_timestamp_[frame_id].front();
-        auto new_cache = std::make_pair(frame_id, kth_timestamp);
-        auto it = std::upper_bound(cache_frame_.begin(),cache_frame_.end(),new_cache
-            ,[&](const std::pair<frame_id_t, size_t>& a, const std::pair<frame_id_t, size_t>& b) {
-                return a.second < b.second;
-            });
-        it = cache_frame_.insert(it,new_cache);
-        cache_frame_umap_[frame_id] = it;
-        return;
-    }
-    // <k 次，不需要处理
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &count = access_count_[frame_id];
+  history_[frame_id * k_ + count % k_] = current_timestamp_++;
+  count++;
+  if (count == 1) {
+    // A frame seen for the first time starts out evictable.
+    evictable_[frame_id] = true;
+    curr_size_++;
+    HeapPush(frame_id);
+    return;
+  }
+  if (heap_pos_[frame_id] != NOT_IN_HEAP) {
+    // The priority only ever grows on access, so the frame can only move down.
+    priority_[frame_id] = Priority(frame_id);
+    SiftDown(heap_pos_[frame_id]);
+  }
 }
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) { 
-    std::scoped_lock<std::mutex> lock(latch_);
-    if(frame_evictable_.find(frame_id) == frame_evictable_.end()) return;
-    if(frame_evictable_[frame_id] == set_evictable) return;
-    frame_evictable_[frame_id] = set_evictable;
-    if(set_evictable){curr_size_++; replacer_size_++;}
-    else{curr_size_--; replacer_size_--;}
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (access_count_[frame_id] == 0 || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+    HeapPush(frame_id);
+  } else {
+    curr_size_--;
+    HeapErase(heap_pos_[frame_id]);
+  }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
-    std::scoped_lock<std::mutex> lock(latch_);
-    // 防止重复remove
-    if(frame_evictable_.find(frame_id) == frame_evictable_.end()) return;
-    if (frame_evictable_[frame_id]) { curr_size_--; }
-    else { // non-evictable, cannot be removed
-        // replacer_size_++; 
-        return;
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Unknown and non-evictable frames are left alone.
+  if (access_count_[frame_id] == 0 || !evictable_[frame_id]) {
+    return;
+  }
+  HeapErase(heap_pos_[frame_id]);
+  ResetFrame(frame_id);
+  curr_size_--;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto LRUKReplacer::Priority(frame_id_t frame_id) const -> uint64_t {
+  const size_t count = access_count_[frame_id];
+  if (count < k_) {
+    return history_[frame_id * k_];
+  }
+  // The slot about to be overwritten holds the k-th most recent access.
+  return history_[frame_id * k_ + count % k_] | K_ACCESSES_BIT;
+}
+
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  priority_[frame_id] = Priority(frame_id);
+  heap_.push_back(frame_id);
+  heap_pos_[frame_id] = heap_.size() - 1;
+  SiftUp(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapErase(size_t pos) {
+  heap_pos_[heap_[pos]] = NOT_IN_HEAP;
+  const frame_id_t last = heap_.back();
+  heap_.pop_back();
+  if (pos == heap_.size()) {
+    return;
+  }
+  HeapPlace(pos, last);
+  if (pos > 0 && priority_[last] < priority_[heap_[(pos - 1) / 2]]) {
+    SiftUp(pos);
+  } else {
+    SiftDown(pos);
+  }
+}
+
+void LRUKReplacer::SiftUp(size_t pos) {
+  const frame_id_t frame_id = heap_[pos];
+  while (pos > 0) {
+    const size_t parent = (pos - 1) / 2;
+    if (priority_[heap_[parent]] <= priority_[frame_id]) {
+      break;
     }
-    frame_timestamp_.erase(frame_id);
-    frame_evictable_.erase(frame_id);
-    frame_k_.erase(frame_id);
-    for (auto it = new_frame_.begin(); it != new_frame_.end(); it++){
-        if (*it == frame_id) {
-            new_frame_umap_.erase(*it);
-            new_frame_.remove(*it);
-            return;
-        }
+    HeapPlace(pos, heap_[parent]);
+    pos = parent;
+  }
+  HeapPlace(pos, frame_id);
+}
+
+void LRUKReplacer::SiftDown(size_t pos) {
+  const frame_id_t frame_id = heap_[pos];
+  const size_t size = heap_.size();
+  while (true) {
+    size_t child = 2 * pos + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && priority_[heap_[child + 1]] < priority_[heap_[child]]) {
+      child++;
     }
-    for (auto it = cache_frame_.begin(); it != cache_frame_.end(); it++){
-        if((*it).first == frame_id) {
-            cache_frame_umap_.erase((*it).first);
-            cache_frame_.remove(*it);
-            return;
-        }
+    if (priority_[frame_id] <= priority_[heap_[child]]) {
+      break;
     }
+    HeapPlace(pos, heap_[child]);
+    pos = child;
+  }
+  HeapPlace(pos, frame_id);
 }
 
-auto LRUKReplacer::Size() -> size_t { std::scoped_lock<std::mutex> lock(latch_); return curr_size_; }
+void LRUKReplacer::HeapPlace(size_t pos, frame_id_t frame_id) {
+  heap_[pos] = frame_id;
+  heap_pos_[frame_id] = pos;
+}
+
+void LRUKReplacer::ResetFrame(frame_id_t frame_id) {
+  access_count_[frame_id] = 0;
+  evictable_[frame_id] = false;
+}
 
 }  // namespace bustub
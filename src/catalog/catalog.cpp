@@ -0,0 +1,301 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// catalog.cpp
+//
+// Identification: src/catalog/catalog.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/catalog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "storage/page/catalog_page.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * The serialized catalog (all numbers in host byte order, strings and lists prefixed by their length):
+ *
+ *  | NextTableOid | NextIndexOid | TableCount | Table_1 | ... | IndexCount | Index_1 | ... |
+ *
+ * Table: | Oid | Name | FirstPageId | ColumnCount | Column_1 name, type, length | ... |
+ * Index: | Oid | Name | TableName | KeyAttrs | IncludedAttrs | IsUnique | KeySize |
+ */
+class CatalogWriter {
+ public:
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto *bytes = reinterpret_cast<const char *>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void WriteString(const std::string &value) {
+    Write(static_cast<uint32_t>(value.size()));
+    data_.insert(data_.end(), value.begin(), value.end());
+  }
+
+  void WriteAttrs(const std::vector<uint32_t> &attrs) {
+    Write(static_cast<uint32_t>(attrs.size()));
+    for (auto attr : attrs) {
+      Write(attr);
+    }
+  }
+
+  auto GetData() const -> const std::vector<char> & { return data_; }
+
+ private:
+  std::vector<char> data_;
+};
+
+class CatalogReader {
+ public:
+  explicit CatalogReader(std::vector<char> data) : data_(std::move(data)) {}
+
+  template <typename T>
+  auto Read() -> T {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    memcpy(&value, Take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  auto ReadString() -> std::string {
+    const auto size = Read<uint32_t>();
+    return {Take(size), size};
+  }
+
+  auto ReadAttrs() -> std::vector<uint32_t> {
+    std::vector<uint32_t> attrs(Read<uint32_t>());
+    for (auto &attr : attrs) {
+      attr = Read<uint32_t>();
+    }
+    return attrs;
+  }
+
+ private:
+  auto Take(size_t size) -> const char * {
+    if (size > data_.size() - offset_) {
+      throw Exception("the catalog pages of the database file are corrupt");
+    }
+    offset_ += size;
+    return data_.data() + offset_ - size;
+  }
+
+  std::vector<char> data_;
+  size_t offset_{0};
+};
+
+template <size_t KeySize>
+auto OpenBPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *bpm,
+                        const std::string &root_record_name) -> std::unique_ptr<Index> {
+  auto index = std::make_unique<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(
+      std::move(metadata), bpm, BPlusTreeMode::CLASSIC, root_record_name);
+  index->LoadRootPageId();
+  return index;
+}
+
+/** @return the B+ tree index an earlier run built over keys of key_size bytes */
+auto OpenIndex(size_t key_size, std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *bpm,
+               const std::string &root_record_name) -> std::unique_ptr<Index> {
+  switch (key_size) {
+    case 4:
+      return OpenBPlusTreeIndex<4>(std::move(metadata), bpm, root_record_name);
+    case 8:
+      return OpenBPlusTreeIndex<8>(std::move(metadata), bpm, root_record_name);
+    case 16:
+      return OpenBPlusTreeIndex<16>(std::move(metadata), bpm, root_record_name);
+    case 32:
+      return OpenBPlusTreeIndex<32>(std::move(metadata), bpm, root_record_name);
+    case 64:
+      return OpenBPlusTreeIndex<64>(std::move(metadata), bpm, root_record_name);
+    default:
+      throw Exception("the catalog pages of the database file are corrupt");
+  }
+}
+
+auto FetchPage(BufferPoolManager *bpm, page_id_t page_id) -> Page * {
+  Page *page = bpm->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a catalog page: all frames are pinned");
+  }
+  return page;
+}
+
+/** @return the id of a new, empty catalog page */
+auto NewCatalogPage(BufferPoolManager *bpm) -> page_id_t {
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a catalog page: all frames are pinned");
+  }
+  static_cast<CatalogPage *>(page)->Init();
+  bpm->UnpinPage(page_id, true);
+  return page_id;
+}
+
+}  // namespace
+
+auto Catalog::Open() -> bool {
+  BUSTUB_ASSERT(tables_.empty(), "the catalog must be opened before any table is created");
+  persistent_ = true;
+
+  Page *header_page = FetchPage(bpm_, HEADER_PAGE_ID);
+  page_id_t page_id;
+  header_page->RLatch();
+  const bool found = static_cast<HeaderPage *>(header_page)->GetRootId(CatalogPage::CATALOG_RECORD_NAME, &page_id);
+  header_page->RUnlatch();
+  bpm_->UnpinPage(HEADER_PAGE_ID, false);
+  if (!found) {
+    return false;
+  }
+
+  std::vector<char> data;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = static_cast<CatalogPage *>(FetchPage(bpm_, page_id));
+    data.insert(data.end(), page->GetCatalogData(), page->GetCatalogData() + page->GetDataSize());
+    const page_id_t next_page_id = page->GetNextPageId();
+    bpm_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  CatalogReader reader(std::move(data));
+  next_table_oid_ = reader.Read<table_oid_t>();
+  next_index_oid_ = reader.Read<index_oid_t>();
+
+  for (auto table_count = reader.Read<uint32_t>(); table_count > 0; table_count--) {
+    const auto table_oid = reader.Read<table_oid_t>();
+    auto table_name = reader.ReadString();
+    const auto first_page_id = reader.Read<page_id_t>();
+    std::vector<Column> columns;
+    for (auto column_count = reader.Read<uint32_t>(); column_count > 0; column_count--) {
+      auto column_name = reader.ReadString();
+      const auto type = static_cast<TypeId>(reader.Read<uint32_t>());
+      const auto length = reader.Read<uint32_t>();
+      if (type == TypeId::VARCHAR) {
+        columns.emplace_back(std::move(column_name), type, length);
+      } else {
+        columns.emplace_back(std::move(column_name), type);
+      }
+    }
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, first_page_id);
+    tables_.emplace(table_oid, std::make_unique<TableInfo>(Schema(columns), table_name, std::move(table), table_oid));
+    table_names_.emplace(table_name, table_oid);
+    index_names_.emplace(std::move(table_name), std::unordered_map<std::string, index_oid_t>{});
+  }
+
+  for (auto index_count = reader.Read<uint32_t>(); index_count > 0; index_count--) {
+    const auto index_oid = reader.Read<index_oid_t>();
+    auto index_name = reader.ReadString();
+    auto table_name = reader.ReadString();
+    const auto key_attrs = reader.ReadAttrs();
+    const auto included_attrs = reader.ReadAttrs();
+    const auto is_unique = reader.Read<bool>();
+    const auto key_size = reader.Read<uint32_t>();
+
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO) {
+      throw Exception("the catalog pages of the database file are corrupt");
+    }
+    const Schema &schema = table_info->schema_;
+    auto metadata =
+        std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique, included_attrs);
+    auto index = OpenIndex(key_size, std::move(metadata), bpm_, RootRecordName(index_oid));
+    index_names_[table_name].emplace(index_name, index_oid);
+    indexes_.emplace(index_oid, std::make_unique<IndexInfo>(Schema::CopySchema(&schema, key_attrs), index_name,
+                                                            std::move(index), index_oid, table_name, key_size));
+  }
+  return true;
+}
+
+void Catalog::Save() {
+  if (!persistent_) {
+    return;
+  }
+
+  CatalogWriter writer;
+  writer.Write(next_table_oid_.load());
+  writer.Write(next_index_oid_.load());
+  // tables without a heap are not kept
+  const auto table_count = std::count_if(tables_.begin(), tables_.end(),
+                                         [](const auto &table) { return table.second->table_ != nullptr; });
+  writer.Write(static_cast<uint32_t>(table_count));
+  for (const auto &[table_oid, table_info] : tables_) {
+    if (table_info->table_ == nullptr) {
+      continue;
+    }
+    writer.Write(table_oid);
+    writer.WriteString(table_info->name_);
+    writer.Write(table_info->table_->GetFirstPageId());
+    writer.Write(table_info->schema_.GetColumnCount());
+    for (const auto &column : table_info->schema_.GetColumns()) {
+      writer.WriteString(column.GetName());
+      writer.Write(static_cast<uint32_t>(column.GetType()));
+      writer.Write(column.GetLength());
+    }
+  }
+  writer.Write(static_cast<uint32_t>(indexes_.size()));
+  for (const auto &[index_oid, index_info] : indexes_) {
+    const IndexMetadata *metadata = index_info->index_->GetMetadata();
+    writer.Write(index_oid);
+    writer.WriteString(index_info->name_);
+    writer.WriteString(index_info->table_name_);
+    writer.WriteAttrs(metadata->GetKeyAttrs());
+    writer.WriteAttrs(metadata->GetIncludedAttrs());
+    writer.Write(metadata->IsUnique());
+    writer.Write(static_cast<uint32_t>(index_info->key_size_));
+  }
+
+  // the header page is shared with the roots of the indexes
+  Page *header_page = FetchPage(bpm_, HEADER_PAGE_ID);
+  auto *header = static_cast<HeaderPage *>(header_page);
+  page_id_t page_id;
+  bool recorded = true;
+  header_page->WLatch();
+  if (!header->GetRootId(CatalogPage::CATALOG_RECORD_NAME, &page_id)) {
+    page_id = NewCatalogPage(bpm_);
+    recorded = header->InsertRecord(CatalogPage::CATALOG_RECORD_NAME, page_id);
+  }
+  header_page->WUnlatch();
+  bpm_->UnpinPage(HEADER_PAGE_ID, true);
+  if (!recorded) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the header page has no room for the catalog");
+  }
+
+  // overwrite the chain, growing it as needed; the pages past the catalog are left empty
+  const std::vector<char> &data = writer.GetData();
+  size_t offset = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = static_cast<CatalogPage *>(FetchPage(bpm_, page_id));
+    const auto size = static_cast<uint32_t>(std::min<size_t>(CatalogPage::CAPACITY, data.size() - offset));
+    page->SetData(data.data() + offset, size);
+    offset += size;
+    page_id_t next_page_id = page->GetNextPageId();
+    if (offset < data.size() && next_page_id == INVALID_PAGE_ID) {
+      next_page_id = NewCatalogPage(bpm_);
+      page->SetNextPageId(next_page_id);
+    }
+    bpm_->UnpinPage(page_id, true);
+    page_id = next_page_id;
+  }
+}
+
+auto Catalog::RootRecordName(index_oid_t index_oid) -> std::string { return fmt::format("__index_{}", index_oid); }
+
+}  // namespace bustub
@@ -33,12 +33,26 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/page/header_page.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  const size_t threads = GetExecutionThreads();
+  if (threads == 1) {
+    return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  }
+  std::shared_ptr<WorkStealingPool> workers;
+  {
+    std::scoped_lock l(execution_workers_lock_);
+    if (execution_workers_ == nullptr || execution_workers_->GetWorkerCount() != threads) {
+      execution_workers_ = std::make_shared<WorkStealingPool>(threads);
+    }
+    workers = execution_workers_;
+  }
+  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_,
+                                           std::move(workers));
 }
 
 BustubInstance::BustubInstance(const std::string &db_file_name) {
@@ -66,8 +80,12 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // Checkpoint related.
   checkpoint_manager_ = new CheckpointManager(txn_manager_, log_manager_, buffer_pool_manager_);
 
-  // Catalog.
+  // Catalog, kept in the database file: reopening the file reads the tables and indexes back without rebuilding them.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
+  if (buffer_pool_manager_ != nullptr) {
+    InitHeaderPage();
+    catalog_->Open();
+  }
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
@@ -100,11 +118,34 @@ BustubInstance::BustubInstance() {
 
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
+  if (buffer_pool_manager_ != nullptr) {
+    InitHeaderPage();
+  }
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
+void BustubInstance::InitHeaderPage() {
+  page_id_t page_id = HEADER_PAGE_ID;
+  Page *page;
+  if (disk_manager_->GetNumPages() > HEADER_PAGE_ID) {
+    page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+    BUSTUB_ASSERT(page != nullptr, "cannot fetch the header page");
+    const int record_count = static_cast<HeaderPage *>(page)->GetRecordCount();
+    if (record_count >= 0 && record_count <= HeaderPage::MAX_RECORD_COUNT) {
+      buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+      return;
+    }
+    // not a database file this version wrote: start over, leaving the pages that are there unused
+  } else {
+    page = buffer_pool_manager_->NewPage(&page_id);
+    BUSTUB_ASSERT(page != nullptr && page_id == HEADER_PAGE_ID, "the header page must be the first page");
+  }
+  static_cast<HeaderPage *>(page)->Init();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
 void BustubInstance::CmdDisplayTables(ResultWriter &writer) {
   auto table_names = catalog_->GetTableNames();
   writer.BeginTable(false);
@@ -174,7 +215,15 @@ see the execution plan of your query.
 
 auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
   auto txn = txn_manager_->Begin();
-  auto result = ExecuteSqlTxn(sql, writer, txn);
+  bool result;
+  try {
+    result = ExecuteSqlTxn(sql, writer, txn);
+  } catch (...) {
+    // roll back what the statement did so far, e.g. the rows of an insert that hit a duplicate key
+    txn_manager_->Abort(txn);
+    delete txn;
+    throw;
+  }
   txn_manager_->Commit(txn);
   delete txn;
   return result;
@@ -224,23 +273,33 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::INDEX_STATEMENT: {
         const auto &index_stmt = dynamic_cast<const IndexStatement &>(*statement);
 
-        std::vector<uint32_t> col_ids;
-        for (const auto &col : index_stmt.cols_) {
-          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
-          col_ids.push_back(idx);
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
+        const auto column_ids = [&](const std::vector<std::unique_ptr<BoundColumnRef>> &cols) {
+          std::vector<uint32_t> col_ids;
+          for (const auto &col : cols) {
+            auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
+            col_ids.push_back(idx);
+            const TypeId type = index_stmt.table_->schema_.GetColumn(idx).GetType();
+            if (type == TypeId::VARCHAR || type == TypeId::TIMESTAMP) {
+              throw NotImplementedException("only support creating index on numeric or boolean columns");
+            }
           }
-        }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
-        }
+          return col_ids;
+        };
+        const std::vector<uint32_t> col_ids = column_ids(index_stmt.cols_);
+        const std::vector<uint32_t> included_ids = column_ids(index_stmt.included_cols_);
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
+        // a non-unique index appends the RID to its keys, and the included columns come last
+        const size_t key_size = key_schema.GetLength() + (index_stmt.unique_ ? 0 : sizeof(int64_t)) +
+                                Schema::CopySchema(&index_stmt.table_->schema_, included_ids).GetLength();
+        if (key_size > INDEX_KEY_SIZE) {
+          throw NotImplementedException(fmt::format("index keys take {} bytes, at most {} are supported", key_size,
+                                                    static_cast<size_t>(INDEX_KEY_SIZE)));
+        }
 
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+        auto info = catalog_->CreateIndex<IndexKeyType, IndexValueType, IndexComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+            INDEX_KEY_SIZE, IndexHashFunctionType{}, index_stmt.unique_, included_ids);
         l.unlock();
 
         if (info == nullptr) {
@@ -257,7 +316,7 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
-        session_variables_[set_stmt.variable_] = set_stmt.value_;
+        SetSessionVariable(set_stmt.variable_, set_stmt.value_);
         continue;
       }
       case StatementType::EXPLAIN_STATEMENT: {
@@ -391,6 +450,10 @@ BustubInstance::~BustubInstance() {
   if (enable_logging) {
     log_manager_->StopFlushThread();
   }
+  // the next run reopens the database from its file
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->FlushAllPages();
+  }
   delete execution_engine_;
   delete catalog_;
   delete checkpoint_manager_;
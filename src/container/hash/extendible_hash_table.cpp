@@ -10,10 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <new>
+#include <string>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "container/hash/extendible_hash_table.h"
@@ -23,7 +27,17 @@ namespace bustub {
 
 template <typename K, typename V>
 ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {dir_.push_back(std::make_shared<Bucket>(bucket_size, 0));}
+    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
+  directories_.push_back(std::make_unique<Directory>(1));
+  directories_.back()->slots_[0] = NewBucket(0);
+  dir_ = directories_.back().get();
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::NewBucket(int depth) -> Bucket * {
+  buckets_.push_back(Bucket::Create(bucket_size_, depth));
+  return buckets_.back().get();
+}
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
@@ -31,10 +45,17 @@ auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
   return std::hash<K>()(key) & mask;
 }
 
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::BucketAt(size_t dir_index) const -> Bucket * {
+  return dir_.load(std::memory_order_relaxed)->slots_[dir_index].load(std::memory_order_relaxed);
+}
+
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  //std::scoped_lock<std::mutex> lock(latch_);
-  return GetGlobalDepthInternal();
+  latch_.RLock();
+  auto global_depth = GetGlobalDepthInternal();
+  latch_.RUnlock();
+  return global_depth;
 }
 
 template <typename K, typename V>
@@ -44,19 +65,23 @@ auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  //std::scoped_lock<std::mutex> lock(latch_);
-  return GetLocalDepthInternal(dir_index);
+  latch_.RLock();
+  auto local_depth = GetLocalDepthInternal(dir_index);
+  latch_.RUnlock();
+  return local_depth;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+  return BucketAt(dir_index)->GetDepth();
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  //std::scoped_lock<std::mutex> lock(latch_);
-  return GetNumBucketsInternal();
+  latch_.RLock();
+  auto num_buckets = GetNumBucketsInternal();
+  latch_.RUnlock();
+  return num_buckets;
 }
 
 template <typename K, typename V>
@@ -66,123 +91,251 @@ auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  //UNREACHABLE("not implemented");
-  std::scoped_lock<std::mutex> lock(latch_);
+  if constexpr (OPTIMISTIC_FIND) {
+    for (int attempt = 0; attempt < OPTIMISTIC_FIND_ATTEMPTS; attempt++) {
+      const uint64_t dir_version = dir_version_.load(std::memory_order_acquire);
+      if ((dir_version & 1) != 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      const Directory *dir = dir_.load(std::memory_order_acquire);
+      const Bucket *bucket = dir->slots_[std::hash<K>()(key) & (dir->size_ - 1)].load(std::memory_order_acquire);
+      V candidate{};
+      bool found;
+      if (!bucket->FindOptimistic(key, &candidate, &found)) {
+        continue;
+      }
+      // A split may have moved the key to another bucket since we read the directory.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (dir_version_.load(std::memory_order_relaxed) != dir_version) {
+        continue;
+      }
+      if (found) {
+        value = candidate;
+      }
+      return found;
+    }
+  }
 
-  auto directory_index = IndexOf(key);
-  auto target_bucket = dir_[directory_index];
-  if(target_bucket->Find(key, value)) {return true;}
-  return false;
+  latch_.RLock();
+  auto *target_bucket = BucketAt(IndexOf(key));
+  target_bucket->GetLatch().RLock();
+  bool found = target_bucket->Find(key, value);
+  target_bucket->GetLatch().RUnlock();
+  latch_.RUnlock();
+  return found;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  //UNREACHABLE("not implemented");
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  auto directory_index = IndexOf(key);
-  auto target_bucket = dir_[directory_index];
-  if(target_bucket->Remove(key)) {return true;}
-  return false;
+  latch_.RLock();
+  auto *target_bucket = BucketAt(IndexOf(key));
+  target_bucket->GetLatch().WLock();
+  bool removed = target_bucket->Remove(key);
+  target_bucket->GetLatch().WUnlock();
+  latch_.RUnlock();
+  return removed;
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  //UNREACHABLE("not implemented");
-  std::scoped_lock<std::mutex> lock(latch_);
+  // Fast path: the bucket has room, so only the bucket is latched exclusively.
+  latch_.RLock();
+  {
+    auto *target_bucket = BucketAt(IndexOf(key));
+    target_bucket->GetLatch().WLock();
+    bool inserted = target_bucket->Insert(key, value);
+    target_bucket->GetLatch().WUnlock();
+    if (inserted) {
+      latch_.RUnlock();
+      return;
+    }
+  }
+  latch_.RUnlock();
 
+  // Slow path: split under the exclusive directory latch, which keeps every other operation out, until the key fits.
+  // Another thread may have split or filled the bucket in between, so always retry the insert first.
+  latch_.WLock();
   auto directory_index = IndexOf(key);
-  auto target_bucket = dir_[directory_index];
-  // 满了
-  while(!target_bucket->Insert(key, value)){
-    // 1
-    if(GetLocalDepth(directory_index) == GetGlobalDepth()){
-      global_depth_++;
-      //std::cout << "start loop.. dir_.size() = " << dir_.size() << std::endl;
-      int length = dir_.size();
-      dir_.resize(length << 1);
-      for (int i = 0; i < length; ++i) {
-        dir_[i + length] = dir_[i];
-      }
-    }
-    // 2
-    target_bucket->IncrementDepth();
-    //std::cout << "Finished 1 2" << std::endl;
-    // 3
-    
-    auto mask = 1 << (target_bucket->GetDepth() - 1);
-    auto bucket_0 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth());
-    auto bucket_1 = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth());
-    num_buckets_++;
-    for (size_t i = 0; i < dir_.size(); ++i) {
-      if (dir_[i] == target_bucket) {
-        if ((i & mask) == 0) {
-            dir_[i] = bucket_0;
-          } else {
-            dir_[i] = bucket_1;
-          }
-      }
+  while (!BucketAt(directory_index)->Insert(key, value)) {
+    SplitBucket(directory_index);
+    directory_index = IndexOf(key);
+  }
+  latch_.WUnlock();
+}
+
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::SplitBucket(size_t directory_index) {
+  // Lock-free readers retry until the directory and the entries are consistent again.
+  dir_version_.store(dir_version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  Directory *dir = dir_.load(std::memory_order_relaxed);
+  auto *target_bucket = dir->slots_[directory_index].load(std::memory_order_relaxed);
+  // 1
+  if (GetLocalDepthInternal(directory_index) == GetGlobalDepthInternal()) {
+    global_depth_++;
+    // readers may still be on the old directory, so it is kept
+    directories_.push_back(std::make_unique<Directory>(dir->size_ << 1));
+    Directory *grown = directories_.back().get();
+    for (size_t i = 0; i < dir->size_; ++i) {
+      auto *bucket = dir->slots_[i].load(std::memory_order_relaxed);
+      grown->slots_[i].store(bucket, std::memory_order_relaxed);
+      grown->slots_[i + dir->size_].store(bucket, std::memory_order_relaxed);
     }
-    // for (size_t i = 0; i < dir_.size(); ++i) {
-    //   if (dir_[i] == target_bucket) {
-    //     dir_[i] = std::make_shared<Bucket>(bucket_size_, target_bucket->GetDepth());
-    //   }
-    // }
-    for(auto &item : target_bucket->GetItems()) {
-      //Insert(item.first, item.second);
-      auto cur_directory_index = IndexOf(item.first);
-      dir_[cur_directory_index]->Insert(item.first, item.second);
+    dir_.store(grown, std::memory_order_release);
+    dir = grown;
+  }
+  // 2
+  target_bucket->IncrementDepth();
+  // 3: the full bucket keeps the entries whose new bit is clear, and its split image takes the others
+  size_t mask = size_t{1} << (target_bucket->GetDepth() - 1);
+  auto *image = NewBucket(target_bucket->GetDepth());
+  num_buckets_++;
+  for (size_t i = 0; i < dir->size_; ++i) {
+    if ((i & mask) != 0 && dir->slots_[i].load(std::memory_order_relaxed) == target_bucket) {
+      dir->slots_[i].store(image, std::memory_order_relaxed);
     }
-    directory_index = IndexOf(key);
-    target_bucket = dir_[directory_index];
-    //std::cout << "Finished 3" << std::endl;
   }
-  //std::cout << "EX_Hash_Table_insert_success  " << directory_index << "  " << target_bucket << std::endl;
+  target_bucket->Split(image, mask);
+
+  dir_version_.store(dir_version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Create(size_t size, int depth) -> Ptr {
+  static_assert(alignof(Bucket) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ &&
+                    alignof(Entry) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                "buckets are allocated with the default alignment");
+  void *memory = ::operator new(EntriesOffset() + size * sizeof(Entry));
+  return Ptr(new (memory) Bucket(size, depth), &Bucket::Destroy);
+}
+
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::Destroy(Bucket *bucket) {
+  bucket->~Bucket();
+  ::operator delete(bucket);
+}
+
 template <typename K, typename V>
 ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
 
+template <typename K, typename V>
+ExtendibleHashTable<K, V>::Bucket::~Bucket() {
+  std::destroy_n(Entries(), count_.load(std::memory_order_relaxed));
+}
+
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::BeginWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::EndWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  //UNREACHABLE("not implemented");
-  for(auto it = list_.begin(); it != list_.end(); it++){
-    if((*it).first == key) { value = (*it).second; return true; }
+  Entry *entries = Entries();
+  const size_t count = count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; i++) {
+    if (entries[i].first == key) {
+      value = entries[i].second;
+      return true;
+    }
   }
   return false;
 }
 
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::FindOptimistic(const K &key, V *value, bool *found) const -> bool {
+  const uint64_t version = version_.load(std::memory_order_acquire);
+  if ((version & 1) != 0) {
+    return false;
+  }
+  // The entries may be changing under us. Keys and values are trivially copyable, so a torn one is only compared or
+  // copied, and the version check below discards the result.
+  const Entry *entries = Entries();
+  const size_t count = std::min(count_.load(std::memory_order_relaxed), size_);
+  *found = false;
+  for (size_t i = 0; i < count; i++) {
+    if (entries[i].first == key) {
+      *value = entries[i].second;
+      *found = true;
+      break;
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return version_.load(std::memory_order_relaxed) == version;
+}
+
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  //UNREACHABLE("not implemented");
-  for(auto it = list_.begin(); it != list_.end(); it++){
-    if((*it).first == key) { list_.erase(it); return true; }
+  Entry *entries = Entries();
+  const size_t count = count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; i++) {
+    if (entries[i].first == key) {
+      BeginWrite();
+      // Order does not matter, so fill the hole with the last entry.
+      if (i != count - 1) {
+        entries[i] = std::move(entries[count - 1]);
+      }
+      std::destroy_at(&entries[count - 1]);
+      count_.store(count - 1, std::memory_order_relaxed);
+      EndWrite();
+      return true;
+    }
   }
   return false;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  //UNREACHABLE("not implemented");
-  for(auto it = list_.begin(); it != list_.end(); it++){
-    if((*it).first == key) { 
-      (*it).second = value; 
-      //std::cout << "insert_update "<< std::endl; 
-      return true; 
+  Entry *entries = Entries();
+  const size_t count = count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; i++) {
+    if (entries[i].first == key) {
+      BeginWrite();
+      entries[i].second = value;
+      EndWrite();
+      return true;
     }
   }
-  if(IsFull()) { 
-    //std::cout << "insert_ISFULL !! "<< std::endl; 
+  if (IsFull()) {
     return false;
   }
-  list_.emplace_back(std::make_pair(key, value));
-  //std::cout << "insert_success , list.size =  "<< list_.size() << std::endl;
+  BeginWrite();
+  new (&entries[count]) Entry(key, value);
+  count_.store(count + 1, std::memory_order_relaxed);
+  EndWrite();
   return true;
 }
 
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::Split(Bucket *image, size_t mask) {
+  BeginWrite();
+  Entry *entries = Entries();
+  size_t count = count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count;) {
+    if ((std::hash<K>()(entries[i].first) & mask) == 0) {
+      i++;
+      continue;
+    }
+    image->Insert(entries[i].first, entries[i].second);
+    if (i != count - 1) {
+      entries[i] = std::move(entries[count - 1]);
+    }
+    std::destroy_at(&entries[--count]);
+  }
+  count_.store(count, std::memory_order_relaxed);
+  EndWrite();
+}
+
 template class ExtendibleHashTable<page_id_t, Page *>;
 template class ExtendibleHashTable<Page *, std::list<Page *>::iterator>;
 template class ExtendibleHashTable<int, int>;
@@ -0,0 +1,232 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// open_addressing_hash_table.cpp
+//
+// Identification: src/container/hash/open_addressing_hash_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "container/hash/open_addressing_hash_table.h"
+
+namespace bustub {
+
+template <typename K, typename V>
+OpenAddressingHashTable<K, V>::OpenAddressingHashTable(size_t capacity) : capacity_(capacity) {
+  // Keep the table at most half full so probe sequences stay short.
+  const size_t min_buckets = (2 * capacity + SLOTS_PER_BUCKET - 1) / SLOTS_PER_BUCKET;
+  num_buckets_ = 1;
+  while (num_buckets_ < min_buckets) {
+    num_buckets_ <<= 1;
+  }
+  bucket_mask_ = num_buckets_ - 1;
+  buckets_ = std::make_unique<Bucket[]>(num_buckets_);
+}
+
+template <typename K, typename V>
+auto OpenAddressingHashTable<K, V>::HomeBucket(const K &key) const -> size_t {
+  // Page ids of one parallel BPM instance share a residue, so scramble the (often identity) std::hash first.
+  uint64_t hash = static_cast<uint64_t>(std::hash<K>()(key)) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash ^ (hash >> 32)) & bucket_mask_;
+}
+
+template <typename K, typename V>
+auto OpenAddressingHashTable<K, V>::SearchBucket(const Bucket &bucket, const K &key, V *value, bool *full) const
+    -> bool {
+  while (true) {
+    const uint32_t version = bucket.version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    const uint32_t occupied = bucket.occupied_.load(std::memory_order_relaxed);
+    bool found = false;
+    for (size_t slot = 0; slot < SLOTS_PER_BUCKET; slot++) {
+      if ((occupied & (uint32_t{1} << slot)) != 0 && bucket.keys_[slot].load(std::memory_order_relaxed) == key) {
+        *value = bucket.values_[slot].load(std::memory_order_relaxed);
+        found = true;
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (bucket.version_.load(std::memory_order_relaxed) == version) {
+      *full = occupied == FULL_MASK;
+      return found;
+    }
+  }
+}
+
+template <typename K, typename V>
+auto OpenAddressingHashTable<K, V>::Find(const K &key, V &value) -> bool {
+  while (true) {
+    const uint64_t shift_version = shift_version_.load(std::memory_order_acquire);
+    if ((shift_version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    size_t bucket_index = HomeBucket(key);
+    for (size_t i = 0; i < num_buckets_; i++) {
+      bool full;
+      if (SearchBucket(buckets_[bucket_index], key, &value, &full)) {
+        return true;
+      }
+      if (!full) {
+        break;
+      }
+      bucket_index = (bucket_index + 1) & bucket_mask_;
+    }
+    // A miss is only trustworthy if no key was moved backwards past us in the meantime.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (shift_version_.load(std::memory_order_relaxed) == shift_version) {
+      return false;
+    }
+  }
+}
+
+template <typename K, typename V>
+auto OpenAddressingHashTable<K, V>::Locate(const K &key, size_t *bucket_index, size_t *slot) const -> bool {
+  size_t index = HomeBucket(key);
+  for (size_t i = 0; i < num_buckets_; i++) {
+    const Bucket &bucket = buckets_[index];
+    const uint32_t occupied = bucket.occupied_.load(std::memory_order_relaxed);
+    for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+      if ((occupied & (uint32_t{1} << s)) != 0 && bucket.keys_[s].load(std::memory_order_relaxed) == key) {
+        *bucket_index = index;
+        *slot = s;
+        return true;
+      }
+    }
+    if (occupied != FULL_MASK) {
+      return false;
+    }
+    index = (index + 1) & bucket_mask_;
+  }
+  return false;
+}
+
+template <typename K, typename V>
+void OpenAddressingHashTable<K, V>::BeginWrite(Bucket *bucket) {
+  bucket->version_.store(bucket->version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V>
+void OpenAddressingHashTable<K, V>::EndWrite(Bucket *bucket) {
+  bucket->version_.store(bucket->version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename K, typename V>
+void OpenAddressingHashTable<K, V>::Insert(const K &key, const V &value) {
+  std::scoped_lock<std::mutex> lock(write_latch_);
+  size_t bucket_index;
+  size_t slot;
+  if (Locate(key, &bucket_index, &slot)) {
+    Bucket &bucket = buckets_[bucket_index];
+    BeginWrite(&bucket);
+    bucket.values_[slot].store(value, std::memory_order_relaxed);
+    EndWrite(&bucket);
+    return;
+  }
+  if (size_.load() >= capacity_) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "open addressing hash table is full");
+  }
+
+  // The table has at least twice as many slots as entries, so a bucket with a free slot exists.
+  bucket_index = HomeBucket(key);
+  while (true) {
+    Bucket &bucket = buckets_[bucket_index];
+    const uint32_t occupied = bucket.occupied_.load(std::memory_order_relaxed);
+    if (occupied != FULL_MASK) {
+      slot = 0;
+      while ((occupied & (uint32_t{1} << slot)) != 0) {
+        slot++;
+      }
+      BeginWrite(&bucket);
+      bucket.keys_[slot].store(key, std::memory_order_relaxed);
+      bucket.values_[slot].store(value, std::memory_order_relaxed);
+      bucket.occupied_.store(occupied | (uint32_t{1} << slot), std::memory_order_relaxed);
+      EndWrite(&bucket);
+      size_++;
+      return;
+    }
+    bucket_index = (bucket_index + 1) & bucket_mask_;
+  }
+}
+
+template <typename K, typename V>
+auto OpenAddressingHashTable<K, V>::Remove(const K &key) -> bool {
+  std::scoped_lock<std::mutex> lock(write_latch_);
+  size_t hole_bucket;
+  size_t hole_slot;
+  if (!Locate(key, &hole_bucket, &hole_slot)) {
+    return false;
+  }
+  Bucket &bucket = buckets_[hole_bucket];
+  const uint32_t hole_occupied = bucket.occupied_.load(std::memory_order_relaxed);
+  // Once the hole's bucket is no longer full, a lookup for a key that probed past it would stop there and miss, so
+  // such lookups must retry until the key that fills the hole is moved in.
+  bool shifting = hole_occupied == FULL_MASK;
+  if (shifting) {
+    shift_version_.store(shift_version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  BeginWrite(&bucket);
+  bucket.occupied_.store(hole_occupied & ~(uint32_t{1} << hole_slot), std::memory_order_relaxed);
+  EndWrite(&bucket);
+  size_--;
+
+  // Backward shift: a key that probed past the hole's bucket moves into the hole, leaving a hole further on. Stop at
+  // the first bucket that is not full, since no key probed past it.
+  for (size_t index = (hole_bucket + 1) & bucket_mask_; index != hole_bucket; index = (index + 1) & bucket_mask_) {
+    Bucket &next = buckets_[index];
+    const uint32_t occupied = next.occupied_.load(std::memory_order_relaxed);
+    for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+      if ((occupied & (uint32_t{1} << s)) == 0) {
+        continue;
+      }
+      const K moved_key = next.keys_[s].load(std::memory_order_relaxed);
+      const size_t home = HomeBucket(moved_key);
+      if (((hole_bucket - home) & bucket_mask_) >= ((index - home) & bucket_mask_)) {
+        continue;
+      }
+      if (!shifting) {
+        shifting = true;
+        shift_version_.store(shift_version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+      }
+      // Copy first, then clear the source, so the key is always present in at least one bucket.
+      Bucket &hole = buckets_[hole_bucket];
+      BeginWrite(&hole);
+      hole.keys_[hole_slot].store(moved_key, std::memory_order_relaxed);
+      hole.values_[hole_slot].store(next.values_[s].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      hole.occupied_.store(hole.occupied_.load(std::memory_order_relaxed) | (uint32_t{1} << hole_slot),
+                           std::memory_order_relaxed);
+      EndWrite(&hole);
+      BeginWrite(&next);
+      next.occupied_.store(occupied & ~(uint32_t{1} << s), std::memory_order_relaxed);
+      EndWrite(&next);
+      hole_bucket = index;
+      hole_slot = s;
+      break;
+    }
+    if (occupied != FULL_MASK) {
+      break;
+    }
+  }
+  if (shifting) {
+    shift_version_.store(shift_version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+  return true;
+}
+
+template class OpenAddressingHashTable<page_id_t, frame_id_t>;
+
+}  // namespace bustub
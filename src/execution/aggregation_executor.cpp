@@ -10,19 +10,102 @@
 //
 //===----------------------------------------------------------------------===//
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "execution/executors/aggregation_executor.h"
+#include "execution/parallel_pipeline.h"
 
 namespace bustub {
 
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
+      aht_iterator_(aht_.Begin()) {}
 
-void AggregationExecutor::Init() {}
+void AggregationExecutor::Init() {
+  aht_.Clear();
+  if (ParallelPipeline::CanRun(exec_ctx_, *plan_->GetChildPlan())) {
+    AggregateInParallel();
+  } else {
+    child_->Init();
+    while (child_->NextBatch(&child_batch_)) {
+      AggregateBatch(child_batch_, &aht_, &group_by_columns_, &aggregate_columns_);
+    }
+  }
 
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // Without groups, aggregating no tuples still yields a tuple
+  if (aht_.Begin() == aht_.End() && plan_->GetGroupBys().empty()) {
+    aht_.InsertInitial(AggregateKey{});
+  }
+  aht_iterator_ = aht_.Begin();
+}
+
+void AggregationExecutor::AggregateBatch(const TupleBatch &batch, SimpleAggregationHashTable *aht,
+                                         std::vector<ColumnVector> *group_by_columns,
+                                         std::vector<ColumnVector> *aggregate_columns) {
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  group_by_columns->resize(group_bys.size());
+  aggregate_columns->resize(aggregates.size());
+  for (size_t i = 0; i < group_bys.size(); i++) {
+    group_bys[i]->EvaluateBatch(batch, &(*group_by_columns)[i]);
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    aggregates[i]->EvaluateBatch(batch, &(*aggregate_columns)[i]);
+  }
+  for (const auto row : batch.GetSelection()) {
+    aht->InsertCombine(MakeAggregateKey(*group_by_columns, row), MakeAggregateValue(*aggregate_columns, row));
+  }
+}
+
+void AggregationExecutor::AggregateInParallel() {
+  ParallelPipeline pipeline(exec_ctx_, plan_->GetChildPlan());
+  std::vector<PartialAggregation> partials;
+  partials.reserve(pipeline.GetWorkerCount());
+  for (size_t i = 0; i < pipeline.GetWorkerCount(); i++) {
+    partials.emplace_back(plan_);
+  }
+  pipeline.Run([&](size_t worker, size_t /*morsel*/, TupleBatch *batch) {
+    auto &partial = partials[worker];
+    AggregateBatch(*batch, &partial.aht_, &partial.group_by_columns_, &partial.aggregate_columns_);
+  });
+  for (auto &partial : partials) {
+    for (auto it = partial.aht_.Begin(); it != partial.aht_.End(); ++it) {
+      aht_.InsertMerge(it.Key(), it.Val());
+    }
+  }
+}
+
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (aht_iterator_ == aht_.End()) {
+    return false;
+  }
+  std::vector<Value> values(aht_iterator_.Key().group_bys_);
+  const auto &aggregates = aht_iterator_.Val().aggregates_;
+  values.insert(values.end(), aggregates.begin(), aggregates.end());
+  *tuple = Tuple(values, &GetOutputSchema());
+  ++aht_iterator_;
+  return true;
+}
+
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  for (; aht_iterator_ != aht_.End() && !batch->IsFull(); ++aht_iterator_) {
+    const size_t row = batch->AppendRow(RID{});
+    uint32_t column_idx = 0;
+    for (const auto &value : aht_iterator_.Key().group_bys_) {
+      batch->GetColumn(column_idx++).SetValue(row, value);
+    }
+    for (const auto &value : aht_iterator_.Val().aggregates_) {
+      batch->GetColumn(column_idx++).SetValue(row, value);
+    }
+  }
+  return batch->Size() > 0;
+}
 
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
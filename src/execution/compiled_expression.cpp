@@ -0,0 +1,449 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.cpp
+//
+// Identification: src/execution/compiled_expression.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/compiled_expression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+auto IsIntegral(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+/** @return the value a column of T holds for NULL, BOOLEAN sharing that of TINYINT */
+template <typename T>
+constexpr auto NullOf() -> T {
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return BUSTUB_INT8_NULL;
+  } else if constexpr (std::is_same_v<T, int16_t>) {
+    return BUSTUB_INT16_NULL;
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return BUSTUB_INT32_NULL;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return BUSTUB_INT64_NULL;
+  } else {
+    static_assert(std::is_same_v<T, double>);
+    return BUSTUB_DECIMAL_NULL;
+  }
+}
+
+/** Read a T at data, which tuples do not align */
+template <typename T>
+auto Read(const char *data) -> T {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+}  // namespace
+
+auto CompiledExpression::Compile(const AbstractExpression &expr, const Schema &schema)
+    -> std::unique_ptr<CompiledExpression> {
+  auto program = std::make_unique<CompiledExpression>();
+  program->schemas_ = {&schema};
+  if (!program->Emit(expr).has_value()) {
+    return nullptr;
+  }
+  program->ret_type_ = program->types_.back();
+  return program;
+}
+
+auto CompiledExpression::CompileJoin(const AbstractExpression &expr, const Schema &left_schema,
+                                     const Schema &right_schema) -> std::unique_ptr<CompiledExpression> {
+  auto program = std::make_unique<CompiledExpression>();
+  program->schemas_ = {&left_schema, &right_schema};
+  if (!program->Emit(expr).has_value()) {
+    return nullptr;
+  }
+  program->ret_type_ = program->types_.back();
+  return program;
+}
+
+auto CompiledExpression::Emit(const AbstractExpression &expr) -> std::optional<uint32_t> {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(&expr); column_expr != nullptr) {
+    // over a single schema the side of a column is ignored, as Evaluate() does
+    const uint32_t tuple_idx = schemas_.size() == 1 ? 0 : column_expr->GetTupleIdx();
+    if (tuple_idx >= schemas_.size() || column_expr->GetColIdx() >= schemas_[tuple_idx]->GetColumnCount()) {
+      return std::nullopt;
+    }
+    const Column &column = schemas_[tuple_idx]->GetColumn(column_expr->GetColIdx());
+    const auto op = LoadOf(column.GetType());
+    if (!op.has_value()) {
+      return std::nullopt;
+    }
+    Instruction load{*op};
+    load.tuple_idx_ = tuple_idx;
+    load.column_idx_ = column_expr->GetColIdx();
+    load.offset_ = column.GetOffset();
+    return Append(load, column.GetType());
+  }
+
+  if (const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(&expr); constant_expr != nullptr) {
+    const Value &value = constant_expr->val_;
+    const auto op = LoadOf(value.GetTypeId());
+    if (!op.has_value()) {
+      return std::nullopt;
+    }
+    char data[sizeof(int64_t)];
+    value.SerializeTo(data);
+    Instruction constant{OpCode::Constant};
+    Load(*op, data, &constant.constant_);
+    return Append(constant, value.GetTypeId());
+  }
+
+  if (expr.GetChildren().size() != 2) {
+    return std::nullopt;
+  }
+  auto lhs = Emit(*expr.GetChildAt(0));
+  auto rhs = lhs.has_value() ? Emit(*expr.GetChildAt(1)) : std::nullopt;
+  if (!rhs.has_value()) {
+    return std::nullopt;
+  }
+  const TypeId lhs_type = types_[*lhs];
+  const TypeId rhs_type = types_[*rhs];
+
+  if (const auto *comparison_expr = dynamic_cast<const ComparisonExpression *>(&expr); comparison_expr != nullptr) {
+    Instruction compare{OpCode::CompareInteger};
+    compare.comparison_ = comparison_expr->comp_type_;
+    const bool both_boolean = lhs_type == TypeId::BOOLEAN && rhs_type == TypeId::BOOLEAN;
+    if (both_boolean || (IsIntegral(lhs_type) && IsIntegral(rhs_type))) {
+      compare.lhs_ = *lhs;
+      compare.rhs_ = *rhs;
+      return Append(compare, TypeId::BOOLEAN);
+    }
+    auto is_numeric = [](TypeId type) { return type == TypeId::DECIMAL || IsIntegral(type); };
+    if (!is_numeric(lhs_type) || !is_numeric(rhs_type)) {
+      return std::nullopt;
+    }
+    // an integer compared to a decimal is compared as a decimal
+    auto to_decimal = [this](uint32_t reg) {
+      if (types_[reg] == TypeId::DECIMAL) {
+        return reg;
+      }
+      Instruction cast{OpCode::IntToDecimal};
+      cast.lhs_ = reg;
+      return Append(cast, TypeId::DECIMAL);
+    };
+    compare.op_ = OpCode::CompareDecimal;
+    compare.lhs_ = to_decimal(*lhs);
+    compare.rhs_ = to_decimal(*rhs);
+    return Append(compare, TypeId::BOOLEAN);
+  }
+
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    if (lhs_type != TypeId::BOOLEAN || rhs_type != TypeId::BOOLEAN) {
+      return std::nullopt;
+    }
+    Instruction logic{logic_expr->logic_type_ == LogicType::And ? OpCode::And : OpCode::Or};
+    logic.lhs_ = *lhs;
+    logic.rhs_ = *rhs;
+    return Append(logic, TypeId::BOOLEAN);
+  }
+
+  if (const auto *arithmetic_expr = dynamic_cast<const ArithmeticExpression *>(&expr); arithmetic_expr != nullptr) {
+    if (lhs_type != TypeId::INTEGER || rhs_type != TypeId::INTEGER) {
+      return std::nullopt;
+    }
+    Instruction arithmetic{arithmetic_expr->compute_type_ == ArithmeticType::Plus ? OpCode::Plus : OpCode::Minus};
+    arithmetic.lhs_ = *lhs;
+    arithmetic.rhs_ = *rhs;
+    return Append(arithmetic, TypeId::INTEGER);
+  }
+
+  return std::nullopt;
+}
+
+auto CompiledExpression::Append(Instruction instruction, TypeId type) -> uint32_t {
+  program_.push_back(instruction);
+  types_.push_back(type);
+  return program_.size() - 1;
+}
+
+auto CompiledExpression::LoadOf(TypeId type) -> std::optional<OpCode> {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return OpCode::LoadInt8;
+    case TypeId::SMALLINT:
+      return OpCode::LoadInt16;
+    case TypeId::INTEGER:
+      return OpCode::LoadInt32;
+    case TypeId::BIGINT:
+      return OpCode::LoadInt64;
+    case TypeId::DECIMAL:
+      return OpCode::LoadDecimal;
+    default:
+      return std::nullopt;
+  }
+}
+
+void CompiledExpression::Load(OpCode op, const char *data, Register *reg) {
+  switch (op) {
+    case OpCode::LoadInt8:
+      SetRegister(Read<int8_t>(data), reg);
+      break;
+    case OpCode::LoadInt16:
+      SetRegister(Read<int16_t>(data), reg);
+      break;
+    case OpCode::LoadInt32:
+      SetRegister(Read<int32_t>(data), reg);
+      break;
+    case OpCode::LoadInt64:
+      SetRegister(Read<int64_t>(data), reg);
+      break;
+    case OpCode::LoadDecimal:
+      SetRegister(Read<double>(data), reg);
+      break;
+    default:
+      UNREACHABLE("not a load");
+  }
+}
+
+template <typename T>
+void CompiledExpression::SetRegister(T value, Register *reg) {
+  reg->is_null_ = value == NullOf<T>();
+  if constexpr (std::is_same_v<T, double>) {
+    reg->decimal_ = value;
+  } else {
+    reg->integer_ = value;
+  }
+}
+
+template <typename T>
+auto CompiledExpression::GetRegister(const Register &reg) -> T {
+  if (reg.is_null_) {
+    return NullOf<T>();
+  }
+  if constexpr (std::is_same_v<T, double>) {
+    return reg.decimal_;
+  } else {
+    return static_cast<T>(reg.integer_);
+  }
+}
+
+template <typename Get>
+void CompiledExpression::Compare(ComparisonType comparison, size_t rows, const Register *lhs, const Register *rhs,
+                                 Register *dst, Get get) {
+  auto compare = [&](auto op) {
+    for (size_t i = 0; i < rows; i++) {
+      dst[i].integer_ = op(get(lhs[i]), get(rhs[i])) ? 1 : 0;
+      dst[i].is_null_ = lhs[i].is_null_ || rhs[i].is_null_;
+    }
+  };
+  switch (comparison) {
+    case ComparisonType::Equal:
+      compare(std::equal_to<>{});
+      break;
+    case ComparisonType::NotEqual:
+      compare(std::not_equal_to<>{});
+      break;
+    case ComparisonType::LessThan:
+      compare(std::less<>{});
+      break;
+    case ComparisonType::LessThanOrEqual:
+      compare(std::less_equal<>{});
+      break;
+    case ComparisonType::GreaterThan:
+      compare(std::greater<>{});
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      compare(std::greater_equal<>{});
+      break;
+    default:
+      UNREACHABLE("Unsupported comparison type.");
+  }
+}
+
+template <typename LoadColumn>
+void CompiledExpression::Run(size_t rows, const LoadColumn &load) {
+  registers_.resize(program_.size() * rows);
+  for (size_t pc = 0; pc < program_.size(); pc++) {
+    const Instruction &instruction = program_[pc];
+    Register *dst = &registers_[pc * rows];
+    const Register *lhs = &registers_[instruction.lhs_ * rows];
+    const Register *rhs = &registers_[instruction.rhs_ * rows];
+    switch (instruction.op_) {
+      case OpCode::LoadInt8:
+      case OpCode::LoadInt16:
+      case OpCode::LoadInt32:
+      case OpCode::LoadInt64:
+      case OpCode::LoadDecimal:
+        load(instruction, dst);
+        break;
+      case OpCode::Constant:
+        std::fill(dst, dst + rows, instruction.constant_);
+        break;
+      case OpCode::IntToDecimal:
+        for (size_t i = 0; i < rows; i++) {
+          dst[i].decimal_ = static_cast<double>(lhs[i].integer_);
+          dst[i].is_null_ = lhs[i].is_null_;
+        }
+        break;
+      case OpCode::CompareInteger:
+        Compare(instruction.comparison_, rows, lhs, rhs, dst, [](const Register &reg) { return reg.integer_; });
+        break;
+      case OpCode::CompareDecimal:
+        Compare(instruction.comparison_, rows, lhs, rhs, dst, [](const Register &reg) { return reg.decimal_; });
+        break;
+      case OpCode::And:
+        for (size_t i = 0; i < rows; i++) {
+          const bool lhs_false = !lhs[i].is_null_ && lhs[i].integer_ == 0;
+          const bool rhs_false = !rhs[i].is_null_ && rhs[i].integer_ == 0;
+          dst[i].integer_ = lhs_false || rhs_false ? 0 : 1;
+          dst[i].is_null_ = !lhs_false && !rhs_false && (lhs[i].is_null_ || rhs[i].is_null_);
+        }
+        break;
+      case OpCode::Or:
+        for (size_t i = 0; i < rows; i++) {
+          const bool lhs_true = !lhs[i].is_null_ && lhs[i].integer_ != 0;
+          const bool rhs_true = !rhs[i].is_null_ && rhs[i].integer_ != 0;
+          dst[i].integer_ = lhs_true || rhs_true ? 1 : 0;
+          dst[i].is_null_ = !lhs_true && !rhs_true && (lhs[i].is_null_ || rhs[i].is_null_);
+        }
+        break;
+      case OpCode::Plus:
+      case OpCode::Minus:
+        for (size_t i = 0; i < rows; i++) {
+          // wrap around on overflow rather than trip over it
+          const auto lhs_value = static_cast<uint32_t>(lhs[i].integer_);
+          const auto rhs_value = static_cast<uint32_t>(rhs[i].integer_);
+          const auto result = static_cast<int32_t>(instruction.op_ == OpCode::Plus ? lhs_value + rhs_value
+                                                                                    : lhs_value - rhs_value);
+          dst[i].integer_ = result;
+          // the null value of INTEGER reads as NULL, as it would from a Value
+          dst[i].is_null_ = lhs[i].is_null_ || rhs[i].is_null_ || result == BUSTUB_INT32_NULL;
+        }
+        break;
+      default:
+        UNREACHABLE("Unsupported instruction.");
+    }
+  }
+}
+
+void CompiledExpression::RunOnTuples(const Tuple *left_tuple, const Tuple *right_tuple) {
+  const Tuple *tuples[] = {left_tuple, right_tuple};
+  Run(1, [&](const Instruction &instruction, Register *dst) {
+    Load(instruction.op_, tuples[instruction.tuple_idx_]->GetData() + instruction.offset_, dst);
+  });
+}
+
+void CompiledExpression::RunOnBatch(const TupleBatch &batch) {
+  BUSTUB_ASSERT(schemas_.size() == 1, "a batch holds the rows of a single schema");
+  const auto &selection = batch.GetSelection();
+  Run(selection.size(), [&](const Instruction &instruction, Register *dst) {
+    const ColumnVector &column = batch.GetColumn(instruction.column_idx_);
+    auto load = [&](const auto *values) {
+      for (size_t i = 0; i < selection.size(); i++) {
+        SetRegister(values[selection[i]], &dst[i]);
+      }
+    };
+    switch (instruction.op_) {
+      case OpCode::LoadInt8:
+        load(column.GetData<int8_t>());
+        break;
+      case OpCode::LoadInt16:
+        load(column.GetData<int16_t>());
+        break;
+      case OpCode::LoadInt32:
+        load(column.GetData<int32_t>());
+        break;
+      case OpCode::LoadInt64:
+        load(column.GetData<int64_t>());
+        break;
+      case OpCode::LoadDecimal:
+        load(column.GetData<double>());
+        break;
+      default:
+        UNREACHABLE("not a load");
+    }
+  });
+}
+
+auto CompiledExpression::Evaluate(const Tuple &tuple) -> Value {
+  RunOnTuples(&tuple, nullptr);
+  const Register &result = registers_.back();
+  switch (ret_type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return {ret_type_, GetRegister<int8_t>(result)};
+    case TypeId::SMALLINT:
+      return {ret_type_, GetRegister<int16_t>(result)};
+    case TypeId::INTEGER:
+      return {ret_type_, GetRegister<int32_t>(result)};
+    case TypeId::BIGINT:
+      return {ret_type_, GetRegister<int64_t>(result)};
+    case TypeId::DECIMAL:
+      return {ret_type_, GetRegister<double>(result)};
+    default:
+      UNREACHABLE("not a type a register holds");
+  }
+}
+
+auto CompiledExpression::EvaluatePredicate(const Tuple &tuple) -> bool {
+  RunOnTuples(&tuple, nullptr);
+  return !registers_.back().is_null_ && registers_.back().integer_ != 0;
+}
+
+auto CompiledExpression::EvaluateJoinPredicate(const Tuple &left_tuple, const Tuple &right_tuple) -> bool {
+  RunOnTuples(&left_tuple, &right_tuple);
+  return !registers_.back().is_null_ && registers_.back().integer_ != 0;
+}
+
+void CompiledExpression::EvaluateBatch(const TupleBatch &batch, ColumnVector *result) {
+  result->Reset(ret_type_, batch.GetRowCount());
+  const auto &selection = batch.GetSelection();
+  if (selection.empty()) {
+    return;
+  }
+  RunOnBatch(batch);
+  const Register *values = &registers_[(program_.size() - 1) * selection.size()];
+  auto store = [&](auto *data) {
+    using T = std::remove_pointer_t<decltype(data)>;
+    for (size_t i = 0; i < selection.size(); i++) {
+      data[selection[i]] = GetRegister<T>(values[i]);
+    }
+  };
+  switch (ret_type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      store(result->GetData<int8_t>());
+      break;
+    case TypeId::SMALLINT:
+      store(result->GetData<int16_t>());
+      break;
+    case TypeId::INTEGER:
+      store(result->GetData<int32_t>());
+      break;
+    case TypeId::BIGINT:
+      store(result->GetData<int64_t>());
+      break;
+    case TypeId::DECIMAL:
+      store(result->GetData<double>());
+      break;
+    default:
+      UNREACHABLE("not a type a register holds");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,234 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange.cpp
+//
+// Identification: src/execution/exchange.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/exchange.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/util/hash_util.h"
+#include "execution/executor_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether every leaf of plan is under a repartition or broadcast exchange, which splits it between copies */
+auto IsPartitioned(const AbstractPlanNode &plan) -> bool {
+  if (plan.GetType() == PlanType::Exchange) {
+    return dynamic_cast<const ExchangePlanNode &>(plan).GetExchangeType() != ExchangeType::Gather;
+  }
+  const auto &children = plan.GetChildren();
+  return !children.empty() &&
+         std::all_of(children.begin(), children.end(), [](const auto &child) { return IsPartitioned(*child); });
+}
+
+}  // namespace
+
+Exchange::Exchange(ExecutorContext *exec_ctx, const ExchangePlanNode *plan, size_t consumer_count) : plan_(plan) {
+  const auto &child = plan_->GetChildPlan();
+  const size_t parallelism = std::max<size_t>(plan_->GetParallelism(), 1);
+  size_t producer_count = 1;
+  if (ParallelPipeline::IsPipeline(*child)) {
+    pipeline_ = std::make_unique<ParallelPipeline>(exec_ctx, child, parallelism);
+    producer_count = parallelism;
+  } else {
+    const bool is_gather = plan_->GetExchangeType() == ExchangeType::Gather;
+    if (is_gather && !IsPartitioned(*child)) {
+      throw ExecutionException("a gather exchange needs a pipeline, or a fragment whose scans are all under "
+                               "repartition or broadcast exchanges");
+    }
+    if (is_gather) {
+      producer_count = parallelism;
+      exchanges_ = std::make_unique<ExchangeRegistry>();
+    }
+    for (size_t i = 0; i < producer_count; i++) {
+      contexts_.push_back(std::make_unique<ExecutorContext>(exec_ctx->GetTransaction(), exec_ctx->GetCatalog(),
+                                                            exec_ctx->GetBufferPoolManager(),
+                                                            exec_ctx->GetTransactionManager(),
+                                                            exec_ctx->GetLockManager()));
+      if (is_gather) {
+        contexts_.back()->SetFragment(i, producer_count, exchanges_.get());
+      }
+      fragments_.push_back(ExecutorFactory::CreateExecutor(contexts_.back().get(), child));
+    }
+  }
+
+  for (size_t i = 0; i < consumer_count; i++) {
+    queues_.push_back(std::make_unique<BoundedQueue<TupleBatch>>(EXCHANGE_QUEUE_BATCHES, producer_count));
+  }
+  partitions_.resize(producer_count, std::vector<TupleBatch>(consumer_count));
+  for (auto &partitions : partitions_) {
+    for (auto &partition : partitions) {
+      partition.Reset(&child->OutputSchema());
+    }
+  }
+  partition_keys_.resize(producer_count);
+  for (size_t i = 0; i < producer_count; i++) {
+    producers_.emplace_back([this, i] { Produce(i); });
+  }
+}
+
+Exchange::~Exchange() {
+  Cancel();
+  for (auto &producer : producers_) {
+    producer.join();
+  }
+}
+
+auto Exchange::Pop(size_t consumer, TupleBatch *batch) -> bool {
+  if (queues_[consumer]->Pop(batch)) {
+    return true;
+  }
+  std::scoped_lock<std::mutex> lock(error_latch_);
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+  return false;
+}
+
+void Exchange::Cancel() {
+  for (auto &queue : queues_) {
+    queue->Cancel();
+  }
+  // the copies of the fragment may be waiting on the exchanges inside it
+  if (exchanges_ != nullptr) {
+    exchanges_->Cancel();
+  }
+}
+
+void Exchange::Release(size_t consumer) { queues_[consumer]->Cancel(); }
+
+void Exchange::Produce(size_t producer) {
+  try {
+    bool open = true;
+    if (pipeline_ != nullptr) {
+      for (size_t morsel = next_morsel_++; open && morsel < pipeline_->GetMorselCount(); morsel = next_morsel_++) {
+        pipeline_->RunMorsel(producer, morsel, [&](size_t /*worker*/, size_t /*morsel*/, TupleBatch *batch) {
+          open = open && Route(producer, batch);
+        });
+      }
+    } else {
+      TupleBatch batch;
+      fragments_[producer]->Init();
+      while (open && fragments_[producer]->NextBatch(&batch)) {
+        open = Route(producer, &batch);
+      }
+    }
+    if (open) {
+      Flush(producer);
+    }
+  } catch (...) {
+    {
+      std::scoped_lock<std::mutex> lock(error_latch_);
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+    Cancel();
+  }
+  if (exchanges_ != nullptr) {
+    exchanges_->Release(producer);
+  }
+  for (auto &queue : queues_) {
+    queue->Close();
+  }
+}
+
+auto Exchange::Route(size_t producer, TupleBatch *batch) -> bool {
+  if (queues_.size() == 1) {
+    return queues_[0]->Push(std::move(*batch));
+  }
+
+  if (plan_->GetExchangeType() == ExchangeType::Broadcast) {
+    for (size_t i = 0; i + 1 < queues_.size(); i++) {
+      queues_[i]->Push(*batch);
+    }
+    queues_.back()->Push(std::move(*batch));
+  } else {
+    const auto &keys = plan_->GetPartitionKeys();
+    auto &key_columns = partition_keys_[producer];
+    key_columns.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      keys[i]->EvaluateBatch(*batch, &key_columns[i]);
+    }
+    auto &partitions = partitions_[producer];
+    const auto column_count = batch->GetSchema().GetColumnCount();
+    for (const auto row : batch->GetSelection()) {
+      // rows with equal keys meet in the same consumer, as do those of another exchange on keys of the same types
+      hash_t hash = 0;
+      for (const auto &key_column : key_columns) {
+        const Value key = key_column.GetValue(row);
+        if (!key.IsNull()) {
+          hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&key));
+        }
+      }
+      const size_t consumer = hash % queues_.size();
+      auto &partition = partitions[consumer];
+      const size_t partition_row = partition.AppendRow(batch->GetRid(row));
+      for (uint32_t i = 0; i < column_count; i++) {
+        partition.GetColumn(i).SetFromColumn(partition_row, batch->GetColumn(i), row);
+      }
+      if (partition.IsFull()) {
+        queues_[consumer]->Push(std::move(partition));
+        partition.Reset(&batch->GetSchema());
+      }
+    }
+  }
+  // a consumer that is done drops its batches, and the producers stop once all of them are
+  return std::any_of(queues_.begin(), queues_.end(), [](const auto &queue) { return !queue->IsCancelled(); });
+}
+
+void Exchange::Flush(size_t producer) {
+  if (plan_->GetExchangeType() != ExchangeType::Repartition || queues_.size() == 1) {
+    return;
+  }
+  for (size_t i = 0; i < queues_.size(); i++) {
+    if (partitions_[producer][i].Size() > 0) {
+      queues_[i]->Push(std::move(partitions_[producer][i]));
+    }
+  }
+}
+
+auto ExchangeRegistry::Open(ExecutorContext *exec_ctx, const ExchangePlanNode *plan) -> Exchange * {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = exchanges_.find(plan);
+  if (it == exchanges_.end()) {
+    auto exchange = std::make_unique<Exchange>(exec_ctx, plan, exec_ctx->GetFragmentCount());
+    for (const auto fragment : released_) {
+      exchange->Release(fragment);
+    }
+    if (cancelled_) {
+      exchange->Cancel();
+    }
+    it = exchanges_.emplace(plan, std::move(exchange)).first;
+  }
+  return it->second.get();
+}
+
+void ExchangeRegistry::Release(size_t fragment) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  released_.insert(fragment);
+  for (auto &[plan, exchange] : exchanges_) {
+    exchange->Release(fragment);
+  }
+}
+
+void ExchangeRegistry::Cancel() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  cancelled_ = true;
+  for (auto &[plan, exchange] : exchanges_) {
+    exchange->Cancel();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.cpp
+//
+// Identification: src/execution/exchange_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/exchange_executor.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ExchangeExecutor::ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void ExchangeExecutor::Init() {
+  ResetOutputBatch();
+  if (plan_->GetExchangeType() == ExchangeType::Gather || exec_ctx_->GetExchanges() == nullptr) {
+    // stop the producers of the last run before starting over
+    own_exchange_.reset();
+    own_exchange_ = std::make_unique<Exchange>(exec_ctx_, plan_, 1);
+    exchange_ = own_exchange_.get();
+    consumer_ = 0;
+    return;
+  }
+
+  // the copies of the fragment read the exchange together, once
+  if (exchange_ != nullptr) {
+    throw NotImplementedException("a repartition or broadcast exchange under a gather exchange is only read once");
+  }
+  exchange_ = exec_ctx_->GetExchanges()->Open(exec_ctx_, plan_);
+  consumer_ = exec_ctx_->GetFragment();
+}
+
+auto ExchangeExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto ExchangeExecutor::NextBatch(TupleBatch *batch) -> bool { return exchange_->Pop(consumer_, batch); }
+
+}  // namespace bustub
@@ -18,6 +18,7 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/delete_executor.h"
+#include "execution/executors/exchange_executor.h"
 #include "execution/executors/filter_executor.h"
 #include "execution/executors/hash_join_executor.h"
 #include "execution/executors/index_scan_executor.h"
@@ -32,6 +33,7 @@
 #include "execution/executors/topn_executor.h"
 #include "execution/executors/update_executor.h"
 #include "execution/executors/values_executor.h"
+#include "execution/plans/exchange_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/mock_scan_plan.h"
 #include "execution/plans/projection_plan.h"
@@ -154,6 +156,12 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, std::move(child));
     }
 
+      // Create a new exchange executor, which creates the executors of its child on its producers
+    case PlanType::Exchange: {
+      const auto *exchange_plan = dynamic_cast<const ExchangePlanNode *>(plan.get());
+      return std::make_unique<ExchangeExecutor>(exec_ctx, exchange_plan);
+    }
+
     default:
       UNREACHABLE("Unsupported plan type.");
   }
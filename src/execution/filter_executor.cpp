@@ -6,7 +6,11 @@ namespace bustub {
 
 FilterExecutor::FilterExecutor(ExecutorContext *exec_ctx, const FilterPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      compiled_predicate_(CompiledExpression::Compile(*plan_->GetPredicate(), child_executor_->GetOutputSchema())),
+      kernel_predicate_(KernelPredicate::Compile(*plan_->GetPredicate(), child_executor_->GetOutputSchema())) {}
 
 void FilterExecutor::Init() {
   // Initialize the child executor
@@ -24,6 +28,12 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       return false;
     }
 
+    if (compiled_predicate_ != nullptr) {
+      if (compiled_predicate_->EvaluatePredicate(*tuple)) {
+        return true;
+      }
+      continue;
+    }
     auto value = filter_expr->Evaluate(tuple, child_executor_->GetOutputSchema());
     if (!value.IsNull() && value.GetAs<bool>()) {
       return true;
@@ -31,4 +41,22 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  while (child_executor_->NextBatch(batch)) {
+    if (kernel_predicate_ != nullptr) {
+      kernel_predicate_->Select(batch);
+    } else if (compiled_predicate_ != nullptr) {
+      compiled_predicate_->EvaluateBatch(*batch, &predicate_);
+      batch->Select(predicate_);
+    } else {
+      plan_->GetPredicate()->EvaluateBatch(*batch, &predicate_);
+      batch->Select(predicate_);
+    }
+    if (batch->Size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
@@ -0,0 +1,480 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels.cpp
+//
+// Identification: src/execution/filter_kernels.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/filter_kernels.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+template <typename T>
+constexpr auto NullOf() -> T {
+  if constexpr (std::is_same_v<T, int32_t>) {
+    return BUSTUB_INT32_NULL;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return BUSTUB_INT64_NULL;
+  } else {
+    static_assert(std::is_same_v<T, double>);
+    return BUSTUB_DECIMAL_NULL;
+  }
+}
+
+template <ComparisonType CMP, typename T>
+inline auto Compare(T lhs, T rhs) -> bool {
+  if constexpr (CMP == ComparisonType::Equal) {
+    return lhs == rhs;
+  } else if constexpr (CMP == ComparisonType::NotEqual) {
+    return lhs != rhs;
+  } else if constexpr (CMP == ComparisonType::LessThan) {
+    return lhs < rhs;
+  } else if constexpr (CMP == ComparisonType::LessThanOrEqual) {
+    return lhs <= rhs;
+  } else if constexpr (CMP == ComparisonType::GreaterThan) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+/** Compare the rows from begin, the first of a word, to end one at a time */
+template <typename T, ComparisonType CMP>
+void CompareRowsScalar(const T *lhs, const T *rhs, bool rhs_is_constant, size_t begin, size_t end, uint64_t *is_true,
+                       uint64_t *is_false) {
+  for (size_t word = begin / 64; word < MaskWords(end); word++) {
+    uint64_t matches = 0;
+    uint64_t valid = 0;
+    const size_t last = std::min(end, (word + 1) * 64);
+    for (size_t row = word * 64; row < last; row++) {
+      const T left = lhs[row];
+      const T right = rhs_is_constant ? *rhs : rhs[row];
+      const uint64_t bit = uint64_t{1} << (row % 64);
+      matches |= Compare<CMP>(left, right) ? bit : 0;
+      valid |= left != NullOf<T>() && right != NullOf<T>() ? bit : 0;
+    }
+    is_true[word] = matches & valid;
+    is_false[word] = ~matches & valid;
+  }
+}
+
+#if defined(__x86_64__)
+
+/** @return the predicate of _mm512_cmp_epi*_mask() for CMP */
+template <ComparisonType CMP>
+constexpr auto IntegerPredicate() -> int {
+  switch (CMP) {
+    case ComparisonType::Equal:
+      return _MM_CMPINT_EQ;
+    case ComparisonType::NotEqual:
+      return _MM_CMPINT_NE;
+    case ComparisonType::LessThan:
+      return _MM_CMPINT_LT;
+    case ComparisonType::LessThanOrEqual:
+      return _MM_CMPINT_LE;
+    case ComparisonType::GreaterThan:
+      return _MM_CMPINT_NLE;
+    default:
+      return _MM_CMPINT_NLT;
+  }
+}
+
+/** @return the predicate of _mm*_cmp_pd() for CMP, which treats NaN as the operators of double do */
+template <ComparisonType CMP>
+constexpr auto DecimalPredicate() -> int {
+  switch (CMP) {
+    case ComparisonType::Equal:
+      return _CMP_EQ_OQ;
+    case ComparisonType::NotEqual:
+      return _CMP_NEQ_UQ;
+    case ComparisonType::LessThan:
+      return _CMP_LT_OQ;
+    case ComparisonType::LessThanOrEqual:
+      return _CMP_LE_OQ;
+    case ComparisonType::GreaterThan:
+      return _CMP_GT_OQ;
+    default:
+      return _CMP_GE_OQ;
+  }
+}
+
+/** Compare the first words words of rows with AVX-512, a register of rows at a time */
+template <typename T, ComparisonType CMP>
+__attribute__((target("avx512f"))) void CompareWordsAvx512(const T *lhs, const T *rhs, bool rhs_is_constant,
+                                                           size_t words, uint64_t *is_true, uint64_t *is_false) {
+  constexpr size_t LANES = 64 / sizeof(T);
+  for (size_t word = 0; word < words; word++) {
+    uint64_t matches = 0;
+    uint64_t valid = 0;
+    for (size_t lane = 0; lane < 64; lane += LANES) {
+      const size_t row = word * 64 + lane;
+      uint64_t match_bits;
+      uint64_t valid_bits;
+      if constexpr (std::is_same_v<T, int32_t>) {
+        constexpr int PREDICATE = IntegerPredicate<CMP>();
+        const __m512i null = _mm512_set1_epi32(NullOf<T>());
+        const __m512i left = _mm512_loadu_si512(lhs + row);
+        const __m512i right = rhs_is_constant ? _mm512_set1_epi32(*rhs) : _mm512_loadu_si512(rhs + row);
+        match_bits = _mm512_cmp_epi32_mask(left, right, PREDICATE);
+        valid_bits = _mm512_cmpneq_epi32_mask(left, null) & _mm512_cmpneq_epi32_mask(right, null);
+      } else if constexpr (std::is_same_v<T, int64_t>) {
+        constexpr int PREDICATE = IntegerPredicate<CMP>();
+        const __m512i null = _mm512_set1_epi64(NullOf<T>());
+        const __m512i left = _mm512_loadu_si512(lhs + row);
+        const __m512i right = rhs_is_constant ? _mm512_set1_epi64(*rhs) : _mm512_loadu_si512(rhs + row);
+        match_bits = _mm512_cmp_epi64_mask(left, right, PREDICATE);
+        valid_bits = _mm512_cmpneq_epi64_mask(left, null) & _mm512_cmpneq_epi64_mask(right, null);
+      } else {
+        constexpr int PREDICATE = DecimalPredicate<CMP>();
+        const __m512d null = _mm512_set1_pd(NullOf<T>());
+        const __m512d left = _mm512_loadu_pd(lhs + row);
+        const __m512d right = rhs_is_constant ? _mm512_set1_pd(*rhs) : _mm512_loadu_pd(rhs + row);
+        match_bits = _mm512_cmp_pd_mask(left, right, PREDICATE);
+        valid_bits = _mm512_cmp_pd_mask(left, null, _CMP_NEQ_UQ) & _mm512_cmp_pd_mask(right, null, _CMP_NEQ_UQ);
+      }
+      matches |= match_bits << lane;
+      valid |= valid_bits << lane;
+    }
+    is_true[word] = matches & valid;
+    is_false[word] = ~matches & valid;
+  }
+}
+
+/** @return a bit per lane of l == r */
+template <typename T>
+__attribute__((target("avx2"))) inline auto EqualAvx2(__m256i l, __m256i r) -> uint64_t {
+  if constexpr (std::is_same_v<T, int32_t>) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(l, r))));
+  } else {
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(l, r))));
+  }
+}
+
+/** @return a bit per lane of l > r */
+template <typename T>
+__attribute__((target("avx2"))) inline auto GreaterAvx2(__m256i l, __m256i r) -> uint64_t {
+  if constexpr (std::is_same_v<T, int32_t>) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(l, r))));
+  } else {
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(l, r))));
+  }
+}
+
+/** @return a bit per lane of the comparison, AVX2 having only == and > for integers */
+template <typename T, ComparisonType CMP>
+__attribute__((target("avx2"))) inline auto CompareIntegersAvx2(__m256i l, __m256i r) -> uint64_t {
+  constexpr uint64_t ALL_LANES = (uint64_t{1} << (32 / sizeof(T))) - 1;
+  if constexpr (CMP == ComparisonType::Equal) {
+    return EqualAvx2<T>(l, r);
+  } else if constexpr (CMP == ComparisonType::NotEqual) {
+    return ~EqualAvx2<T>(l, r) & ALL_LANES;
+  } else if constexpr (CMP == ComparisonType::LessThan) {
+    return GreaterAvx2<T>(r, l);
+  } else if constexpr (CMP == ComparisonType::LessThanOrEqual) {
+    return ~GreaterAvx2<T>(l, r) & ALL_LANES;
+  } else if constexpr (CMP == ComparisonType::GreaterThan) {
+    return GreaterAvx2<T>(l, r);
+  } else {
+    return ~GreaterAvx2<T>(r, l) & ALL_LANES;
+  }
+}
+
+/** Compare the first words words of rows with AVX2, a register of rows at a time */
+template <typename T, ComparisonType CMP>
+__attribute__((target("avx2"))) void CompareWordsAvx2(const T *lhs, const T *rhs, bool rhs_is_constant, size_t words,
+                                                      uint64_t *is_true, uint64_t *is_false) {
+  constexpr size_t LANES = 32 / sizeof(T);
+  constexpr uint64_t ALL_LANES = (uint64_t{1} << LANES) - 1;
+  for (size_t word = 0; word < words; word++) {
+    uint64_t matches = 0;
+    uint64_t valid = 0;
+    for (size_t lane = 0; lane < 64; lane += LANES) {
+      const size_t row = word * 64 + lane;
+      uint64_t match_bits;
+      uint64_t null_bits;
+      if constexpr (std::is_same_v<T, double>) {
+        constexpr int PREDICATE = DecimalPredicate<CMP>();
+        const __m256d null = _mm256_set1_pd(NullOf<T>());
+        const __m256d left = _mm256_loadu_pd(lhs + row);
+        const __m256d right = rhs_is_constant ? _mm256_set1_pd(*rhs) : _mm256_loadu_pd(rhs + row);
+        match_bits = static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(left, right, PREDICATE)));
+        null_bits = static_cast<uint32_t>(_mm256_movemask_pd(
+            _mm256_or_pd(_mm256_cmp_pd(left, null, _CMP_EQ_OQ), _mm256_cmp_pd(right, null, _CMP_EQ_OQ))));
+      } else {
+        __m256i null;
+        __m256i right;
+        if constexpr (std::is_same_v<T, int32_t>) {
+          null = _mm256_set1_epi32(NullOf<T>());
+          right = _mm256_set1_epi32(*rhs);
+        } else {
+          null = _mm256_set1_epi64x(NullOf<T>());
+          right = _mm256_set1_epi64x(*rhs);
+        }
+        const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + row));
+        if (!rhs_is_constant) {
+          right = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + row));
+        }
+        match_bits = CompareIntegersAvx2<T, CMP>(left, right);
+        null_bits = EqualAvx2<T>(left, null) | EqualAvx2<T>(right, null);
+      }
+      matches |= match_bits << lane;
+      valid |= (~null_bits & ALL_LANES) << lane;
+    }
+    is_true[word] = matches & valid;
+    is_false[word] = ~matches & valid;
+  }
+}
+
+#endif
+
+template <typename T, ComparisonType CMP>
+void CompareValuesAs(const T *lhs, const T *rhs, bool rhs_is_constant, size_t rows, uint64_t *is_true,
+                     uint64_t *is_false, SimdLevel level) {
+  // the full words go through the kernel of the level, the rows past them one at a time
+  size_t words = 0;
+#if defined(__x86_64__)
+  switch (level) {
+    case SimdLevel::Avx512:
+      words = rows / 64;
+      CompareWordsAvx512<T, CMP>(lhs, rhs, rhs_is_constant, words, is_true, is_false);
+      break;
+    case SimdLevel::Avx2:
+      words = rows / 64;
+      CompareWordsAvx2<T, CMP>(lhs, rhs, rhs_is_constant, words, is_true, is_false);
+      break;
+    case SimdLevel::Scalar:
+      break;
+  }
+#endif
+  CompareRowsScalar<T, CMP>(lhs, rhs, rhs_is_constant, words * 64, rows, is_true, is_false);
+}
+
+/** @return the comparison of rhs to lhs that lhs comparison rhs is */
+auto Flip(ComparisonType comparison) -> ComparisonType {
+  switch (comparison) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comparison;
+  }
+}
+
+auto IsIntegral(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+}  // namespace
+
+auto BestSimdLevel() -> SimdLevel {
+#if defined(__x86_64__)
+  static const SimdLevel LEVEL = __builtin_cpu_supports("avx512f") ? SimdLevel::Avx512
+                                 : __builtin_cpu_supports("avx2")  ? SimdLevel::Avx2
+                                                                   : SimdLevel::Scalar;
+  return LEVEL;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+template <typename T>
+void CompareValues(ComparisonType comparison, const T *lhs, const T *rhs, bool rhs_is_constant, size_t rows,
+                   uint64_t *is_true, uint64_t *is_false, SimdLevel level) {
+  switch (comparison) {
+    case ComparisonType::Equal:
+      CompareValuesAs<T, ComparisonType::Equal>(lhs, rhs, rhs_is_constant, rows, is_true, is_false, level);
+      break;
+    case ComparisonType::NotEqual:
+      CompareValuesAs<T, ComparisonType::NotEqual>(lhs, rhs, rhs_is_constant, rows, is_true, is_false, level);
+      break;
+    case ComparisonType::LessThan:
+      CompareValuesAs<T, ComparisonType::LessThan>(lhs, rhs, rhs_is_constant, rows, is_true, is_false, level);
+      break;
+    case ComparisonType::LessThanOrEqual:
+      CompareValuesAs<T, ComparisonType::LessThanOrEqual>(lhs, rhs, rhs_is_constant, rows, is_true, is_false, level);
+      break;
+    case ComparisonType::GreaterThan:
+      CompareValuesAs<T, ComparisonType::GreaterThan>(lhs, rhs, rhs_is_constant, rows, is_true, is_false, level);
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      CompareValuesAs<T, ComparisonType::GreaterThanOrEqual>(lhs, rhs, rhs_is_constant, rows, is_true, is_false,
+                                                             level);
+      break;
+    default:
+      UNREACHABLE("Unsupported comparison type.");
+  }
+}
+
+template void CompareValues<int32_t>(ComparisonType, const int32_t *, const int32_t *, bool, size_t, uint64_t *,
+                                     uint64_t *, SimdLevel);
+template void CompareValues<int64_t>(ComparisonType, const int64_t *, const int64_t *, bool, size_t, uint64_t *,
+                                     uint64_t *, SimdLevel);
+template void CompareValues<double>(ComparisonType, const double *, const double *, bool, size_t, uint64_t *,
+                                    uint64_t *, SimdLevel);
+
+auto KernelPredicate::Compile(const AbstractExpression &expr, const Schema &schema)
+    -> std::unique_ptr<KernelPredicate> {
+  auto predicate = std::make_unique<KernelPredicate>();
+  if (!predicate->Emit(expr, schema).has_value()) {
+    return nullptr;
+  }
+  return predicate;
+}
+
+auto KernelPredicate::Emit(const AbstractExpression &expr, const Schema &schema) -> std::optional<uint32_t> {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    auto lhs = Emit(*logic_expr->GetChildAt(0), schema);
+    auto rhs = lhs.has_value() ? Emit(*logic_expr->GetChildAt(1), schema) : std::nullopt;
+    if (!rhs.has_value()) {
+      return std::nullopt;
+    }
+    Node node;
+    node.type_ = logic_expr->logic_type_ == LogicType::And ? NodeType::And : NodeType::Or;
+    node.lhs_ = *lhs;
+    node.rhs_ = *rhs;
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+  }
+
+  const auto *comparison_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comparison_expr == nullptr) {
+    return std::nullopt;
+  }
+  Node node;
+  node.type_ = NodeType::Compare;
+  node.comparison_ = comparison_expr->comp_type_;
+  const auto *lhs = comparison_expr->GetChildAt(0).get();
+  const auto *rhs = comparison_expr->GetChildAt(1).get();
+  // the kernels take the column first
+  if (dynamic_cast<const ColumnValueExpression *>(lhs) == nullptr) {
+    std::swap(lhs, rhs);
+    node.comparison_ = Flip(node.comparison_);
+  }
+  const auto *lhs_column = dynamic_cast<const ColumnValueExpression *>(lhs);
+  if (lhs_column == nullptr || lhs_column->GetColIdx() >= schema.GetColumnCount()) {
+    return std::nullopt;
+  }
+  node.lhs_column_ = lhs_column->GetColIdx();
+  node.column_type_ = schema.GetColumn(node.lhs_column_).GetType();
+  if (node.column_type_ != TypeId::INTEGER && node.column_type_ != TypeId::BIGINT &&
+      node.column_type_ != TypeId::DECIMAL) {
+    return std::nullopt;
+  }
+
+  if (const auto *rhs_column = dynamic_cast<const ColumnValueExpression *>(rhs); rhs_column != nullptr) {
+    if (rhs_column->GetColIdx() >= schema.GetColumnCount() ||
+        schema.GetColumn(rhs_column->GetColIdx()).GetType() != node.column_type_) {
+      return std::nullopt;
+    }
+    node.rhs_column_ = rhs_column->GetColIdx();
+  } else if (const auto *constant = dynamic_cast<const ConstantValueExpression *>(rhs); constant != nullptr) {
+    // the constant is taken as the type of the column when that keeps its value, as the comparison of Values does
+    const Value &value = constant->val_;
+    const TypeId type = value.GetTypeId();
+    if (value.IsNull()) {
+      return std::nullopt;
+    }
+    if (node.column_type_ == TypeId::INTEGER && IsIntegral(type) && type != TypeId::BIGINT) {
+      node.integer_ = value.CastAs(TypeId::INTEGER).GetAs<int32_t>();
+    } else if (node.column_type_ == TypeId::BIGINT && IsIntegral(type)) {
+      node.bigint_ = value.CastAs(TypeId::BIGINT).GetAs<int64_t>();
+    } else if (node.column_type_ == TypeId::DECIMAL && (IsIntegral(type) || type == TypeId::DECIMAL)) {
+      node.decimal_ = value.CastAs(TypeId::DECIMAL).GetAs<double>();
+    } else {
+      return std::nullopt;
+    }
+  } else {
+    return std::nullopt;
+  }
+  nodes_.push_back(node);
+  return nodes_.size() - 1;
+}
+
+void KernelPredicate::EvaluateComparison(const Node &node, const TupleBatch &batch, size_t rows, uint64_t *is_true,
+                                         uint64_t *is_false) const {
+  const ColumnVector &lhs = batch.GetColumn(node.lhs_column_);
+  const bool rhs_is_constant = !node.rhs_column_.has_value();
+  switch (node.column_type_) {
+    case TypeId::INTEGER: {
+      const int32_t *rhs = rhs_is_constant ? &node.integer_ : batch.GetColumn(*node.rhs_column_).GetData<int32_t>();
+      CompareValues(node.comparison_, lhs.GetData<int32_t>(), rhs, rhs_is_constant, rows, is_true, is_false, level_);
+      break;
+    }
+    case TypeId::BIGINT: {
+      const int64_t *rhs = rhs_is_constant ? &node.bigint_ : batch.GetColumn(*node.rhs_column_).GetData<int64_t>();
+      CompareValues(node.comparison_, lhs.GetData<int64_t>(), rhs, rhs_is_constant, rows, is_true, is_false, level_);
+      break;
+    }
+    case TypeId::DECIMAL: {
+      const double *rhs = rhs_is_constant ? &node.decimal_ : batch.GetColumn(*node.rhs_column_).GetData<double>();
+      CompareValues(node.comparison_, lhs.GetData<double>(), rhs, rhs_is_constant, rows, is_true, is_false, level_);
+      break;
+    }
+    default:
+      UNREACHABLE("the kernels compare INTEGER, BIGINT and DECIMAL columns");
+  }
+}
+
+void KernelPredicate::Select(TupleBatch *batch) {
+  const size_t rows = batch->GetRowCount();
+  if (rows == 0) {
+    return;
+  }
+  // every row of the batch is compared, selected or not, so that the kernels run over whole registers
+  const size_t words = MaskWords(rows);
+  is_true_.resize(nodes_.size() * words);
+  is_false_.resize(nodes_.size() * words);
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    const Node &node = nodes_[i];
+    uint64_t *is_true = &is_true_[i * words];
+    uint64_t *is_false = &is_false_[i * words];
+    const uint64_t *lhs_true = &is_true_[node.lhs_ * words];
+    const uint64_t *lhs_false = &is_false_[node.lhs_ * words];
+    const uint64_t *rhs_true = &is_true_[node.rhs_ * words];
+    const uint64_t *rhs_false = &is_false_[node.rhs_ * words];
+    switch (node.type_) {
+      case NodeType::Compare:
+        EvaluateComparison(node, *batch, rows, is_true, is_false);
+        break;
+      case NodeType::And:
+        for (size_t word = 0; word < words; word++) {
+          is_true[word] = lhs_true[word] & rhs_true[word];
+          is_false[word] = lhs_false[word] | rhs_false[word];
+        }
+        break;
+      case NodeType::Or:
+        for (size_t word = 0; word < words; word++) {
+          is_true[word] = lhs_true[word] | rhs_true[word];
+          is_false[word] = lhs_false[word] & rhs_false[word];
+        }
+        break;
+    }
+  }
+  batch->Select(&is_true_[(nodes_.size() - 1) * words]);
+}
+
+}  // namespace bustub
@@ -7,6 +7,7 @@
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/plans/exchange_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/sort_plan.h"
@@ -53,4 +54,12 @@ auto TopNPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("TopN {{ n={}, order_bys={}}}", n_, order_bys_);
 }
 
+auto ExchangePlanNode::PlanNodeToString() const -> std::string {
+  if (exchange_type_ == ExchangeType::Repartition) {
+    return fmt::format("Exchange {{ type={}, partition_keys={}, parallelism={} }}", exchange_type_, partition_keys_,
+                       parallelism_);
+  }
+  return fmt::format("Exchange {{ type={}, parallelism={} }}", exchange_type_, parallelism_);
+}
+
 }  // namespace bustub
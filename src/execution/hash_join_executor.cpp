@@ -11,24 +11,167 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/hash_join_executor.h"
-
-// Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
-// if you want to get faster in leaderboard tests.
+#include "execution/parallel_pipeline.h"
 
 namespace bustub {
 
+namespace {
+
+/** The right rows of a left row that joins none */
+const std::vector<std::pair<size_t, size_t>> NO_MATCHES;
+
+}  // namespace
+
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void HashJoinExecutor::Init() { throw NotImplementedException("HashJoinExecutor is not implemented"); }
+void HashJoinExecutor::Init() {
+  left_child_->Init();
+  ResetOutputBatch();
+
+  // Build: keep the batches of the right child as they come, and hash their rows
+  right_batches_.clear();
+  hash_tables_.clear();
+  if (ParallelPipeline::CanRun(exec_ctx_, *plan_->GetRightPlan())) {
+    BuildInParallel();
+  } else {
+    right_child_->Init();
+    hash_tables_.resize(1);
+    TupleBatch batch;
+    ColumnVector keys;
+    while (right_child_->NextBatch(&batch)) {
+      plan_->RightJoinKeyExpression().EvaluateBatch(batch, &keys);
+      for (const auto row : batch.GetSelection()) {
+        Value key = keys.GetValue(row);
+        if (!key.IsNull()) {
+          hash_tables_[0][HashJoinKey{std::move(key)}].emplace_back(right_batches_.size(), row);
+        }
+      }
+      right_batches_.push_back(std::move(batch));
+    }
+  }
+
+  left_batch_.Reset(&left_child_->GetOutputSchema());
+  probe_cursor_ = 0;
+  matches_ = nullptr;
+  match_cursor_ = 0;
+}
+
+void HashJoinExecutor::BuildInParallel() {
+  ParallelPipeline pipeline(exec_ctx_, plan_->GetRightPlan());
+  const size_t partition_count = pipeline.GetWorkerCount();
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // The workers scan the right child, keeping each batch with the keys of its rows and the rows of each partition
+  struct RightBatch {
+    TupleBatch batch_;
+    ColumnVector keys_;
+    std::vector<std::vector<uint32_t>> partition_rows_;
+  };
+  std::vector<std::vector<RightBatch>> morsels(pipeline.GetMorselCount());
+  pipeline.Run([&](size_t /*worker*/, size_t morsel, TupleBatch *batch) {
+    RightBatch right{std::move(*batch), ColumnVector(), std::vector<std::vector<uint32_t>>(partition_count)};
+    plan_->RightJoinKeyExpression().EvaluateBatch(right.batch_, &right.keys_);
+    for (const auto row : right.batch_.GetSelection()) {
+      const Value key = right.keys_.GetValue(row);
+      if (!key.IsNull()) {
+        right.partition_rows_[std::hash<HashJoinKey>{}(HashJoinKey{key}) % partition_count].push_back(row);
+      }
+    }
+    morsels[morsel].push_back(std::move(right));
+  });
+
+  // Then each one builds a partition of the hash table from the rows of that partition alone, in the order of a
+  // serial build
+  std::vector<const RightBatch *> batches;
+  for (auto &morsel : morsels) {
+    for (auto &right : morsel) {
+      batches.push_back(&right);
+    }
+  }
+  hash_tables_.resize(partition_count);
+  exec_ctx_->GetWorkers()->Run(partition_count, [&](size_t /*worker*/, size_t partition) {
+    for (size_t i = 0; i < batches.size(); i++) {
+      for (const auto row : batches[i]->partition_rows_[partition]) {
+        hash_tables_[partition][HashJoinKey{batches[i]->keys_.GetValue(row)}].emplace_back(i, row);
+      }
+    }
+  });
+  right_batches_.reserve(batches.size());
+  for (auto &morsel : morsels) {
+    for (auto &right : morsel) {
+      right_batches_.push_back(std::move(right.batch_));
+    }
+  }
+}
+
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return NextFromBatch(tuple, rid); }
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (probe_cursor_ == left_batch_.Size()) {
+      probe_cursor_ = 0;
+      if (!left_child_->NextBatch(&left_batch_)) {
+        left_batch_.Reset(&left_child_->GetOutputSchema());
+        break;
+      }
+      plan_->LeftJoinKeyExpression().EvaluateBatch(left_batch_, &left_keys_);
+    }
+    const size_t left_row = left_batch_.GetSelection()[probe_cursor_];
+
+    if (matches_ == nullptr) {
+      matches_ = &NO_MATCHES;
+      match_cursor_ = 0;
+      const Value key = left_keys_.GetValue(left_row);
+      if (!key.IsNull()) {
+        const HashJoinKey join_key{key};
+        auto &hash_table = PartitionOf(join_key);
+        if (const auto it = hash_table.find(join_key); it != hash_table.end()) {
+          matches_ = &it->second;
+        }
+      }
+      if (matches_->empty() && plan_->GetJoinType() == JoinType::LEFT) {
+        AppendJoinedRow(batch, left_row, nullptr);
+      }
+    }
+
+    // A row may join more right rows than the batch has room for: the rest go in the next batch
+    while (match_cursor_ < matches_->size() && !batch->IsFull()) {
+      AppendJoinedRow(batch, left_row, &(*matches_)[match_cursor_++]);
+    }
+    if (match_cursor_ == matches_->size()) {
+      probe_cursor_++;
+      matches_ = nullptr;
+    }
+  }
+  return batch->Size() > 0;
+}
+
+void HashJoinExecutor::AppendJoinedRow(TupleBatch *batch, size_t left_row, const RightRow *right_row) {
+  const size_t row = batch->AppendRow(RID{});
+  const uint32_t left_column_count = left_child_->GetOutputSchema().GetColumnCount();
+  const uint32_t right_column_count = right_child_->GetOutputSchema().GetColumnCount();
+  for (uint32_t i = 0; i < left_column_count; i++) {
+    batch->GetColumn(i).SetFromColumn(row, left_batch_.GetColumn(i), left_row);
+  }
+  for (uint32_t i = 0; i < right_column_count; i++) {
+    ColumnVector &column = batch->GetColumn(left_column_count + i);
+    if (right_row == nullptr) {
+      column.SetNull(row);
+    } else {
+      column.SetFromColumn(row, right_batches_[right_row->first].GetColumn(i), right_row->second);
+    }
+  }
+}
 
 }  // namespace bustub
@@ -10,13 +10,83 @@
 //
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+  tree_ = dynamic_cast<BPlusTreeIndexForFixedSizeKeys *>(index_info_->index_.get());
+  if (tree_ == nullptr) {
+    throw NotImplementedException("IndexScanExecutor only scans B+ tree indexes");
+  }
+
+  std::optional<IndexKeyBound> low = plan_->low_;
+  const std::optional<IndexKeyBound> &high = plan_->high_;
+  if (high.has_value() && high->values_.size() > (low.has_value() ? low->values_.size() : 0)) {
+    // NULL keys sort first, and compare to no value: the column only high bounds must not be NULL
+    std::vector<Value> values(high->values_.begin(), high->values_.end() - 1);
+    values.push_back(ValueFactory::GetNullValueByType(index_info_->key_schema_.GetColumn(values.size()).GetType()));
+    low = IndexKeyBound{std::move(values), false};
+  }
+  iterator_ = tree_->GetRangeIterator(low, high, plan_->reverse_);
+  rids_.clear();
+  entries_.clear();
+  cursor_ = 0;
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (plan_->index_only_) {
+    return NextFromIndex(tuple, rid);
+  }
+  while (true) {
+    if (cursor_ == rids_.size()) {
+      rids_.clear();
+      cursor_ = 0;
+      if (!iterator_.NextBatch(&rids_)) {
+        return false;
+      }
+    }
+    const RID next_rid = rids_[cursor_++];
+    // an entry whose tuple is gone was deleted after the batch was taken
+    if (table_info_->table_->GetTuple(next_rid, tuple, exec_ctx_->GetTransaction())) {
+      *rid = next_rid;
+      return true;
+    }
+  }
+}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+auto IndexScanExecutor::NextFromIndex(Tuple *tuple, RID *rid) -> bool {
+  if (cursor_ == entries_.size()) {
+    entries_.clear();
+    cursor_ = 0;
+    if (!iterator_.NextBatch(&entries_)) {
+      return false;
+    }
+  }
+  const auto &[key, entry_rid] = entries_[cursor_++];
+  entry_values_.clear();
+  tree_->DecodeEntry(key, &entry_values_);
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // no plan above reads the columns the index does not store
+  const Schema &schema = GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (const auto &column : schema.GetColumns()) {
+    values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+  for (size_t i = 0; i < entry_attrs.size(); i++) {
+    values[entry_attrs[i]] = entry_values_[i];
+  }
+  *tuple = Tuple(values, &schema);
+  *rid = entry_rid;
+  return true;
+}
 
 }  // namespace bustub
@@ -13,15 +13,55 @@
 #include <memory>
 
 #include "execution/executors/insert_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
+void InsertExecutor::Init() {
+  child_executor_->Init();
+  auto *catalog = exec_ctx_->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->TableOid());
+  index_infos_ = catalog->GetTableIndexes(table_info_->name_);
+  done_ = false;
+}
 
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+
+  // a bulk insert into a large table goes through a private ring instead of flushing the buffer pool
+  auto ring = table_info_->table_->MakeScanRing();
+  auto *txn = exec_ctx_->GetTransaction();
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    RID new_rid;
+    if (!table_info_->table_->InsertTuple(child_tuple, &new_rid, txn, ring.get())) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "InsertExecutor: cannot insert the tuple");
+    }
+    // the error escapes the execution engine, so the statement aborts and rolls back the tuple and its index entries
+    for (auto *index_info : index_infos_) {
+      auto key = child_tuple.KeyFromTuple(table_info_->schema_, *index_info->index_->GetEntrySchema(),
+                                          index_info->index_->GetEntryAttrs());
+      if (!index_info->index_->InsertEntry(key, new_rid, txn)) {
+        throw Exception("duplicate key in unique index " + index_info->name_);
+      }
+      txn->AppendIndexWriteRecord(IndexWriteRecord(new_rid, table_info_->oid_, WType::INSERT, child_tuple,
+                                                   index_info->index_oid_, exec_ctx_->GetCatalog()));
+    }
+    count++;
+  }
+
+  std::vector<Value> values{ValueFactory::GetIntegerValue(count)};
+  *tuple = Tuple(values, &GetOutputSchema());
+  return true;
+}
 
 }  // namespace bustub
@@ -99,7 +99,7 @@ auto GetMockTableSchemaOf(const std::string &table) -> Schema {
   throw bustub::Exception(fmt::format("mock table {} not found", table));
 }
 
-auto GetSizeOf(const MockScanPlanNode *plan) -> size_t {
+auto GetMockTableSizeOf(const MockScanPlanNode *plan) -> size_t {
   const auto &table = plan->GetTable();
 
   if (table == "__mock_table_1") {
@@ -380,7 +380,7 @@ auto GetFunctionOf(const MockScanPlanNode *plan) -> std::function<Tuple(size_t)>
 }
 
 MockScanExecutor::MockScanExecutor(ExecutorContext *exec_ctx, const MockScanPlanNode *plan)
-    : AbstractExecutor{exec_ctx}, plan_{plan}, func_(GetFunctionOf(plan)), size_(GetSizeOf(plan)) {
+    : AbstractExecutor{exec_ctx}, plan_{plan}, func_(GetFunctionOf(plan)), size_(GetMockTableSizeOf(plan)) {
   if (GetShuffled(plan)) {
     for (size_t i = 0; i < size_; i++) {
       shuffled_idx_.push_back(i);
@@ -392,16 +392,19 @@ MockScanExecutor::MockScanExecutor(ExecutorContext *exec_ctx, const MockScanPlan
 }
 
 void MockScanExecutor::Init() {
-  // Reset the cursor
-  cursor_ = 0;
+  // Reset the cursor, to the morsel of a worker of a parallel scan if there is one
+  const Morsel *morsel = exec_ctx_->GetMorsel();
+  cursor_ = morsel == nullptr ? 0 : morsel->begin_;
+  end_ = morsel == nullptr ? size_ : morsel->end_;
 }
 
 auto MockScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (cursor_ == size_) {
+  if (cursor_ == end_) {
     // Scan complete
     return EXECUTOR_EXHAUSTED;
   }
-  if (shuffled_idx_.empty()) {
+  // Each worker of a parallel scan would shuffle the table its own way, so morsels read their rows in order
+  if (shuffled_idx_.empty() || exec_ctx_->GetMorsel() != nullptr) {
     *tuple = func_(cursor_);
   } else {
     *tuple = func_(shuffled_idx_[cursor_]);
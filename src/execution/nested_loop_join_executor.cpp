@@ -13,21 +13,83 @@
 #include "execution/executors/nested_loop_join_executor.h"
 #include "binder/table_ref/bound_join_ref.h"
 #include "common/exception.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)),
+      compiled_predicate_(CompiledExpression::CompileJoin(plan_->Predicate(), left_executor_->GetOutputSchema(),
+                                                          right_executor_->GetOutputSchema())) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestedLoopJoinExecutor::Init() { throw NotImplementedException("NestedLoopJoinExecutor is not implemented"); }
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  RID rid;
+  has_left_tuple_ = left_executor_->Next(&left_tuple_, &rid);
+  left_joined_ = false;
+}
+
+auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  Tuple right_tuple;
+  RID right_rid;
+  while (has_left_tuple_) {
+    while (right_executor_->Next(&right_tuple, &right_rid)) {
+      if (MatchesPredicate(right_tuple)) {
+        left_joined_ = true;
+        *tuple = JoinTuples(&right_tuple);
+        return true;
+      }
+    }
+
+    // The right side is done with this left tuple: move on to the next one
+    const bool pad = !left_joined_ && plan_->GetJoinType() == JoinType::LEFT;
+    if (pad) {
+      *tuple = JoinTuples(nullptr);
+    }
+    RID left_rid;
+    has_left_tuple_ = left_executor_->Next(&left_tuple_, &left_rid);
+    left_joined_ = false;
+    right_executor_->Init();
+    if (pad) {
+      return true;
+    }
+  }
+  return false;
+}
 
-auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto NestedLoopJoinExecutor::MatchesPredicate(const Tuple &right_tuple) -> bool {
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->EvaluateJoinPredicate(left_tuple_, right_tuple);
+  }
+  auto value = plan_->Predicate().EvaluateJoin(&left_tuple_, left_executor_->GetOutputSchema(), &right_tuple,
+                                                right_executor_->GetOutputSchema());
+  return !value.IsNull() && value.GetAs<bool>();
+}
+
+auto NestedLoopJoinExecutor::JoinTuples(const Tuple *right_tuple) const -> Tuple {
+  const Schema &left_schema = left_executor_->GetOutputSchema();
+  const Schema &right_schema = right_executor_->GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+    values.push_back(left_tuple_.GetValue(&left_schema, i));
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    values.push_back(right_tuple == nullptr ? ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType())
+                                            : right_tuple->GetValue(&right_schema, i));
+  }
+  return {values, &GetOutputSchema()};
+}
 
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.cpp
+//
+// Identification: src/execution/parallel_pipeline.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/parallel_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "execution/executor_factory.h"
+#include "execution/executors/mock_scan_executor.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the scan at the bottom of a pipeline, or nullptr if plan is not one */
+auto ScanOf(const AbstractPlanNode *plan) -> const AbstractPlanNode * {
+  while (plan->GetType() == PlanType::Filter || plan->GetType() == PlanType::Projection) {
+    plan = plan->GetChildAt(0).get();
+  }
+  if (plan->GetType() == PlanType::SeqScan || plan->GetType() == PlanType::MockScan) {
+    return plan;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+auto ParallelPipeline::CanRun(ExecutorContext *exec_ctx, const AbstractPlanNode &plan) -> bool {
+  return exec_ctx->GetWorkers() != nullptr && exec_ctx->GetWorkers()->GetWorkerCount() > 1 &&
+         exec_ctx->GetMorsel() == nullptr && IsPipeline(plan);
+}
+
+auto ParallelPipeline::IsPipeline(const AbstractPlanNode &plan) -> bool { return ScanOf(&plan) != nullptr; }
+
+ParallelPipeline::ParallelPipeline(ExecutorContext *exec_ctx, AbstractPlanNodeRef plan)
+    : ParallelPipeline(exec_ctx, std::move(plan), exec_ctx->GetWorkers()->GetWorkerCount()) {}
+
+ParallelPipeline::ParallelPipeline(ExecutorContext *exec_ctx, AbstractPlanNodeRef plan, size_t worker_count)
+    : exec_ctx_(exec_ctx), plan_(std::move(plan)) {
+  SplitIntoMorsels();
+  for (size_t i = 0; i < worker_count; i++) {
+    // the workers do not start workers of their own
+    contexts_.push_back(std::make_unique<ExecutorContext>(exec_ctx_->GetTransaction(), exec_ctx_->GetCatalog(),
+                                                          exec_ctx_->GetBufferPoolManager(),
+                                                          exec_ctx_->GetTransactionManager(),
+                                                          exec_ctx_->GetLockManager()));
+    executors_.push_back(ExecutorFactory::CreateExecutor(contexts_.back().get(), plan_));
+  }
+  batches_.resize(worker_count);
+}
+
+void ParallelPipeline::Run(const std::function<void(size_t worker, size_t morsel, TupleBatch *batch)> &consume) {
+  exec_ctx_->GetWorkers()->Run(morsels_.size(),
+                               [&](size_t worker, size_t morsel) { RunMorsel(worker, morsel, consume); });
+}
+
+void ParallelPipeline::RunMorsel(size_t worker, size_t morsel,
+                                 const std::function<void(size_t worker, size_t morsel, TupleBatch *batch)> &consume) {
+  contexts_[worker]->SetMorsel(&morsels_[morsel]);
+  executors_[worker]->Init();
+  while (executors_[worker]->NextBatch(&batches_[worker])) {
+    consume(worker, morsel, &batches_[worker]);
+  }
+}
+
+void ParallelPipeline::SplitIntoMorsels() {
+  const AbstractPlanNode *scan = ScanOf(plan_.get());
+  if (scan->GetType() == PlanType::MockScan) {
+    const size_t rows = GetMockTableSizeOf(dynamic_cast<const MockScanPlanNode *>(scan));
+    for (size_t begin = 0; begin < rows; begin += MORSEL_ROWS) {
+      morsels_.push_back(Morsel{INVALID_PAGE_ID, begin, std::min<size_t>(begin + MORSEL_ROWS, rows)});
+    }
+    return;
+  }
+
+  const auto *seq_scan = dynamic_cast<const SeqScanPlanNode *>(scan);
+  const auto page_ids = exec_ctx_->GetCatalog()->GetTable(seq_scan->GetTableOid())->table_->GetPageIds();
+  for (size_t i = 0; i < page_ids.size(); i += MORSEL_PAGES) {
+    const size_t end = i + MORSEL_PAGES < page_ids.size() ? i + MORSEL_PAGES : SIZE_MAX;
+    morsels_.push_back(Morsel{page_ids[i], i, end});
+  }
+}
+
+}  // namespace bustub
@@ -1,11 +1,21 @@
 #include "execution/executors/projection_executor.h"
+#include "execution/expressions/column_value_expression.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 ProjectionExecutor::ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
                                        std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  for (const auto &expr : plan_->GetExpressions()) {
+    // the tree copies a column of a batch at once
+    if (dynamic_cast<const ColumnValueExpression *>(expr.get()) != nullptr) {
+      compiled_expressions_.emplace_back(nullptr);
+    } else {
+      compiled_expressions_.push_back(CompiledExpression::Compile(*expr, child_executor_->GetOutputSchema()));
+    }
+  }
+}
 
 void ProjectionExecutor::Init() {
   // Initialize the child executor
@@ -25,12 +35,34 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   // Compute expressions
   std::vector<Value> values{};
   values.reserve(GetOutputSchema().GetColumnCount());
-  for (const auto &expr : plan_->GetExpressions()) {
-    values.push_back(expr->Evaluate(&child_tuple, child_executor_->GetOutputSchema()));
+  const auto &expressions = plan_->GetExpressions();
+  for (uint32_t i = 0; i < expressions.size(); i++) {
+    values.push_back(compiled_expressions_[i] != nullptr
+                         ? compiled_expressions_[i]->Evaluate(child_tuple)
+                         : expressions[i]->Evaluate(&child_tuple, child_executor_->GetOutputSchema()));
   }
 
   *tuple = Tuple{values, &GetOutputSchema()};
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  // The projected rows keep the positions, and so the selection, of those of the child
+  batch->Reset(&GetOutputSchema());
+  batch->CopyRows(child_batch_);
+  const auto &expressions = plan_->GetExpressions();
+  for (uint32_t i = 0; i < expressions.size(); i++) {
+    if (compiled_expressions_[i] != nullptr) {
+      compiled_expressions_[i]->EvaluateBatch(child_batch_, &batch->GetColumn(i));
+    } else {
+      expressions[i]->EvaluateBatch(child_batch_, &batch->GetColumn(i));
+    }
+  }
+  return true;
+}
 }  // namespace bustub
@@ -14,10 +14,98 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {
+  if (plan_->filter_predicate_ != nullptr) {
+    compiled_predicate_ = CompiledExpression::Compile(*plan_->filter_predicate_, GetOutputSchema());
+    kernel_predicate_ = KernelPredicate::Compile(*plan_->filter_predicate_, GetOutputSchema());
+  }
+}
 
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  // read ahead so that the scan does not wait on the disk one page at a time, and keep a large table from flushing
+  // the rest of the buffer pool
+  iterator_.reset();
+  const Morsel *morsel = exec_ctx_->GetMorsel();
+  if (morsel == nullptr) {
+    ring_ = table_info_->table_->MakeScanRing();
+    iterator_ = std::make_unique<TableIterator>(
+        table_info_->table_->Begin(exec_ctx_->GetTransaction(), SEQ_SCAN_READAHEAD_PAGES, ring_.get()));
+    stop_position_ = SIZE_MAX;
+    return;
+  }
+  // a worker of a parallel scan keeps its ring from one morsel to the next
+  if (ring_ == nullptr) {
+    ring_ = table_info_->table_->MakeScanRing();
+  }
+  iterator_ = std::make_unique<TableIterator>(table_info_->table_->BeginAt(
+      morsel->first_page_id_, exec_ctx_->GetTransaction(), SEQ_SCAN_READAHEAD_PAGES, ring_.get()));
+  stop_position_ = morsel->end_;
+  position_page_id_ = INVALID_PAGE_ID;
+}
 
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto SeqScanExecutor::HasNext(const TableIterator &end) -> bool {
+  if (*iterator_ == end) {
+    return false;
+  }
+  if (stop_position_ == SIZE_MAX) {
+    return true;
+  }
+  // the chain position only changes with the page, so it is looked up once per page
+  const page_id_t page_id = (**iterator_).GetRid().GetPageId();
+  if (page_id != position_page_id_) {
+    position_page_id_ = page_id;
+    page_in_range_ = table_info_->table_->GetChainPosition(page_id) < stop_position_;
+  }
+  return page_in_range_;
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto end = table_info_->table_->End();
+  while (HasNext(end)) {
+    *tuple = **iterator_;
+    *rid = tuple->GetRid();
+    ++(*iterator_);
+    if (plan_->filter_predicate_ == nullptr) {
+      return true;
+    }
+    if (compiled_predicate_ != nullptr) {
+      if (compiled_predicate_->EvaluatePredicate(*tuple)) {
+        return true;
+      }
+      continue;
+    }
+    auto value = plan_->filter_predicate_->Evaluate(tuple, GetOutputSchema());
+    if (!value.IsNull() && value.GetAs<bool>()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  const auto end = table_info_->table_->End();
+  do {
+    batch->Reset(&GetOutputSchema());
+    for (; !batch->IsFull() && HasNext(end); ++(*iterator_)) {
+      const Tuple &tuple = **iterator_;
+      batch->AppendTuple(tuple, tuple.GetRid());
+    }
+    if (batch->GetRowCount() == 0) {
+      return false;
+    }
+    if (kernel_predicate_ != nullptr) {
+      kernel_predicate_->Select(batch);
+    } else if (compiled_predicate_ != nullptr) {
+      compiled_predicate_->EvaluateBatch(*batch, &predicate_);
+      batch->Select(predicate_);
+    } else if (plan_->filter_predicate_ != nullptr) {
+      plan_->filter_predicate_->EvaluateBatch(*batch, &predicate_);
+      batch->Select(predicate_);
+    }
+  } while (batch->Size() == 0);
+  return true;
+}
 
 }  // namespace bustub
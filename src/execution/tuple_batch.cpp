@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include <utility>
+
+#include "type/limits.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+ColumnVector::ColumnVector(TypeId type) : type_(type), width_(Type::GetTypeSize(type)) {}
+
+void ColumnVector::Resize(size_t size) {
+  size_ = size;
+  if (IsInlined()) {
+    data_.resize(size * width_);
+  } else {
+    values_.resize(size);
+  }
+}
+
+void ColumnVector::Reset(TypeId type, size_t size) {
+  type_ = type;
+  width_ = Type::GetTypeSize(type);
+  Resize(size);
+}
+
+void ColumnVector::SetValue(size_t row, const Value &value) {
+  if (value.IsNull()) {
+    SetNull(row);
+    return;
+  }
+  const Value &typed = value.GetTypeId() == type_ ? value : value.CastAs(type_);
+  if (IsInlined()) {
+    typed.SerializeTo(&data_[row * width_]);
+  } else {
+    values_[row] = typed;
+  }
+}
+
+void ColumnVector::SetNull(size_t row) {
+  char *storage = IsInlined() ? &data_[row * width_] : nullptr;
+  switch (type_) {
+    case TypeId::BOOLEAN:
+      *reinterpret_cast<int8_t *>(storage) = BUSTUB_BOOLEAN_NULL;
+      break;
+    case TypeId::TINYINT:
+      *reinterpret_cast<int8_t *>(storage) = BUSTUB_INT8_NULL;
+      break;
+    case TypeId::SMALLINT:
+      *reinterpret_cast<int16_t *>(storage) = BUSTUB_INT16_NULL;
+      break;
+    case TypeId::INTEGER:
+      *reinterpret_cast<int32_t *>(storage) = BUSTUB_INT32_NULL;
+      break;
+    case TypeId::BIGINT:
+      *reinterpret_cast<int64_t *>(storage) = BUSTUB_INT64_NULL;
+      break;
+    case TypeId::DECIMAL:
+      *reinterpret_cast<double *>(storage) = BUSTUB_DECIMAL_NULL;
+      break;
+    case TypeId::TIMESTAMP:
+      *reinterpret_cast<uint64_t *>(storage) = BUSTUB_TIMESTAMP_NULL;
+      break;
+    case TypeId::VARCHAR:
+      values_[row] = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+      break;
+    default:
+      UNREACHABLE("a column has no values of an invalid type");
+  }
+}
+
+void TupleBatch::Reset(const Schema *schema) {
+  // a batch moved from has no columns left
+  if (schema != schema_ || columns_.size() != schema->GetColumnCount()) {
+    schema_ = schema;
+    columns_.clear();
+    for (const auto &column : schema->GetColumns()) {
+      columns_.emplace_back(column.GetType());
+    }
+  }
+  for (auto &column : columns_) {
+    column.Resize(0);
+  }
+  rids_.clear();
+  selection_.clear();
+}
+
+auto TupleBatch::AppendRow(RID rid) -> size_t {
+  const size_t row = rids_.size();
+  rids_.push_back(rid);
+  selection_.push_back(row);
+  for (auto &column : columns_) {
+    column.Resize(row + 1);
+  }
+  return row;
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, RID rid) {
+  const size_t row = AppendRow(rid);
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].SetFromTuple(row, tuple, *schema_, i);
+  }
+}
+
+void TupleBatch::CopyRows(const TupleBatch &other) {
+  rids_ = other.rids_;
+  selection_ = other.selection_;
+  for (auto &column : columns_) {
+    column.Resize(rids_.size());
+  }
+}
+
+void TupleBatch::Select(const ColumnVector &predicate) {
+  // NULL is neither true nor false
+  const auto *keep = predicate.GetData<int8_t>();
+  size_t count = 0;
+  for (const auto row : selection_) {
+    if (keep[row] == 1) {
+      selection_[count++] = row;
+    }
+  }
+  selection_.resize(count);
+}
+
+void TupleBatch::Select(const uint64_t *mask) {
+  size_t count = 0;
+  for (const auto row : selection_) {
+    if ((mask[row / 64] >> (row % 64) & 1) != 0) {
+      selection_[count++] = row;
+    }
+  }
+  selection_.resize(count);
+}
+
+auto TupleBatch::GetTuple(size_t row) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column.GetValue(row));
+  }
+  return {std::move(values), schema_};
+}
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// work_stealing_pool.cpp
+//
+// Identification: src/execution/work_stealing_pool.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/work_stealing_pool.h"
+
+namespace bustub {
+
+WorkStealingPool::WorkStealingPool(size_t worker_count) {
+  BUSTUB_ASSERT(worker_count > 0, "a pool needs a worker");
+  for (size_t i = 0; i < worker_count; i++) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  for (size_t i = 1; i < worker_count; i++) {
+    threads_.emplace_back(&WorkStealingPool::RunWorker, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::Run(size_t task_count, const std::function<void(size_t worker, size_t task)> &task) {
+  std::scoped_lock<std::mutex> run_lock(run_latch_);
+  const size_t worker_count = queues_.size();
+  for (size_t worker = 0; worker < worker_count; worker++) {
+    std::scoped_lock<std::mutex> lock(queues_[worker]->latch_);
+    for (size_t i = task_count * worker / worker_count; i < task_count * (worker + 1) / worker_count; i++) {
+      queues_[worker]->tasks_.push_back(i);
+    }
+  }
+
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    task_ = &task;
+    error_ = nullptr;
+    running_ = threads_.size();
+    generation_++;
+  }
+  start_cv_.notify_all();
+  RunTasks(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    done_cv_.wait(lock, [&] { return running_ == 0; });
+    task_ = nullptr;
+    error = error_;
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkStealingPool::RunWorker(size_t worker) {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      start_cv_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+    }
+    RunTasks(worker);
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      running_--;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void WorkStealingPool::RunTasks(size_t worker) {
+  size_t task;
+  while (NextTask(worker, &task)) {
+    try {
+      (*task_)(worker, task);
+    } catch (...) {
+      {
+        std::scoped_lock<std::mutex> lock(latch_);
+        if (error_ == nullptr) {
+          error_ = std::current_exception();
+        }
+      }
+      // drop the tasks nobody has started, whose results would be thrown away
+      for (auto &queue : queues_) {
+        std::scoped_lock<std::mutex> lock(queue->latch_);
+        queue->tasks_.clear();
+      }
+    }
+  }
+}
+
+auto WorkStealingPool::NextTask(size_t worker, size_t *task) -> bool {
+  {
+    auto &queue = *queues_[worker];
+    std::scoped_lock<std::mutex> lock(queue.latch_);
+    if (!queue.tasks_.empty()) {
+      *task = queue.tasks_.front();
+      queue.tasks_.pop_front();
+      return true;
+    }
+  }
+  // steal the task furthest from the ones the victim is on
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto &victim = *queues_[(worker + i) % queues_.size()];
+    std::scoped_lock<std::mutex> lock(victim.latch_);
+    if (!victim.tasks_.empty()) {
+      *task = victim.tasks_.back();
+      victim.tasks_.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
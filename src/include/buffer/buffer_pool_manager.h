@@ -15,7 +15,9 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_ring.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -84,6 +86,41 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page with an access hint. See AccessType and BufferRing.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the scan, or nullptr
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type, BufferRing *ring = nullptr) -> Page * {
+    return FetchPgWithHintImp(page_id, access_type, ring);
+  }
+
+  /**
+   * Create a new page with an access hint. See AccessType and BufferRing.
+   * @param[out] page_id id of created page
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the bulk insert, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, AccessType access_type, BufferRing *ring = nullptr) -> Page * {
+    return NewPgWithHintImp(page_id, access_type, ring);
+  }
+
+  /**
+   * Hint that the given pages will be fetched soon. Pages that are not resident are read into the buffer pool in the
+   * background, without being pinned, so that a later FetchPage() finds them in memory. This is only a hint: pages
+   * may be skipped when there are not enough evictable frames, and prefetched pages may be evicted again before use.
+   * @param page_ids ids of the pages to prefetch, in the order they are expected to be fetched
+   * @param ring the private ring of the scan the pages are prefetched for, or nullptr
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferRing *ring = nullptr) {
+    if (!page_ids.empty()) {
+      PrefetchPgsImp(page_ids, ring);
+    }
+  }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -141,5 +178,34 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Fetch a page with an access hint. The default implementation ignores the hint.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the scan, or nullptr
+   * @return the requested page
+   */
+  virtual auto FetchPgWithHintImp(page_id_t page_id, AccessType access_type, BufferRing *ring) -> Page * {
+    return FetchPgImp(page_id);
+  }
+
+  /**
+   * Create a new page with an access hint. The default implementation ignores the hint.
+   * @param[out] page_id id of created page
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the bulk insert, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgWithHintImp(page_id_t *page_id, AccessType access_type, BufferRing *ring) -> Page * {
+    return NewPgImp(page_id);
+  }
+
+  /**
+   * Starts reading the given pages into the buffer pool. The default implementation ignores the hint.
+   * @param page_ids ids of the pages to prefetch
+   * @param ring the private ring of the scan the pages are prefetched for, or nullptr
+   */
+  virtual void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) {}
 };
 }  // namespace bustub
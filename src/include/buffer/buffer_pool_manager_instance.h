@@ -12,20 +12,69 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
+#include "container/hash/open_addressing_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * Tuning knobs of the background page cleaner.
+ */
+struct PageCleanerOptions {
+  /** Fraction of the evictable frames that the cleaner tries to keep clean. */
+  double clean_ratio_{0.25};
+  /** How long the cleaner sleeps between two rounds, unless an eviction has to write a dirty victim first. */
+  std::chrono::milliseconds interval_{std::chrono::milliseconds(10)};
+  /** Maximum number of pages written back in one round. */
+  size_t max_batch_size_{64};
+};
+
+/**
+ * Counters of the background page cleaner.
+ */
+struct PageCleanerStats {
+  /** Rounds that wrote back at least one page. */
+  size_t rounds_{0};
+  /** Pages written back by the cleaner. */
+  size_t pages_cleaned_{0};
+  /** Sequential writes issued by the cleaner, i.e. runs of adjacent page ids. */
+  size_t write_runs_{0};
+  /** Times a dirty page was held back because its log records were not yet persistent. */
+  size_t wal_skipped_{0};
+  /** Evictions whose victim had been cleaned by the cleaner, so no foreground write was needed. */
+  size_t stalls_avoided_{0};
+  /** Evictions that still had to write back a dirty victim in the foreground. */
+  size_t dirty_evictions_{0};
+
+  auto operator+=(const PageCleanerStats &other) -> PageCleanerStats & {
+    rounds_ += other.rounds_;
+    pages_cleaned_ += other.pages_cleaned_;
+    write_runs_ += other.write_runs_;
+    wal_skipped_ += other.wal_skipped_;
+    stalls_avoided_ += other.stalls_avoided_;
+    dirty_evictions_ += other.dirty_evictions_;
+    return *this;
+  }
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -37,9 +86,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -52,6 +116,30 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Start the background page cleaner. The cleaner periodically writes back dirty, unpinned pages so that a
+   * share of the evictable frames is always clean and evictions rarely have to write a victim in the foreground.
+   * @param options tuning knobs of the cleaner
+   */
+  void StartPageCleaner(const PageCleanerOptions &options = PageCleanerOptions());
+
+  /** @brief Stop the background page cleaner, if it is running. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Run one round of page cleaning in the calling thread.
+   *
+   * Dirty pages are picked among unpinned frames until clean_ratio_ of the evictable frames is clean, sweeping the page
+   * ids in ascending order from where the previous round stopped, so that adjacent pages are written back together.
+   * A page is skipped if its LSN is not yet persistent in the log (WAL rule).
+   *
+   * @return the number of pages written back
+   */
+  auto CleanPages() -> size_t;
+
+  /** @return a snapshot of the page cleaner counters */
+  auto GetPageCleanerStats() -> PageCleanerStats;
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -72,6 +160,15 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Create a new page like NewPgImp(). With a ring, the frame is taken from the ring once it is full.
+   * @param[out] page_id id of created page
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the bulk insert, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgWithHintImp(page_id_t *page_id, AccessType access_type, BufferRing *ring) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -90,6 +187,16 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch a page like FetchPgImp(). A SCAN hit is not recorded in the replacer, and a miss with a ring is read
+   * into one of the ring's frames once the ring is full.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the scan, or nullptr
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgWithHintImp(page_id_t page_id, AccessType access_type, BufferRing *ring) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -125,6 +232,21 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * @brief Start reading the given pages into the buffer pool in the background.
+   *
+   * Frames are reserved for the pages that are neither resident nor allocated after the call started, using at most
+   * half of the free and evictable frames so that a prefetch never pushes out the whole working set. The reads are
+   * handed to the prefetch thread as one batch; until a page has been read its frame is LOADING, so a concurrent
+   * FetchPage() waits for the read instead of issuing a second one. Prefetched pages are left unpinned.
+   *
+   * With a ring, the frames come from the ring instead, and the budget is the ring's capacity.
+   *
+   * @param page_ids ids of the pages to prefetch
+   * @param ring the private ring of the scan the pages are prefetched for, or nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -142,32 +264,93 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The data of the pages, one frame after the other, aligned so that O_DIRECT I/O needs no bounce buffer. */
+  char *frames_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  OpenAddressingHashTable<page_id_t, frame_id_t> *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  Replacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes the changes to the page table, the free list, the frame states and the book-keeping fields
+   * (page id, pin count, dirty flag) of every page. It is never held across a disk read or write.
+   *
+   * A hit is served without it: PinHit() raises the pin count of the frame the page table names, which keeps the frame
+   * from being claimed for another page, and then checks that the frame still holds the page. Latched code that reuses
+   * or frees a frame first claims it with ClaimFrame(), which only succeeds while nobody holds a pin on it.
+   */
   std::mutex latch_;
+  /** Pin count of a frame that latched code is reusing or freeing; hits on it take the latched path. */
+  static constexpr int CLAIMED = -1;
+
+  /**
+   * I/O state of a frame.
+   *
+   * A frame is reserved under latch_ and moves READY -> EVICTING (its previous dirty image is being written back) ->
+   * LOADING (the requested page is being read in) -> READY, with the actual I/O performed outside the latch. The new
+   * page id is already in the page table while the frame is not READY, so concurrent fetchers of that page pin the
+   * frame and wait on io_cv_ instead of reading the page a second time.
+   */
+  enum class FrameState { READY, EVICTING, LOADING };
+  /** State of each frame, indexed by frame id. Read by hits without latch_. */
+  std::unique_ptr<std::atomic<FrameState>[]> frame_states_;
+  /** Pages whose dirty image is currently being written back by an evicting thread. */
+  std::unordered_set<page_id_t> evicting_pages_;
+  /** Signalled (with latch_ held by the waiter) every time a frame finishes its I/O. */
+  std::condition_variable io_cv_;
+
+  /** Page cleaner state, protected by latch_. */
+  PageCleanerOptions cleaner_options_;
+  PageCleanerStats cleaner_stats_;
+  std::thread cleaner_thread_;
+  bool cleaner_running_{false};
+  /** Signalled to wake the cleaner up early, or to stop it. */
+  std::condition_variable cleaner_cv_;
+  /** The page id the next cleaning round starts sweeping from. */
+  page_id_t cleaner_cursor_{0};
+  /** Whether the frame's page was last made clean by the cleaner, indexed by frame id. */
+  std::vector<bool> cleaned_frames_;
+
+  /** A frame reserved by PrefetchPgsImp() that the prefetch thread still has to fill. */
+  struct PrefetchRequest {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    page_id_t victim_page_id_;
+  };
+  /** Prefetch thread state, protected by latch_. The thread is started by the first prefetch. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  std::thread prefetch_thread_;
+  bool prefetch_running_{false};
+  std::condition_variable prefetch_cv_;
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * Page ids handed out by this instance are always congruent to instance_index_ modulo num_instances_,
+   * so that a ParallelBufferPoolManager can route a page id back to the instance that owns it.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Check that a page id belongs to this instance.
+   * @param page_id id of the page to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
@@ -176,6 +359,68 @@ class BufferPoolManagerInstance : public BufferPoolManager {
     // This is a no-nop right now without a more complex data structure to track deallocated pages
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Reserve a frame for page_id, taking it from a full ring first, the free list second and the replacer third.
+   * The previous page of the frame, if any, is unmapped; if it is dirty it is registered in evicting_pages_ and must be
+   * written back by the caller (after releasing the latch) before calling FinishFrameIo(). Caller must hold latch_.
+   * @param page_id the page that will live in the frame
+   * @param[out] frame_id the reserved frame
+   * @param[out] victim_page_id the dirty page to write back, or INVALID_PAGE_ID if there is nothing to write
+   * @param ring the ring the page is loaded through, or nullptr; page_id joins the ring
+   * @return false if all frames are pinned
+   */
+  auto ReserveFrame(page_id_t page_id, frame_id_t *frame_id, page_id_t *victim_page_id, BufferRing *ring = nullptr)
+      -> bool;
+
+  /**
+   * @brief Pin the frame of a hit without latch_, waiting for its I/O if it is not READY.
+   * @param page_id the page that was looked up
+   * @param frame_id the frame the page table named for it, which may have been reused since
+   * @param access_type how the page is going to be accessed; a SCAN hit is not recorded in the replacer
+   * @return false if the frame is claimed or no longer holds page_id, in which case it is left unpinned
+   */
+  auto PinHit(page_id_t page_id, frame_id_t frame_id, AccessType access_type) -> bool;
+
+  /**
+   * @brief Claim an unpinned frame so that no hit can pin it while it is reused or freed. The claim ends when the pin
+   * count is stored again. Caller must hold latch_.
+   * @return false if the frame is pinned
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Take the frame of the oldest page of a full ring that nobody else is using. Pages of the ring that have been
+   * evicted, or are pinned by someone else, leave the ring. Caller must hold latch_.
+   * @param ring the ring
+   * @param[out] frame_id the recycled frame, removed from the page table and the replacer
+   * @return false if the ring is not full or has no reusable frame
+   */
+  auto RecycleRingFrame(BufferRing *ring, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Unmap the page of a frame that is being reused. Caller must hold latch_.
+   * @param frame_id the frame
+   * @param[out] victim_page_id the page if it is dirty and must be written back, otherwise INVALID_PAGE_ID
+   */
+  void UnmapVictim(frame_id_t frame_id, page_id_t *victim_page_id);
+
+  /**
+   * @brief Mark the I/O on a reserved frame as complete and wake up everyone waiting on it.
+   * @param frame_id the frame returned by ReserveFrame()
+   * @param victim_page_id the page that was written back, or INVALID_PAGE_ID
+   */
+  void FinishFrameIo(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /** @brief Body of the page cleaner thread. */
+  void RunPageCleaner();
+
+  /** @brief Body of the prefetch thread. */
+  void RunPrefetcher();
+
+  /**
+   * @brief Check the WAL rule for a page. Caller must hold latch_.
+   * @return true if the log records up to the page's LSN are on disk, so the page may be written back
+   */
+  auto IsLogPersistent(Page *page) -> bool;
 };
 }  // namespace bustub
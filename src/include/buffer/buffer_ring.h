@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_ring.h
+//
+// Identification: src/include/buffer/buffer_ring.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** How a page is going to be accessed. Passed to the buffer pool as a hint together with FetchPage/NewPage. */
+enum class AccessType {
+  /** Regular access, the page takes part in replacement like any other page. */
+  UNKNOWN,
+  /**
+   * The page is touched once by a large sequential scan or a bulk insert. A hit does not count as an access for
+   * replacement, and a miss is served from the scan's BufferRing (if any) instead of evicting other pages.
+   */
+  SCAN,
+};
+
+/**
+ * BufferRing is a small private set of frames used by one large scan or bulk insert, in the spirit of PostgreSQL's
+ * buffer access strategies. Pages the scan has to read in are loaded into the ring's frames, recycling the oldest
+ * ones once the ring is full, so that a scan over a table much larger than the buffer pool only ever displaces a
+ * ring's worth of other pages. Pages that are already resident are used in place and do not join the ring.
+ *
+ * A ring belongs to a single scan and is not thread-safe. It keeps one ring per buffer pool instance, so the same
+ * ring can be handed to a ParallelBufferPoolManager.
+ */
+class BufferRing {
+ public:
+  /** @param size the number of frames in the ring */
+  explicit BufferRing(size_t size = BUFFER_RING_SIZE) : size_(size) {}
+
+  /** @return the number of frames in the ring */
+  auto GetSize() const -> size_t { return size_; }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /**
+   * @param instance_index index of the buffer pool instance
+   * @param num_instances number of instances in the buffer pool
+   * @return the pages the ring has brought into that instance, oldest first
+   */
+  auto GetPages(uint32_t instance_index, uint32_t num_instances) -> std::deque<page_id_t> & {
+    if (pages_.size() < num_instances) {
+      pages_.resize(num_instances);
+    }
+    return pages_[instance_index];
+  }
+
+  /** @return the number of frames the ring may use in each of num_instances instances */
+  auto GetCapacity(uint32_t num_instances) const -> size_t { return std::max<size_t>(1, size_ / num_instances); }
+
+  const size_t size_;
+  /** Pages loaded through the ring, per buffer pool instance. */
+  std::vector<std::deque<page_id_t>> pages_;
+};
+
+}  // namespace bustub
@@ -12,17 +12,22 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Each frame has one atomic state word holding its tracked, evictable and reference bits, and the clock hand is an
+ * atomic counter. No call takes a lock: RecordAccess on a tracked frame is a single atomic OR, and Evict claims its
+ * victim with a compare-and-swap, so concurrent evictions never pick the same frame.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +37,40 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  /**
+   * Sweep the clock hand, clearing reference bits, until an evictable frame without one is found. Gives up after the
+   * hand has passed every frame three times, which can only happen while other threads keep pinning frames.
+   */
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  static constexpr uint8_t TRACKED = 1;
+  static constexpr uint8_t EVICTABLE = 2;
+  static constexpr uint8_t REFERENCED = 4;
+
+  /** Number of frames. */
+  const size_t num_pages_;
+  /** State bits of each frame. */
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /** Position of the clock hand; taken modulo num_pages_. */
+  std::atomic<size_t> hand_{0};
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
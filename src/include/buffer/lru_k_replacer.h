@@ -12,21 +12,17 @@
 
 #pragma once
 
+#include <cstdint>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
-#include <algorithm>
-#include <iostream>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-using timestamp_t = std::list<size_t>;//记录单个页时间戳的列表
-
 /**
  * LRUKReplacer implements the LRU-k replacement policy.
  *
@@ -37,8 +33,12 @@ using timestamp_t = std::list<size_t>;//记录单个页时间戳的列表
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * All state lives in flat arrays indexed by frame id, and the evictable frames are kept in an
+ * indexed binary min-heap ordered by eviction priority, so RecordAccess, SetEvictable, Remove and
+ * Evict all run in O(log n) without allocating.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -56,7 +56,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -74,9 +74,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
-
-  auto EvictInstance(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -89,7 +87,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame that received a new access.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -108,7 +106,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -127,7 +125,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -136,48 +134,59 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
-
-  void Print_mem(){
-    std::cout << "new_frame_:" << std::endl;
-    for (auto it = new_frame_.begin(); it != new_frame_.end(); it++){
-      std::cout << *it << "(" << frame_k_[(*it)] << std::endl;
-    }
-    std::cout << "cache_frame_:" << std::endl;
-    for (auto it = cache_frame_.begin(); it != cache_frame_.end(); it++){
-      std::cout << (*it).first << "(" << frame_k_[(*it).first] << std::endl;
-    }
-    std::cout<< "curr_size_:" << std::endl;
-    std::cout<< curr_size_ << std::endl;
-    std::cout<< "replacer_size_:" << std::endl;
-    std::cout<< replacer_size_ << std::endl;
-  }
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  // 当前时间戳，每次recode后+1
-  size_t current_timestamp_{0};
-  // 当前存放的可驱逐页面数量
+  /** Position of a frame that is not in the heap. */
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+  /** Set on the priority of frames with at least k accesses, so frames with +inf k-distance sort first. */
+  static constexpr uint64_t K_ACCESSES_BIT = uint64_t{1} << 63;
+
+  /**
+   * @brief The eviction priority of a frame; the evictable frame with the smallest priority is evicted first.
+   * This is the timestamp of the k-th most recent access, or of the first access if the frame has fewer than k.
+   */
+  auto Priority(frame_id_t frame_id) const -> uint64_t;
+
+  /** @brief Push an evictable frame onto the heap. */
+  void HeapPush(frame_id_t frame_id);
+
+  /** @brief Remove the frame at the given heap position. */
+  void HeapErase(size_t pos);
+
+  /** @brief Move the frame at the given heap position up until the heap property holds. */
+  void SiftUp(size_t pos);
+
+  /** @brief Move the frame at the given heap position down until the heap property holds. */
+  void SiftDown(size_t pos);
+
+  /** @brief Place a frame at the given heap position and record that position. */
+  void HeapPlace(size_t pos, frame_id_t frame_id);
+
+  /** @brief Forget the access history of a frame. */
+  void ResetFrame(frame_id_t frame_id);
+
+  /** Logical clock, incremented on every access. */
+  uint64_t current_timestamp_{0};
+  /** Number of evictable frames. */
   size_t curr_size_{0};
-  // 最大可驱逐页面数量。初始为主存最多可存页面数
-  size_t replacer_size_;
-  // lru-k的k
-  size_t k_;
-  // latch
+  /** Number of frames the replacer can track. */
+  const size_t replacer_size_;
+  const size_t k_;
   std::mutex latch_;
-  // 记录每个frame的 timestamp 列表(只维护k个，这样.begin()就可以直接获取倒数第k次)
-  std::unordered_map<frame_id_t, timestamp_t> frame_timestamp_;
-  // 记录每个frame的 evictable 
-  std::unordered_map<frame_id_t, bool> frame_evictable_;
-  // 记录每个frame的 访问次数
-  std::unordered_map<frame_id_t, size_t> frame_k_;
-  // 未满 k 次的 LRU （头插尾删）
-  std::list<frame_id_t> new_frame_;
-  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> new_frame_umap_;
-  // 达到 k 次的 LRU -- pair(frame_id, last k-th timestamp)
-  std::list<std::pair<frame_id_t, size_t>> cache_frame_;
-  std::unordered_map<frame_id_t, std::list<std::pair<frame_id_t, size_t>>::iterator> cache_frame_umap_;
+
+  /** The last k access timestamps of each frame, as a ring of k slots starting at frame_id * k. */
+  std::vector<uint64_t> history_;
+  /** Number of accesses of each frame since it was last evicted or removed; 0 means the frame is not tracked. */
+  std::vector<size_t> access_count_;
+  /** Whether each tracked frame is evictable. */
+  std::vector<bool> evictable_;
+  /** Cached Priority() of each frame in the heap. */
+  std::vector<uint64_t> priority_;
+  /** Position of each frame in heap_, or NOT_IN_HEAP. */
+  std::vector<size_t> heap_pos_;
+  /** Min-heap of the evictable frames, ordered by priority_. Its capacity is reserved up front. */
+  std::vector<frame_id_t> heap_;
 };
 
 }  // namespace bustub
@@ -45,6 +45,20 @@ class LRUReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  auto Evict(frame_id_t *frame_id) -> bool override { return Victim(frame_id); }
+
+  void RecordAccess(frame_id_t frame_id) override {}
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override {
+    if (set_evictable) {
+      Unpin(frame_id);
+    } else {
+      Pin(frame_id);
+    }
+  }
+
+  void Remove(frame_id_t frame_id) override { Pin(frame_id); }
+
  private:
   // TODO(student): implement me!
 };
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards pages across several BufferPoolManagerInstances. Every instance owns its own
+ * frames, page table, replacer, free list and latch, so threads that touch pages of different shards never contend.
+ * A page id is owned by instance (page_id % num_instances); new pages are allocated round-robin across instances.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the total number of frames across all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return the number of BufferPoolManagerInstances */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * Starts the background page cleaner of every instance.
+   * @param options tuning knobs of the cleaners
+   */
+  void StartPageCleaner(const PageCleanerOptions &options = PageCleanerOptions());
+
+  /** Stops the background page cleaner of every instance. */
+  void StopPageCleaner();
+
+  /** @return the page cleaner counters, summed over all instances */
+  auto GetPageCleanerStats() -> PageCleanerStats;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Fetch the requested page with an access hint, from the instance that owns it.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the scan, or nullptr
+   * @return the requested page
+   */
+  auto FetchPgWithHintImp(page_id_t page_id, AccessType access_type, BufferRing *ring) -> Page * override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried round-robin, starting from the instance after the one
+   * that served the previous call, until one of them has a free or evictable frame.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Creates a new page with an access hint, probing instances like NewPgImp().
+   * @param[out] page_id id of created page
+   * @param access_type how the page is going to be accessed
+   * @param ring the private ring of the bulk insert, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgWithHintImp(page_id_t *page_id, AccessType access_type, BufferRing *ring) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPgsImp() override;
+
+  /**
+   * Splits the pages by owning instance and prefetches each share in its instance.
+   * @param page_ids ids of the pages to prefetch
+   * @param ring the private ring of the scan the pages are prefetched for, or nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) override;
+
+ private:
+  /** The shards, instance i owns every page id with page_id % num_instances == i. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Pool size of each instance. */
+  const size_t pool_size_;
+  /** The instance NewPgImp starts probing from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -16,35 +16,71 @@
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManagerInstance can be built with. */
+enum class ReplacerType { LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
+ *
+ * The buffer pool drives a replacer through RecordAccess/SetEvictable/Evict/Remove. The older Victim/Pin/Unpin
+ * interface is expressed in terms of those calls.
  */
 class Replacer {
  public:
   Replacer() = default;
   virtual ~Replacer() = default;
 
+  /**
+   * Evict a frame chosen by the replacement policy. Only evictable frames are candidates, and the evicted frame is no
+   * longer tracked.
+   * @param[out] frame_id id of the evicted frame
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame. A frame seen for the first time starts being tracked as evictable.
+   * @param frame_id id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * Mark a tracked frame evictable or not. Untracked frames are ignored.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame. Untracked and non-evictable frames are ignored.
+   * @param frame_id id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /** @return the number of elements in the replacer that can be victimized */
+  virtual auto Size() -> size_t = 0;
+
   /**
    * Remove the victim frame as defined by the replacement policy.
    * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
 
   /**
    * Pins a frame, indicating that it should not be victimized until it is unpinned.
    * @param frame_id the id of the frame to pin
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
 
   /**
    * Unpins a frame, indicating that it can now be victimized.
    * @param frame_id the id of the frame to unpin
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
-
-  /** @return the number of elements in the replacer that can be victimized */
-  virtual auto Size() -> size_t = 0;
+  virtual void Unpin(frame_id_t frame_id) {
+    RecordAccess(frame_id);
+    SetEvictable(frame_id, true);
+  }
 };
 
 }  // namespace bustub
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_ring.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
@@ -94,9 +95,11 @@ struct IndexInfo {
 };
 
 /**
- * The Catalog is a non-persistent catalog that is designed for
- * use by executors within the DBMS execution engine. It handles
- * table creation, table lookup, index creation, and index lookup.
+ * The Catalog is designed for use by executors within the DBMS
+ * execution engine. It handles table creation, table lookup, index
+ * creation, and index lookup. It lives in memory, unless it is opened
+ * with Open(): then it keeps itself in catalog pages of the database
+ * file as well, and a later run reads it back from there.
  */
 class Catalog {
  public:
@@ -151,6 +154,11 @@ class Catalog {
     table_names_.emplace(table_name, table_oid);
     index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
 
+    // a table without a heap has nothing to reopen
+    if (create_table_heap) {
+      Save();
+    }
+
     return tmp;
   }
 
@@ -194,14 +202,19 @@ class Catalog {
    * @param schema The schema of the table
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
-   * @param keysize Size of the key
+   * @param keysize Size of the key, that of KeyType for the catalog to reopen the index
    * @param hash_function The hash function for the index
+   * @param is_unique Whether a key maps to at most one row; a non-unique index appends the RID to its keys, which
+   * must leave room for it
+   * @param included_attrs Columns stored in the index entries after the key, for index-only scans
    * @return A (non-owning) pointer to the metadata of the new table
+   * @throw Exception if the index is unique and two rows of the table have the same key; no index is created then
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool is_unique = true,
+                   const std::vector<uint32_t> &included_attrs = {}) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -218,25 +231,36 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta =
+        std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique, included_attrs);
 
     // Construct the index, take ownership of metadata
     // TODO(Kyle): We should update the API for CreateIndex
     // to allow specification of the index type itself, not
     // just the key, value, and comparator types
 
+    // Get the next OID for the new index
+    const auto index_oid = next_index_oid_.fetch_add(1);
+
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(
+        std::move(meta), bpm_, BPlusTreeMode::CLASSIC, RootRecordName(index_oid));
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap: one sequential scan feeding a sort and a bulk load. If the
+    // load throws, the index is dropped before it is registered.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
-    }
-
-    // Get the next OID for the new index
-    const auto index_oid = next_index_oid_.fetch_add(1);
+    BufferRing ring;
+    auto tuple = heap->Begin(txn, SEQ_SCAN_READAHEAD_PAGES, &ring);
+    index->BulkLoad([&](Tuple *key, RID *rid) {
+      if (tuple == heap->End()) {
+        return false;
+      }
+      *key = tuple->KeyFromTuple(schema, *index->GetEntrySchema(), index->GetEntryAttrs());
+      *rid = tuple->GetRid();
+      ++tuple;
+      return true;
+    });
 
     // Construct index information; IndexInfo takes ownership of the Index itself
     auto index_info =
@@ -246,6 +270,7 @@ class Catalog {
     // Update internal tracking
     indexes_.emplace(index_oid, std::move(index_info));
     table_indexes.emplace(index_name, index_oid);
+    Save();
 
     return tmp;
   }
@@ -298,7 +323,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -341,7 +366,20 @@ class Catalog {
     return result;
   }
 
+  /**
+   * Keep the catalog in the database file from now on, and read back the tables and indexes an earlier run kept
+   * there, without touching their data. The header page must exist, and the catalog must be empty.
+   * @return whether the database file held a catalog
+   */
+  auto Open() -> bool;
+
  private:
+  /** Write the catalog to its pages, if it is kept in the database file. The caller holds the catalog exclusively. */
+  void Save();
+
+  /** @return the header page record of the root of the index index_oid */
+  static auto RootRecordName(index_oid_t index_oid) -> std::string;
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -371,6 +409,9 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Whether the catalog is kept in the database file, see Open(). */
+  bool persistent_{false};
 };
 
 }  // namespace bustub
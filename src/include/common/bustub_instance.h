@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <sstream>
@@ -25,6 +28,7 @@
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/util/string_util.h"
+#include "execution/work_stealing_pool.h"
 #include "libfort/lib/fort.hpp"
 #include "type/value.h"
 
@@ -210,6 +214,12 @@ class BustubInstance {
    */
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
+  /**
+   * Give a new database its header page, which is the first page and leads to the catalog and the index roots. An
+   * existing database file already starts with it.
+   */
+  void InitHeaderPage();
+
  public:
   explicit BustubInstance(const std::string &db_file_name);
 
@@ -255,10 +265,14 @@ class BustubInstance {
   std::shared_mutex catalog_lock_;
 
   auto GetSessionVariable(const std::string &key) -> std::string {
-    if (session_variables_.find(key) != session_variables_.end()) {
-      return session_variables_[key];
-    }
-    return "";
+    std::scoped_lock l(session_lock_);
+    auto it = session_variables_.find(key);
+    return it != session_variables_.end() ? it->second : "";
+  }
+
+  void SetSessionVariable(const std::string &key, const std::string &value) {
+    std::scoped_lock l(session_lock_);
+    session_variables_[key] = value;
   }
 
   auto IsForceStarterRule() -> bool {
@@ -266,12 +280,30 @@ class BustubInstance {
     return variable == "1" || variable == "true" || variable == "yes";
   }
 
+  /**
+   * @return the number of workers a query runs its pipelines on, set by `set execution_threads=N`. The default of 1
+   * runs queries on the calling thread.
+   */
+  auto GetExecutionThreads() -> size_t {
+    const auto threads = std::strtoll(GetSessionVariable("execution_threads").c_str(), nullptr, 10);
+    return std::clamp<int64_t>(threads, 1, MAX_EXECUTION_THREADS);
+  }
+
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
+  /** Protects session_variables_, which concurrent statements read and `set` writes */
+  std::mutex session_lock_;
   std::unordered_map<std::string, std::string> session_variables_;
+  /** Protects execution_workers_ */
+  std::mutex execution_workers_lock_;
+  /**
+   * The workers of parallel queries, started for the first one and again when execution_threads changes. A new pool
+   * replaces the old one, which stays up until the queries that run on it are done.
+   */
+  std::shared_ptr<WorkStealingPool> execution_workers_;
 };
 
 }  // namespace bustub
@@ -32,10 +32,20 @@ static constexpr int INVALID_TXN_ID = -1;
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;                                     // alignment of O_DIRECT buffers
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int SEQ_SCAN_READAHEAD_PAGES = 16;  // pages a sequential scan keeps prefetched ahead of itself
+static constexpr int BUFFER_RING_SIZE = 32;          // frames in the private ring of a large scan or bulk insert
+static constexpr double INDEX_FILL_FACTOR = 0.9;     // how full bulk loading packs B+ tree pages
+static constexpr int EXTERNAL_SORT_RUN_PAGES = 64;   // pages worth of entries an external sort orders in memory
+static constexpr int TUPLE_BATCH_SIZE = 1024;        // tuples an executor passes on at a time in NextBatch()
+static constexpr int MORSEL_PAGES = 16;              // table heap pages a worker of a parallel scan takes at a time
+static constexpr int MORSEL_ROWS = 16384;            // mock table rows a worker of a parallel scan takes at a time
+static constexpr int MAX_EXECUTION_THREADS = 256;    // the most workers `set execution_threads` gives a query
+static constexpr int EXCHANGE_QUEUE_BATCHES = 8;      // batches an exchange holds for each of its consumers
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
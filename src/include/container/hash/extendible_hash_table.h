@@ -17,18 +17,32 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "container/hash/hash_table.h"
 
 namespace bustub {
 
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
+ *
+ * The table is safe for concurrent use. The directory is guarded by a reader-writer latch that only bucket splits
+ * take exclusively; Remove and non-splitting Inserts share it and then latch just their bucket exclusively, so writes
+ * to different buckets proceed in parallel. Buckets store their entries inline, in one allocation with the bucket.
+ *
+ * When keys and values are trivially copyable, Find takes no latch: it reads the directory and the bucket
+ * optimistically and validates them against their versions (a seqlock), which writers make odd while they change
+ * them. It falls back to the latches, shared for the bucket, only if validation keeps failing, and always does for
+ * other types. Buckets and replaced directories are therefore only freed with the table, and a split keeps the full
+ * bucket as one of its halves.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -63,6 +77,9 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto GetNumBuckets() const -> int;
 
+  /** Number of optimistic attempts Find makes before it takes the latches. */
+  static constexpr int OPTIMISTIC_FIND_ATTEMPTS = 4;
+
   /**
    *
    * TODO(P1): Add implementation
@@ -110,10 +127,14 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   class Bucket {
    public:
-    explicit Bucket(size_t size, int depth = 0);
+    /** A bucket owned through its Destroy function, which frees it along with its entries. */
+    using Ptr = std::unique_ptr<Bucket, void (*)(Bucket *)>;
+
+    /** @brief Create a bucket of size entries, which are stored inline after it. */
+    static auto Create(size_t size, int depth = 0) -> Ptr;
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return count_.load(std::memory_order_relaxed) == size_; }
 
     /** @brief Get the local depth of the bucket. */
     inline auto GetDepth() const -> int { return depth_; }
@@ -121,7 +142,8 @@ class ExtendibleHashTable : public HashTable<K, V> {
     /** @brief Increment the local depth of a bucket. */
     inline void IncrementDepth() { depth_++; }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    /** @brief The latch guarding the bucket's entries. */
+    inline auto GetLatch() -> ReaderWriterLatch & { return latch_; }
 
     /**
      *
@@ -134,6 +156,15 @@ class ExtendibleHashTable : public HashTable<K, V> {
      */
     auto Find(const K &key, V &value) -> bool;
 
+    /**
+     * @brief Find the value associated with the given key without the latch, for trivially copyable keys and values.
+     * @param key The key to be searched.
+     * @param[out] value The value associated with the key, if found.
+     * @param[out] found Whether the key was found.
+     * @return False if a writer changed the bucket during the search, in which case its result is to be discarded.
+     */
+    auto FindOptimistic(const K &key, V *value, bool *found) const -> bool;
+
     /**
      *
      * TODO(P1): Add implementation
@@ -157,22 +188,72 @@ class ExtendibleHashTable : public HashTable<K, V> {
      */
     auto Insert(const K &key, const V &value) -> bool;
 
+    /**
+     * @brief Move the entries whose hash has the given bit set into the split image of the bucket.
+     * @param image The new bucket that takes the entries.
+     * @param mask The directory bit that tells the two halves of the split apart.
+     */
+    void Split(Bucket *image, size_t mask);
+
    private:
-    // TODO(student): You may add additional private members and helper functions
+    using Entry = std::pair<K, V>;
+
+    Bucket(size_t size, int depth);
+    ~Bucket();
+
+    /** @brief Destroy a bucket created by Create. */
+    static void Destroy(Bucket *bucket);
+
+    /** @return the offset of the entries from the start of a bucket */
+    static constexpr auto EntriesOffset() -> size_t {
+      return (sizeof(Bucket) + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry);
+    }
+
+    /** @return the entries, in no particular order; the first count_ of them are constructed */
+    auto Entries() -> Entry * { return reinterpret_cast<Entry *>(reinterpret_cast<char *>(this) + EntriesOffset()); }
+    auto Entries() const -> const Entry * {
+      return reinterpret_cast<const Entry *>(reinterpret_cast<const char *>(this) + EntriesOffset());
+    }
+
+    /** @brief Make the version odd before modifying the bucket. */
+    void BeginWrite();
+    /** @brief Make the version even again once the bucket is consistent. */
+    void EndWrite();
+
     size_t size_;
     int depth_;
-    std::list<std::pair<K, V>> list_;
+    std::atomic<size_t> count_{0};
+    /** Odd while a writer is modifying the bucket. */
+    std::atomic<uint64_t> version_{0};
+    ReaderWriterLatch latch_;
   };
 
  private:
   // TODO(student): You may add additional private members and helper functions and remove the ones
   // you don't need.
 
+  /** A directory array, which a larger one replaces when the global depth grows. */
+  struct Directory {
+    explicit Directory(size_t size) : size_(size), slots_(new std::atomic<Bucket *>[size]) {}
+
+    size_t size_;
+    std::unique_ptr<std::atomic<Bucket *>[]> slots_;
+  };
+
+  /** Whether Find reads without latches, which is only safe if torn keys and values are harmless to read. */
+  static constexpr bool OPTIMISTIC_FIND = std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>;
+
   int global_depth_;    // The global depth of the directory
   size_t bucket_size_;  // The size of a bucket
   int num_buckets_;     // The number of buckets in the hash table
-  mutable std::mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
+  // Guards the directory and the depths; taken exclusively only to split a bucket
+  mutable ReaderWriterLatch latch_;
+  std::atomic<Directory *> dir_;  // The directory of the hash table
+  // Odd while a split is changing the directory
+  std::atomic<uint64_t> dir_version_{0};
+  // Every directory and bucket of the table, kept until it is destroyed since lock-free readers may be on any of them
+  std::vector<std::unique_ptr<Directory>> directories_;
+  std::vector<typename Bucket::Ptr> buckets_;
 
   // The following functions are completely optional, you can delete them if you have your own ideas.
 
@@ -182,10 +263,20 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
 
+  /** @brief Create a bucket that the table owns. */
+  auto NewBucket(int depth) -> Bucket *;
+
   /*****************************************************************
    * Must acquire latch_ first before calling the below functions. *
    *****************************************************************/
 
+  /**
+   * @brief Split the bucket the given directory index points to, doubling the directory if needed.
+   * Requires latch_ to be held exclusively.
+   * @param directory_index A directory index pointing to the full bucket.
+   */
+  void SplitBucket(size_t directory_index);
+
   /**
    * @brief For the given key, return the entry index in the directory where the key hashes to.
    * @param key The key to be hashed.
@@ -193,6 +284,9 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto IndexOf(const K &key) -> size_t;
 
+  /** @return the bucket the given directory index points to */
+  auto BucketAt(size_t dir_index) const -> Bucket *;
+
   auto GetGlobalDepthInternal() const -> int;
   auto GetLocalDepthInternal(int dir_index) const -> int;
   auto GetNumBucketsInternal() const -> int;
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// open_addressing_hash_table.h
+//
+// Identification: src/include/container/hash/open_addressing_hash_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <type_traits>
+
+#include "container/hash/hash_table.h"
+
+namespace bustub {
+
+/**
+ * OpenAddressingHashTable is a fixed-capacity concurrent hash table built for small, trivially copyable keys and
+ * values such as the buffer pool's page table.
+ *
+ * Slots are grouped into buckets of one cache line each: a version word, an occupancy bitmap and as many key/value
+ * pairs as fit. A key lives in its home bucket or, when that bucket is full, in one of the following buckets (linear
+ * probing at bucket granularity). Removal shifts displaced keys back, so no tombstones build up.
+ *
+ * Lookups never lock. Each bucket is read optimistically and validated against its version (a seqlock), and a miss is
+ * validated against a table-wide version that removals bump whenever they move keys between buckets. Inserts and
+ * removes are serialized by one latch; in the buffer pool they already happen under the instance latch.
+ *
+ * @tparam K key type
+ * @tparam V value type
+ */
+template <typename K, typename V>
+class OpenAddressingHashTable : public HashTable<K, V> {
+  static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+                "keys and values are copied with atomic loads and stores");
+
+ public:
+  /** Size of a bucket, which is also its alignment. */
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+  /** Number of key/value pairs per bucket. */
+  static constexpr size_t SLOTS_PER_BUCKET = (CACHE_LINE_SIZE - 2 * sizeof(uint32_t)) / (sizeof(K) + sizeof(V));
+
+  /**
+   * @brief Create a new OpenAddressingHashTable.
+   * @param capacity the maximum number of entries; the table allocates about twice as many slots
+   */
+  explicit OpenAddressingHashTable(size_t capacity);
+
+  /**
+   * @brief Find the value associated with the given key, without taking any lock.
+   * @param key The key to be searched.
+   * @param[out] value The value associated with the key.
+   * @return True if the key is found, false otherwise.
+   */
+  auto Find(const K &key, V &value) -> bool override;
+
+  /**
+   * @brief Remove the given key, shifting keys that probed past its slot back towards their home bucket.
+   * @param key The key to be deleted.
+   * @return True if the key exists, false otherwise.
+   */
+  auto Remove(const K &key) -> bool override;
+
+  /**
+   * @brief Insert the given key/value pair, overwriting the value if the key exists.
+   * Throws an OUT_OF_MEMORY Exception if the table holds more entries than the capacity it was created with.
+   * @param key The key to be inserted.
+   * @param value The value to be inserted.
+   */
+  void Insert(const K &key, const V &value) override;
+
+  /** @return the number of entries in the table */
+  auto Size() const -> size_t { return size_.load(); }
+
+  /** @return the number of buckets in the table */
+  auto GetNumBuckets() const -> size_t { return num_buckets_; }
+
+ private:
+  static_assert(SLOTS_PER_BUCKET > 0 && SLOTS_PER_BUCKET <= 32, "a bucket's occupancy must fit in 32 bits");
+  static constexpr uint32_t FULL_MASK =
+      SLOTS_PER_BUCKET == 32 ? ~uint32_t{0} : (uint32_t{1} << SLOTS_PER_BUCKET) - 1;
+
+  struct alignas(CACHE_LINE_SIZE) Bucket {
+    /** Odd while a writer is modifying the bucket. */
+    std::atomic<uint32_t> version_{0};
+    /** Bit i is set if slot i holds an entry. */
+    std::atomic<uint32_t> occupied_{0};
+    std::atomic<K> keys_[SLOTS_PER_BUCKET];
+    std::atomic<V> values_[SLOTS_PER_BUCKET];
+  };
+
+  /** @return the home bucket of a key */
+  auto HomeBucket(const K &key) const -> size_t;
+
+  /**
+   * Search one bucket optimistically.
+   * @param[out] value the value of the key, if found
+   * @param[out] full whether the bucket was full, i.e. the search has to continue in the next bucket
+   * @return true if the key was found
+   */
+  auto SearchBucket(const Bucket &bucket, const K &key, V *value, bool *full) const -> bool;
+
+  /** Writers only: find the bucket and slot holding key. */
+  auto Locate(const K &key, size_t *bucket_index, size_t *slot) const -> bool;
+
+  /** Writers only: make a bucket's version odd before modifying it. */
+  static void BeginWrite(Bucket *bucket);
+  /** Writers only: make a bucket's version even again once it is consistent. */
+  static void EndWrite(Bucket *bucket);
+
+  size_t num_buckets_;
+  /** num_buckets_ - 1; the number of buckets is a power of two. */
+  size_t bucket_mask_;
+  /** Maximum number of entries. */
+  size_t capacity_;
+  std::unique_ptr<Bucket[]> buckets_;
+  std::atomic<size_t> size_{0};
+  /** Odd while a removal is moving keys between buckets. */
+  std::atomic<uint64_t> shift_version_{0};
+  /** Serializes writers. */
+  std::mutex write_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.h
+//
+// Identification: src/include/execution/compiled_expression.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression is an expression tree lowered into a flat program, so that evaluating it neither recurses
+ * through the tree nor builds a Value for each of its nodes.
+ *
+ * Each node becomes one instruction, and instruction i writes register i. A register holds an integer of any width
+ * or a boolean as an int64_t, or a decimal as a double, along with whether it is NULL. Columns are read straight
+ * from their offset in the tuple, or from their ColumnVector in a batch. Over a batch the program runs one
+ * instruction at a time across all the selected rows.
+ *
+ * Only column values, constants, comparisons, logic and arithmetic over fixed-size types are compiled; Compile()
+ * returns nullptr for any other expression, which is then evaluated through the tree as before.
+ */
+class CompiledExpression {
+ public:
+  /**
+   * Compile an expression over tuples of a schema.
+   * @return the program, or nullptr if the expression cannot be compiled
+   */
+  static auto Compile(const AbstractExpression &expr, const Schema &schema) -> std::unique_ptr<CompiledExpression>;
+
+  /**
+   * Compile a join predicate over a left tuple of left_schema and a right tuple of right_schema.
+   * @return the program, or nullptr if the expression cannot be compiled
+   */
+  static auto CompileJoin(const AbstractExpression &expr, const Schema &left_schema, const Schema &right_schema)
+      -> std::unique_ptr<CompiledExpression>;
+
+  /** @return the type of the value the program computes */
+  auto GetReturnType() const -> TypeId { return ret_type_; }
+
+  /** @return the value of the expression for a tuple, as AbstractExpression::Evaluate() */
+  auto Evaluate(const Tuple &tuple) -> Value;
+
+  /** @return whether a predicate is true, and so neither false nor NULL, for a tuple */
+  auto EvaluatePredicate(const Tuple &tuple) -> bool;
+
+  /** @return whether a join predicate is true for a pair of tuples, see CompileJoin() */
+  auto EvaluateJoinPredicate(const Tuple &left_tuple, const Tuple &right_tuple) -> bool;
+
+  /** Evaluate the expression over the selected rows of a batch, as AbstractExpression::EvaluateBatch() */
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result);
+
+ private:
+  enum class OpCode : uint8_t {
+    /** Read the column of an instruction, of a type held in a register as int8_t ... int64_t or double */
+    LoadInt8,
+    LoadInt16,
+    LoadInt32,
+    LoadInt64,
+    LoadDecimal,
+    /** Copy the constant of the instruction */
+    Constant,
+    /** Turn the integer in lhs into a decimal */
+    IntToDecimal,
+    /** Compare lhs to rhs, both integers or both decimals */
+    CompareInteger,
+    CompareDecimal,
+    /** Combine the booleans lhs and rhs, NULL being unknown */
+    And,
+    Or,
+    /** Add or subtract INTEGER rhs to lhs, as ArithmeticExpression does */
+    Plus,
+    Minus,
+  };
+
+  struct Register {
+    union {
+      int64_t integer_;
+      double decimal_;
+    };
+    bool is_null_;
+  };
+
+  struct Instruction {
+    OpCode op_;
+    /** The registers of the operands */
+    uint32_t lhs_{0};
+    uint32_t rhs_{0};
+    ComparisonType comparison_{ComparisonType::Equal};
+    /** The column a load reads: the side of a join, the index in its schema, and the offset in its tuples */
+    uint32_t tuple_idx_{0};
+    uint32_t column_idx_{0};
+    uint32_t offset_{0};
+    Register constant_{};
+  };
+
+  /**
+   * Add the instructions computing expr.
+   * @return the register of expr, or std::nullopt if it cannot be compiled
+   */
+  auto Emit(const AbstractExpression &expr) -> std::optional<uint32_t>;
+
+  /** Add an instruction writing a value of type, and return its register */
+  auto Append(Instruction instruction, TypeId type) -> uint32_t;
+
+  /** Run the program for the given tuples, one per side of a join */
+  void RunOnTuples(const Tuple *left_tuple, const Tuple *right_tuple);
+
+  /** Run the program for the selected rows of a batch, register r of row i being registers_[r * rows + i] */
+  void RunOnBatch(const TupleBatch &batch);
+
+  /** Run the instructions other than loads over rows rows, the loads being left to load(instruction, dst) */
+  template <typename LoadColumn>
+  void Run(size_t rows, const LoadColumn &load);
+
+  /** @return the load of a column of type, or std::nullopt if a register cannot hold its values */
+  static auto LoadOf(TypeId type) -> std::optional<OpCode>;
+
+  /** Set a register to a value stored in the format of a tuple, which a load of op reads */
+  static void Load(OpCode op, const char *data, Register *reg);
+
+  /** Set a register to a value of T, NULL being the null value of its type */
+  template <typename T>
+  static void SetRegister(T value, Register *reg);
+
+  /** @return the value of a register as T, NULL being the null value of its type */
+  template <typename T>
+  static auto GetRegister(const Register &reg) -> T;
+
+  /** Compare the values get() takes from lhs and rhs for rows rows */
+  template <typename Get>
+  static void Compare(ComparisonType comparison, size_t rows, const Register *lhs, const Register *rhs,
+                      Register *dst, Get get);
+
+  /** The schemas of the tuples of each side, a single one unless the program is for a join */
+  std::vector<const Schema *> schemas_;
+  std::vector<Instruction> program_;
+  /** The type of the value of each register */
+  std::vector<TypeId> types_;
+  TypeId ret_type_{TypeId::INVALID};
+  std::vector<Register> registers_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange.h
+//
+// Identification: src/include/execution/exchange.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/parallel_pipeline.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * BoundedQueue hands items from producer threads to a consumer. It holds at most capacity items, and a producer
+ * waits while it is full, so that producers cannot run further ahead of a slow consumer.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @param capacity the most items the queue holds
+   * @param producer_count the number of producers, each of which calls Close() once done
+   */
+  BoundedQueue(size_t capacity, size_t producer_count) : capacity_(capacity), open_producers_(producer_count) {}
+
+  /**
+   * Add an item, waiting while the queue is full.
+   * @return false if the queue is cancelled, in which case the item is dropped
+   */
+  auto Push(T item) -> bool {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_full_.wait(lock, [&] { return items_.size() < capacity_ || cancelled_; });
+    if (cancelled_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * Take the next item, waiting while the queue is empty and a producer is not done.
+   * @return false once every producer is done and the queue is empty, or once the queue is cancelled
+   */
+  auto Pop(T *item) -> bool {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_empty_.wait(lock, [&] { return !items_.empty() || open_producers_ == 0 || cancelled_; });
+    if (cancelled_ || items_.empty()) {
+      return false;
+    }
+    *item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /** Mark a producer done */
+  void Close() {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (--open_producers_ == 0) {
+      not_empty_.notify_all();
+    }
+  }
+
+  /** Drop the items of the queue and those pushed from now on, and wake everyone waiting on it */
+  void Cancel() {
+    std::scoped_lock<std::mutex> lock(latch_);
+    cancelled_ = true;
+    items_.clear();
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  auto IsCancelled() -> bool {
+    std::scoped_lock<std::mutex> lock(latch_);
+    return cancelled_;
+  }
+
+ private:
+  std::mutex latch_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<T> items_;
+  size_t capacity_;
+  size_t open_producers_;
+  bool cancelled_{false};
+};
+
+class ExchangeRegistry;
+
+/**
+ * Exchange runs the producers of an exchange plan node on threads of their own, and hands the batches they produce
+ * to its consumers through a BoundedQueue for each.
+ *
+ * The producers of a pipeline take morsels of its scan in turn. Those of a gather exchange over any other fragment
+ * each run a copy of it, and those copies share the repartition and broadcast exchanges inside the fragment through
+ * an ExchangeRegistry.
+ */
+class Exchange {
+ public:
+  /**
+   * Start the producers of an exchange.
+   * @param exec_ctx the context of the consumers
+   * @param plan the exchange plan
+   * @param consumer_count the number of consumers, 1 for a gather exchange
+   */
+  Exchange(ExecutorContext *exec_ctx, const ExchangePlanNode *plan, size_t consumer_count);
+
+  /** Cancel the exchange, and wait for its producers to stop */
+  ~Exchange();
+
+  DISALLOW_COPY_AND_MOVE(Exchange);
+
+  /**
+   * Take the next batch of a consumer, waiting for the producers. Rethrows the exception of a producer that failed.
+   * @return false once the producers are done and the consumer has read every batch
+   */
+  auto Pop(size_t consumer, TupleBatch *batch) -> bool;
+
+  /** Stop the producers, along with the exchanges inside the fragment they run */
+  void Cancel();
+
+  /** Drop the batches of a consumer that is done, so that the producers do not wait for it */
+  void Release(size_t consumer);
+
+ private:
+  /** Body of the thread of a producer */
+  void Produce(size_t producer);
+
+  /**
+   * Hand a batch of a producer to the consumers, which may move it out.
+   * @return false if no consumer is left
+   */
+  auto Route(size_t producer, TupleBatch *batch) -> bool;
+
+  /** Hand the partitions a repartitioning producer is filling to their consumers */
+  void Flush(size_t producer);
+
+  const ExchangePlanNode *plan_;
+  /** The pipeline the producers run over morsels, nullptr if the child is not a pipeline */
+  std::unique_ptr<ParallelPipeline> pipeline_;
+  std::atomic<size_t> next_morsel_{0};
+  /** The context and executors of each producer, if the child is not a pipeline */
+  std::vector<std::unique_ptr<ExecutorContext>> contexts_;
+  std::vector<std::unique_ptr<AbstractExecutor>> fragments_;
+  /** The exchanges the copies of the fragment share, for a gather exchange over a fragment that is not a pipeline */
+  std::unique_ptr<ExchangeRegistry> exchanges_;
+  /** The batches waiting for each consumer */
+  std::vector<std::unique_ptr<BoundedQueue<TupleBatch>>> queues_;
+  /** The batch each repartitioning producer is filling for each consumer, and its partition keys */
+  std::vector<std::vector<TupleBatch>> partitions_;
+  std::vector<std::vector<ColumnVector>> partition_keys_;
+  /** The first exception of a producer */
+  std::mutex error_latch_;
+  std::exception_ptr error_;
+  std::vector<std::thread> producers_;
+};
+
+/**
+ * ExchangeRegistry holds the repartition and broadcast exchanges that the copies of a fragment under a gather
+ * exchange share. Each copy is one of their consumers.
+ */
+class ExchangeRegistry {
+ public:
+  /** @return the exchange of plan, started by the first copy of the fragment that opens it */
+  auto Open(ExecutorContext *exec_ctx, const ExchangePlanNode *plan) -> Exchange *;
+
+  /** Release the batches of a copy of the fragment that is done, in the exchanges it opened and those it did not */
+  void Release(size_t fragment);
+
+  /** Cancel the exchanges, and those opened from now on */
+  void Cancel();
+
+ private:
+  std::mutex latch_;
+  std::unordered_map<const ExchangePlanNode *, std::unique_ptr<Exchange>> exchanges_;
+  std::unordered_set<size_t> released_;
+  bool cancelled_{false};
+};
+
+}  // namespace bustub
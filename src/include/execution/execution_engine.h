@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -20,7 +21,9 @@
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
+#include "execution/parallel_pipeline.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -61,8 +64,12 @@ class ExecutionEngine {
     auto executor_succeeded = true;
 
     try {
-      executor->Init();
-      PollExecutor(executor.get(), plan, result_set);
+      if (ParallelPipeline::CanRun(exec_ctx, *plan)) {
+        RunPipeline(exec_ctx, plan, result_set);
+      } else {
+        executor->Init();
+        PollExecutor(executor.get(), plan, result_set);
+      }
     } catch (const ExecutionException &ex) {
 #ifndef NDEBUG
       LOG_ERROR("Error Encountered in Executor Execution: %s", ex.what());
@@ -85,11 +92,36 @@ class ExecutionEngine {
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
                            std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      if (result_set != nullptr) {
+        for (const auto row : batch.GetSelection()) {
+          result_set->push_back(batch.GetTuple(row));
+        }
+      }
+    }
+  }
+
+  /**
+   * Run a plan that is a pipeline across the workers of the query.
+   * @param exec_ctx The executor context of the query
+   * @param plan The plan to execute
+   * @param result_set The tuple result set, in the order of a serial run
+   */
+  static void RunPipeline(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, std::vector<Tuple> *result_set) {
+    ParallelPipeline pipeline(exec_ctx, plan);
+    std::vector<std::vector<Tuple>> morsel_results(pipeline.GetMorselCount());
+    pipeline.Run([&](size_t /*worker*/, size_t morsel, TupleBatch *batch) {
       if (result_set != nullptr) {
-        result_set->push_back(tuple);
+        for (const auto row : batch->GetSelection()) {
+          morsel_results[morsel].push_back(batch->GetTuple(row));
+        }
+      }
+    });
+    if (result_set != nullptr) {
+      for (auto &tuples : morsel_results) {
+        result_set->insert(result_set->end(), std::make_move_iterator(tuples.begin()),
+                           std::make_move_iterator(tuples.end()));
       }
     }
   }
@@ -12,15 +12,21 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/morsel.h"
+#include "execution/work_stealing_pool.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
+
+class ExchangeRegistry;
+
 /**
  * ExecutorContext stores all the context necessary to run an executor.
  */
@@ -33,10 +39,17 @@ class ExecutorContext {
    * @param bpm The buffer pool manager that the executor uses
    * @param txn_mgr The transaction manager that the executor uses
    * @param lock_mgr The lock manager that the executor uses
+   * @param workers The threads that run the pipelines of the query in parallel, nullptr to run it on the caller. The
+   * context keeps them running until the query is done, whatever happens to the pool of the instance meanwhile.
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
-                  LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+                  LockManager *lock_mgr, std::shared_ptr<WorkStealingPool> workers = nullptr)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        workers_(std::move(workers)) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +73,31 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the threads that run pipelines in parallel, nullptr if the query runs on the calling thread */
+  auto GetWorkers() -> WorkStealingPool * { return workers_.get(); }
+
+  /** @return the morsel the table scan reads, nullptr to scan the whole table */
+  auto GetMorsel() const -> const Morsel * { return morsel_; }
+
+  /** Restrict the table scan of a worker of a parallel pipeline to a morsel */
+  void SetMorsel(const Morsel *morsel) { morsel_ = morsel; }
+
+  /** @return which copy of the fragment under a gather exchange the executors run, 0 outside of one */
+  auto GetFragment() const -> size_t { return fragment_; }
+
+  /** @return the number of copies of the fragment under a gather exchange, 1 outside of one */
+  auto GetFragmentCount() const -> size_t { return fragment_count_; }
+
+  /** @return the exchanges the copies of the fragment share, nullptr outside of a gather exchange */
+  auto GetExchanges() -> ExchangeRegistry * { return exchanges_; }
+
+  /** Make the executors run one copy of the fragment under a gather exchange */
+  void SetFragment(size_t fragment, size_t fragment_count, ExchangeRegistry *exchanges) {
+    fragment_ = fragment;
+    fragment_count_ = fragment_count;
+    exchanges_ = exchanges;
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +109,14 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The worker threads of the query, if it runs in parallel */
+  std::shared_ptr<WorkStealingPool> workers_;
+  /** The morsel the scan reads, in the context of a worker of a parallel pipeline */
+  const Morsel *morsel_{nullptr};
+  /** The copy of the fragment the executors run, see SetFragment() */
+  size_t fragment_{0};
+  size_t fragment_count_{1};
+  ExchangeRegistry *exchanges_{nullptr};
 };
 
 }  // namespace bustub
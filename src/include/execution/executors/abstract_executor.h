@@ -13,6 +13,7 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +21,9 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors may also yield a batch of tuples at a time with NextBatch(). Either call drives any executor: one that
+ * only implements Next() fills batches from it, and one that produces batches implements Next() with NextFromBatch().
  */
 class AbstractExecutor {
  public:
@@ -46,6 +50,21 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor. Do not mix with Next() between two calls of Init().
+   * @param[out] batch The next up to TUPLE_BATCH_SIZE tuples, laid out as GetOutputSchema()
+   * @return `true` if the batch holds a tuple, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->Size() > 0;
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
@@ -53,7 +72,34 @@ class AbstractExecutor {
   auto GetExecutorContext() -> ExecutorContext * { return exec_ctx_; }
 
  protected:
+  /** Next() of an executor that produces batches: yield the tuples of NextBatch() one at a time */
+  auto NextFromBatch(Tuple *tuple, RID *rid) -> bool {
+    while (output_cursor_ == output_batch_.Size()) {
+      output_cursor_ = 0;
+      if (!NextBatch(&output_batch_)) {
+        output_batch_.Reset(&GetOutputSchema());
+        return false;
+      }
+    }
+    const auto row = output_batch_.GetSelection()[output_cursor_++];
+    *tuple = output_batch_.GetTuple(row);
+    *rid = output_batch_.GetRid(row);
+    return true;
+  }
+
+  /** Drop the tuples NextFromBatch() has yet to yield, on Init() */
+  void ResetOutputBatch() {
+    output_batch_.Reset(&GetOutputSchema());
+    output_cursor_ = 0;
+  }
+
   /** The executor context in which the executor runs */
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The batch NextFromBatch() yields from */
+  TupleBatch output_batch_;
+  /** The position in the selection of output_batch_ */
+  size_t output_cursor_{0};
 };
 }  // namespace bustub
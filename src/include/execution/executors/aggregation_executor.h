@@ -64,20 +64,41 @@ class SimpleAggregationHashTable {
   }
 
   /**
-   * TODO(Student)
-   *
    * Combines the input into the aggregation result.
    * @param[out] result The output aggregate value
    * @param input The input value
    */
   void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
     for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      Value &aggregate = result->aggregates_[i];
+      const Value &value = input.aggregates_[i];
+      if (agg_types_[i] == AggregationType::CountStarAggregate) {
+        aggregate = aggregate.Add(ValueFactory::GetIntegerValue(1));
+        continue;
+      }
+      // The other aggregates skip NULL values, and are NULL until they see a value
+      if (value.IsNull()) {
+        continue;
+      }
       switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
         case AggregationType::CountAggregate:
+          aggregate = aggregate.IsNull() ? ValueFactory::GetIntegerValue(1)
+                                         : aggregate.Add(ValueFactory::GetIntegerValue(1));
+          break;
         case AggregationType::SumAggregate:
+          aggregate = aggregate.IsNull() ? value : aggregate.Add(value);
+          break;
         case AggregationType::MinAggregate:
+          if (aggregate.IsNull() || value.CompareLessThan(aggregate) == CmpBool::CmpTrue) {
+            aggregate = value;
+          }
+          break;
         case AggregationType::MaxAggregate:
+          if (aggregate.IsNull() || value.CompareGreaterThan(aggregate) == CmpBool::CmpTrue) {
+            aggregate = value;
+          }
+          break;
+        case AggregationType::CountStarAggregate:
           break;
       }
     }
@@ -89,12 +110,65 @@ class SimpleAggregationHashTable {
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+    auto it = ht_.find(agg_key);
+    if (it == ht_.end()) {
+      it = ht_.insert({agg_key, GenerateInitialAggregateValue()}).first;
     }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
+    CombineAggregateValues(&it->second, agg_val);
   }
 
+  /**
+   * Merges a partial aggregation result, that of another hash table over part of the input, into the result.
+   * @param[out] result The output aggregate value
+   * @param partial The partial result
+   */
+  void MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) {
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      Value &aggregate = result->aggregates_[i];
+      const Value &value = partial.aggregates_[i];
+      // A NULL partial result saw no value
+      if (value.IsNull()) {
+        continue;
+      }
+      switch (agg_types_[i]) {
+        case AggregationType::CountStarAggregate:
+        case AggregationType::CountAggregate:
+        case AggregationType::SumAggregate:
+          aggregate = aggregate.IsNull() ? value : aggregate.Add(value);
+          break;
+        case AggregationType::MinAggregate:
+          if (aggregate.IsNull() || value.CompareLessThan(aggregate) == CmpBool::CmpTrue) {
+            aggregate = value;
+          }
+          break;
+        case AggregationType::MaxAggregate:
+          if (aggregate.IsNull() || value.CompareGreaterThan(aggregate) == CmpBool::CmpTrue) {
+            aggregate = value;
+          }
+          break;
+      }
+    }
+  }
+
+  /**
+   * Inserts a partial aggregation result into the hash table and then merges it with the current aggregation.
+   * @param agg_key the key to be inserted
+   * @param partial the partial result to be merged
+   */
+  void InsertMerge(const AggregateKey &agg_key, const AggregateValue &partial) {
+    auto it = ht_.find(agg_key);
+    if (it == ht_.end()) {
+      it = ht_.insert({agg_key, GenerateInitialAggregateValue()}).first;
+    }
+    MergeAggregateValues(&it->second, partial);
+  }
+
+  /**
+   * Inserts the initial aggregate values under a key, the result of aggregating no tuples.
+   * @param agg_key the key to be inserted
+   */
+  void InsertInitial(const AggregateKey &agg_key) { ht_.insert({agg_key, GenerateInitialAggregateValue()}); }
+
   /**
    * Clear the hash table
    */
@@ -170,6 +244,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The next groups of the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -177,20 +258,39 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
-  /** @return The tuple as an AggregateKey */
-  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
+  /** The hash table and the expressions over the last batch of a worker of a parallel aggregation */
+  struct PartialAggregation {
+    explicit PartialAggregation(const AggregationPlanNode *plan)
+        : aht_(plan->GetAggregates(), plan->GetAggregateTypes()) {}
+
+    SimpleAggregationHashTable aht_;
+    std::vector<ColumnVector> group_by_columns_;
+    std::vector<ColumnVector> aggregate_columns_;
+  };
+
+  /** Aggregate the selected rows of a batch into a hash table, evaluating the expressions into the given columns */
+  void AggregateBatch(const TupleBatch &batch, SimpleAggregationHashTable *aht,
+                      std::vector<ColumnVector> *group_by_columns, std::vector<ColumnVector> *aggregate_columns);
+
+  /** Aggregate the child pipeline across the workers of the query, each into its own table, and merge the tables */
+  void AggregateInParallel();
+
+  /** @return A row of the group by expressions over a batch as an AggregateKey */
+  static auto MakeAggregateKey(const std::vector<ColumnVector> &group_by_columns, size_t row) -> AggregateKey {
     std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+    keys.reserve(group_by_columns.size());
+    for (const auto &column : group_by_columns) {
+      keys.emplace_back(column.GetValue(row));
     }
     return {keys};
   }
 
-  /** @return The tuple as an AggregateValue */
-  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
+  /** @return A row of the aggregate expressions over a batch as an AggregateValue */
+  static auto MakeAggregateValue(const std::vector<ColumnVector> &aggregate_columns, size_t row) -> AggregateValue {
     std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+    vals.reserve(aggregate_columns.size());
+    for (const auto &column : aggregate_columns) {
+      vals.emplace_back(column.GetValue(row));
     }
     return {vals};
   }
@@ -201,8 +301,14 @@ class AggregationExecutor : public AbstractExecutor {
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
   /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
+  SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The last batch of the child */
+  TupleBatch child_batch_;
+  /** The group by expressions over the last batch of the child */
+  std::vector<ColumnVector> group_by_columns_;
+  /** The aggregate expressions over the last batch of the child */
+  std::vector<ColumnVector> aggregate_columns_;
 };
 }  // namespace bustub
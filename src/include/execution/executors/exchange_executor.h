@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.h
+//
+// Identification: src/include/execution/executors/exchange_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+
+#include "execution/exchange.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/exchange_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * The ExchangeExecutor executor reads the output of an exchange: all of it for a gather exchange, and the share of the
+ * copy of the fragment it runs in for a repartition or broadcast exchange.
+ */
+class ExchangeExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new ExchangeExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The exchange plan to be executed
+   */
+  ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan);
+
+  /** Start the producers of the exchange, or join those the other copies of the fragment started */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the exchange.
+   * @param[out] tuple The next tuple produced by the exchange
+   * @param[out] rid The next tuple RID produced by the exchange
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /**
+   * Yield the next batch of tuples from the exchange, as a producer made it.
+   * @param[out] batch The next batch of the consumer
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return The output schema for the exchange */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+ private:
+  /** The exchange plan node to be executed */
+  const ExchangePlanNode *plan_;
+
+  /** The exchange this executor started, nullptr if another copy of the fragment may have */
+  std::unique_ptr<Exchange> own_exchange_;
+  /** The exchange the executor reads, and the consumer it reads as */
+  Exchange *exchange_{nullptr};
+  size_t consumer_{0};
+};
+}  // namespace bustub
@@ -15,7 +15,9 @@
 #include <memory>
 #include <vector>
 
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
+#include "execution/filter_kernels.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -48,6 +50,13 @@ class FilterExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the filter.
+   * @param[out] batch The next tuples of the child that satisfy the predicate
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the filter plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -57,5 +66,11 @@ class FilterExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The predicate compiled over the tuples of the child, nullptr if it cannot be compiled */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The predicate as filter kernels over batches, nullptr if the kernels do not handle it */
+  std::unique_ptr<KernelPredicate> kernel_predicate_;
+  /** The predicate over the last batch */
+  ColumnVector predicate_;
 };
 }  // namespace bustub
@@ -13,8 +13,11 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/hash_join_plan.h"
@@ -22,8 +25,36 @@
 
 namespace bustub {
 
+/** HashJoinKey is the join key of a tuple */
+struct HashJoinKey {
+  /** The value of the join key expression */
+  Value value_;
+
+  /** @return `true` if both keys join, NULL joins no key */
+  auto operator==(const HashJoinKey &other) const -> bool {
+    return value_.CompareEquals(other.value_) == CmpBool::CmpTrue;
+  }
+};
+
+}  // namespace bustub
+
+namespace std {
+
+/** Implements std::hash on HashJoinKey */
+template <>
+struct hash<bustub::HashJoinKey> {
+  auto operator()(const bustub::HashJoinKey &key) const -> std::size_t {
+    return key.value_.IsNull() ? 0 : bustub::HashUtil::HashValue(&key.value_);
+  }
+};
+
+}  // namespace std
+
+namespace bustub {
+
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes an equi-JOIN on two tables: it builds a hash table over the right child, then probes it
+ * with the tuples of the left child, a batch at a time.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -48,12 +79,56 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The next joined tuples, the left columns then the right ones
+   * @return `true` if a tuple was produced, `false` if there are no more tuples.
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** A row of the right child: its batch in right_batches_, and its position in the batch */
+  using RightRow = std::pair<size_t, size_t>;
+
+  using HashTable = std::unordered_map<HashJoinKey, std::vector<RightRow>>;
+
+  /** Build the hash table from the right child pipeline across the workers of the query */
+  void BuildInParallel();
+
+  /** @return the partition of the hash table that holds a key */
+  auto PartitionOf(const HashJoinKey &key) -> HashTable & {
+    return hash_tables_.size() == 1 ? hash_tables_[0]
+                                    : hash_tables_[std::hash<HashJoinKey>{}(key) % hash_tables_.size()];
+  }
+
+  /** Add to batch the join of a row of left_batch_ with a right row, or with NULLs if right_row is nullptr */
+  void AppendJoinedRow(TupleBatch *batch, size_t left_row, const RightRow *right_row);
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The child executors of the left and right side */
+  std::unique_ptr<AbstractExecutor> left_child_;
+  std::unique_ptr<AbstractExecutor> right_child_;
+
+  /** The batches of the right child */
+  std::vector<TupleBatch> right_batches_;
+  /**
+   * The rows of the right child by join key; those with a NULL key join nothing and are left out. A parallel build
+   * splits the table into a partition per worker by the hash of the key.
+   */
+  std::vector<HashTable> hash_tables_;
+
+  /** The batch of the left child being probed, and its join keys */
+  TupleBatch left_batch_;
+  ColumnVector left_keys_;
+  /** The position in the selection of left_batch_ of the row being probed */
+  size_t probe_cursor_{0};
+  /** The right rows the probed row joins, nullptr until it is looked up, and how many were joined so far */
+  const std::vector<RightRow> *matches_{nullptr};
+  size_t match_cursor_{0};
 };
 
 }  // namespace bustub
@@ -12,18 +12,22 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table. It takes the record ids of the entries in range a leaf at a
+ * time off the index, and fetches their tuples from the table; an index-only scan takes the entries themselves, and
+ * builds the tuples out of the columns they store.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +46,21 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Next() for an index-only scan. */
+  auto NextFromIndex(Tuple *tuple, RID *rid) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  const IndexInfo *index_info_{nullptr};
+  const TableInfo *table_info_{nullptr};
+  BPlusTreeIndexForFixedSizeKeys *tree_{nullptr};
+  BPlusTreeIndexIteratorForFixedSizeKeys iterator_;
+  /** The record ids of the last batch taken off the index, and the next one to fetch. */
+  std::vector<RID> rids_;
+  /** The last batch of an index-only scan. */
+  std::vector<std::pair<IndexKeyType, RID>> entries_;
+  size_t cursor_{0};
+  /** The columns of the current entry of an index-only scan. */
+  std::vector<Value> entry_values_;
 };
 }  // namespace bustub
@@ -14,7 +14,9 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/insert_plan.h"
@@ -57,6 +59,14 @@ class InsertExecutor : public AbstractExecutor {
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** The child executor from which inserted tuples are pulled */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The table being inserted into */
+  const TableInfo *table_info_{nullptr};
+  /** The indexes of the table */
+  std::vector<IndexInfo *> index_infos_;
+  /** Whether the count of inserted rows has been produced */
+  bool done_{false};
 };
 
 }  // namespace bustub
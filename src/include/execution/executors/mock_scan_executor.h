@@ -25,6 +25,7 @@ namespace bustub {
 
 extern const char *mock_table_list[];
 auto GetMockTableSchemaOf(const std::string &table) -> Schema;
+auto GetMockTableSizeOf(const MockScanPlanNode *plan) -> size_t;
 
 /**
  * The MockScanExecutor executor executes a sequential table scan for tests.
@@ -77,6 +78,9 @@ class MockScanExecutor : public AbstractExecutor {
   /** The size of the mock table */
   std::size_t size_;
 
+  /** The cursor the scan stops at, size_ unless a worker of a parallel scan runs it */
+  std::size_t end_{0};
+
   /** The shuffled output */
   std::vector<size_t> shuffled_idx_;
 };
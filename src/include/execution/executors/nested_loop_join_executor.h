@@ -14,7 +14,9 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/nested_loop_join_plan.h"
@@ -53,8 +55,24 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
+  /** @return whether the left tuple and a right tuple satisfy the join predicate */
+  auto MatchesPredicate(const Tuple &right_tuple) -> bool;
+
+  /** @return the join of the left tuple with a right tuple, or with NULLs if right_tuple is nullptr */
+  auto JoinTuples(const Tuple *right_tuple) const -> Tuple;
+
   /** The NestedLoopJoin plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
+  /** The child executors of the left and right side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The join predicate compiled over the tuples of both sides, nullptr if it cannot be compiled */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The left tuple the right side is scanned for */
+  Tuple left_tuple_;
+  /** Whether left_tuple_ holds a tuple, and whether it joined a right tuple yet */
+  bool has_left_tuple_{false};
+  bool left_joined_{false};
 };
 
 }  // namespace bustub
@@ -12,11 +12,17 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "catalog/catalog.h"
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
+#include "execution/filter_kernels.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -44,11 +50,38 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The next tuples of the scan that satisfy the filter predicate
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** @return whether the scan, or the morsel it is on, has tuples left */
+  auto HasNext(const TableIterator &end) -> bool;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  const TableInfo *table_info_{nullptr};
+  /** The private buffer ring of the scan, nullptr for small tables */
+  std::unique_ptr<BufferRing> ring_;
+  /** The position of the scan */
+  std::unique_ptr<TableIterator> iterator_;
+  /** The chain position the scan stops at, the end of the morsel when a worker of a parallel scan runs it */
+  size_t stop_position_{SIZE_MAX};
+  /** The last page the scan looked up the chain position of, and whether that position is before stop_position_ */
+  page_id_t position_page_id_{INVALID_PAGE_ID};
+  bool page_in_range_{true};
+  /** The filter predicate compiled over the tuples of the table, nullptr if there is none or it cannot be compiled */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The filter predicate as filter kernels over batches, nullptr if there is none or the kernels do not handle it */
+  std::unique_ptr<KernelPredicate> kernel_predicate_;
+  /** The filter predicate over the last batch */
+  ColumnVector predicate_;
 };
 }  // namespace bustub
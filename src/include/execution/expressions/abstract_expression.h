@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -65,6 +66,21 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression over the selected rows of a batch. The expressions that do not override it evaluate
+   * one tuple at a time.
+   * @param batch the input rows, laid out as the schema Evaluate() would be given
+   * @param[out] result the value for each row of the batch, of the return type; those of the rows not selected are
+   * undefined
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const {
+    result->Reset(GetReturnType(), batch.GetRowCount());
+    for (const auto row : batch.GetSelection()) {
+      const Tuple tuple = batch.GetTuple(row);
+      result->SetValue(row, Evaluate(&tuple, batch.GetSchema()));
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -65,6 +65,22 @@ class ArithmeticExpression : public AbstractExpression {
     return ValueFactory::GetIntegerValue(*res);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->Reset(GetReturnType(), batch.GetRowCount());
+    for (const auto row : batch.GetSelection()) {
+      auto res = PerformComputation(lhs.GetValue(row), rhs.GetValue(row));
+      if (res == std::nullopt) {
+        result->SetNull(row);
+      } else {
+        result->SetValue(row, ValueFactory::GetIntegerValue(*res));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), compute_type_, *GetChildAt(1));
@@ -34,6 +34,13 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    result->Reset(GetReturnType(), batch.GetRowCount());
+    for (const auto row : batch.GetSelection()) {
+      result->SetValue(row, val_);
+    }
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
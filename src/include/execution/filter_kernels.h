@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels.h
+//
+// Identification: src/include/execution/filter_kernels.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/** The instruction sets the filter kernels are built for, from the slowest */
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+/** @return the fastest level the CPU supports */
+auto BestSimdLevel() -> SimdLevel;
+
+/** @return the number of words of a bitmask of rows rows, row i being bit i % 64 of word i / 64 */
+inline auto MaskWords(size_t rows) -> size_t { return (rows + 63) / 64; }
+
+/**
+ * Compare rows values of a column to rhs, either another column or, if rhs_is_constant, a single value. The bits of
+ * the rows for which the comparison is true are set in is_true, and those for which it is false in is_false; a row
+ * with a NULL, the null value of T, is in neither. Each mask has MaskWords(rows) words.
+ *
+ * T is int32_t, int64_t or double.
+ */
+template <typename T>
+void CompareValues(ComparisonType comparison, const T *lhs, const T *rhs, bool rhs_is_constant, size_t rows,
+                   uint64_t *is_true, uint64_t *is_false, SimdLevel level = BestSimdLevel());
+
+/**
+ * KernelPredicate evaluates a predicate over a batch with the filter kernels: each comparison of an INTEGER, BIGINT
+ * or DECIMAL column to a constant or to another column of its type becomes a pair of bitmasks, which AND and OR then
+ * combine word by word, NULL being neither true nor false.
+ *
+ * Compile() returns nullptr for predicates of any other shape, which are then evaluated as before.
+ */
+class KernelPredicate {
+ public:
+  /**
+   * Compile a predicate over batches of a schema.
+   * @return the predicate, or nullptr if it is not made only of comparisons the kernels handle, AND and OR
+   */
+  static auto Compile(const AbstractExpression &expr, const Schema &schema) -> std::unique_ptr<KernelPredicate>;
+
+  /** Keep the selected rows of a batch for which the predicate is true */
+  void Select(TupleBatch *batch);
+
+ private:
+  enum class NodeType { Compare, And, Or };
+
+  /** A node of the predicate, whose result is the is_true and is_false masks of its index */
+  struct Node {
+    NodeType type_{NodeType::Compare};
+    ComparisonType comparison_{ComparisonType::Equal};
+    /** The type of the columns compared, and the columns, rhs_column_ being unset for a constant */
+    TypeId column_type_{TypeId::INVALID};
+    uint32_t lhs_column_{0};
+    std::optional<uint32_t> rhs_column_;
+    /** The constant compared to, as the type of the column */
+    int32_t integer_{0};
+    int64_t bigint_{0};
+    double decimal_{0};
+    /** The operands of AND and OR */
+    uint32_t lhs_{0};
+    uint32_t rhs_{0};
+  };
+
+  /** Add the nodes of expr, and return its own */
+  auto Emit(const AbstractExpression &expr, const Schema &schema) -> std::optional<uint32_t>;
+
+  /** Set the masks of a comparison over rows rows */
+  void EvaluateComparison(const Node &node, const TupleBatch &batch, size_t rows, uint64_t *is_true,
+                          uint64_t *is_false) const;
+
+  /** The nodes, each after its operands */
+  std::vector<Node> nodes_;
+  /** The masks of node i, MaskWords() words each starting at i * words */
+  std::vector<uint64_t> is_true_;
+  std::vector<uint64_t> is_false_;
+  SimdLevel level_{BestSimdLevel()};
+};
+
+}  // namespace bustub
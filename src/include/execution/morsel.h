@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel.h
+//
+// Identification: src/include/execution/morsel.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A morsel is the piece of a table scan that a worker runs at a time: the pages at positions [begin_, end_) in the
+ * chain of a table heap, starting with first_page_id_, or the rows [begin_, end_) of a mock table.
+ *
+ * A table morsel is bounded by chain positions rather than by the first page of the next morsel, as a scan skips the
+ * pages that have no live tuple and would not stop on such a page.
+ */
+struct Morsel {
+  /** The page at chain position begin_, INVALID_PAGE_ID for a mock table */
+  page_id_t first_page_id_{INVALID_PAGE_ID};
+  size_t begin_{0};
+  /** The end of the range, SIZE_MAX for the last morsel of a table heap, which takes the pages appended since */
+  size_t end_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_pipeline.h
+//
+// Identification: src/include/execution/parallel_pipeline.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/morsel.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * ParallelPipeline runs a pipeline, a sequential or mock scan under any number of filters and projections, across
+ * the workers of a query.
+ *
+ * The scan is split into morsels of MORSEL_PAGES pages of a table heap or MORSEL_ROWS rows of a mock table, which are
+ * the tasks of the work-stealing pool. Each worker runs its own executors for the pipeline over the morsels it takes,
+ * and hands the batches they produce to the operator above, which keeps per-worker state and merges it once the
+ * pipeline is done.
+ */
+class ParallelPipeline {
+ public:
+  /** @return whether the query of exec_ctx has workers, and plan is a pipeline they can run */
+  static auto CanRun(ExecutorContext *exec_ctx, const AbstractPlanNode &plan) -> bool;
+
+  /** @return whether plan is a scan under any number of filters and projections */
+  static auto IsPipeline(const AbstractPlanNode &plan) -> bool;
+
+  /**
+   * Split a pipeline into morsels, and create the executors of each worker.
+   * @param exec_ctx the context of the query, see CanRun()
+   * @param plan the plan of the pipeline
+   */
+  ParallelPipeline(ExecutorContext *exec_ctx, AbstractPlanNodeRef plan);
+
+  /**
+   * Split a pipeline into morsels, and create the executors of worker_count workers that the caller runs, see
+   * RunMorsel().
+   */
+  ParallelPipeline(ExecutorContext *exec_ctx, AbstractPlanNodeRef plan, size_t worker_count);
+
+  /** @return the number of workers running the pipeline */
+  auto GetWorkerCount() const -> size_t { return executors_.size(); }
+
+  /** @return the number of morsels of the scan */
+  auto GetMorselCount() const -> size_t { return morsels_.size(); }
+
+  /**
+   * Run the pipeline. Each batch it produces for a morsel is passed to consume(worker, morsel, batch) on the worker
+   * that runs the morsel, in the order the pipeline produces them; consume may move the batch out.
+   */
+  void Run(const std::function<void(size_t worker, size_t morsel, TupleBatch *batch)> &consume);
+
+  /** Run the pipeline over one morsel on the executors of a worker, see Run() */
+  void RunMorsel(size_t worker, size_t morsel,
+                 const std::function<void(size_t worker, size_t morsel, TupleBatch *batch)> &consume);
+
+ private:
+  /** Split the table the pipeline scans into morsels */
+  void SplitIntoMorsels();
+
+  ExecutorContext *exec_ctx_;
+  AbstractPlanNodeRef plan_;
+  std::vector<Morsel> morsels_;
+  /** The context, executors and batch of each worker, a context pointing its scan at the morsel of the worker */
+  std::vector<std::unique_ptr<ExecutorContext>> contexts_;
+  std::vector<std::unique_ptr<AbstractExecutor>> executors_;
+  std::vector<TupleBatch> batches_;
+};
+
+}  // namespace bustub
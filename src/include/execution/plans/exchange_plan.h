@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_plan.h
+//
+// Identification: src/include/execution/plans/exchange_plan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** ExchangeType is how an exchange hands the tuples of its producers to its consumers */
+enum class ExchangeType {
+  /** Merge the output of the copies of a fragment into a single stream */
+  Gather,
+  /** Send each tuple to the copy of the fragment above whose number is the hash of its partition keys */
+  Repartition,
+  /** Send every tuple to each copy of the fragment above */
+  Broadcast,
+};
+
+/**
+ * The ExchangePlanNode moves tuples between threads, and marks where a plan is cut into fragments that run in
+ * parallel.
+ *
+ * A gather exchange runs parallelism copies of the fragment under it, each on a thread of its own, and yields the
+ * tuples of all of them. When the fragment is a pipeline (a scan under filters and projections) the copies split the
+ * scan into morsels. Otherwise each copy runs the whole fragment, so every scan of the fragment must be under a
+ * repartition or broadcast exchange, which hands each copy its share of the input.
+ *
+ * A repartition or broadcast exchange runs its child on parallelism threads (one unless the child is a pipeline) and
+ * feeds the copies of the fragment it is in. Outside of a gather exchange it has a single consumer.
+ */
+class ExchangePlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new ExchangePlanNode instance.
+   * @param output The output schema, that of the child
+   * @param child The plan that produces the tuples
+   * @param exchange_type How the tuples go from the producers to the consumers
+   * @param partition_keys The expressions over the tuples of the child that a repartition exchange hashes
+   * @param parallelism The number of threads that run the child
+   */
+  ExchangePlanNode(SchemaRef output, AbstractPlanNodeRef child, ExchangeType exchange_type,
+                   std::vector<AbstractExpressionRef> partition_keys, size_t parallelism)
+      : AbstractPlanNode(std::move(output), {std::move(child)}),
+        exchange_type_(exchange_type),
+        partition_keys_(std::move(partition_keys)),
+        parallelism_(parallelism) {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::Exchange; }
+
+  /** @return The child plan node */
+  auto GetChildPlan() const -> AbstractPlanNodeRef {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Exchange should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return How the tuples go from the producers to the consumers */
+  auto GetExchangeType() const -> ExchangeType { return exchange_type_; }
+
+  /** @return The expressions a repartition exchange hashes */
+  auto GetPartitionKeys() const -> const std::vector<AbstractExpressionRef> & { return partition_keys_; }
+
+  /** @return The number of threads that run the child */
+  auto GetParallelism() const -> size_t { return parallelism_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(ExchangePlanNode);
+
+  /** How the tuples go from the producers to the consumers */
+  ExchangeType exchange_type_;
+  /** The expressions a repartition exchange hashes */
+  std::vector<AbstractExpressionRef> partition_keys_;
+  /** The number of threads that run the child */
+  size_t parallelism_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override;
+};
+
+}  // namespace bustub
+
+template <>
+struct fmt::formatter<bustub::ExchangeType> : formatter<string_view> {
+  template <typename FormatContext>
+  auto format(bustub::ExchangeType c, FormatContext &ctx) const {
+    string_view name;
+    switch (c) {
+      case bustub::ExchangeType::Gather:
+        name = "Gather";
+        break;
+      case bustub::ExchangeType::Repartition:
+        name = "Repartition";
+        break;
+      case bustub::ExchangeType::Broadcast:
+        name = "Broadcast";
+        break;
+      default:
+        name = "Unknown";
+        break;
+    }
+    return formatter<string_view>::format(name, ctx);
+  }
+};
@@ -12,26 +12,42 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
+#include "storage/index/index.h"
 
 namespace bustub {
+
 /**
- * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * IndexScanPlanNode identifies a table that should be scanned through an index, in key order, over an optional range
+ * of keys. The bounds of the range are on the leading key columns, see BPlusTreeIndex::GetRangeIterator.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to scan
+   * @param low the low end of the key range, none for an open one
+   * @param high the high end of the key range, none for an open one
+   * @param reverse whether to scan in descending key order
+   * @param index_only whether to read the columns off the index entries instead of the table
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<IndexKeyBound> low = std::nullopt,
+                    std::optional<IndexKeyBound> high = std::nullopt, bool reverse = false, bool index_only = false)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        low_(std::move(low)),
+        high_(std::move(high)),
+        reverse_(reverse),
+        index_only_(index_only) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -40,14 +56,50 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
-  /** The table whose tuples should be scanned. */
+  /** The index to scan. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /**
+   * The range of keys to scan, bounding the leading key columns. The bounds agree on every column but the last one
+   * either of them bounds, and the scan skips NULLs in that column.
+   */
+  std::optional<IndexKeyBound> low_;
+  std::optional<IndexKeyBound> high_;
+
+  /** Scan in descending key order. */
+  bool reverse_;
+
+  /**
+   * Build the tuples out of the index entries, without going to the table: every column the plan is read by is a key
+   * or included column of the index. The other columns of the output are NULL.
+   */
+  bool index_only_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (!low_.has_value() && !high_.has_value() && !reverse_) {
+      return fmt::format("IndexScan {{ index_oid={}{} }}", index_oid_, index_only_ ? ", index_only" : "");
+    }
+    const std::string low =
+        low_.has_value() ? fmt::format("{}{}", low_->inclusive_ ? "[" : "(", BoundToString(*low_)) : "(-inf";
+    const std::string high =
+        high_.has_value() ? fmt::format("{}{}", BoundToString(*high_), high_->inclusive_ ? "]" : ")") : "+inf)";
+    return fmt::format("IndexScan {{ index_oid={}, range={}, {}{}{} }}", index_oid_, low, high,
+                       reverse_ ? ", reverse" : "", index_only_ ? ", index_only" : "");
+  }
+
+ private:
+  /** @return the value of a bound on one column, or a tuple of the values of a bound on several */
+  static auto BoundToString(const IndexKeyBound &bound) -> std::string {
+    if (bound.values_.size() == 1) {
+      return bound.values_[0].ToString();
+    }
+    std::vector<std::string> values;
+    values.reserve(bound.values_.size());
+    for (const auto &value : bound.values_) {
+      values.push_back(value.ToString());
+    }
+    return fmt::format("({})", fmt::join(values, ", "));
   }
 };
 
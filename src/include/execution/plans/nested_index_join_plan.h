@@ -81,10 +81,13 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   /** The join type */
   JoinType join_type_;
 
+  /** Every inner table column the plans above read is in the index entries, so the join need not go to the table. */
+  bool index_only_{false};
+
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("NestedIndexJoin {{ type={}, key_predicate={}, index={}, index_table={} }}", join_type_,
-                       key_predicate_, index_name_, index_table_name_);
+    return fmt::format("NestedIndexJoin {{ type={}, key_predicate={}, index={}, index_table={}{} }}", join_type_,
+                       key_predicate_, index_name_, index_table_name_, index_only_ ? ", index_only" : "");
   }
 };
 }  // namespace bustub
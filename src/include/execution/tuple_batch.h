@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnVector holds the values of one column for the rows of a batch.
+ *
+ * Fixed-size values are kept back to back in the format of a tuple, with NULL as the null value of their type
+ * (e.g. BUSTUB_INT32_NULL), so that GetData() is a plain array of the column. VARCHAR values are kept as Values.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(TypeId type = TypeId::INTEGER);
+
+  auto GetType() const -> TypeId { return type_; }
+  auto IsInlined() const -> bool { return type_ != TypeId::VARCHAR; }
+  auto Size() const -> size_t { return size_; }
+
+  /** Resize the column to size rows, the new rows are undefined */
+  void Resize(size_t size);
+
+  /** Turn the column into one of size undefined rows of type, keeping its memory */
+  void Reset(TypeId type, size_t size);
+
+  /** @return the values of an inlined column as an array of T, which must be of the size of the type */
+  template <typename T>
+  auto GetData() -> T * {
+    BUSTUB_ASSERT(IsInlined() && sizeof(T) == width_, "the column is not an array of T");
+    return reinterpret_cast<T *>(data_.data());
+  }
+  template <typename T>
+  auto GetData() const -> const T * {
+    BUSTUB_ASSERT(IsInlined() && sizeof(T) == width_, "the column is not an array of T");
+    return reinterpret_cast<const T *>(data_.data());
+  }
+
+  auto GetValue(size_t row) const -> Value {
+    return IsInlined() ? Value::DeserializeFrom(&data_[row * width_], type_) : values_[row];
+  }
+
+  /** Set a row to value, cast to the type of the column */
+  void SetValue(size_t row, const Value &value);
+
+  /** Set a row to the value of a column of a tuple with the given schema */
+  void SetFromTuple(size_t row, const Tuple &tuple, const Schema &schema, uint32_t column_idx) {
+    if (IsInlined()) {
+      memcpy(&data_[row * width_], tuple.GetData() + schema.GetColumn(column_idx).GetOffset(), width_);
+    } else {
+      values_[row] = tuple.GetValue(&schema, column_idx);
+    }
+  }
+
+  /** Set a row to a row of another column of the same type */
+  void SetFromColumn(size_t row, const ColumnVector &other, size_t other_row) {
+    if (IsInlined()) {
+      memcpy(&data_[row * width_], &other.data_[other_row * width_], width_);
+    } else {
+      values_[row] = other.values_[other_row];
+    }
+  }
+
+  void SetNull(size_t row);
+
+ private:
+  TypeId type_;
+  /** The size of a value of an inlined column */
+  size_t width_;
+  size_t size_{0};
+  std::vector<char> data_;
+  std::vector<Value> values_;
+};
+
+/**
+ * TupleBatch carries up to TUPLE_BATCH_SIZE tuples between executors, one ColumnVector per column of its schema,
+ * along with the RID of each row.
+ *
+ * The selection vector lists the rows the batch holds, in order. A filter drops rows from it rather than moving
+ * the columns, so that a row keeps its position for the whole batch.
+ */
+class TupleBatch {
+ public:
+  /** Empty the batch and lay it out for tuples of schema, which must outlive the batch */
+  void Reset(const Schema *schema);
+
+  auto GetSchema() const -> const Schema & { return *schema_; }
+  auto GetColumn(uint32_t column_idx) -> ColumnVector & { return columns_[column_idx]; }
+  auto GetColumn(uint32_t column_idx) const -> const ColumnVector & { return columns_[column_idx]; }
+
+  /** @return the number of rows stored, selected or not */
+  auto GetRowCount() const -> size_t { return rids_.size(); }
+  auto GetRid(size_t row) const -> RID { return rids_[row]; }
+
+  /** @return the selected rows */
+  auto GetSelection() const -> const std::vector<uint32_t> & { return selection_; }
+  /** @return the number of selected rows */
+  auto Size() const -> size_t { return selection_.size(); }
+  auto IsFull() const -> bool { return GetRowCount() >= static_cast<size_t>(TUPLE_BATCH_SIZE); }
+
+  /** Add a selected row, whose columns are then set through GetColumn() */
+  auto AppendRow(RID rid) -> size_t;
+
+  /** Add a selected row holding a tuple of the schema of the batch */
+  void AppendTuple(const Tuple &tuple, RID rid);
+
+  /** Take the RIDs and the selection of the rows of other; the columns are then set through GetColumn() */
+  void CopyRows(const TupleBatch &other);
+
+  /** Keep the selected rows for which predicate, a BOOLEAN column of the batch, is true */
+  void Select(const ColumnVector &predicate);
+
+  /** Keep the selected rows whose bit is set in mask, that of row i being bit i % 64 of word i / 64 */
+  void Select(const uint64_t *mask);
+
+  auto GetValue(size_t row, uint32_t column_idx) const -> Value { return columns_[column_idx].GetValue(row); }
+
+  /** @return a row as a tuple, see GetRid() for its RID */
+  auto GetTuple(size_t row) const -> Tuple;
+
+ private:
+  const Schema *schema_{nullptr};
+  std::vector<ColumnVector> columns_;
+  std::vector<RID> rids_;
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// work_stealing_pool.h
+//
+// Identification: src/include/execution/work_stealing_pool.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkStealingPool runs the tasks of a query across a fixed set of worker threads.
+ *
+ * Run() deals the tasks out to the workers in contiguous blocks, so that a worker scans neighbouring morsels of a
+ * table. A worker takes its own tasks from the front of its queue, and once it runs out steals from the back of the
+ * queue of another worker, so that a worker with slow morsels does not hold up the rest of the query.
+ *
+ * The thread calling Run() is worker 0, and the pool starts one thread for each of the others.
+ */
+class WorkStealingPool {
+ public:
+  /**
+   * Start a pool.
+   * @param worker_count the number of workers, at least one, counting the thread calling Run()
+   */
+  explicit WorkStealingPool(size_t worker_count);
+
+  ~WorkStealingPool();
+
+  DISALLOW_COPY_AND_MOVE(WorkStealingPool);
+
+  /** @return the number of workers */
+  auto GetWorkerCount() const -> size_t { return queues_.size(); }
+
+  /**
+   * Run tasks 0 to task_count - 1 across the workers, and return once they have all run. Once a task throws, the
+   * tasks not yet started are dropped and Run() rethrows the exception. Queries running at once take turns.
+   * @param task_count the number of tasks
+   * @param task run(worker, task) runs a task on a worker, in [0, GetWorkerCount())
+   */
+  void Run(size_t task_count, const std::function<void(size_t worker, size_t task)> &task);
+
+ private:
+  /** The tasks dealt to a worker */
+  struct TaskQueue {
+    std::mutex latch_;
+    std::deque<size_t> tasks_;
+  };
+
+  /** Body of the thread of a worker */
+  void RunWorker(size_t worker);
+
+  /** Run tasks on a worker until none is left */
+  void RunTasks(size_t worker);
+
+  /** Take the next task of a worker, its own or one stolen from another worker, and return false if none is left */
+  auto NextTask(size_t worker, size_t *task) -> bool;
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  /** Held by the query running on the pool */
+  std::mutex run_latch_;
+
+  /** Wakes up the workers for a query, and then Run() once they are done */
+  std::mutex latch_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  /** The tasks of the running query, nullptr between queries */
+  const std::function<void(size_t, size_t)> *task_{nullptr};
+  /** Bumped for each query, so that a worker joins each one once */
+  uint64_t generation_{0};
+  /** The threads yet to finish the running query */
+  size_t running_{0};
+  /** The first exception a task of the running query threw */
+  std::exception_ptr error_;
+  bool stop_{false};
+};
+
+}  // namespace bustub
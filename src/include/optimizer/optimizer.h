@@ -85,6 +85,22 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize a filter over a seq scan into a range scan of an index. Comparisons of an indexed column with
+   * constants become the bounds of the scan, and the rest of the predicate stays in a filter above it.
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief make index scans, and the lookups of nested index joins, index-only when the entries of the index store
+   * every column of the table that the plans above them read
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /** @brief OptimizeIndexOnlyScan() of a plan whose parents read the output columns marked in required */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan, const std::vector<bool> &required)
+      -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
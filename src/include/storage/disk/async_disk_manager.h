@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager is a DiskManager that keeps many page I/Os in flight at once.
+ *
+ * The database file is opened with O_DIRECT (when the file system supports it), so page reads and writes bypass the
+ * OS page cache. Buffer pool frames are aligned to DIRECT_IO_ALIGNMENT and go to the kernel as they are; other
+ * buffers that are not aligned are transparently staged through aligned bounce buffers. Requests are executed either
+ * by an io_uring instance, driven through the raw system calls, or by a pool of worker threads issuing pread/pwrite
+ * when io_uring is not available. The size of the database file is cached, so reads never stat() the file.
+ *
+ * The synchronous ReadPage/WritePage interface is still supported, so an AsyncDiskManager can be handed to a buffer
+ * pool in place of the plain DiskManager.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /** How requests are executed. AUTO picks io_uring and falls back to the thread pool if it cannot be set up. */
+  enum class Backend { AUTO, IO_URING, THREAD_POOL };
+
+  /**
+   * Creates a new async disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param backend how requests are executed
+   * @param queue_depth the maximum number of I/Os in flight at once
+   * @param num_threads the number of worker threads of the thread pool backend
+   */
+  explicit AsyncDiskManager(const std::string &db_file, Backend backend = Backend::AUTO, size_t queue_depth = 64,
+                            size_t num_threads = 4);
+
+  ~AsyncDiskManager() override;
+
+  /**
+   * Wait for all in-flight I/O, stop the backend and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Asynchronously read a page. page_data must stay valid until the returned future is ready.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return a future that becomes ready once the page has been read, or holds an Exception if the read failed
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Asynchronously write a page. page_data must stay valid and unmodified until the returned future is ready.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that becomes ready once the page has been written, or holds an Exception if the write failed
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Submits all writes in one batch (one io_uring_enter, or one pwritev per run of adjacent pages) and waits. */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  /** Submits all reads in one batch (one io_uring_enter, or one preadv per run of adjacent pages) and waits. */
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override;
+
+  /** @return the backend actually in use */
+  auto GetBackend() const -> Backend { return backend_; }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+ private:
+  struct IoRequest;
+  class IoUring;
+
+  /** Build a request, staging the buffer through a bounce buffer if it is not suitably aligned. */
+  auto MakeRequest(bool is_write, page_id_t page_id, char *page_data) -> std::unique_ptr<IoRequest>;
+
+  /** Submit a batch of requests to the backend. Ownership of the requests is passed to the backend. */
+  void Submit(std::vector<std::unique_ptr<IoRequest>> requests);
+
+  /** Finish and release a request given the bytes transferred (or -errno), writing the rest of a short write. */
+  void Complete(IoRequest *request, int64_t result);
+
+  /** Body of the io_uring completion thread. */
+  void ReapCompletions();
+
+  /** Body of a thread pool worker. */
+  void RunWorker();
+
+  /** Execute one run of requests for adjacent pages with a single preadv/pwritev. */
+  void ExecuteRun(std::vector<std::unique_ptr<IoRequest>> run);
+
+  /** File descriptor of the database file. */
+  int db_fd_{-1};
+  /** Whether db_fd_ was opened with O_DIRECT. */
+  bool direct_io_{false};
+  /** Cached size of the database file, in bytes. */
+  std::atomic<int64_t> file_size_{0};
+  /** The backend in use. */
+  Backend backend_;
+  /** Maximum number of I/Os in flight. */
+  const size_t queue_depth_;
+  /** Whether ShutDown() has already run. */
+  bool shut_down_{false};
+
+  /** io_uring backend: the ring, its completion thread, and the number of requests submitted but not reaped. */
+  std::unique_ptr<IoUring> uring_;
+  std::thread completion_thread_;
+  std::mutex submit_latch_;
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+
+  /** Thread pool backend: runs of requests waiting to be executed. */
+  std::vector<std::thread> workers_;
+  std::deque<std::vector<std::unique_ptr<IoRequest>>> pending_runs_;
+  std::mutex pending_latch_;
+  std::condition_variable pending_cv_;
+  bool stop_workers_{false};
+};
+
+}  // namespace bustub
@@ -17,6 +17,8 @@
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -42,7 +44,7 @@ class DiskManager {
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -58,6 +60,19 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a batch of pages to the database file. Returns once all of them are written. The default implementation
+   * writes them one at a time; disk managers that can keep several I/Os in flight override it.
+   * @param pages (page id, raw page data) pairs
+   */
+  virtual void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Read a batch of pages from the database file. Returns once all of them are read.
+   * @param pages (page id, output buffer) pairs
+   */
+  virtual void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages);
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +98,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of pages the database file holds, which an existing database already uses */
+  auto GetNumPages() -> page_id_t;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,6 +112,8 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+  /** Open (or create) the log file that lives next to the given database file. */
+  void OpenLogFile(const std::string &db_file);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
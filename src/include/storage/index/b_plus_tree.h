@@ -10,10 +10,15 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "buffer/buffer_ring.h"
+#include "common/config.h"
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -23,24 +28,49 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * CLASSIC is a B+ tree with latch crabbing. B_LINK is a Lehman-Yao B-link tree: every page has a right link and a high
+ * key, so readers and writers hold at most a few latches at a time and find keys that a concurrent split moved right
+ * by following the link. A B-link tree does not merge pages on removal.
+ */
+enum class BPlusTreeMode { CLASSIC, B_LINK };
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key; BPlusTreeIndex appends the RID to the keys of a non-unique index
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency uses latch crabbing on the page latches. Readers take read latches hand-over-hand. Writers first
+ * descend optimistically with read latches and write latch only the leaf; if the leaf would split or underflow they
+ * restart and descend again with write latches, keeping the latched path in the transaction's page set and releasing
+ * it whenever a node is safe, i.e. cannot propagate a split or merge to its parent. root_page_id_ is protected by
+ * root_latch_, which stands as a nullptr at the front of the page set while a writer holds it.
+ *
+ * In B-link mode nobody crabs: a descent holds one latch at a time and moves right past the high key of a page that
+ * split since its parent was read. A writer remembers the internal pages it passed, and posts a split to the parent
+ * while still holding the page that split, latching bottom-up. Only creating a new root takes root_latch_; parent
+ * page ids are hints, since pages moved to a new internal sibling keep their old parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
+  /** What a descent is for; decides which nodes are safe. */
+  enum class Operation { SEARCH, INSERT, REMOVE };
+
  public:
+  /** Produces the next key/value pair to bulk load; returns false once there are no more. */
+  using BulkLoadSource = std::function<bool(KeyType *, ValueType *)>;
+
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     BPlusTreeMode mode = BPlusTreeMode::CLASSIC);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -57,11 +87,44 @@ class BPlusTree {
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  /**
+   * Take up the tree that an earlier run left, whose root the header page records under the name of this tree.
+   * @return false if the header page has no root for the tree, which then stays empty
+   */
+  auto LoadRootPageId() -> bool;
+
+  /**
+   * Build the tree from pairs in ascending key order. Leaves are packed left to right to fill_factor of their
+   * capacity and the internal levels are built bottom-up as the leaves fill, so every page is written once, through a
+   * private buffer ring. Only the last two pages of each level are rebalanced at the end, to keep them above their
+   * minimum size. A key that is not above its predecessor throws, and leaves the tree empty.
+   * Concurrent operations wait until the load is done.
+   * @param source produces the pairs
+   * @param fill_factor how full to pack the pages, between 0 and 1
+   * @return false if the tree is not empty
+   */
+  auto BulkLoad(const BulkLoadSource &source, double fill_factor = INDEX_FILL_FACTOR) -> bool;
+
+  /**
+   * Build the tree from pairs in any order, by running them through an ExternalSorter first.
+   * @return false if the tree is not empty
+   */
+  auto BulkLoadUnsorted(const BulkLoadSource &source, double fill_factor = INDEX_FILL_FACTOR) -> bool;
+
+  auto GetMode() const -> BPlusTreeMode { return mode_; }
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
+  /**
+   * Scan the entries within the bounds of range, in ascending key order or, for a reverse range, descending order.
+   * Reverse scans walk the prev links of the leaves.
+   * @return an iterator at the first entry of the scan, End() if there is none
+   */
+  auto Scan(const IndexScanRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -77,6 +140,177 @@ class BPlusTree {
  private:
   void UpdateRootPageId(int insert_record = 0);
 
+  /**
+   * Descend with read latches, releasing each node once its child is latched.
+   * @param key the key to search for, nullptr for the leftmost leaf, or the rightmost one if rightmost is set
+   * @return the pinned and read latched leaf, nullptr if the tree is empty
+   */
+  auto FindLeafRead(const KeyType *key, bool rightmost = false) -> Page *;
+
+  /** @return the pinned and read latched leaf covering key, as FindLeafRead or FindLeafBLink finds it for the mode */
+  auto FindLeafForScan(const KeyType *key, bool rightmost) -> Page *;
+
+  /**
+   * Descend with read latches like FindLeafRead, but write latch the leaf.
+   * @return the pinned and write latched leaf, nullptr if the tree is empty
+   */
+  auto FindLeafOptimistic(const KeyType &key) -> Page *;
+
+  /**
+   * Descend with write latches, adding the root latch and every latched page to the transaction's page set and
+   * releasing the set whenever a node is safe for op.
+   * @return the leaf, which is the last page in the page set; nullptr if the tree is empty, with the root latch held
+   */
+  auto FindLeafPessimistic(const KeyType &key, Operation op, Transaction *transaction) -> Page *;
+
+  /** @return true if op on node, for key, cannot split or merge it */
+  auto IsSafe(const BPlusTreePage *node, Operation op, const KeyType &key) const -> bool;
+
+  /**
+   * A page is underfull below its minimum size, unless its entries still take a quarter of the page: with prefix
+   * compression, the minimum size, a count, can be most of what a page holds.
+   * @param size the number of entries to judge node with
+   */
+  auto IsUnderfull(const BPlusTreePage *node, int size) const -> bool;
+
+  /** Unlatch and unpin every page in the transaction's page set, and release the root latch if it is held. */
+  void ReleasePageSet(Transaction *transaction, bool is_dirty);
+
+  /** Allocate a page for a new node; throws OUT_OF_MEMORY, after releasing the page set, if no frame is free. */
+  auto NewNode(page_id_t *page_id, Transaction *transaction) -> Page *;
+
+  /** @return the parent of node, which a pessimistic descent keeps write latched in the page set */
+  auto ParentOf(const BPlusTreePage *node, Transaction *transaction) -> InternalPage *;
+
+  /** Set the parent of a child page, write latching it unless it is already in the page set. */
+  void SetParent(page_id_t child_id, page_id_t parent_id, Transaction *transaction);
+
+  /**
+   * Pin the leaf after leaf, whose prev link a split or merge of leaf is about to change. Taken left to right, its
+   * latch cannot deadlock.
+   * @param[out] next the pinned leaf, nullptr if leaf is the last one
+   * @return false if no frame is free
+   */
+  auto FetchNextLeaf(const LeafPage *leaf, Page **next) -> bool;
+
+  /** Point the prev link of a leaf pinned by FetchNextLeaf at prev_page_id and unpin it; nothing if next is nullptr. */
+  void RelinkPrev(Page *next, page_id_t prev_page_id);
+
+  void StartNewTree(const KeyType &key, const ValueType &value, Transaction *transaction);
+
+  /**
+   * Move the upper half of leaf to the empty new_leaf, then insert key/value into the half that covers it if insert
+   * is set, for a key the full leaf had no room for.
+   * @return the separator of the two leaves, the shortest key between them that GenericComparator finds
+   */
+  auto SplitLeaf(LeafPage *leaf, LeafPage *new_leaf, const KeyType &key, const ValueType &value, bool insert)
+      -> KeyType;
+
+  /** Link new_node, split off old_node, into the parent of old_node, splitting the parent if it is full. */
+  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, Transaction *transaction);
+
+  /**
+   * Fix up node after a removal by borrowing from or merging with a sibling. Merged pages go to the deleted set. If
+   * the entries do not fit in one page and the parent has no room for a new separator either, node stays underfull.
+   */
+  void CoalesceOrRedistribute(BPlusTreePage *node, Transaction *transaction);
+
+  /** Shrink the tree when the root leaf became empty or the root internal page has a single child left. */
+  void AdjustRoot(BPlusTreePage *old_root, Transaction *transaction);
+
+  /** Append right and the separator key to its left sibling. */
+  void MergeInternal(InternalPage *left, InternalPage *right, const KeyType &middle_key, Transaction *transaction);
+
+  /**
+   * Move one entry from sibling to node.
+   * @param index position of node in its parent; the sibling is the right neighbour if index is 0, else the left one
+   * @return false, moving nothing, if the parent has no room for the new separator
+   */
+  auto Redistribute(BPlusTreePage *node, BPlusTreePage *sibling, InternalPage *parent, int index,
+                    Transaction *transaction) -> bool;
+
+  /*
+   * Bulk loading
+   */
+
+  /** The right edge of one level of a bulk load: the open page and the one before it, both pinned. */
+  struct BulkLoadLevel {
+    Page *prev_{nullptr};
+    Page *cur_{nullptr};
+    /** The lower bounds of the keys under prev_ and cur_, which become their separators in the level above. */
+    KeyType prev_key_;
+    KeyType cur_key_;
+  };
+
+  /** How full a bulk load packs its pages. */
+  struct BulkLoadFill {
+    int leaf_size_;
+    int internal_size_;
+    /** Bytes of entries per page, since how many entries fit depends on their keys. */
+    size_t data_size_;
+  };
+
+  /** Allocate a page for a bulk load through its ring. */
+  auto BulkLoadNewPage(page_id_t *page_id, BufferRing *ring) -> Page *;
+
+  /**
+   * Start a new page on a level, making the open page prev_ and linking the old prev_ into the level above.
+   * @param key the separator of the open page and the new page
+   */
+  void BulkLoadNextPage(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &key, BufferRing *ring,
+                        const BulkLoadFill &fill);
+
+  /**
+   * Append a child to the open internal page of a level, starting a page or the level as needed.
+   * @param child the child page, unpinned by this call
+   */
+  void BulkLoadAppendChild(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &key, Page *child,
+                           BufferRing *ring, const BulkLoadFill &fill);
+
+  /** Merge or rebalance the last two pages of a level so that the last one is not below its minimum size. */
+  void BulkLoadBalanceEdge(BulkLoadLevel *edge);
+
+  /*
+   * B-link mode
+   */
+
+  /**
+   * Descend holding one latch at a time, moving right wherever key is not below a page's high key.
+   * @param key the key to search for, nullptr for the leftmost leaf, or the rightmost one if rightmost is set
+   * @param write_leaf whether to write latch the leaf instead of read latching it
+   * @param[out] stack if not nullptr, receives the internal pages the descent went down from, root first
+   * @return the pinned and latched leaf covering key, nullptr if the tree is empty
+   */
+  auto FindLeafBLink(const KeyType *key, bool write_leaf, std::vector<page_id_t> *stack, bool rightmost = false)
+      -> Page *;
+
+  /**
+   * Move right from a latched page until key is below its high key, latching the right sibling before releasing the
+   * page.
+   * @param key the key to cover, nullptr to move to the last page of the level
+   * @return the latched page covering key
+   */
+  auto MoveRight(Page *page, const KeyType *key, bool exclusive) -> Page *;
+
+  auto InsertBLink(const KeyType &key, const ValueType &value) -> bool;
+
+  void RemoveBLink(const KeyType &key);
+
+  /**
+   * Post the split of a write latched page to its parent, splitting parents up the tree as needed, and release it.
+   * @param page the page that split
+   * @param key the first key of the new right sibling
+   * @param new_page the new right sibling, pinned but not latched; unpinned by this call
+   * @param stack the internal pages the descent to page went down from
+   */
+  void InsertIntoParentBLink(Page *page, const KeyType &key, Page *new_page, std::vector<page_id_t> *stack);
+
+  /**
+   * Write latch the internal page whose child pointer for key is child_id, starting at page_id and moving right or,
+   * if the tree grew above page_id's level meanwhile, down.
+   */
+  auto LatchParentBLink(page_id_t page_id, page_id_t child_id, const KeyType &key) -> Page *;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -84,11 +318,15 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  /** Written under root_latch_; B-link descents read it without the latch. */
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  BPlusTreeMode mode_;
+  /** Protects root_page_id_. */
+  mutable ReaderWriterLatch root_latch_;
 };
 
 }  // namespace bustub
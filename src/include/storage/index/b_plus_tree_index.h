@@ -11,8 +11,10 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -24,39 +26,113 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * A B+ tree over the keys of an index. A non-unique index makes its keys unique by appending the RID right after the
+ * encoded key columns, so that entries of equal keys sort by RID and an entry is removed by its key and RID. The
+ * included columns of a covering index follow at the end of the tree keys, where they never decide the order of two
+ * entries, and DecodeEntry() reads them back without going to the table.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param metadata the index metadata
+   * @param buffer_pool_manager the buffer pool the tree lives in
+   * @param mode whether to build a classic B+ tree or a B-link tree
+   * @param root_record_name the header page record of the root of the tree; the index name if empty
+   * @throw Exception if the index is not unique, or has included columns, and its entries do not fit in the keys
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 BPlusTreeMode mode = BPlusTreeMode::CLASSIC, const std::string &root_record_name = "");
 
-  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+  /** Reopen the tree an earlier run left, see BPlusTree::LoadRootPageId. */
+  auto LoadRootPageId() -> bool { return container_.LoadRootPageId(); }
+
+  auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Build the index from key tuples in any order: an ExternalSorter sorts the entries for BPlusTree::BulkLoad.
+   * @param source produces the next key tuple and its RID; returns false once there are no more
+   * @return false if the index is not empty
+   * @throw Exception if the index is unique and two key tuples are equal, which leaves the index empty
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &source) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  /** @return an iterator over the entries within the bounds of range, see BPlusTree::Scan */
+  auto GetScanIterator(const IndexScanRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
+  /**
+   * Scan the entries whose leading key columns are between low and high, which may bound different numbers of
+   * columns, e.g. for a = 1 AND b > 2 on an index over (a, b, c) low is (1, 2) and high is (1).
+   * @param low the low bound, none for an open one
+   * @param high the high bound, none for an open one
+   * @param reverse whether to scan in descending key order
+   * @return an iterator at the first entry of the scan
+   */
+  auto GetRangeIterator(const std::optional<IndexKeyBound> &low, const std::optional<IndexKeyBound> &high,
+                        bool reverse) -> INDEXITERATOR_TYPE;
+
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /**
+   * Decode the columns an entry of the index stores.
+   * @param key the tree key of the entry
+   * @param[out] values receives the key columns, then the included ones, in the order of GetEntryAttrs()
+   */
+  void DecodeEntry(const KeyType &key, std::vector<Value> *values) const;
+
  protected:
+  /** @return whether a tree key holds nothing but the encoded key tuple, so that a key is looked up exactly */
+  auto IsKeyExact() const -> bool;
+
+  /**
+   * @return the key of an entry: the encoded key tuple, followed by rid for a non-unique index, and by the included
+   * columns of entry
+   */
+  auto MakeKey(const Tuple &entry, RID rid) const -> KeyType;
+
+  /** @return the range of the tree keys whose first length bytes are those of key */
+  static auto PrefixRange(KeyType key, size_t length) -> IndexScanRange<KeyType>;
+
+  /**
+   * Turn the first length bytes of key into the smallest key above every key that starts with them.
+   * @return false if there is no such key
+   */
+  static auto Successor(KeyType *key, size_t length) -> bool;
+
+  /**
+   * Encode a bound as the smallest key whose leading columns are its values or, with past set, as the smallest key
+   * after all of those.
+   * @return false if past is set and there is no such key
+   */
+  auto BoundKey(const IndexKeyBound &bound, bool past, KeyType *key) const -> bool;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
 };
 
-/** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
-
-constexpr static const auto INTEGER_SIZE = 4;
-using IntegerKeyType = GenericKey<INTEGER_SIZE>;
-using IntegerValueType = RID;
-using IntegerComparatorType = GenericComparator<INTEGER_SIZE>;
-using BPlusTreeIndexForOneIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
-using BPlusTreeIndexIteratorForOneIntegerColumn =
-    IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
-using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
+/**
+ * We only support index tables with keys of one size for now in BusTub, which hold up to 32 bytes of fixed length
+ * columns, including the RID of a non-unique index and the included columns. Prefix compression drops the unused
+ * bytes from the pages. Hardcode everything here.
+ */
+
+constexpr static const auto INDEX_KEY_SIZE = 32;
+using IndexKeyType = GenericKey<INDEX_KEY_SIZE>;
+using IndexValueType = RID;
+using IndexComparatorType = GenericComparator<INDEX_KEY_SIZE>;
+using BPlusTreeIndexForFixedSizeKeys = BPlusTreeIndex<IndexKeyType, IndexValueType, IndexComparatorType>;
+using BPlusTreeIndexIteratorForFixedSizeKeys = IndexIterator<IndexKeyType, IndexValueType, IndexComparatorType>;
+using IndexHashFunctionType = HashFunction<IndexKeyType>;
 
 }  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSorter sorts key/value pairs that may not fit in memory, to feed BPlusTree::BulkLoad.
+ *
+ * Pairs are collected in a buffer of run_pages pages worth of entries. Whenever the buffer fills up it is sorted and
+ * written out as a run, a stretch of pages of a temporary file. Finish() merges the runs down to at most merge_fan_in
+ * of them, and Next() then streams out the final k-way merge, reading one page of each run at a time. If everything
+ * fits in the buffer, nothing is written out at all. The runs stay out of the buffer pool and out of the database
+ * file: the temporary file is gone once the sorter is.
+ *
+ * The sort is stable: pairs with equal keys come out in the order they were added.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  /**
+   * @param comparator the key comparator
+   * @param run_pages the in-memory buffer size, in pages worth of entries
+   * @param merge_fan_in the number of runs merged at once, each through a page of memory; 0 picks run_pages
+   */
+  explicit ExternalSorter(const KeyComparator &comparator, size_t run_pages = EXTERNAL_SORT_RUN_PAGES,
+                          size_t merge_fan_in = 0);
+
+  ExternalSorter(const ExternalSorter &) = delete;
+  auto operator=(const ExternalSorter &) -> ExternalSorter & = delete;
+
+  /** Close, and so delete, the temporary file. */
+  ~ExternalSorter();
+
+  /** Add a pair. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Stop adding and prepare the sorted output. */
+  void Finish();
+
+  /**
+   * Produce the next pair in key order.
+   * @return false once all pairs have been produced
+   */
+  auto Next(KeyType *key, ValueType *value) -> bool;
+
+  /** @return the number of runs written out so far */
+  auto GetNumRuns() const -> size_t { return num_runs_written_; }
+
+ private:
+  static constexpr size_t ENTRIES_PER_PAGE = BUSTUB_PAGE_SIZE / sizeof(MappingType);
+
+  /** A sorted run: size_ entries on the pages of the temporary file from first_page_ on. */
+  struct Run {
+    size_t first_page_;
+    size_t size_;
+  };
+
+  /** Read position in a run, with the page of the run it is on. */
+  struct Cursor {
+    Run run_;
+    size_t pos_{0};
+    std::vector<MappingType> page_;
+  };
+
+  /** Sort the buffer and write it out as a run. */
+  void SpillBuffer();
+
+  /** Append an entry to the run being written, which starts at the end of the temporary file. */
+  void Append(Run *run, const MappingType &entry);
+  /** Write out the last page of the run being written. */
+  void Close();
+
+  /** Write page_buffer_ to the next page of the temporary file, creating the file first if need be. */
+  void WritePage();
+  /** Read the first count entries of a page of the temporary file. */
+  void ReadPage(size_t page, size_t count, std::vector<MappingType> *entries);
+
+  /** Open cursors on the runs and fill the merge heap. */
+  void StartMerge(const std::vector<Run> &runs);
+  /** Pop the smallest entry of the merge, advancing its run. */
+  auto PopMerge(MappingType *entry) -> bool;
+  /** @return whether the current entry of cursor a goes after that of cursor b, the heap order of the merge */
+  auto Later(size_t a, size_t b) const -> bool;
+
+  KeyComparator comparator_;
+  size_t buffer_capacity_;
+  size_t merge_fan_in_;
+  bool finished_{false};
+
+  std::vector<MappingType> buffer_;
+  /** Next entry of buffer_ to produce, when nothing was written out. */
+  size_t buffer_pos_{0};
+
+  /** The temporary file of the runs, nullptr until the first run is written. */
+  std::FILE *file_{nullptr};
+  /** The pages of the temporary file so far; a run goes after the runs before it. */
+  size_t num_pages_{0};
+  /** The page of the run being written. */
+  std::vector<MappingType> page_buffer_;
+
+  /** The runs not merged yet. */
+  std::vector<Run> runs_;
+  size_t num_runs_written_{0};
+
+  /** The merge in progress: one cursor per run, and a min-heap of the runs by their current key. */
+  std::vector<Cursor> cursors_;
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
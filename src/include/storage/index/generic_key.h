@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -24,43 +26,31 @@ namespace bustub {
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
- * with a template argument.
+ * with a template argument. The key is stored in the encoding of
+ * KeyEncoder, so that keys compare with memcmp.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
-    // intialize to 0
-    memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+  /** @return the length of the encoding, see KeyEncoder::Encode() */
+  inline auto SetFromKey(const Tuple &tuple, const Schema *key_schema) -> size_t {
+    return KeyEncoder::Encode(tuple, key_schema, data_, KeySize);
   }
 
   // NOTE: for test purpose only
-  inline void SetFromInteger(int64_t key) {
-    memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
-  }
+  // encode key as a key of one bigint column
+  inline void SetFromInteger(int64_t key) { KeyEncoder::EncodeBigInt(key, data_, KeySize); }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
-    }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return KeyEncoder::Decode(data_, KeySize, schema, column_idx);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the key as a key of one bigint column
+  inline auto ToString() const -> int64_t { return KeyEncoder::DecodeBigInt(data_, KeySize); }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the key as a key of one bigint column
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -72,34 +62,63 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are in the memcmp ordered encoding of KeyEncoder, so they compare byte by byte. The first 8 bytes are read as
+ * one big endian integer, the prefix, which a search can read once for the key it looks for.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
+    return Compare(lhs, Prefix(lhs), rhs, Prefix(rhs));
+  }
+
+  /** @return the first bytes of key as a big endian integer, so that prefixes order keys as their bytes do */
+  inline auto Prefix(const GenericKey<KeySize> &key) const -> uint64_t {
+    uint64_t prefix = 0;
+    memcpy(&prefix, key.data_, PREFIX_SIZE);
+    return __builtin_bswap64(prefix);
+  }
+
+  /**
+   * Compare two keys whose prefixes the caller already read, so a search reads the prefix of its key only once.
+   * @return the same as operator()
+   */
+  inline auto Compare(const GenericKey<KeySize> &lhs, uint64_t lhs_prefix, const GenericKey<KeySize> &rhs,
+                      uint64_t rhs_prefix) const -> int {
+    if (lhs_prefix != rhs_prefix) {
+      return lhs_prefix < rhs_prefix ? -1 : 1;
     }
-    // equals
-    return 0;
+    const int cmp = memcmp(lhs.data_ + PREFIX_SIZE, rhs.data_ + PREFIX_SIZE, KeySize - PREFIX_SIZE);
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+  }
+
+  /**
+   * Pick a separator key for two neighbouring pages: a key greater than lhs and not greater than rhs, which are the
+   * last key of the left page and the first key of the right one. It is rhs up to the first byte that tells it apart
+   * from lhs, followed by zeros, so the zero bytes compress away in the internal pages.
+   * @return the truncated key
+   */
+  inline auto Separator(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> GenericKey<KeySize> {
+    const auto *mismatch = std::mismatch(lhs.data_, lhs.data_ + KeySize, rhs.data_).first;
+    const size_t keep = std::min(KeySize, static_cast<size_t>(mismatch - lhs.data_) + 1);
+    GenericKey<KeySize> separator;
+    memcpy(separator.data_, rhs.data_, keep);
+    memset(separator.data_ + keep, 0, KeySize - keep);
+    return separator;
   }
 
+  /** @return the schema of the keys */
+  inline auto GetKeySchema() const -> Schema * { return key_schema_; }
+
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
 
   // constructor
   explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
  private:
+  static constexpr size_t PREFIX_SIZE = std::min(KeySize, sizeof(uint64_t));
+
   Schema *key_schema_;
 };
 
@@ -43,11 +43,20 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether a key maps to at most one RID
+   * @param included_attrs The base table columns stored in the index entries after the key, which are not part of it
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, std::vector<uint32_t> included_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        included_attrs_(std::move(included_attrs)) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), included_attrs_.begin(), included_attrs_.end());
+    entry_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, entry_attrs_));
   }
 
   ~IndexMetadata() = default;
@@ -72,6 +81,18 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return Whether a key maps to at most one RID */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
+  /** @return The base table columns stored in the index entries after the key columns */
+  inline auto GetIncludedAttrs() const -> const std::vector<uint32_t> & { return included_attrs_; }
+
+  /** @return The base table columns of an index entry: the key columns, then the included ones */
+  inline auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return entry_attrs_; }
+
+  /** @return A schema object pointer that represents an index entry, the key followed by the included columns */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_.get(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -79,8 +100,10 @@ class IndexMetadata {
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
        << "Type = B+Tree, "
+       << "Unique = " << (is_unique_ ? "true" : "false") << ", "
+       << "Included columns = " << included_attrs_.size() << ", "
        << "Table name = " << table_name_ << "] :: ";
-    os << key_schema_->ToString();
+    os << entry_schema_->ToString();
 
     return os.str();
   }
@@ -92,8 +115,26 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** Whether a key maps to at most one RID */
+  const bool is_unique_;
+  /** The mapping relation between the included columns and tuple schema */
+  const std::vector<uint32_t> included_attrs_;
+  /** The key attributes followed by the included ones */
+  std::vector<uint32_t> entry_attrs_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** The schema of an index entry */
+  std::shared_ptr<Schema> entry_schema_;
+};
+
+/**
+ * One end of a range of index keys, given by the values of the leading key columns. Keys whose leading columns equal
+ * the values are in the range if the bound is inclusive.
+ */
+struct IndexKeyBound {
+  /** Values of the first key columns, at least one. */
+  std::vector<Value> values_;
+  bool inclusive_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +180,12 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The schema of the tuples InsertEntry() and DeleteEntry() take: the key, then the included columns */
+  auto GetEntrySchema() const -> Schema * { return metadata_->GetEntrySchema(); }
+
+  /** @return The base table columns of an index entry */
+  auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetEntryAttrs(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,15 +200,16 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index key, followed by the included columns, see GetEntrySchema()
    * @param rid The RID associated with the key
    * @param transaction The transaction context
+   * @return false if the entry was not inserted, e.g. because the index is unique and already holds the key
    */
-  virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
+  virtual auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool = 0;
 
   /**
    * Delete an index entry by key.
-   * @param key The index key
+   * @param key The index key, followed by the included columns, see GetEntrySchema()
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
@@ -13,17 +13,67 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <deque>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/** The bounds and the direction of a range scan. A missing bound leaves its end of the range open. */
+template <typename KeyType>
+struct IndexScanRange {
+  std::optional<KeyType> low_;
+  bool low_inclusive_{true};
+  std::optional<KeyType> high_;
+  bool high_inclusive_{true};
+  /** Run from the high end of the range down to the low end. */
+  bool reverse_{false};
+};
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
+
+  /**
+   * Creates an iterator positioned at an entry of a leaf page.
+   * @param bpm the buffer pool manager of the tree
+   * @param page the leaf page, already pinned; the iterator takes over the pin
+   * @param index offset of the entry in the leaf page
+   * @param readahead_window how many leaves ahead of the current one to prefetch, 0 disables read-ahead
+   */
+  IndexIterator(BufferPoolManager *bpm, Page *page, int index, size_t readahead_window = 0);
+
+  /**
+   * Creates an iterator for a range scan, positioned at an entry of a leaf page, which moves on to the first entry in
+   * range in the direction of the scan.
+   * @param bpm the buffer pool manager of the tree
+   * @param page the leaf page, pinned and read latched; the iterator takes over the pin and releases the latch once it
+   * is at the first entry, so the offset cannot go stale before then
+   * @param index offset of the entry in the leaf page, -1 for a reverse scan that starts before the page
+   * @param range the bounds and the direction of the scan
+   * @param comparator compares keys with the bounds; must outlive the iterator
+   * @param find_leaf returns the pinned and read latched leaf covering a key; a reverse scan seeks back through it
+   * when the prev link of a leaf turns out stale
+   */
+  IndexIterator(BufferPoolManager *bpm, Page *page, int index, IndexScanRange<KeyType> range,
+                const KeyComparator *comparator, std::function<Page *(const KeyType &)> find_leaf);
+
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -32,12 +82,96 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  /**
+   * Append the values of the entries from the current one to the end of the current leaf that are in range, under a
+   * single read latch, and move on to the next leaf.
+   * @param[out] values receives the values, in scan order
+   * @return false, appending nothing, once the scan is exhausted
+   */
+  auto NextBatch(std::vector<ValueType> *values) -> bool;
+
+  /**
+   * Like NextBatch() for values, but append whole entries, keys included.
+   * @param[out] entries receives the entries, in scan order
+   */
+  auto NextBatch(std::vector<MappingType> *entries) -> bool;
+
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return GetPageId() == itr.GetPageId() && index_ == itr.index_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** @return the id of the current leaf, INVALID_PAGE_ID for the end iterator */
+  auto GetPageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  /** NextBatch() into a batch of values or of entries. */
+  template <typename Entry>
+  auto NextBatchOf(std::vector<Entry> *batch) -> bool;
+
+  /** Unpin the current leaf and turn this into the end iterator. */
+  void Release();
+
+  /**
+   * Move past the end of exhausted leaves, and past entries before the range, to the next entry in range; or to the
+   * end of the index, or of the range.
+   * @param latched whether the caller already holds the read latch on the current leaf
+   */
+  void SkipToValidEntry(bool latched = false);
+
+  /** @return -1 if key comes before the range in scan order, 1 if after it, 0 if it is in range */
+  auto Classify(const KeyType &key) const -> int;
+
+  /**
+   * Find the place of a range scan in the current leaf again by the last key it looked at, since entries move when
+   * other threads write the leaf between two latches: the entry right after that key, in scan order. The caller holds
+   * the read latch.
+   */
+  void Reposition();
+
+  /**
+   * Read latch the current leaf again and reposition in it. A reverse scan finding nothing left at or above the last
+   * key seeks it again, as a split may have moved the entries right below it into the next leaf; the iterator is then
+   * at the leaf it found, read latched, or at the end.
+   */
+  void Relatch();
+
+  /** Move a reverse scan to the largest key below bound, at the leaf holding it, read latched; or to the end. */
+  void SeekBelow(const KeyType &bound);
+
+  /**
+   * Move a reverse scan to the last entry of the leaf before the current one, which is read latched by the caller.
+   * The previous leaf is only latched if that needs no waiting, while the current one is still held; otherwise, or if
+   * the link turns out stale, the scan seeks the last key it looked at again. The leaf moved to is left read latched.
+   */
+  void StepToPrevLeaf();
+
+  /**
+   * Prefetch the leaves that follow the current one. The right siblings of the current leaf are read off its parent,
+   * which is only inspected if its read latch can be taken without waiting; the next leaf is always prefetched.
+   * @param parent_page_id parent of the current leaf, as read from the leaf
+   * @param next_page_id the leaf after the current one
+   */
+  void ReadAhead(page_id_t parent_page_id, page_id_t next_page_id);
+
+  BufferPoolManager *bpm_{nullptr};
+  /** The current leaf, pinned by the iterator; nullptr for the end iterator. */
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  /** The entry at index_, decoded out of the prefix compressed leaf under the latch that found it, as entries move
+   * once it is released. */
+  MappingType item_;
+  size_t readahead_window_{0};
+  /** Leaves after the current one that have already been prefetched, in chain order. */
+  std::deque<page_id_t> prefetched_;
+  IndexScanRange<KeyType> range_;
+  /** Set for range scans; a plain iterator runs forward over the whole index. */
+  const KeyComparator *comparator_{nullptr};
+  std::function<Page *(const KeyType &)> find_leaf_;
+  /** The key of the last entry a range scan looked at, which it carries on after; unset before the first one. */
+  std::optional<KeyType> last_key_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * KeyEncoder turns index keys into byte strings whose memcmp order is the SQL order of the keys, so that indexes
+ * compare keys without building Values.
+ *
+ * The columns are encoded one after the other:
+ *  - integers, timestamps and booleans big endian, with the sign bit flipped for the signed ones
+ *  - decimals big endian, with the sign bit flipped for positive numbers and every bit flipped for negative ones
+ *  - varchars as a NULL flag byte (0 for NULL, 1 otherwise), then their bytes with each 0 escaped as 0 0xFF, then a
+ *    0 0 terminator, so a string sorts before every longer string it is a prefix of
+ *
+ * Fixed length columns take the same bytes as in a tuple. Their NULL is the smallest value of the type, which the
+ * encoding sorts first, except for timestamps, whose NULL is the largest one. An encoding longer than the key is cut
+ * at the key size: such keys only compare by the bytes that fit, and decode to a shortened last varchar.
+ */
+class KeyEncoder {
+ public:
+  /**
+   * Encode the key tuple, laid out by key_schema, into size bytes at dst; the bytes after the encoding are zeroed.
+   * @return the length of the encoding, which is more than size if it was cut
+   */
+  static auto Encode(const Tuple &key, const Schema *key_schema, char *dst, size_t size) -> size_t;
+
+  /**
+   * Encode columns [begin, end) of a tuple laid out by schema at dst + offset, writing nothing past size.
+   * @return the offset after the columns
+   */
+  static auto EncodeColumns(const Tuple &tuple, const Schema *schema, uint32_t begin, uint32_t end, char *dst,
+                            size_t offset, size_t size) -> size_t;
+
+  /**
+   * Encode a record id at dst + offset, writing nothing past size, so that record ids order as RID::Get() does.
+   * @return the offset after the record id
+   */
+  static auto EncodeRid(RID rid, char *dst, size_t offset, size_t size) -> size_t;
+
+  /**
+   * Encode a single bigint into size bytes at dst, as a key of one bigint column.
+   */
+  static void EncodeBigInt(int64_t value, char *dst, size_t size);
+
+  /**
+   * Decode column column_idx of a key encoded by Encode().
+   */
+  static auto Decode(const char *src, size_t size, const Schema *key_schema, uint32_t column_idx) -> Value;
+
+  /**
+   * Decode columns [begin, end) of schema, encoded by EncodeColumns() at src + *offset, and move *offset past them.
+   * @param[out] values receives the values of the columns
+   */
+  static void DecodeColumns(const char *src, size_t size, const Schema *schema, uint32_t begin, uint32_t end,
+                            size_t *offset, std::vector<Value> *values);
+
+  /**
+   * Decode a key encoded by EncodeBigInt().
+   */
+  static auto DecodeBigInt(const char *src, size_t size) -> int64_t;
+
+ private:
+  /** Encode value at dst + offset, writing nothing past size. @return the offset after the value */
+  static auto EncodeValue(const Value &value, char *dst, size_t offset, size_t size) -> size_t;
+
+  /** Decode a value of type type at src + *offset, and move *offset past it. */
+  static auto DecodeValue(TypeId type, const char *src, size_t *offset, size_t size) -> Value;
+
+  /** Write the low width bytes of bits big endian. */
+  static auto PutBigEndian(uint64_t bits, int width, char *dst, size_t offset, size_t size) -> size_t;
+
+  /** Read width bytes big endian; missing bytes read as 0. */
+  static auto GetBigEndian(int width, const char *src, size_t *offset, size_t size) -> uint64_t;
+};
+
+}  // namespace bustub
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_compressed_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_COMPRESSED_PAGE_TYPE BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator>
+#define B_PLUS_TREE_COMPRESSED_PAGE_HEADER_SIZE 36
+/** Bytes of a page left for its entries, after the header, the high key and the base key. */
+#define B_PLUS_TREE_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - B_PLUS_TREE_COMPRESSED_PAGE_HEADER_SIZE - 2 * sizeof(KeyType))
+
+/**
+ * Key/value storage shared by leaf and internal pages, with prefix compression.
+ *
+ * The bytes that every key of the page has in common at its start (the prefix) and at its end (the suffix) are stored
+ * once, in the base key, and each entry only stores the bytes in between, followed by its value:
+ *  ---------------------------------------------------------------------------------------------
+ * | HEADER | HighKey | BaseKey | KEY(1)[prefix, size - suffix) + VALUE(1) | ... | KEY(n)... + VALUE(n)
+ *  ---------------------------------------------------------------------------------------------
+ *  Header format (size in byte, 36 bytes in total):
+ *  ------------------------------------------------------------------------------------------------------
+ * | common header (24) | NextPageId (4) | PrevPageId (4) | PrefixSize (2) | SuffixSize (2) |
+ *  ------------------------------------------------------------------------------------------------------
+ * GenericKey pads keys with zeros and stores integers big endian, so the prefix usually covers the leading columns and
+ * the high bytes of integers, and the suffix the padding. The stored width grows when an entry shares fewer bytes, and only shrinks again when
+ * the page is rebuilt, on a split or a merge.
+ *
+ * How many entries fit therefore depends on the keys. Callers check HasRoomFor() before adding an entry; the count
+ * limit of a page (its max size) only bounds the entries from above. Page sizes are chosen so that half of a full page
+ * always fits uncompressed, which is what a split needs.
+ *
+ * Searches run on the compressed entries: each probe copies the stored bytes of one entry into a scratch key that
+ * already holds the shared bytes, instead of decoding the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedPage : public BPlusTreePage {
+ public:
+  /** Bytes of a whole key. */
+  static constexpr int KEY_SIZE = static_cast<int>(sizeof(KeyType));
+  /** Number of entries that fit even if no byte is shared. */
+  static constexpr int UNCOMPRESSED_CAPACITY =
+      static_cast<int>(B_PLUS_TREE_PAGE_DATA_SIZE / (sizeof(KeyType) + sizeof(ValueType)));
+
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  /** The left sibling of a leaf, for reverse scans; internal pages leave it invalid. */
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &high_key);
+
+  auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+
+  /** @return the bytes each entry stores of its key */
+  auto GetKeyWidth() const -> int { return KEY_SIZE - prefix_size_ - suffix_size_; }
+
+  /** @return the bytes an entry takes, key and value */
+  auto GetEntrySize() const -> int { return GetKeyWidth() + static_cast<int>(sizeof(ValueType)); }
+
+  /**
+   * @param key the key of the new entry, which may share fewer bytes with the page than its keys do
+   * @param data_size the bytes the entries may take, less than the page has to keep some free
+   * @return true if one more entry with key fits
+   */
+  auto HasRoomFor(const KeyType &key, size_t data_size = B_PLUS_TREE_PAGE_DATA_SIZE) const -> bool;
+
+  /** @return true if one more entry fits whatever its key */
+  auto HasRoomForAnyKey() const -> bool;
+
+  /** @return true if key can replace the key of an entry */
+  auto CanReplaceKey(const KeyType &key) const -> bool;
+
+  /**
+   * @param other a page whose entries are to be appended to this one
+   * @param key a key that replaces one of other's keys on the way, or nullptr
+   * @return true if the entries of both pages fit in this one
+   */
+  auto CanAbsorb(const BPlusTreeCompressedPage *other, const KeyType *key) const -> bool;
+
+ protected:
+  /** Empty the page. */
+  void ClearEntries();
+
+  /** @return the first index in [begin, size) whose key is not less than key, size if there is none */
+  auto LowerBound(const KeyType &key, int begin, const KeyComparator &comparator) const -> int;
+
+  /** @return the first index in [begin, size) whose key is greater than key, size if there is none */
+  auto UpperBound(const KeyType &key, int begin, const KeyComparator &comparator) const -> int;
+
+  /** Insert an entry at index, shifting the following ones right. The entry must fit. */
+  void InsertEntry(int index, const KeyType &key, const ValueType &value);
+
+  /** Remove the entry at index, shifting the following ones left. */
+  void RemoveEntry(int index);
+
+  /** Replace the key of the entry at index. The key must fit. */
+  void ReplaceKey(int index, const KeyType &key);
+
+  /** Append the entries [begin, end) of source. They must fit. */
+  void AppendEntries(const BPlusTreeCompressedPage *source, int begin, int end);
+
+  /** Append count entries. They must fit. */
+  void AppendEntries(const MappingType *items, int count);
+
+  /** Drop the entries from size on and recompress the rest as tightly as possible. */
+  void Truncate(int size);
+
+ private:
+  /** Bytes shared by a set of keys: the first prefix_ and the last suffix_ bytes of base_. */
+  struct SharedBytes {
+    KeyType base_;
+    int prefix_{KEY_SIZE};
+    int suffix_{0};
+    /** No key seen yet. */
+    bool empty_{true};
+
+    /** Narrow down to the bytes that key shares too. */
+    void Add(const KeyType &key);
+    /** Narrow down to the bytes that a set of keys described by other shares too. */
+    void Add(const SharedBytes &other);
+    /** @return the width of an entry's key bytes */
+    auto Width() const -> int;
+  };
+
+  /** @return the first index in [begin, size) whose key is greater than key, or not less than it if !upper */
+  auto Search(const KeyType &key, int begin, const KeyComparator &comparator, bool upper) const -> int;
+
+  /** @return the bytes shared by the keys of this page; for a page with a single key, that is all of them */
+  auto Shared() const -> SharedBytes;
+
+  auto EntryAt(int index) -> char * { return Entries() + index * GetEntrySize(); }
+  auto EntryAt(int index) const -> const char * { return Entries() + index * GetEntrySize(); }
+  auto Entries() -> char * { return reinterpret_cast<char *>(this) + sizeof(BPlusTreeCompressedPage); }
+  auto Entries() const -> const char * {
+    return reinterpret_cast<const char *>(this) + sizeof(BPlusTreeCompressedPage);
+  }
+
+  /** @return true if count entries of the given key width fit in data_size bytes */
+  static auto Fits(int count, int width, size_t data_size = B_PLUS_TREE_PAGE_DATA_SIZE) -> bool;
+
+  /** Re-encode the entries with the shared bytes of shared, which must cover every key of the page. */
+  void Relayout(const SharedBytes &shared);
+
+  void WriteEntry(int index, const KeyType &key, const ValueType &value);
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  uint16_t prefix_size_;
+  uint16_t suffix_size_;
+  KeyType high_key_;
+  /** Holds the shared bytes; its other bytes are unused. */
+  KeyType base_key_;
+};
+
+}  // namespace bustub
@@ -12,38 +12,60 @@
 
 #include <queue>
 
-#include "storage/page/b_plus_tree_page.h"
+#include "storage/page/b_plus_tree_compressed_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+/** The count cap of a prefix compressed internal page, see LEAF_PAGE_SIZE. */
+#define INTERNAL_PAGE_SIZE (2 * (B_PLUS_TREE_PAGE_DATA_SIZE / (sizeof(KeyType) + sizeof(page_id_t))) - 2)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
  * K(i) <= K < K(i+1).
  * NOTE: since the number of keys does not equal to number of child pointers,
- * the first key always remains invalid. That is to say, any search/lookup
- * should ignore the first key.
+ * the first key is never compared against. It still has to be a key of the
+ * index's key space, a lower bound of the subtree, because it takes part in
+ * the prefix compression of the page.
  *
- * Internal page format (keys are stored in increasing order):
+ * Internal page format (keys are stored in increasing order, prefix compressed, see BPlusTreeCompressedPage):
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The right sibling and the high key, an exclusive upper bound of the keys in
+ * the subtree, are only maintained by B-link trees; the rightmost page of a
+ * level has no right sibling and no high key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-class BPlusTreeInternalPage : public BPlusTreePage {
+class BPlusTreeInternalPage : public BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator> {
  public:
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
-  auto KeyAt(int index) const -> KeyType;
+  /** Replace the key at index. The page must have room for it, see CanReplaceKey(). */
   void SetKeyAt(int index, const KeyType &key);
-  auto ValueAt(int index) const -> ValueType;
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  /** @return the child pointer whose subtree covers key */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  /**
+   * Turn this empty page into a root with the two children of a split old root. The first key, which is never
+   * compared against, is set to new_key too.
+   */
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  /**
+   * Insert a key/child pair at index, shifting the following entries right. The page must have room for the entry,
+   * see HasRoomFor(); the tree splits full internal pages through a scratch buffer instead.
+   */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  /** Remove the key/child pair at index, shifting the following entries left. */
+  void Remove(int index);
 
- private:
-  // Flexible array member for page data.
-  MappingType array_[1];
+  /** Replace all entries by count entries from a scratch buffer. They must fit. */
+  void SetEntries(const MappingType *items, int count);
 };
 }  // namespace bustub
@@ -13,46 +13,78 @@
 #include <utility>
 #include <vector>
 
-#include "storage/page/b_plus_tree_page.h"
+#include "storage/page/b_plus_tree_compressed_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+/**
+ * Entries are prefix compressed, so how many fit depends on the keys. The max size only caps the count, at the number
+ * that fits uncompressed in two pages, so that either half of a split page fits whatever its keys.
+ */
+#define LEAF_PAGE_SIZE (2 * (B_PLUS_TREE_PAGE_DATA_SIZE / (sizeof(KeyType) + sizeof(ValueType))) - 2)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
- * Leaf page format (keys are stored in order):
+ * Leaf page format (keys are stored in order, prefix compressed, see BPlusTreeCompressedPage):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
- *  ---------------------------------------------------------------------
- * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
- *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ * The high key is an upper bound of the keys in the page, exclusive, and is
+ * only maintained by B-link trees. The last page of the chain has no high key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-class BPlusTreeLeafPage : public BPlusTreePage {
+class BPlusTreeLeafPage : public BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator> {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
   // helper methods
-  auto GetNextPageId() const -> page_id_t;
-  void SetNextPageId(page_id_t next_page_id);
-  auto KeyAt(int index) const -> KeyType;
-
- private:
-  page_id_t next_page_id_;
-  // Flexible array member for page data.
-  MappingType array_[1];
+  auto GetItem(int index) const -> MappingType;
+
+  /** @return the index of the first key not less than key, i.e. where key is or would be inserted */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /** @return the index of the first key greater than key */
+  auto UpperKeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * Look up a key.
+   * @param[out] value the value of the key, if present
+   * @return true if the key is present
+   */
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+
+  /**
+   * Insert a key/value pair in key order. The page must have room for the entry, see HasRoomFor().
+   * @return false if the key is already present
+   */
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
+
+  /**
+   * Remove a key.
+   * @return false if the key is not present
+   */
+  auto Remove(const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  /** Move the upper half of the entries to an empty recipient, used to split this page. */
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+
+  /**
+   * Append all entries to the recipient, the left neighbour of this page, and unlink this page from the chain; the
+   * caller points the prev link of the next page at the recipient. The recipient must be able to absorb them, see
+   * CanAbsorb().
+   */
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+
+  /** Move the first entry to the end of the recipient, the left neighbour of this page. It must fit. */
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+
+  /** Move the last entry to the front of the recipient, the right neighbour of this page. It must fit. */
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 };
 }  // namespace bustub
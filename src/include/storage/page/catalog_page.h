@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// catalog_page.h
+//
+// Identification: src/include/storage/page/catalog_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * The catalog is kept serialized in a chain of catalog pages, the first of which the header page records under
+ * CATALOG_RECORD_NAME. Each page holds the next part of the serialized catalog.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------
+ * | NextPageId (4) | DataSize (4) | Data (DataSize) ...     |
+ *  ---------------------------------------------------------
+ */
+class CatalogPage : public Page {
+ public:
+  /** The header page record of the first catalog page */
+  static constexpr const char *CATALOG_RECORD_NAME = "__catalog";
+  /** The number of bytes of the catalog a page holds */
+  static constexpr uint32_t CAPACITY = BUSTUB_PAGE_SIZE - 8;
+
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetData(nullptr, 0);
+  }
+
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+  void SetNextPageId(page_id_t next_page_id) { memcpy(GetData(), &next_page_id, sizeof(page_id_t)); }
+
+  auto GetDataSize() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+  auto GetCatalogData() -> const char * { return GetData() + OFFSET_DATA; }
+
+  /**
+   * Replace the part of the catalog the page holds.
+   * @param data the bytes to store
+   * @param size how many, at most CAPACITY
+   */
+  void SetData(const char *data, uint32_t size) {
+    memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(uint32_t));
+    if (size > 0) {
+      memcpy(GetData() + OFFSET_DATA, data, size);
+    }
+  }
+
+ private:
+  static constexpr size_t OFFSET_DATA_SIZE = 4;
+  static constexpr size_t OFFSET_DATA = 8;
+};
+
+}  // namespace bustub
@@ -19,7 +19,8 @@ namespace bustub {
 /**
  * Database use the first page (page_id = 0) as header page to store metadata, in
  * our case, we will contain information about table/index name (length less than
- * 32 bytes) and their corresponding root_id
+ * 32 bytes) and their corresponding root_id. The catalog record leads to the
+ * catalog pages, see CatalogPage.
  *
  * Format (size in byte):
  *  -----------------------------------------------------------------
@@ -28,6 +29,9 @@ namespace bustub {
  */
 class HeaderPage : public Page {
  public:
+  /** The number of records that fit in the page */
+  static constexpr int MAX_RECORD_COUNT = (BUSTUB_PAGE_SIZE - 4) / 36;
+
   void Init() { SetRecordCount(0); }
   /**
    * Record related
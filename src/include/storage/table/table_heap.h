@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -55,9 +60,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param ring the private buffer ring of a bulk insert, or nullptr
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferRing *ring = nullptr) -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,12 +101,30 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param acquire_read_lock whether to take the tuple's read lock
+   * @param ring the private buffer ring of the scan performing the read, or nullptr
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true,
+                BufferRing *ring = nullptr) -> bool;
+
+  /**
+   * @param txn the transaction performing the scan
+   * @param readahead_window how many pages ahead of the current page the iterator prefetches, 0 disables read-ahead
+   * @param ring a private buffer ring for the scan, or nullptr to go through the buffer pool like any other access
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, size_t readahead_window = 0, BufferRing *ring = nullptr) -> TableIterator;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * @param page_id a page of this table
+   * @param txn the transaction performing the scan
+   * @param readahead_window how many pages ahead of the current page the iterator prefetches, 0 disables read-ahead
+   * @param ring a private buffer ring for the scan, or nullptr to go through the buffer pool like any other access
+   * @return an iterator at the first tuple of the page, or of the first page after it that has one
+   */
+  auto BeginAt(page_id_t page_id, Transaction *txn, size_t readahead_window = 0, BufferRing *ring = nullptr)
+      -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -108,11 +132,56 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * @return the ids of the pages of this table in chain order, which a parallel scan splits into morsels. Only the
+   * pages past the part of the chain the table already knows are read.
+   */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /**
+   * @param page_id a page of this table
+   * @return the position of the page in the chain, or the number of pages known if the chain is not known that far
+   */
+  auto GetChainPosition(page_id_t page_id) -> size_t;
+
+  /**
+   * Create a private buffer ring for a scan or bulk insert over this table, if the table is large enough to need one.
+   * As in PostgreSQL, tables of up to a quarter of the buffer pool are read through the buffer pool as usual, so that
+   * they can stay cached between scans.
+   * @return the ring, or nullptr if the table is small
+   */
+  auto MakeScanRing() -> std::unique_ptr<BufferRing>;
+
  private:
+  /**
+   * Record that next_page_id follows page_id in the page chain. Pages are only ever linked at the end of the chain,
+   * so the known part of the chain is always a prefix of it.
+   */
+  void RememberNextPage(page_id_t page_id, page_id_t next_page_id);
+
+  /**
+   * Prefetch the pages following page_id in the chain, as far as the chain is known.
+   * @param page_id the page the scan is on
+   * @param window how many pages ahead of page_id to keep prefetched
+   * @param[in,out] horizon chain position up to which pages have already been prefetched by this scan
+   * @param ring the private buffer ring of the scan, or nullptr
+   */
+  void ReadAhead(page_id_t page_id, size_t window, size_t *horizon, BufferRing *ring);
+
+  /** Fetch a page, through the ring if there is one. */
+  auto FetchPage(page_id_t page_id, BufferRing *ring) -> Page *;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+
+  /** Protects the known prefix of the page chain. */
+  std::mutex chain_latch_;
+  /** Ids of the pages of the table in chain order, as far as they are known. */
+  std::vector<page_id_t> page_chain_;
+  /** Position of each known page in page_chain_. */
+  std::unordered_map<page_id_t, size_t> chain_positions_;
 };
 
 }  // namespace bustub
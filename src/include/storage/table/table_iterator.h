@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_ring.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +30,23 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * @param table_heap the table to iterate over
+   * @param rid the tuple the iterator starts at
+   * @param txn the transaction performing the scan
+   * @param readahead_window how many pages ahead of the current page to prefetch, 0 disables read-ahead
+   * @param ring the private buffer ring of the scan, or nullptr
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, size_t readahead_window = 0,
+                BufferRing *ring = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        readahead_window_(other.readahead_window_),
+        readahead_horizon_(other.readahead_horizon_),
+        ring_(other.ring_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,6 +68,9 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    readahead_window_ = other.readahead_window_;
+    readahead_horizon_ = other.readahead_horizon_;
+    ring_ = other.ring_;
     return *this;
   }
 
@@ -61,6 +78,12 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** How many pages ahead of the current page to prefetch. */
+  size_t readahead_window_;
+  /** Position in the page chain up to which pages have been prefetched. */
+  size_t readahead_horizon_{0};
+  /** The private buffer ring of the scan, not owned. */
+  BufferRing *ring_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,252 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** A term of the form `column op constant`. */
+struct RangeTerm {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+/** Split a predicate into the terms of its top-level conjunction. */
+void SplitConjunction(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *terms) {
+  const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+  if (logic != nullptr && logic->logic_type_ == LogicType::And) {
+    SplitConjunction(logic->GetChildAt(0), terms);
+    SplitConjunction(logic->GetChildAt(1), terms);
+    return;
+  }
+  terms->push_back(expr);
+}
+
+/** @return the comparison that holds with its operands swapped */
+auto Mirror(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+/** @return the term as a comparison of a column of schema with a constant, the column on the left */
+auto MatchRangeTerm(const AbstractExpression &expr, const Schema &schema) -> std::optional<RangeTerm> {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comparison == nullptr || comparison->comp_type_ == ComparisonType::NotEqual) {
+    return std::nullopt;
+  }
+  ComparisonType comp_type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+    comp_type = Mirror(comp_type);
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0) {
+    return std::nullopt;
+  }
+  // keys only encode values of the column's own type, and NULL matches nothing
+  if (constant->val_.IsNull() || constant->val_.GetTypeId() != schema.GetColumn(column->GetColIdx()).GetType()) {
+    return std::nullopt;
+  }
+  return RangeTerm{column->GetColIdx(), comp_type, constant->val_};
+}
+
+/** One end of the range of a column. */
+struct ColumnBound {
+  Value value_;
+  bool inclusive_;
+};
+
+/** Replace bound by candidate if that one is tighter. @param lower whether these are low bounds */
+void Tighten(std::optional<ColumnBound> *bound, const ColumnBound &candidate, bool lower) {
+  if (!bound->has_value()) {
+    *bound = candidate;
+    return;
+  }
+  const Value &current = (*bound)->value_;
+  if (candidate.value_.CompareEquals(current) == CmpBool::CmpTrue) {
+    (*bound)->inclusive_ = (*bound)->inclusive_ && candidate.inclusive_;
+    return;
+  }
+  const CmpBool tighter =
+      lower ? candidate.value_.CompareGreaterThan(current) : candidate.value_.CompareLessThan(current);
+  if (tighter == CmpBool::CmpTrue) {
+    *bound = candidate;
+  }
+}
+
+/** How an index matches the terms of a conjunction. */
+struct IndexMatch {
+  index_oid_t index_oid_;
+  /** The terms that pin the leading key columns to a value, one per column. */
+  std::vector<size_t> equal_terms_;
+  /** The comparisons of the key column after those. */
+  std::vector<size_t> range_terms_;
+
+  /** @return the number of key columns the scan bounds */
+  auto Columns() const -> size_t { return equal_terms_.size() + (range_terms_.empty() ? 0 : 1); }
+};
+
+/**
+ * Match the terms against the key columns of an index: equalities on its leading columns, then any other comparisons
+ * of the column after those.
+ */
+auto MatchTerms(const IndexInfo &index, const std::vector<std::optional<RangeTerm>> &range_terms) -> IndexMatch {
+  IndexMatch match{index.index_oid_, {}, {}};
+  for (const uint32_t key_attr : index.index_->GetKeyAttrs()) {
+    std::optional<size_t> equal_term;
+    std::vector<size_t> column_terms;
+    for (size_t i = 0; i < range_terms.size(); i++) {
+      if (!range_terms[i].has_value() || range_terms[i]->col_idx_ != key_attr) {
+        continue;
+      }
+      if (range_terms[i]->comp_type_ == ComparisonType::Equal && !equal_term.has_value()) {
+        equal_term = i;
+      } else {
+        column_terms.push_back(i);
+      }
+    }
+    if (!equal_term.has_value()) {
+      match.range_terms_ = std::move(column_terms);
+      break;
+    }
+    // other comparisons of the column stay in the filter
+    match.equal_terms_.push_back(*equal_term);
+  }
+  return match;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // the rows a delete or an update writes would move under an index scan that feeds it
+  if (plan->GetType() == PlanType::Delete || plan->GetType() == PlanType::Update) {
+    return plan;
+  }
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+  const auto &child_plan = optimized_plan->children_[0];
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+
+  // scan the index that bounds the most key columns
+  std::vector<AbstractExpressionRef> terms;
+  SplitConjunction(filter_plan.GetPredicate(), &terms);
+  std::vector<std::optional<RangeTerm>> range_terms;
+  range_terms.reserve(terms.size());
+  for (const auto &term : terms) {
+    range_terms.push_back(MatchRangeTerm(*term, seq_scan.OutputSchema()));
+  }
+  std::optional<IndexMatch> best;
+  for (const auto *index : catalog_.GetTableIndexes(seq_scan.table_name_)) {
+    IndexMatch match = MatchTerms(*index, range_terms);
+    if (match.Columns() > 0 && (!best.has_value() || match.Columns() > best->Columns())) {
+      best = std::move(match);
+    }
+  }
+  if (!best.has_value()) {
+    return optimized_plan;
+  }
+
+  // the equalities make the common prefix of the bounds, and the comparisons of the next column their last value
+  std::vector<Value> prefix;
+  std::vector<bool> consumed(terms.size(), false);
+  for (const size_t i : best->equal_terms_) {
+    prefix.push_back(range_terms[i]->value_);
+    consumed[i] = true;
+  }
+  std::optional<ColumnBound> low_value;
+  std::optional<ColumnBound> high_value;
+  for (const size_t i : best->range_terms_) {
+    const Value &value = range_terms[i]->value_;
+    switch (range_terms[i]->comp_type_) {
+      case ComparisonType::Equal:
+        Tighten(&low_value, {value, true}, true);
+        Tighten(&high_value, {value, true}, false);
+        break;
+      case ComparisonType::LessThan:
+        Tighten(&high_value, {value, false}, false);
+        break;
+      case ComparisonType::LessThanOrEqual:
+        Tighten(&high_value, {value, true}, false);
+        break;
+      case ComparisonType::GreaterThan:
+        Tighten(&low_value, {value, false}, true);
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        Tighten(&low_value, {value, true}, true);
+        break;
+      default:
+        UNREACHABLE("not equal is no range");
+    }
+    consumed[i] = true;
+  }
+  const auto make_bound = [&prefix](const std::optional<ColumnBound> &column_bound) -> std::optional<IndexKeyBound> {
+    if (!column_bound.has_value()) {
+      if (prefix.empty()) {
+        return std::nullopt;
+      }
+      return IndexKeyBound{prefix, true};
+    }
+    std::vector<Value> values = prefix;
+    values.push_back(column_bound->value_);
+    return IndexKeyBound{std::move(values), column_bound->inclusive_};
+  };
+  std::vector<AbstractExpressionRef> residual;
+  for (size_t i = 0; i < terms.size(); i++) {
+    if (!consumed[i]) {
+      residual.push_back(terms[i]);
+    }
+  }
+
+  AbstractPlanNodeRef index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, best->index_oid_,
+                                                                       make_bound(low_value), make_bound(high_value));
+  if (residual.empty()) {
+    return index_scan;
+  }
+  AbstractExpressionRef predicate = residual[0];
+  for (size_t i = 1; i < residual.size(); i++) {
+    predicate = std::make_shared<LogicExpression>(predicate, residual[i], LogicType::And);
+  }
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, predicate, index_scan);
+}
+
+}  // namespace bustub
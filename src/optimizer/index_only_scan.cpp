@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Mark the columns expr reads of the input tuple_idx of its plan; any input if tuple_idx is none. */
+void MarkColumns(const AbstractExpression &expr, std::optional<uint32_t> tuple_idx, std::vector<bool> *columns) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(&expr); column != nullptr) {
+    if ((!tuple_idx.has_value() || column->GetTupleIdx() == *tuple_idx) && column->GetColIdx() < columns->size()) {
+      (*columns)[column->GetColIdx()] = true;
+    }
+    return;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    MarkColumns(*child, tuple_idx, columns);
+  }
+}
+
+/** @return the count marks of required from begin on: those of the output columns one input of a join adds */
+auto Slice(const std::vector<bool> &required, size_t begin, size_t count) -> std::vector<bool> {
+  std::vector<bool> columns(count, false);
+  for (size_t i = 0; i < count && begin + i < required.size(); i++) {
+    columns[i] = required[begin + i];
+  }
+  return columns;
+}
+
+/**
+ * @return for each child of plan, which of its output columns plan reads when the plans above read the columns of
+ * plan marked in required
+ */
+auto ReadColumns(const AbstractPlanNode &plan, const std::vector<bool> &required) -> std::vector<std::vector<bool>> {
+  std::vector<std::vector<bool>> read;
+  for (const auto &child : plan.GetChildren()) {
+    read.emplace_back(child->OutputSchema().GetColumnCount(), false);
+  }
+  switch (plan.GetType()) {
+    case PlanType::Projection: {
+      const auto &expressions = dynamic_cast<const ProjectionPlanNode &>(plan).GetExpressions();
+      for (size_t i = 0; i < expressions.size(); i++) {
+        if (required[i]) {
+          MarkColumns(*expressions[i], 0, &read[0]);
+        }
+      }
+      return read;
+    }
+    case PlanType::Filter:
+      read[0] = required;
+      MarkColumns(*dynamic_cast<const FilterPlanNode &>(plan).GetPredicate(), 0, &read[0]);
+      return read;
+    case PlanType::Sort:
+      read[0] = required;
+      for (const auto &[order_type, expr] : dynamic_cast<const SortPlanNode &>(plan).GetOrderBy()) {
+        MarkColumns(*expr, 0, &read[0]);
+      }
+      return read;
+    case PlanType::TopN:
+      read[0] = required;
+      for (const auto &[order_type, expr] : dynamic_cast<const TopNPlanNode &>(plan).GetOrderBy()) {
+        MarkColumns(*expr, 0, &read[0]);
+      }
+      return read;
+    case PlanType::Limit:
+      read[0] = required;
+      return read;
+    case PlanType::Exchange:
+      read[0] = required;
+      for (const auto &expr : dynamic_cast<const ExchangePlanNode &>(plan).GetPartitionKeys()) {
+        MarkColumns(*expr, 0, &read[0]);
+      }
+      return read;
+    case PlanType::Aggregation: {
+      const auto &aggregation = dynamic_cast<const AggregationPlanNode &>(plan);
+      for (const auto &expr : aggregation.GetGroupBys()) {
+        MarkColumns(*expr, 0, &read[0]);
+      }
+      for (const auto &expr : aggregation.GetAggregates()) {
+        MarkColumns(*expr, 0, &read[0]);
+      }
+      return read;
+    }
+    case PlanType::NestedLoopJoin: {
+      // the output is the left columns, then the right ones
+      const auto &predicate = dynamic_cast<const NestedLoopJoinPlanNode &>(plan).Predicate();
+      read[0] = Slice(required, 0, read[0].size());
+      read[1] = Slice(required, read[0].size(), read[1].size());
+      MarkColumns(predicate, 0, &read[0]);
+      MarkColumns(predicate, 1, &read[1]);
+      return read;
+    }
+    case PlanType::NestedIndexJoin:
+      read[0] = Slice(required, 0, read[0].size());
+      MarkColumns(*dynamic_cast<const NestedIndexJoinPlanNode &>(plan).KeyPredicate(), 0, &read[0]);
+      return read;
+    default:
+      // the plan may read any column of its children
+      for (auto &columns : read) {
+        columns.assign(columns.size(), true);
+      }
+      return read;
+  }
+}
+
+/** @return whether the entries of an index store every column marked in required */
+auto Covers(const Index &index, const std::vector<bool> &required) -> bool {
+  const auto &entry_attrs = index.GetEntryAttrs();
+  for (uint32_t i = 0; i < required.size(); i++) {
+    if (required[i] && std::find(entry_attrs.begin(), entry_attrs.end(), i) == entry_attrs.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // whatever runs the plan reads all of its output
+  return OptimizeIndexOnlyScan(plan, std::vector<bool>(plan->OutputSchema().GetColumnCount(), true));
+}
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan, const std::vector<bool> &required)
+    -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::IndexScan) {
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*plan);
+    const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+    if (!index_scan.index_only_ && Covers(*index_info->index_, required)) {
+      return std::make_shared<IndexScanPlanNode>(index_scan.output_schema_, index_scan.index_oid_, index_scan.low_,
+                                                 index_scan.high_, index_scan.reverse_, true);
+    }
+    return plan;
+  }
+
+  const auto read = ReadColumns(*plan, required);
+  std::vector<AbstractPlanNodeRef> children;
+  for (size_t i = 0; i < plan->GetChildren().size(); i++) {
+    children.emplace_back(OptimizeIndexOnlyScan(plan->GetChildAt(i), read[i]));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::NestedIndexJoin) {
+    // the output is the outer columns, then those of the inner table, which the join looks up in the index
+    const auto &join = dynamic_cast<const NestedIndexJoinPlanNode &>(*optimized_plan);
+    const auto *index_info = catalog_.GetIndex(join.GetIndexOid());
+    const size_t outer_columns = join.GetChildPlan()->OutputSchema().GetColumnCount();
+    if (!join.index_only_ &&
+        Covers(*index_info->index_, Slice(required, outer_columns, join.InnerTableSchema().GetColumnCount()))) {
+      auto index_only_join = std::make_shared<NestedIndexJoinPlanNode>(join);
+      index_only_join->index_only_ = true;
+      return index_only_join;
+    }
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
@@ -1,5 +1,9 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "catalog/column.h"
 #include "catalog/schema.h"
 #include "common/exception.h"
@@ -7,6 +11,7 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/hash_join_plan.h"
@@ -17,6 +22,59 @@
 
 namespace bustub {
 
+namespace {
+
+/** Append the conjuncts of expr, the expressions it ANDs together, to conjuncts */
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    SplitConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** @return the left and right join keys if expr is <column_expr> = <column_expr>, one from each side of the join */
+auto AsJoinKeys(const AbstractExpression &expr)
+    -> std::optional<std::pair<AbstractExpressionRef, AbstractExpressionRef>> {
+  const auto *comparison_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comparison_expr == nullptr || comparison_expr->comp_type_ != ComparisonType::Equal) {
+    return std::nullopt;
+  }
+  const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(comparison_expr->children_[0].get());
+  const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(comparison_expr->children_[1].get());
+  if (left_expr == nullptr || right_expr == nullptr || left_expr->GetTupleIdx() == right_expr->GetTupleIdx()) {
+    return std::nullopt;
+  }
+  // Each key is evaluated on the tuples of its own side, as tuple 0
+  auto left_expr_tuple_0 =
+      std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
+  auto right_expr_tuple_0 =
+      std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
+  if (left_expr->GetTupleIdx() == 0) {
+    return std::make_pair(std::move(left_expr_tuple_0), std::move(right_expr_tuple_0));
+  }
+  return std::make_pair(std::move(right_expr_tuple_0), std::move(left_expr_tuple_0));
+}
+
+/** @return expr, over the two sides of a join, as an expression over the output of the join */
+auto OverJoinOutput(const AbstractExpressionRef &expr, uint32_t left_column_count) -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    const uint32_t offset = column_value_expr->GetTupleIdx() == 0 ? 0 : left_column_count;
+    return std::make_shared<ColumnValueExpression>(0, offset + column_value_expr->GetColIdx(),
+                                                   column_value_expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(OverJoinOutput(child, left_column_count));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -29,33 +87,32 @@ auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> Abstra
     // Has exactly two children
     BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
 
-    // Check if expr is equal condition where one is for the left table, and one is for the right table.
-    if (const auto *expr = dynamic_cast<const ComparisonExpression *>(&nlj_plan.Predicate()); expr != nullptr) {
-      if (expr->comp_type_ == ComparisonType::Equal) {
-        if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-            left_expr != nullptr) {
-          if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
-            // Ensure both exprs have tuple_id == 0
-            auto left_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
-            auto right_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
-            // Now it's in form of <column_expr> = <column_expr>. Let's check if one of them is from the left table, and
-            // the other is from the right table.
-            if (left_expr->GetTupleIdx() == 0 && right_expr->GetTupleIdx() == 1) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(left_expr_tuple_0),
-                                                        std::move(right_expr_tuple_0), nlj_plan.GetJoinType());
-            }
-            if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(right_expr_tuple_0),
-                                                        std::move(left_expr_tuple_0), nlj_plan.GetJoinType());
-            }
-          }
-        }
+    // Join on the first conjunct of the predicate that is an equi-condition between the left and the right table. An
+    // inner join checks the others in a filter over the hash join; an outer join must check them while joining.
+    std::vector<AbstractExpressionRef> conjuncts;
+    SplitConjuncts(nlj_plan.predicate_, &conjuncts);
+    if (conjuncts.size() > 1 && nlj_plan.GetJoinType() != JoinType::INNER) {
+      return optimized_plan;
+    }
+    for (auto it = conjuncts.begin(); it != conjuncts.end(); ++it) {
+      auto keys = AsJoinKeys(**it);
+      if (!keys.has_value()) {
+        continue;
+      }
+      auto hash_join_plan =
+          std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), nlj_plan.GetRightPlan(),
+                                             std::move(keys->first), std::move(keys->second), nlj_plan.GetJoinType());
+      conjuncts.erase(it);
+      if (conjuncts.empty()) {
+        return hash_join_plan;
+      }
+      const uint32_t left_column_count = nlj_plan.GetLeftPlan()->OutputSchema().GetColumnCount();
+      auto predicate = OverJoinOutput(conjuncts[0], left_column_count);
+      for (size_t i = 1; i < conjuncts.size(); i++) {
+        predicate = std::make_shared<LogicExpression>(std::move(predicate),
+                                                      OverJoinOutput(conjuncts[i], left_column_count), LogicType::And);
       }
+      return std::make_shared<FilterPlanNode>(nlj_plan.output_schema_, std::move(predicate), std::move(hash_join_plan));
     }
   }
 
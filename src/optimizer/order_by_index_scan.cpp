@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -21,6 +23,31 @@
 
 namespace bustub {
 
+namespace {
+
+/**
+ * @return whether an index scan returns its entries ordered by a column: one of the key columns, such that the bounds
+ * of the scan pin every key column before it to a single value
+ */
+auto IsScanOrderedBy(const IndexScanPlanNode &index_scan, const std::vector<uint32_t> &key_attrs, uint32_t column_id)
+    -> bool {
+  const auto &low = index_scan.low_;
+  const auto &high = index_scan.high_;
+  for (size_t i = 0; i < key_attrs.size(); i++) {
+    if (key_attrs[i] == column_id) {
+      return true;
+    }
+    // keys between two bounds that agree on a column have its value
+    if (!low.has_value() || !high.has_value() || low->values_.size() <= i || high->values_.size() <= i ||
+        low->values_[i].CompareEquals(high->values_[i]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -37,11 +64,12 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc; a desc order scans the index backwards
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (order_type == OrderByType::INVALID) {
       return optimized_plan;
     }
+    const bool reverse = order_type == OrderByType::DESC;
 
     // Order expression is a column value expression
     const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -61,12 +89,32 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
-        const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
-            columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
+        // entries come in the order of the first key column
+        if (index->index_->GetKeyAttrs()[0] == order_by_column_id) {
           // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, std::nullopt,
+                                                     std::nullopt, reverse);
+        }
+      }
+    }
+
+    // A range scan, which OptimizeFilterAsIndexScan made out of a filter, already comes out in the order of the first
+    // key column its bounds do not pin to a value; so does what is left of the filter on top of it.
+    const AbstractPlanNodeRef *scan_plan = &child_plan;
+    if (child_plan->GetType() == PlanType::Filter) {
+      scan_plan = &child_plan->children_[0];
+    }
+    if ((*scan_plan)->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(**scan_plan);
+      const auto *index = catalog_.GetIndex(index_scan.GetIndexOid());
+      if (IsScanOrderedBy(index_scan, index->index_->GetKeyAttrs(), order_by_column_id)) {
+        AbstractPlanNodeRef ordered_scan = std::make_shared<IndexScanPlanNode>(
+            index_scan.output_schema_, index_scan.index_oid_, index_scan.low_, index_scan.high_, reverse,
+            index_scan.index_only_);
+        if (scan_plan == &child_plan) {
+          return ordered_scan;
         }
+        return child_plan->CloneWithChildren({ordered_scan});
       }
     }
   }
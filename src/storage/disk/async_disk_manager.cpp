@@ -0,0 +1,558 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Upper bound of the number of pages merged into one preadv/pwritev by the thread pool backend. */
+static constexpr size_t MAX_RUN_LENGTH = 64;
+
+/**
+ * One page read or write. The request is owned by the backend from submission until Complete().
+ */
+struct AsyncDiskManager::IoRequest {
+  ~IoRequest() {
+    if (io_buffer_ != user_buffer_) {
+      std::free(io_buffer_);  // NOLINT
+    }
+  }
+
+  auto Offset() const -> off_t { return static_cast<off_t>(page_id_) * BUSTUB_PAGE_SIZE; }
+
+  bool is_write_;
+  page_id_t page_id_;
+  /** The buffer handed to the kernel: either user_buffer_ or an aligned bounce buffer. */
+  char *io_buffer_;
+  /** The caller's buffer. */
+  char *user_buffer_;
+  /** Single-element vector for IORING_OP_READV / IORING_OP_WRITEV. */
+  struct iovec iov_;
+  std::promise<void> promise_;
+};
+
+/**
+ * A minimal io_uring driven through the raw io_uring_setup / io_uring_enter system calls (no liburing).
+ * Submissions must be serialized by the caller; completions are consumed by a single thread.
+ */
+class AsyncDiskManager::IoUring {
+ public:
+  /** @return a ring with at least `entries` submission slots, or nullptr if io_uring is unavailable */
+  static auto Create(unsigned entries) -> std::unique_ptr<IoUring> {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring(ring_fd));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    close(ring_fd_);
+  }
+
+  /** Queue one submission. iov may be nullptr for IORING_OP_NOP. */
+  void Prepare(uint8_t opcode, int fd, const struct iovec *iov, off_t offset, uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = iov == nullptr ? 0 : 1;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+  }
+
+  /** Hand every prepared submission to the kernel. @return 0 or -errno */
+  auto Submit() -> int {
+    while (to_submit_ > 0) {
+      auto ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, 0, 0, nullptr, 0);
+      if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          continue;
+        }
+        return -errno;
+      }
+      to_submit_ -= static_cast<unsigned>(ret);
+    }
+    return 0;
+  }
+
+  /**
+   * Take back the prepared submissions that the kernel did not consume, once Submit() failed.
+   * @return their user_data
+   */
+  auto Withdraw() -> std::vector<uint64_t> {
+    std::vector<uint64_t> user_data;
+    const unsigned tail = *sq_tail_;
+    for (unsigned i = tail - to_submit_; i != tail; i++) {
+      user_data.push_back(sqes_[sq_array_[i & *sq_mask_]].user_data);
+    }
+    __atomic_store_n(sq_tail_, tail - to_submit_, __ATOMIC_RELEASE);
+    to_submit_ = 0;
+    return user_data;
+  }
+
+  /** Wait until at least one completion is available, then pass every available (user_data, res) to func. */
+  template <typename Func>
+  void Reap(Func &&func) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      return;
+    }
+    for (; head != tail; head++) {
+      const struct io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      func(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+ private:
+  explicit IoUring(int ring_fd) : ring_fd_(ring_fd) {}
+
+  auto Map(const struct io_uring_params &params) -> bool {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = MapRegion(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) {
+      return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_ : MapRegion(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe *>(MapRegion(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  auto MapRegion(size_t size, off_t offset) -> void * {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  int ring_fd_;
+  unsigned to_submit_{0};
+  void *sq_ring_{nullptr};
+  void *cq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  struct io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  struct io_uring_cqe *cqes_{nullptr};
+};
+
+/**
+ * Constructor: open/create the database file (with O_DIRECT if possible) & log file, then start the backend
+ */
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, Backend backend, size_t queue_depth,
+                                   size_t num_threads)
+    : backend_(backend), queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  file_name_ = db_file;
+  if (file_name_.rfind('.') == std::string::npos) {
+    throw Exception("wrong file format");
+  }
+  OpenLogFile(db_file);
+
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);  // NOLINT
+  direct_io_ = db_fd_ >= 0;
+  if (db_fd_ < 0 && errno == EINVAL) {
+    // the file system does not support O_DIRECT (e.g. tmpfs)
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    file_size_ = stat_buf.st_size;
+  }
+
+  if (backend_ != Backend::THREAD_POOL) {
+    uring_ = IoUring::Create(static_cast<unsigned>(queue_depth_));
+    if (uring_ == nullptr && backend_ == Backend::IO_URING) {
+      LOG_WARN("io_uring is not available, falling back to the thread pool backend");
+    }
+  }
+  if (uring_ != nullptr) {
+    backend_ = Backend::IO_URING;
+    completion_thread_ = std::thread(&AsyncDiskManager::ReapCompletions, this);
+  } else {
+    backend_ = Backend::THREAD_POOL;
+    for (size_t i = 0; i < std::max<size_t>(num_threads, 1); i++) {
+      workers_.emplace_back(&AsyncDiskManager::RunWorker, this);
+    }
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() { ShutDown(); }
+
+/**
+ * Drain all in-flight I/O, stop the backend and close all files
+ */
+void AsyncDiskManager::ShutDown() {
+  if (shut_down_) {
+    return;
+  }
+  shut_down_ = true;
+
+  if (backend_ == Backend::IO_URING) {
+    {
+      std::unique_lock<std::mutex> lock(submit_latch_);
+      slot_cv_.wait(lock, [&] { return in_flight_ == 0; });
+      // user_data == 0 tells the completion thread to exit
+      uring_->Prepare(IORING_OP_NOP, -1, nullptr, 0, 0);
+      uring_->Submit();
+    }
+    completion_thread_.join();
+    uring_.reset();
+  } else {
+    {
+      std::scoped_lock<std::mutex> lock(pending_latch_);
+      stop_workers_ = true;
+    }
+    pending_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  close(db_fd_);
+  DiskManager::ShutDown();
+}
+
+auto AsyncDiskManager::MakeRequest(bool is_write, page_id_t page_id, char *page_data) -> std::unique_ptr<IoRequest> {
+  auto request = std::make_unique<IoRequest>();
+  request->is_write_ = is_write;
+  request->page_id_ = page_id;
+  request->user_buffer_ = page_data;
+  request->io_buffer_ = page_data;
+  if (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0) {
+    // O_DIRECT needs an aligned buffer; stage the page through one
+    request->io_buffer_ = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE));
+    if (is_write) {
+      memcpy(request->io_buffer_, page_data, BUSTUB_PAGE_SIZE);
+    }
+  }
+  request->iov_.iov_base = request->io_buffer_;
+  request->iov_.iov_len = BUSTUB_PAGE_SIZE;
+  return request;
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  // check if read beyond file length, using the cached size instead of stat()
+  if (static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE >= file_size_.load()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    std::promise<void> promise;
+    promise.set_value();
+    return promise.get_future();
+  }
+  auto request = MakeRequest(false, page_id, page_data);
+  auto future = request->promise_.get_future();
+  std::vector<std::unique_ptr<IoRequest>> batch;
+  batch.emplace_back(std::move(request));
+  Submit(std::move(batch));
+  return future;
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  auto request = MakeRequest(true, page_id, const_cast<char *>(page_data));
+  auto future = request->promise_.get_future();
+  std::vector<std::unique_ptr<IoRequest>> batch;
+  batch.emplace_back(std::move(request));
+  Submit(std::move(batch));
+  return future;
+}
+
+void AsyncDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  try {
+    WritePageAsync(page_id, page_data).get();
+  } catch (Exception &e) {
+    LOG_DEBUG("I/O error while writing");
+  }
+}
+
+void AsyncDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  try {
+    ReadPageAsync(page_id, page_data).get();
+  } catch (Exception &e) {
+    LOG_DEBUG("I/O error while reading");
+  }
+}
+
+void AsyncDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  std::vector<std::unique_ptr<IoRequest>> batch;
+  std::vector<std::future<void>> futures;
+  for (const auto &[page_id, page_data] : pages) {
+    batch.emplace_back(MakeRequest(true, page_id, const_cast<char *>(page_data)));
+    futures.emplace_back(batch.back()->promise_.get_future());
+  }
+  Submit(std::move(batch));
+  for (auto &future : futures) {
+    try {
+      future.get();
+    } catch (Exception &e) {
+      LOG_DEBUG("I/O error while writing");
+    }
+  }
+}
+
+void AsyncDiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  std::vector<std::unique_ptr<IoRequest>> batch;
+  std::vector<std::future<void>> futures;
+  const int64_t file_size = file_size_.load();
+  for (const auto &[page_id, page_data] : pages) {
+    if (static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE >= file_size) {
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+      continue;
+    }
+    batch.emplace_back(MakeRequest(false, page_id, page_data));
+    futures.emplace_back(batch.back()->promise_.get_future());
+  }
+  Submit(std::move(batch));
+  for (auto &future : futures) {
+    try {
+      future.get();
+    } catch (Exception &e) {
+      LOG_DEBUG("I/O error while reading");
+    }
+  }
+}
+
+void AsyncDiskManager::Submit(std::vector<std::unique_ptr<IoRequest>> requests) {
+  if (requests.empty()) {
+    return;
+  }
+  BUSTUB_ASSERT(!shut_down_, "submitting I/O to a disk manager that has been shut down");
+
+  if (backend_ == Backend::IO_URING) {
+    std::unique_lock<std::mutex> lock(submit_latch_);
+    size_t next = 0;
+    while (next < requests.size()) {
+      // never have more requests in flight than the completion queue can hold
+      slot_cv_.wait(lock, [&] { return in_flight_ < queue_depth_; });
+      for (; next < requests.size() && in_flight_ < queue_depth_; next++) {
+        auto *request = requests[next].release();
+        if (request->is_write_) {
+          num_writes_ += 1;
+        }
+        uring_->Prepare(request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV, db_fd_, &request->iov_,
+                        request->Offset(), reinterpret_cast<uint64_t>(request));
+        in_flight_++;
+      }
+      if (const int error = uring_->Submit(); error < 0) {
+        // fail the requests the kernel did not take, and the rest of the batch, so that no one waits on them
+        const auto withdrawn = uring_->Withdraw();
+        in_flight_ -= withdrawn.size();
+        for (const uint64_t user_data : withdrawn) {
+          Complete(reinterpret_cast<IoRequest *>(user_data), error);
+        }
+        for (; next < requests.size(); next++) {
+          Complete(requests[next].release(), error);
+        }
+        lock.unlock();
+        slot_cv_.notify_all();
+        return;
+      }
+    }
+    return;
+  }
+
+  // Thread pool: merge requests for adjacent pages into runs that a worker issues as one preadv/pwritev.
+  std::sort(requests.begin(), requests.end(), [](const auto &a, const auto &b) {
+    return a->is_write_ != b->is_write_ ? a->is_write_ < b->is_write_ : a->page_id_ < b->page_id_;
+  });
+  std::vector<std::vector<std::unique_ptr<IoRequest>>> runs;
+  for (auto &request : requests) {
+    if (runs.empty() || runs.back().size() == MAX_RUN_LENGTH || runs.back().back()->is_write_ != request->is_write_ ||
+        runs.back().back()->page_id_ + 1 != request->page_id_) {
+      runs.emplace_back();
+    }
+    runs.back().emplace_back(std::move(request));
+  }
+  {
+    std::scoped_lock<std::mutex> lock(pending_latch_);
+    for (auto &run : runs) {
+      if (run.front()->is_write_) {
+        num_writes_ += static_cast<int>(run.size());
+      }
+      pending_runs_.emplace_back(std::move(run));
+    }
+  }
+  pending_cv_.notify_all();
+}
+
+void AsyncDiskManager::Complete(IoRequest *request, int64_t result) {
+  std::unique_ptr<IoRequest> owned(request);
+  // A write may stop short of the page, e.g. when the disk fills up. Finish it here, and fail the request once a write
+  // makes no progress, so that a page is never taken as written when part of it is not.
+  while (owned->is_write_ && result >= 0 && result < BUSTUB_PAGE_SIZE) {
+    ssize_t rest;
+    do {
+      rest = pwrite(db_fd_, owned->io_buffer_ + result, BUSTUB_PAGE_SIZE - result, owned->Offset() + result);
+    } while (rest < 0 && errno == EINTR);
+    if (rest <= 0) {
+      result = rest < 0 ? -errno : -ENOSPC;
+    } else {
+      result += rest;
+    }
+  }
+  if (result < 0) {
+    owned->promise_.set_exception(std::make_exception_ptr(
+        Exception(std::string(owned->is_write_ ? "I/O error while writing: " : "I/O error while reading: ") +
+                  strerror(static_cast<int>(-result)))));
+    return;
+  }
+  if (owned->is_write_) {
+    const int64_t end = owned->Offset() + BUSTUB_PAGE_SIZE;
+    int64_t size = file_size_.load();
+    while (size < end && !file_size_.compare_exchange_weak(size, end)) {
+    }
+  } else {
+    if (result < BUSTUB_PAGE_SIZE) {
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      memset(owned->io_buffer_ + result, 0, BUSTUB_PAGE_SIZE - result);
+    }
+    if (owned->io_buffer_ != owned->user_buffer_) {
+      memcpy(owned->user_buffer_, owned->io_buffer_, BUSTUB_PAGE_SIZE);
+    }
+  }
+  owned->promise_.set_value();
+}
+
+void AsyncDiskManager::ReapCompletions() {
+  bool stop = false;
+  while (!stop) {
+    uring_->Reap([&](uint64_t user_data, int32_t res) {
+      if (user_data == 0) {
+        stop = true;
+        return;
+      }
+      Complete(reinterpret_cast<IoRequest *>(user_data), res);
+      {
+        std::scoped_lock<std::mutex> lock(submit_latch_);
+        in_flight_--;
+      }
+      slot_cv_.notify_all();
+    });
+  }
+}
+
+void AsyncDiskManager::RunWorker() {
+  while (true) {
+    std::vector<std::unique_ptr<IoRequest>> run;
+    {
+      std::unique_lock<std::mutex> lock(pending_latch_);
+      pending_cv_.wait(lock, [&] { return stop_workers_ || !pending_runs_.empty(); });
+      if (pending_runs_.empty()) {
+        // stop_workers_ is set and everything submitted has been executed
+        return;
+      }
+      run = std::move(pending_runs_.front());
+      pending_runs_.pop_front();
+    }
+    ExecuteRun(std::move(run));
+  }
+}
+
+void AsyncDiskManager::ExecuteRun(std::vector<std::unique_ptr<IoRequest>> run) {
+  std::vector<struct iovec> iovs;
+  iovs.reserve(run.size());
+  for (const auto &request : run) {
+    iovs.push_back(request->iov_);
+  }
+  const bool is_write = run.front()->is_write_;
+  const off_t offset = run.front()->Offset();
+  ssize_t result;
+  do {
+    result = is_write ? pwritev(db_fd_, iovs.data(), static_cast<int>(iovs.size()), offset)
+                      : preadv(db_fd_, iovs.data(), static_cast<int>(iovs.size()), offset);
+  } while (result < 0 && errno == EINTR);
+  const int64_t error = result < 0 ? -errno : 0;
+
+  int64_t remaining = result;
+  for (auto &request : run) {
+    if (result < 0) {
+      Complete(request.release(), error);
+      continue;
+    }
+    // after a short vectored write, Complete() finishes the pages it did not fully write
+    const int64_t transferred = std::min<int64_t>(remaining, BUSTUB_PAGE_SIZE);
+    remaining -= transferred;
+    Complete(request.release(), transferred);
+  }
+}
+
+}  // namespace bustub
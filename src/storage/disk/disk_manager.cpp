@@ -36,18 +36,7 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
+  OpenLogFile(db_file);
 
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
@@ -63,6 +52,25 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   buffer_used = nullptr;
 }
 
+/**
+ * Open the log file that belongs to db_file, creating it if necessary
+ */
+void DiskManager::OpenLogFile(const std::string &db_file) {
+  std::string::size_type n = db_file.rfind('.');
+  log_name_ = db_file.substr(0, n) + ".log";
+
+  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
+  // directory or file does not exist
+  if (!log_io_.is_open()) {
+    log_io_.clear();
+    // create a new file
+    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!log_io_.is_open()) {
+      throw Exception("can't open dblog file");
+    }
+  }
+}
+
 /**
  * Close all file streams
  */
@@ -122,6 +130,24 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write a batch of pages, one at a time
+ */
+void DiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    WritePage(page_id, page_data);
+  }
+}
+
+/**
+ * Read a batch of pages, one at a time
+ */
+void DiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    ReadPage(page_id, page_data);
+  }
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -184,6 +210,15 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Returns the number of whole or partly written pages in the database file
+ */
+auto DiskManager::GetNumPages() -> page_id_t {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  const int file_size = file_name_.empty() ? 0 : GetFileSize(file_name_);
+  return file_size <= 0 ? 0 : (file_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE;
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -1,27 +1,42 @@
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, BPlusTreeMode mode)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      mode_(mode) {
+  // beyond these, half of a full page may not fit in a page without compression, and splits would fail
+  BUSTUB_ASSERT(leaf_max_size_ <= static_cast<int>(LEAF_PAGE_SIZE), "leaf max size too large");
+  BUSTUB_ASSERT(internal_max_size_ <= static_cast<int>(INTERNAL_PAGE_SIZE), "internal max size too large");
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  root_latch_.RLock();
+  bool empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return empty;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -32,9 +47,230 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
+  Page *page = mode_ == BPlusTreeMode::B_LINK ? FindLeafBLink(&key, false, nullptr) : FindLeafRead(&key);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType *key, bool rightmost) -> Page * {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root: all frames are pinned");
+  }
+  page->RLatch();
+  root_latch_.RUnlock();
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_id = key == nullptr ? internal->ValueAt(rightmost ? internal->GetSize() - 1 : 0)
+                                        : internal->Lookup(*key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page: all frames are pinned");
+    }
+    child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key) -> Page * {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root: all frames are pinned");
+  }
+  // The type of a page never changes while it is reachable, so it can be read before latching the page.
+  bool is_leaf = reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage();
+  if (is_leaf) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!is_leaf) {
+    page_id_t child_id = reinterpret_cast<InternalPage *>(page->GetData())->Lookup(key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page: all frames are pinned");
+    }
+    is_leaf = reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage();
+    if (is_leaf) {
+      child->WLatch();
+    } else {
+      child->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPessimistic(const KeyType &key, Operation op, Transaction *transaction) -> Page * {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      ReleasePageSet(transaction, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a tree page: all frames are pinned");
+    }
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op, key)) {
+      ReleasePageSet(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(const BPlusTreePage *node, Operation op, const KeyType &key) const -> bool {
+  switch (op) {
+    case Operation::SEARCH:
+      return true;
+    case Operation::INSERT:
+      // the leaf is checked against the key itself; a separator from below can have any key
+      if (node->IsLeafPage()) {
+        return node->GetSize() + 1 < leaf_max_size_ && reinterpret_cast<const LeafPage *>(node)->HasRoomFor(key);
+      }
+      return node->GetSize() < internal_max_size_ && reinterpret_cast<const InternalPage *>(node)->HasRoomForAnyKey();
+    case Operation::REMOVE:
+      if (node->IsRootPage()) {
+        return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+      }
+      return !IsUnderfull(node, node->GetSize() - 1);
+  }
   return false;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsUnderfull(const BPlusTreePage *node, int size) const -> bool {
+  if (size >= node->GetMinSize()) {
+    return false;
+  }
+  const int entry_size = node->IsLeafPage() ? reinterpret_cast<const LeafPage *>(node)->GetEntrySize()
+                                            : reinterpret_cast<const InternalPage *>(node)->GetEntrySize();
+  return static_cast<size_t>(size * entry_size) < B_PLUS_TREE_PAGE_DATA_SIZE / 4;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePageSet(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+    }
+  }
+  page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewNode(page_id_t *page_id, Transaction *transaction) -> Page * {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    ReleasePageSet(transaction, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a tree page: all frames are pinned");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ParentOf(const BPlusTreePage *node, Transaction *transaction) -> InternalPage * {
+  for (Page *page : *transaction->GetPageSet()) {
+    if (page != nullptr && page->GetPageId() == node->GetParentPageId()) {
+      return reinterpret_cast<InternalPage *>(page->GetData());
+    }
+  }
+  UNREACHABLE("the parent of an unsafe node is in the page set");
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetParent(page_id_t child_id, page_id_t parent_id, Transaction *transaction) {
+  for (Page *page : *transaction->GetPageSet()) {
+    if (page != nullptr && page->GetPageId() == child_id) {
+      reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_id);
+      return;
+    }
+  }
+  // Only its parent, which we hold, leads a writer to the child, so waiting here cannot deadlock.
+  Page *page = buffer_pool_manager_->FetchPage(child_id);
+  if (page == nullptr) {
+    ReleasePageSet(transaction, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page: all frames are pinned");
+  }
+  page->WLatch();
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(child_id, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchNextLeaf(const LeafPage *leaf, Page **next) -> bool {
+  *next = nullptr;
+  if (leaf->GetNextPageId() == INVALID_PAGE_ID) {
+    return true;
+  }
+  *next = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+  return *next != nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RelinkPrev(Page *next, page_id_t prev_page_id) {
+  if (next == nullptr) {
+    return;
+  }
+  next->WLatch();
+  reinterpret_cast<LeafPage *>(next->GetData())->SetPrevPageId(prev_page_id);
+  next->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next->GetPageId(), true);
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -47,7 +283,141 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    return InsertBLink(key, value);
+  }
+
+  // optimistic pass: only the leaf is write latched, which is enough unless the leaf splits
+  Page *page = FindLeafOptimistic(key);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType existing;
+    if (leaf->Lookup(key, &existing, comparator_)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    if (IsSafe(leaf, Operation::INSERT, key)) {
+      leaf->Insert(key, value, comparator_);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return true;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  // pessimistic pass
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  page = FindLeafPessimistic(key, Operation::INSERT, transaction);
+  if (page == nullptr) {
+    StartNewTree(key, value, transaction);
+    ReleasePageSet(transaction, true);
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    ReleasePageSet(transaction, false);
+    return false;
+  }
+  // a key that does not fit goes in after the split, into whichever half covers it
+  const bool fits = leaf->HasRoomFor(key);
+  if (fits) {
+    leaf->Insert(key, value, comparator_);
+  }
+  if (!fits || leaf->GetSize() >= leaf_max_size_) {
+    page_id_t new_page_id;
+    auto *new_leaf = reinterpret_cast<LeafPage *>(NewNode(&new_page_id, transaction)->GetData());
+    Page *next_page;
+    if (!FetchNextLeaf(leaf, &next_page)) {
+      buffer_pool_manager_->UnpinPage(new_page_id, false);
+      buffer_pool_manager_->DeletePage(new_page_id);
+      ReleasePageSet(transaction, true);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf: all frames are pinned");
+    }
+    new_leaf->Init(new_page_id, leaf->GetParentPageId(), leaf_max_size_);
+    const KeyType separator = SplitLeaf(leaf, new_leaf, key, value, !fits);
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    new_leaf->SetPrevPageId(leaf->GetPageId());
+    leaf->SetNextPageId(new_page_id);
+    RelinkPrev(next_page, new_page_id);
+    InsertIntoParent(leaf, separator, new_leaf, transaction);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+  }
+  ReleasePageSet(transaction, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  page_id_t page_id;
+  auto *leaf = reinterpret_cast<LeafPage *>(NewNode(&page_id, transaction)->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SplitLeaf(LeafPage *leaf, LeafPage *new_leaf, const KeyType &key, const ValueType &value,
+                               bool insert) -> KeyType {
+  leaf->MoveHalfTo(new_leaf);
+  if (insert) {
+    LeafPage *half = comparator_(key, new_leaf->KeyAt(0)) < 0 ? leaf : new_leaf;
+    half->Insert(key, value, comparator_);
+  }
+  return comparator_.Separator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_id;
+    auto *root = reinterpret_cast<InternalPage *>(NewNode(&root_id, transaction)->GetData());
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+
+  InternalPage *parent = ParentOf(old_node, transaction);
+  int index = parent->ValueIndex(old_node->GetPageId()) + 1;
+  new_node->SetParentPageId(parent->GetPageId());
+  if (parent->GetSize() < internal_max_size_ && parent->HasRoomFor(key)) {
+    parent->InsertAt(index, key, new_node->GetPageId());
+    return;
+  }
+
+  // A full page has no room for one more entry, so split it through a scratch buffer. Either half fits uncompressed.
+  std::vector<std::pair<KeyType, page_id_t>> entries;
+  entries.reserve(parent->GetSize() + 1);
+  for (int i = 0; i < parent->GetSize(); i++) {
+    entries.emplace_back(parent->KeyAt(i), parent->ValueAt(i));
+  }
+  entries.emplace(entries.begin() + index, key, new_node->GetPageId());
+
+  page_id_t sibling_id;
+  auto *sibling = reinterpret_cast<InternalPage *>(NewNode(&sibling_id, transaction)->GetData());
+  sibling->Init(sibling_id, parent->GetParentPageId(), internal_max_size_);
+  const int total = static_cast<int>(entries.size());
+  const int keep = (total + 1) / 2;
+  parent->SetEntries(entries.data(), keep);
+  sibling->SetEntries(entries.data() + keep, total - keep);
+  for (int i = 0; i < sibling->GetSize(); i++) {
+    SetParent(sibling->ValueAt(i), sibling_id, transaction);
+  }
+  InsertIntoParent(parent, sibling->KeyAt(0), sibling, transaction);
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
 }
 
 /*****************************************************************************
@@ -61,7 +431,499 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    RemoveBLink(key);
+    return;
+  }
+
+  // optimistic pass: only the leaf is write latched, which is enough unless the leaf underflows
+  Page *page = FindLeafOptimistic(key);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return;
+  }
+  if (IsSafe(leaf, Operation::REMOVE, key)) {
+    leaf->Remove(key, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+  // pessimistic pass
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  page = FindLeafPessimistic(key, Operation::REMOVE, transaction);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->Remove(key, comparator_)) {
+      CoalesceOrRedistribute(leaf, transaction);
+    }
+  }
+  ReleasePageSet(transaction, true);
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CoalesceOrRedistribute(BPlusTreePage *node, Transaction *transaction) {
+  if (node->IsRootPage()) {
+    AdjustRoot(node, transaction);
+    return;
+  }
+  if (!IsUnderfull(node, node->GetSize())) {
+    return;
+  }
+
+  InternalPage *parent = ParentOf(node, transaction);
+  if (parent->GetSize() < 2) {
+    // an underfull parent that could not merge either, node has no sibling
+    return;
+  }
+  const int index = parent->ValueIndex(node->GetPageId());
+  const page_id_t sibling_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  // Siblings are only reached through their parent, which we hold, so waiting here cannot deadlock.
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_id);
+  if (sibling_page == nullptr) {
+    ReleasePageSet(transaction, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a sibling page: all frames are pinned");
+  }
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<BPlusTreePage *>(sibling_page->GetData());
+
+  // always merge the right page of the pair into the left one
+  BPlusTreePage *left = index == 0 ? node : sibling;
+  BPlusTreePage *right = index == 0 ? sibling : node;
+  const int right_index = index == 0 ? 1 : index;
+  const int combined = node->GetSize() + sibling->GetSize();
+  bool fits;
+  if (node->IsLeafPage()) {
+    fits = combined < leaf_max_size_ &&
+           reinterpret_cast<LeafPage *>(left)->CanAbsorb(reinterpret_cast<LeafPage *>(right), nullptr);
+  } else {
+    const KeyType middle_key = parent->KeyAt(right_index);
+    fits = combined <= internal_max_size_ &&
+           reinterpret_cast<InternalPage *>(left)->CanAbsorb(reinterpret_cast<InternalPage *>(right), &middle_key);
+  }
+  if (!fits) {
+    bool moved = false;
+    while (IsUnderfull(node, node->GetSize()) && Redistribute(node, sibling, parent, index, transaction)) {
+      moved = true;
+    }
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_id, moved);
+    return;
+  }
+
+  if (node->IsLeafPage()) {
+    Page *next_page;
+    if (!FetchNextLeaf(reinterpret_cast<LeafPage *>(right), &next_page)) {
+      sibling_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(sibling_id, false);
+      ReleasePageSet(transaction, true);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf: all frames are pinned");
+    }
+    reinterpret_cast<LeafPage *>(right)->MoveAllTo(reinterpret_cast<LeafPage *>(left));
+    RelinkPrev(next_page, left->GetPageId());
+  } else {
+    MergeInternal(reinterpret_cast<InternalPage *>(left), reinterpret_cast<InternalPage *>(right),
+                  parent->KeyAt(right_index), transaction);
+  }
+  transaction->AddIntoDeletedPageSet(right->GetPageId());
+  parent->Remove(right_index);
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
+  CoalesceOrRedistribute(parent, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root, Transaction *transaction) {
+  if (old_root->IsLeafPage()) {
+    if (old_root->GetSize() > 0) {
+      return;
+    }
+    transaction->AddIntoDeletedPageSet(old_root->GetPageId());
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    return;
+  }
+  if (old_root->GetSize() > 1) {
+    return;
+  }
+  const page_id_t child_id = reinterpret_cast<InternalPage *>(old_root)->ValueAt(0);
+  SetParent(child_id, INVALID_PAGE_ID, transaction);
+  transaction->AddIntoDeletedPageSet(old_root->GetPageId());
+  root_page_id_ = child_id;
+  UpdateRootPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MergeInternal(InternalPage *left, InternalPage *right, const KeyType &middle_key,
+                                   Transaction *transaction) {
+  const int start = left->GetSize();
+  left->InsertAt(start, middle_key, right->ValueAt(0));
+  for (int i = 1; i < right->GetSize(); i++) {
+    left->InsertAt(left->GetSize(), right->KeyAt(i), right->ValueAt(i));
+  }
+  right->SetSize(0);
+  for (int i = start; i < left->GetSize(); i++) {
+    SetParent(left->ValueAt(i), left->GetPageId(), transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Redistribute(BPlusTreePage *node, BPlusTreePage *sibling, InternalPage *parent, int index,
+                                  Transaction *transaction) -> bool {
+  // the sibling must not underflow in turn
+  if (sibling->GetSize() < 2 || IsUnderfull(sibling, sibling->GetSize() - 1)) {
+    return false;
+  }
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    auto *sibling_leaf = reinterpret_cast<LeafPage *>(sibling);
+    const int last = sibling_leaf->GetSize() - 1;
+    const KeyType separator = index == 0
+                                  ? comparator_.Separator(sibling_leaf->KeyAt(0), sibling_leaf->KeyAt(1))
+                                  : comparator_.Separator(sibling_leaf->KeyAt(last - 1), sibling_leaf->KeyAt(last));
+    if (!parent->CanReplaceKey(separator)) {
+      return false;
+    }
+    if (index == 0) {
+      sibling_leaf->MoveFirstToEndOf(leaf);
+      parent->SetKeyAt(1, separator);
+    } else {
+      sibling_leaf->MoveLastToFrontOf(leaf);
+      parent->SetKeyAt(index, separator);
+    }
+    return true;
+  }
+
+  // internal pages rotate the child through the parent's separator key
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  auto *sibling_internal = reinterpret_cast<InternalPage *>(sibling);
+  const KeyType separator = sibling_internal->KeyAt(index == 0 ? 1 : sibling_internal->GetSize() - 1);
+  if (!parent->CanReplaceKey(separator)) {
+    return false;
+  }
+  page_id_t moved_child;
+  if (index == 0) {
+    moved_child = sibling_internal->ValueAt(0);
+    internal->InsertAt(internal->GetSize(), parent->KeyAt(1), moved_child);
+    parent->SetKeyAt(1, sibling_internal->KeyAt(1));
+    sibling_internal->Remove(0);
+  } else {
+    const int last = sibling_internal->GetSize() - 1;
+    moved_child = sibling_internal->ValueAt(last);
+    internal->InsertAt(0, sibling_internal->KeyAt(last), moved_child);
+    internal->SetKeyAt(1, parent->KeyAt(index));
+    parent->SetKeyAt(index, sibling_internal->KeyAt(last));
+    sibling_internal->Remove(last);
+  }
+  SetParent(moved_child, internal->GetPageId(), transaction);
+  return true;
+}
+
+/*****************************************************************************
+ * B-LINK MODE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafBLink(const KeyType *key, bool write_leaf, std::vector<page_id_t> *stack, bool rightmost)
+    -> Page * {
+  const page_id_t root_page_id = root_page_id_.load();
+  if (root_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root: all frames are pinned");
+  }
+  bool exclusive = write_leaf && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage();
+  if (exclusive) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+
+  while (true) {
+    if (key != nullptr || rightmost) {
+      // the rightmost page of a level may have split after we passed its parent
+      page = MoveRight(page, key, exclusive);
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_id = key == nullptr ? internal->ValueAt(rightmost ? internal->GetSize() - 1 : 0)
+                                        : internal->Lookup(*key, comparator_);
+    if (stack != nullptr) {
+      stack->push_back(page->GetPageId());
+    }
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (child == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page: all frames are pinned");
+    }
+    // Pages are never freed in B-link mode, so the child can be latched after letting go of the parent; if it splits
+    // in between, MoveRight catches up with the key.
+    exclusive = write_leaf && reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage();
+    if (exclusive) {
+      child->WLatch();
+    } else {
+      child->RLatch();
+    }
+    page = child;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType *key, bool exclusive) -> Page * {
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id;
+    KeyType high_key;
+    if (node->IsLeafPage()) {
+      next_page_id = reinterpret_cast<LeafPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<LeafPage *>(node)->GetHighKey();
+    } else {
+      next_page_id = reinterpret_cast<InternalPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<InternalPage *>(node)->GetHighKey();
+    }
+    if (next_page_id == INVALID_PAGE_ID || (key != nullptr && comparator_(*key, high_key) < 0)) {
+      return page;
+    }
+
+    Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next == nullptr) {
+      if (exclusive) {
+        page->WUnlatch();
+      } else {
+        page->RUnlatch();
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a right sibling: all frames are pinned");
+    }
+    // latches are taken left to right within a level
+    if (exclusive) {
+      next->WLatch();
+      page->WUnlatch();
+    } else {
+      next->RLatch();
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) -> bool {
+  std::vector<page_id_t> stack;
+  Page *page = FindLeafBLink(&key, true, &stack);
+  if (page == nullptr) {
+    Transaction transaction(INVALID_TXN_ID);
+    root_latch_.WLock();
+    transaction.AddIntoPageSet(nullptr);
+    const bool start_new_tree = root_page_id_ == INVALID_PAGE_ID;
+    if (start_new_tree) {
+      StartNewTree(key, value, &transaction);
+    }
+    ReleasePageSet(&transaction, true);
+    if (start_new_tree) {
+      return true;
+    }
+    page = FindLeafBLink(&key, true, &stack);
+  }
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  const bool fits = leaf->HasRoomFor(key);
+  if (fits) {
+    leaf->Insert(key, value, comparator_);
+    if (leaf->GetSize() < leaf_max_size_) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return true;
+    }
+  }
+
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (new_page == nullptr) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a tree page: all frames are pinned");
+  }
+  Page *next_page;
+  if (!FetchNextLeaf(leaf, &next_page)) {
+    buffer_pool_manager_->UnpinPage(new_page_id, false);
+    buffer_pool_manager_->DeletePage(new_page_id);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf: all frames are pinned");
+  }
+  // the new leaf is unreachable until the old one is released, so it needs no latch
+  auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+  new_leaf->Init(new_page_id, leaf->GetParentPageId(), leaf_max_size_);
+  const KeyType separator = SplitLeaf(leaf, new_leaf, key, value, !fits);
+  new_leaf->SetHighKey(leaf->GetHighKey());
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetPrevPageId(leaf->GetPageId());
+  leaf->SetHighKey(separator);
+  leaf->SetNextPageId(new_page_id);
+  // reverse scans reaching the new leaf through this link check its next link, which is already set
+  RelinkPrev(next_page, new_page_id);
+  InsertIntoParentBLink(page, separator, new_page, &stack);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key) {
+  Page *page = FindLeafBLink(&key, true, nullptr);
+  if (page == nullptr) {
+    return;
+  }
+  bool removed = reinterpret_cast<LeafPage *>(page->GetData())->Remove(key, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(Page *page, const KeyType &key, Page *new_page,
+                                           std::vector<page_id_t> *stack) {
+  KeyType separator = key;
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    auto *new_node = reinterpret_cast<BPlusTreePage *>(new_page->GetData());
+    const page_id_t page_id = page->GetPageId();
+    const page_id_t new_page_id = new_page->GetPageId();
+
+    Page *parent_page;
+    if (stack->empty()) {
+      // page was the root when we passed it
+      root_latch_.WLock();
+      if (root_page_id_ == page_id) {
+        page_id_t root_id;
+        Page *root_page = buffer_pool_manager_->NewPage(&root_id);
+        if (root_page == nullptr) {
+          root_latch_.WUnlock();
+          page->WUnlatch();
+          buffer_pool_manager_->UnpinPage(page_id, true);
+          buffer_pool_manager_->UnpinPage(new_page_id, true);
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a tree page: all frames are pinned");
+        }
+        auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+        root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+        root->PopulateNewRoot(page_id, separator, new_page_id);
+        node->SetParentPageId(root_id);
+        new_node->SetParentPageId(root_id);
+        root_page_id_ = root_id;
+        UpdateRootPageId();
+        root_latch_.WUnlock();
+        buffer_pool_manager_->UnpinPage(root_id, true);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        buffer_pool_manager_->UnpinPage(new_page_id, true);
+        return;
+      }
+      const page_id_t root_id = root_page_id_;
+      root_latch_.WUnlock();
+      parent_page = LatchParentBLink(root_id, page_id, separator);
+    } else {
+      const page_id_t parent_id = stack->back();
+      stack->pop_back();
+      parent_page = LatchParentBLink(parent_id, page_id, separator);
+    }
+
+    // Lehman-Yao: the page that split is released only once its parent is latched
+    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    new_node->SetParentPageId(parent->GetPageId());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+
+    const int index = parent->ValueIndex(page_id) + 1;
+    if (parent->GetSize() < internal_max_size_ && parent->HasRoomFor(separator)) {
+      parent->InsertAt(index, separator, new_page_id);
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(new_page_id, true);
+      return;
+    }
+
+    // A full page has no room for one more entry, so split it through a scratch buffer. Either half fits uncompressed.
+    std::vector<std::pair<KeyType, page_id_t>> entries;
+    entries.reserve(parent->GetSize() + 1);
+    for (int i = 0; i < parent->GetSize(); i++) {
+      entries.emplace_back(parent->KeyAt(i), parent->ValueAt(i));
+    }
+    entries.emplace(entries.begin() + index, separator, new_page_id);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+    page_id_t sibling_id;
+    Page *sibling_page = buffer_pool_manager_->NewPage(&sibling_id);
+    if (sibling_page == nullptr) {
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a tree page: all frames are pinned");
+    }
+    auto *sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+    sibling->Init(sibling_id, parent->GetParentPageId(), internal_max_size_);
+    const int total = static_cast<int>(entries.size());
+    const int keep = (total + 1) / 2;
+    parent->SetEntries(entries.data(), keep);
+    sibling->SetEntries(entries.data() + keep, total - keep);
+    sibling->SetHighKey(parent->GetHighKey());
+    sibling->SetNextPageId(parent->GetNextPageId());
+    parent->SetHighKey(entries[keep].first);
+    parent->SetNextPageId(sibling_id);
+
+    page = parent_page;
+    separator = entries[keep].first;
+    new_page = sibling_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchParentBLink(page_id_t page_id, page_id_t child_id, const KeyType &key) -> Page * {
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a parent page: all frames are pinned");
+    }
+    page->WLatch();
+    page = MoveRight(page, &key, true);
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    BUSTUB_ASSERT(!internal->IsLeafPage(), "a split child is always linked from the level above it");
+    const page_id_t covering_id = internal->Lookup(key, comparator_);
+    if (covering_id == child_id) {
+      return page;
+    }
+    // A new root was added above the level we expected the parent at. Go down, releasing the page first, since
+    // writers latch bottom-up.
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page_id = covering_id;
+  }
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -72,7 +934,14 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  Page *page = mode_ == BPlusTreeMode::B_LINK ? FindLeafBLink(nullptr, false, nullptr) : FindLeafRead(nullptr);
+  if (page == nullptr) {
+    return End();
+  }
+  page->RUnlatch();
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -80,7 +949,15 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = mode_ == BPlusTreeMode::B_LINK ? FindLeafBLink(&key, false, nullptr) : FindLeafRead(&key);
+  if (page == nullptr) {
+    return End();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  page->RUnlatch();
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -90,11 +967,285 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Find the leaf where the scan starts: that of the low bound for a forward
+ * scan and of the high bound for a reverse one, or the leftmost/rightmost
+ * leaf if that bound is open
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Scan(const IndexScanRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  const std::optional<KeyType> &start = range.reverse_ ? range.high_ : range.low_;
+  Page *page = FindLeafForScan(start.has_value() ? &*start : nullptr, range.reverse_);
+  if (page == nullptr) {
+    return End();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = 0;
+  if (start.has_value()) {
+    index = leaf->KeyIndex(*start, comparator_);
+    // a reverse scan starts at the last key not above its bound
+    if (range.reverse_ && (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), *start) != 0)) {
+      index--;
+    }
+  } else if (range.reverse_) {
+    index = leaf->GetSize() - 1;
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, range, &comparator_,
+                            [this](const KeyType &key) { return FindLeafForScan(&key, false); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafForScan(const KeyType *key, bool rightmost) -> Page * {
+  return mode_ == BPlusTreeMode::B_LINK ? FindLeafBLink(key, false, nullptr, rightmost) : FindLeafRead(key, rightmost);
+}
+
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
+  root_latch_.RLock();
+  page_id_t root_page_id = root_page_id_;
+  root_latch_.RUnlock();
+  return root_page_id;
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const BulkLoadSource &source, double fill_factor) -> bool {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  // never pack a page below its minimum size, nor so full that the next insert splits it
+  BulkLoadFill fill;
+  fill.leaf_size_ =
+      std::clamp(static_cast<int>(fill_factor * (leaf_max_size_ - 1)), leaf_max_size_ / 2, leaf_max_size_ - 1);
+  fill.internal_size_ = std::clamp(static_cast<int>(fill_factor * internal_max_size_), (internal_max_size_ + 1) / 2,
+                                   internal_max_size_);
+  fill.data_size_ = static_cast<size_t>(std::clamp(fill_factor, 0.5, 1.0) * B_PLUS_TREE_PAGE_DATA_SIZE);
+  BufferRing ring;
+  std::vector<BulkLoadLevel> levels;
+  Page *root_page = nullptr;
+  try {
+    KeyType key;
+    ValueType value;
+    while (source(&key, &value)) {
+      if (levels.empty()) {
+        page_id_t page_id;
+        levels.emplace_back();
+        levels[0].cur_ = BulkLoadNewPage(&page_id, &ring);
+        levels[0].cur_key_ = key;
+        reinterpret_cast<LeafPage *>(levels[0].cur_->GetData())->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+      } else {
+        auto *leaf = reinterpret_cast<LeafPage *>(levels[0].cur_->GetData());
+        const KeyType last_key = leaf->KeyAt(leaf->GetSize() - 1);
+        const int cmp = comparator_(key, last_key);
+        if (cmp == 0) {
+          throw Exception("bulk load input has a duplicate key");
+        }
+        if (cmp < 0) {
+          throw Exception("bulk load input is not sorted");
+        }
+        if (leaf->GetSize() >= fill.leaf_size_ || !leaf->HasRoomFor(key, fill.data_size_)) {
+          BulkLoadNextPage(&levels, 0, comparator_.Separator(last_key, key), &ring, fill);
+        }
+      }
+      reinterpret_cast<LeafPage *>(levels[0].cur_->GetData())->Insert(key, value, comparator_);
+    }
+
+    // Close the levels bottom-up. Linking the last pages of a level may still start new pages above it.
+    for (size_t level = 0; level < levels.size(); level++) {
+      if (levels[level].prev_ != nullptr) {
+        BulkLoadBalanceEdge(&levels[level]);
+      }
+      // copy the keys out, appending to the level above can grow levels
+      if (levels[level].prev_ != nullptr) {
+        Page *prev = levels[level].prev_;
+        const KeyType prev_key = levels[level].prev_key_;
+        levels[level].prev_ = nullptr;
+        BulkLoadAppendChild(&levels, level + 1, prev_key, prev, &ring, fill);
+      }
+      Page *cur = levels[level].cur_;
+      const KeyType cur_key = levels[level].cur_key_;
+      levels[level].cur_ = nullptr;
+      if (level + 1 == levels.size()) {
+        root_page = cur;
+        break;
+      }
+      BulkLoadAppendChild(&levels, level + 1, cur_key, cur, &ring, fill);
+    }
+  } catch (...) {
+    // an aborted load leaves the tree empty; the pages it wrote are not reclaimed
+    for (auto &edge : levels) {
+      for (Page *page : {edge.prev_, edge.cur_}) {
+        if (page != nullptr) {
+          buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        }
+      }
+    }
+    root_latch_.WUnlock();
+    throw;
+  }
+
+  if (root_page != nullptr) {
+    root_page_id_ = root_page->GetPageId();
+    UpdateRootPageId(1);
+    buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);
+  }
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadUnsorted(const BulkLoadSource &source, double fill_factor) -> bool {
+  if (!IsEmpty()) {
+    return false;
+  }
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+  KeyType key;
+  ValueType value;
+  while (source(&key, &value)) {
+    sorter.Add(key, value);
+  }
+  sorter.Finish();
+  return BulkLoad([&sorter](KeyType *key, ValueType *value) { return sorter.Next(key, value); }, fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadNewPage(page_id_t *page_id, BufferRing *ring) -> Page * {
+  Page *page = buffer_pool_manager_->NewPage(page_id, AccessType::SCAN, ring);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a tree page: all frames are pinned");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadNextPage(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &key,
+                                      BufferRing *ring, const BulkLoadFill &fill) {
+  BulkLoadLevel &edge = (*levels)[level];
+  page_id_t page_id;
+  Page *page = BulkLoadNewPage(&page_id, ring);
+  if (level == 0) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    leaf->SetPrevPageId(edge.cur_->GetPageId());
+    auto *left = reinterpret_cast<LeafPage *>(edge.cur_->GetData());
+    left->SetNextPageId(page_id);
+    left->SetHighKey(key);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    auto *left = reinterpret_cast<InternalPage *>(edge.cur_->GetData());
+    left->SetNextPageId(page_id);
+    left->SetHighKey(key);
+  }
+  Page *retired = edge.prev_;
+  const KeyType retired_key = edge.prev_key_;
+  edge.prev_ = edge.cur_;
+  edge.prev_key_ = edge.cur_key_;
+  edge.cur_ = page;
+  edge.cur_key_ = key;
+  // edge may not survive this call, since it can add a level
+  if (retired != nullptr) {
+    BulkLoadAppendChild(levels, level + 1, retired_key, retired, ring, fill);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppendChild(std::vector<BulkLoadLevel> *levels, size_t level, const KeyType &key,
+                                         Page *child, BufferRing *ring, const BulkLoadFill &fill) {
+  try {
+    if (level == levels->size()) {
+      levels->emplace_back();
+    }
+    BulkLoadLevel &edge = (*levels)[level];
+    if (edge.cur_ == nullptr) {
+      page_id_t page_id;
+      edge.cur_ = BulkLoadNewPage(&page_id, ring);
+      edge.cur_key_ = key;
+      reinterpret_cast<InternalPage *>(edge.cur_->GetData())->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    } else {
+      auto *parent = reinterpret_cast<InternalPage *>(edge.cur_->GetData());
+      if (parent->GetSize() >= fill.internal_size_ || !parent->HasRoomFor(key, fill.data_size_)) {
+        BulkLoadNextPage(levels, level, key, ring, fill);
+      }
+    }
+  } catch (...) {
+    buffer_pool_manager_->UnpinPage(child->GetPageId(), false);
+    throw;
+  }
+  // the first key of an internal page is never compared against, but it is the lower bound of the page
+  auto *parent = reinterpret_cast<InternalPage *>((*levels)[level].cur_->GetData());
+  parent->InsertAt(parent->GetSize(), key, child->GetPageId());
+  reinterpret_cast<BPlusTreePage *>(child->GetData())->SetParentPageId(parent->GetPageId());
+  buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadBalanceEdge(BulkLoadLevel *edge) {
+  auto *left_node = reinterpret_cast<BPlusTreePage *>(edge->prev_->GetData());
+  auto *right_node = reinterpret_cast<BPlusTreePage *>(edge->cur_->GetData());
+  if (!IsUnderfull(right_node, right_node->GetSize())) {
+    return;
+  }
+  const int total = left_node->GetSize() + right_node->GetSize();
+
+  if (left_node->IsLeafPage()) {
+    auto *left = reinterpret_cast<LeafPage *>(left_node);
+    auto *right = reinterpret_cast<LeafPage *>(right_node);
+    if (total >= leaf_max_size_ || !left->CanAbsorb(right, nullptr)) {
+      while (right->GetSize() < total / 2 && right->HasRoomFor(left->KeyAt(left->GetSize() - 1))) {
+        left->MoveLastToFrontOf(right);
+      }
+      edge->cur_key_ = comparator_.Separator(left->KeyAt(left->GetSize() - 1), right->KeyAt(0));
+      left->SetHighKey(edge->cur_key_);
+      return;
+    }
+    right->MoveAllTo(left);
+  } else {
+    auto *left = reinterpret_cast<InternalPage *>(left_node);
+    auto *right = reinterpret_cast<InternalPage *>(right_node);
+    auto reparent = [this](page_id_t child_id, page_id_t parent_id) {
+      Page *child = buffer_pool_manager_->FetchPage(child_id);
+      if (child == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page: all frames are pinned");
+      }
+      reinterpret_cast<BPlusTreePage *>(child->GetData())->SetParentPageId(parent_id);
+      buffer_pool_manager_->UnpinPage(child_id, true);
+    };
+    // the first key of the right page is its separator already, so entries move over as they are
+    if (total > internal_max_size_ || !left->CanAbsorb(right, nullptr)) {
+      while (right->GetSize() < total / 2 && right->HasRoomFor(left->KeyAt(left->GetSize() - 1))) {
+        const int last = left->GetSize() - 1;
+        const page_id_t child_id = left->ValueAt(last);
+        right->InsertAt(0, left->KeyAt(last), child_id);
+        left->Remove(last);
+        reparent(child_id, right->GetPageId());
+      }
+      edge->cur_key_ = right->KeyAt(0);
+      left->SetHighKey(edge->cur_key_);
+      return;
+    }
+    for (int i = 0; i < right->GetSize(); i++) {
+      left->InsertAt(left->GetSize(), right->KeyAt(i), right->ValueAt(i));
+      reparent(right->ValueAt(i), left->GetPageId());
+    }
+    left->SetNextPageId(INVALID_PAGE_ID);
+  }
+
+  // the right page was merged into the left one, which is the last page of the level now
+  const page_id_t right_id = edge->cur_->GetPageId();
+  buffer_pool_manager_->UnpinPage(right_id, false);
+  buffer_pool_manager_->DeletePage(right_id);
+  edge->cur_ = edge->prev_;
+  edge->cur_key_ = edge->prev_key_;
+  edge->prev_ = nullptr;
+}
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -109,17 +1260,38 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(page);
+  // the header page is shared by all indexes
+  page->WLatch();
+  // create a new record<index_name + root_page_id> in header_page; a tree that was emptied already has one
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LoadRootPageId() -> bool {
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the header page: all frames are pinned");
+  }
+  page_id_t root_page_id;
+  page->RLatch();
+  const bool found = static_cast<HeaderPage *>(page)->GetRootId(index_name_, &root_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  if (found) {
+    root_latch_.WLock();
+    root_page_id_ = root_page_id;
+    root_latch_.WUnlock();
+  }
+  return found;
+}
+
 /*
  * This method is used for test only
  * Read data from file and insert one by one
@@ -9,43 +9,97 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "common/exception.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/external_sorter.h"
 
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     BPlusTreeMode mode, const std::string &root_record_name)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(root_record_name.empty() ? GetMetadata()->GetName() : root_record_name, buffer_pool_manager,
+                 comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE, mode) {
+  if (IsKeyExact()) {
+    return;
+  }
+  const Schema *entry_schema = GetMetadata()->GetEntrySchema();
+  const size_t rid_size = GetMetadata()->IsUnique() ? 0 : sizeof(int64_t);
+  if (!entry_schema->IsInlined() || entry_schema->GetLength() + rid_size > sizeof(KeyType)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the entries of the index do not fit in its keys");
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
-
-  container_.Insert(index_key, rid, transaction);
+auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
+  const KeyType index_key = MakeKey(key, rid);
+  if (GetMetadata()->IsUnique() && !IsKeyExact()) {
+    // The included columns make two entries of one key differ, so look for the key first. Like the tree does for
+    // equal keys, keep the entry that is there.
+    auto iterator = container_.Scan(PrefixRange(index_key, GetKeySchema()->GetLength()));
+    if (!iterator.IsEnd()) {
+      return false;
+    }
+  }
+  return container_.Insert(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
-
-  container_.Remove(index_key, transaction);
+  container_.Remove(MakeKey(key, rid), transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  const size_t length = index_key.SetFromKey(key, GetKeySchema());
+  if (IsKeyExact()) {
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+
+  auto iterator = container_.Scan(PrefixRange(index_key, length));
+  while (iterator.NextBatch(result)) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &source) -> bool {
+  if (!container_.IsEmpty()) {
+    return false;
+  }
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+  Tuple key;
+  RID rid;
+  while (source(&key, &rid)) {
+    sorter.Add(MakeKey(key, rid), rid);
+  }
+  sorter.Finish();
 
-  container_.GetValue(index_key, result, transaction);
+  // The entries of one key are neighbours in the sorted order. A unique index with included columns compares the
+  // key columns alone, as the included ones would tell two entries of a key apart.
+  const bool is_unique = GetMetadata()->IsUnique();
+  const size_t key_length = IsKeyExact() ? sizeof(KeyType) : GetKeySchema()->GetLength();
+  std::optional<KeyType> last_key;
+  return container_.BulkLoad([&](KeyType *index_key, RID *index_rid) {
+    if (!sorter.Next(index_key, index_rid)) {
+      return false;
+    }
+    if (is_unique && last_key.has_value() && std::memcmp(last_key->data_, index_key->data_, key_length) == 0) {
+      throw Exception("duplicate key in unique index " + GetName());
+    }
+    last_key = *index_key;
+    return true;
+  });
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -54,9 +108,114 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return con
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetScanIterator(const IndexScanRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  return container_.Scan(range);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const std::optional<IndexKeyBound> &low,
+                                            const std::optional<IndexKeyBound> &high, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  // every bound becomes an inclusive low key or an exclusive high key
+  IndexScanRange<KeyType> range;
+  range.reverse_ = reverse;
+  if (low.has_value()) {
+    KeyType key;
+    if (!BoundKey(*low, !low->inclusive_, &key)) {
+      return container_.End();
+    }
+    range.low_ = key;
+  }
+  if (high.has_value()) {
+    KeyType key;
+    if (BoundKey(*high, high->inclusive_, &key)) {
+      range.high_ = key;
+      range.high_inclusive_ = false;
+    }
+  }
+  return container_.Scan(range);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DecodeEntry(const KeyType &key, std::vector<Value> *values) const {
+  const Schema *entry_schema = GetMetadata()->GetEntrySchema();
+  const uint32_t key_columns = GetIndexColumnCount();
+  size_t offset = 0;
+  KeyEncoder::DecodeColumns(key.data_, sizeof(KeyType), entry_schema, 0, key_columns, &offset, values);
+  if (!GetMetadata()->IsUnique()) {
+    offset += sizeof(int64_t);
+  }
+  KeyEncoder::DecodeColumns(key.data_, sizeof(KeyType), entry_schema, key_columns, entry_schema->GetColumnCount(),
+                            &offset, values);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::IsKeyExact() const -> bool {
+  return GetMetadata()->IsUnique() && GetMetadata()->GetIncludedAttrs().empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &entry, RID rid) const -> KeyType {
+  KeyType index_key;
+  if (IsKeyExact()) {
+    index_key.SetFromKey(entry, GetKeySchema());
+    return index_key;
+  }
+  // the key columns have a fixed length, so the RID only breaks ties between equal keys, and the included columns
+  // come after anything that tells two entries apart
+  const Schema *entry_schema = GetMetadata()->GetEntrySchema();
+  const uint32_t key_columns = GetIndexColumnCount();
+  std::memset(index_key.data_, 0, sizeof(KeyType));
+  size_t offset = KeyEncoder::EncodeColumns(entry, entry_schema, 0, key_columns, index_key.data_, 0, sizeof(KeyType));
+  if (!GetMetadata()->IsUnique()) {
+    offset = KeyEncoder::EncodeRid(rid, index_key.data_, offset, sizeof(KeyType));
+  }
+  KeyEncoder::EncodeColumns(entry, entry_schema, key_columns, entry_schema->GetColumnCount(), index_key.data_, offset,
+                            sizeof(KeyType));
+  return index_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::PrefixRange(KeyType key, size_t length) -> IndexScanRange<KeyType> {
+  // the keys run from the prefix padded with zeros to the next prefix
+  IndexScanRange<KeyType> range;
+  if (length < sizeof(KeyType)) {
+    std::memset(key.data_ + length, 0, sizeof(KeyType) - length);
+  }
+  range.low_ = key;
+  if (Successor(&key, length)) {
+    range.high_ = key;
+    range.high_inclusive_ = false;
+  }
+  return range;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::Successor(KeyType *key, size_t length) -> bool {
+  for (size_t i = std::min(length, sizeof(KeyType)); i-- > 0;) {
+    auto &byte = reinterpret_cast<uint8_t &>(key->data_[i]);
+    if (byte != 0xFF) {
+      byte++;
+      return true;
+    }
+    byte = 0;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BoundKey(const IndexKeyBound &bound, bool past, KeyType *key) const -> bool {
+  std::vector<uint32_t> key_attrs(bound.values_.size());
+  std::iota(key_attrs.begin(), key_attrs.end(), 0);
+  const Schema prefix_schema = Schema::CopySchema(GetKeySchema(), key_attrs);
+  const size_t length = key->SetFromKey(Tuple(bound.values_, &prefix_schema), &prefix_schema);
+  return !past || Successor(key, length);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/external_sorter.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::ExternalSorter(const KeyComparator &comparator, size_t run_pages, size_t merge_fan_in)
+    : comparator_(comparator),
+      buffer_capacity_(std::max<size_t>(1, run_pages * ENTRIES_PER_PAGE)),
+      merge_fan_in_(std::max<size_t>(2, merge_fan_in != 0 ? merge_fan_in : run_pages)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::~ExternalSorter() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!finished_, "cannot add to a finished sort");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() >= buffer_capacity_) {
+    SpillBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Finish() {
+  if (finished_) {
+    return;
+  }
+  finished_ = true;
+  if (num_runs_written_ == 0) {
+    std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &a, const MappingType &b) {
+      return comparator_(a.first, b.first) < 0;
+    });
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+
+  // Merge passes over neighbouring groups of runs, which keeps equal keys in the order they were added.
+  while (runs_.size() > merge_fan_in_) {
+    std::vector<Run> merged_runs;
+    for (size_t begin = 0; begin < runs_.size(); begin += merge_fan_in_) {
+      const size_t end = std::min(runs_.size(), begin + merge_fan_in_);
+      StartMerge(std::vector<Run>(runs_.begin() + begin, runs_.begin() + end));
+      Run run{num_pages_, 0};
+      MappingType entry;
+      while (PopMerge(&entry)) {
+        Append(&run, entry);
+      }
+      Close();
+      merged_runs.push_back(run);
+    }
+    runs_ = std::move(merged_runs);
+  }
+  StartMerge(runs_);
+  runs_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::Next(KeyType *key, ValueType *value) -> bool {
+  Finish();
+  if (num_runs_written_ == 0) {
+    if (buffer_pos_ >= buffer_.size()) {
+      return false;
+    }
+    *key = buffer_[buffer_pos_].first;
+    *value = buffer_[buffer_pos_].second;
+    buffer_pos_++;
+    return true;
+  }
+  MappingType entry;
+  if (!PopMerge(&entry)) {
+    return false;
+  }
+  *key = entry.first;
+  *value = entry.second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SpillBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+  Run run{num_pages_, 0};
+  for (const auto &entry : buffer_) {
+    Append(&run, entry);
+  }
+  Close();
+  runs_.push_back(run);
+  num_runs_written_++;
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Append(Run *run, const MappingType &entry) {
+  page_buffer_.push_back(entry);
+  run->size_++;
+  if (page_buffer_.size() == ENTRIES_PER_PAGE) {
+    WritePage();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Close() {
+  if (!page_buffer_.empty()) {
+    WritePage();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::WritePage() {
+  if (file_ == nullptr) {
+    file_ = std::tmpfile();
+    if (file_ == nullptr) {
+      throw Exception(std::string("cannot create the temporary file of a sort: ") + strerror(errno));
+    }
+  }
+  const auto *data = reinterpret_cast<const char *>(page_buffer_.data());
+  const size_t length = page_buffer_.size() * sizeof(MappingType);
+  const auto offset = static_cast<off_t>(num_pages_ * BUSTUB_PAGE_SIZE);
+  for (size_t done = 0; done < length;) {
+    const ssize_t written = pwrite(fileno(file_), data + done, length - done, offset + static_cast<off_t>(done));
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      throw Exception(std::string("cannot write a sort run: ") + strerror(written < 0 ? errno : ENOSPC));
+    }
+    done += static_cast<size_t>(written);
+  }
+  num_pages_++;
+  page_buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::ReadPage(size_t page, size_t count, std::vector<MappingType> *entries) {
+  entries->resize(count);
+  auto *data = reinterpret_cast<char *>(entries->data());
+  const size_t length = count * sizeof(MappingType);
+  const auto offset = static_cast<off_t>(page * BUSTUB_PAGE_SIZE);
+  for (size_t done = 0; done < length;) {
+    const ssize_t bytes = pread(fileno(file_), data + done, length - done, offset + static_cast<off_t>(done));
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      throw Exception(std::string("cannot read a sort run: ") + (bytes < 0 ? strerror(errno) : "the file is short"));
+    }
+    done += static_cast<size_t>(bytes);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::StartMerge(const std::vector<Run> &runs) {
+  cursors_.clear();
+  heap_.clear();
+  for (const Run &run : runs) {
+    Cursor cursor{run, 0, {}};
+    ReadPage(run.first_page_, std::min(ENTRIES_PER_PAGE, run.size_), &cursor.page_);
+    heap_.push_back(cursors_.size());
+    cursors_.push_back(std::move(cursor));
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return Later(a, b); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::PopMerge(MappingType *entry) -> bool {
+  if (heap_.empty()) {
+    return false;
+  }
+  auto later = [this](size_t a, size_t b) { return Later(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), later);
+  const size_t run = heap_.back();
+  heap_.pop_back();
+  Cursor &cursor = cursors_[run];
+  *entry = cursor.page_[cursor.pos_ % ENTRIES_PER_PAGE];
+  cursor.pos_++;
+  if (cursor.pos_ == cursor.run_.size_) {
+    cursor.page_ = {};
+    return true;
+  }
+  if (cursor.pos_ % ENTRIES_PER_PAGE == 0) {
+    ReadPage(cursor.run_.first_page_ + cursor.pos_ / ENTRIES_PER_PAGE,
+             std::min(ENTRIES_PER_PAGE, cursor.run_.size_ - cursor.pos_), &cursor.page_);
+  }
+  heap_.push_back(run);
+  std::push_heap(heap_.begin(), heap_.end(), later);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::Later(size_t a, size_t b) const -> bool {
+  // the heap puts the run with the smallest current key on top, the earlier run on ties
+  const Cursor &lhs = cursors_[a];
+  const Cursor &rhs = cursors_[b];
+  const int cmp =
+      comparator_(lhs.page_[lhs.pos_ % ENTRIES_PER_PAGE].first, rhs.page_[rhs.pos_ % ENTRIES_PER_PAGE].first);
+  return cmp > 0 || (cmp == 0 && a > b);
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
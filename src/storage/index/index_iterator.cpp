@@ -2,29 +2,378 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, Page *page, int index, size_t readahead_window)
+    : bpm_(bpm),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index),
+      readahead_window_(readahead_window) {
+  if (readahead_window_ > 0) {
+    page_->RLatch();
+    const page_id_t parent_page_id = leaf_->GetParentPageId();
+    const page_id_t next_page_id = leaf_->GetNextPageId();
+    page_->RUnlatch();
+    ReadAhead(parent_page_id, next_page_id);
+  }
+  SkipToValidEntry();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, Page *page, int index, IndexScanRange<KeyType> range,
+                                  const KeyComparator *comparator, std::function<Page *(const KeyType &)> find_leaf)
+    : bpm_(bpm),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index),
+      range_(std::move(range)),
+      comparator_(comparator),
+      find_leaf_(std::move(find_leaf)) {
+  SkipToValidEntry(true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : bpm_(other.bpm_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      index_(other.index_),
+      item_(std::move(other.item_)),
+      readahead_window_(other.readahead_window_),
+      prefetched_(std::move(other.prefetched_)),
+      range_(std::move(other.range_)),
+      comparator_(other.comparator_),
+      find_leaf_(std::move(other.find_leaf_)),
+      last_key_(std::move(other.last_key_)) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    Release();
+    bpm_ = other.bpm_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    item_ = std::move(other.item_);
+    readahead_window_ = other.readahead_window_;
+    prefetched_ = std::move(other.prefetched_);
+    range_ = std::move(other.range_);
+    comparator_ = other.comparator_;
+    find_leaf_ = std::move(other.find_leaf_);
+    last_key_ = std::move(other.last_key_);
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.index_ = 0;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  BUSTUB_ASSERT(!IsEnd(), "dereferencing the end iterator");
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (!IsEnd()) {
+    index_ += range_.reverse_ ? -1 : 1;
+    SkipToValidEntry();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextBatch(std::vector<ValueType> *values) -> bool {
+  return NextBatchOf(values);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> *entries) -> bool {
+  return NextBatchOf(entries);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename Entry>
+auto INDEXITERATOR_TYPE::NextBatchOf(std::vector<Entry> *batch) -> bool {
+  constexpr bool whole_entries = std::is_same_v<Entry, MappingType>;
+  const size_t old_size = batch->size();
+  const bool bounded = comparator_ != nullptr && (range_.low_.has_value() || range_.high_.has_value());
+  const int step = range_.reverse_ ? -1 : 1;
+  while (!IsEnd() && batch->size() == old_size) {
+    // the entry the iterator is at has not been returned yet, and may have moved to another leaf since
+    if constexpr (whole_entries) {
+      batch->push_back(item_);
+    } else {
+      batch->push_back(item_.second);
+    }
+    bool past_range = false;
+    index_ += step;
+    Relatch();
+    if (IsEnd()) {
+      break;
+    }
+    const int size = leaf_->GetSize();
+    int last_index = -1;
+    for (; index_ >= 0 && index_ < size; index_ += step) {
+      const int position = bounded ? Classify(leaf_->KeyAt(index_)) : 0;
+      last_index = index_;
+      if (position > 0) {
+        past_range = true;
+        break;
+      }
+      if (position == 0) {
+        if constexpr (whole_entries) {
+          batch->push_back(leaf_->GetItem(index_));
+        } else {
+          batch->push_back(leaf_->ValueAt(index_));
+        }
+      }
+    }
+    if (comparator_ != nullptr && last_index >= 0) {
+      last_key_ = leaf_->KeyAt(last_index);
+    }
+    page_->RUnlatch();
+    if (past_range) {
+      Release();
+    } else {
+      SkipToValidEntry();
+    }
+  }
+  return batch->size() > old_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+  }
+  index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipToValidEntry(bool latched) {
+  while (page_ != nullptr) {
+    if (latched) {
+      Reposition();
+    } else {
+      Relatch();
+      if (IsEnd()) {
+        return;
+      }
+    }
+    latched = false;
+    const int size = leaf_->GetSize();
+    if (index_ >= 0 && index_ < size) {
+      item_ = leaf_->GetItem(index_);
+      page_->RUnlatch();
+      if (comparator_ == nullptr) {
+        return;
+      }
+      // the scan moves past this entry whether it is in range or not
+      last_key_ = item_.first;
+      const int position = Classify(*last_key_);
+      if (position == 0) {
+        return;
+      }
+      if (position > 0) {
+        Release();
+        return;
+      }
+      continue;
+    }
+    if (range_.reverse_) {
+      StepToPrevLeaf();
+      latched = true;
+      continue;
+    }
+    // walk to the next leaf, pinning it while the link to it cannot change, so it is not merged away and deleted first
+    const page_id_t next_page_id = leaf_->GetNextPageId();
+    Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : bpm_->FetchPage(next_page_id);
+    page_->RUnlatch();
+    Release();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    if (next == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf: all frames are pinned");
+    }
+    page_ = next;
+    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    if (readahead_window_ > 0) {
+      page_->RLatch();
+      const page_id_t parent_page_id = leaf_->GetParentPageId();
+      const page_id_t next_next_page_id = leaf_->GetNextPageId();
+      page_->RUnlatch();
+      ReadAhead(parent_page_id, next_next_page_id);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::Classify(const KeyType &key) const -> int {
+  bool below = false;
+  if (range_.low_.has_value()) {
+    const int cmp = (*comparator_)(key, *range_.low_);
+    below = cmp < 0 || (cmp == 0 && !range_.low_inclusive_);
+  }
+  bool above = false;
+  if (range_.high_.has_value()) {
+    const int cmp = (*comparator_)(key, *range_.high_);
+    above = cmp > 0 || (cmp == 0 && !range_.high_inclusive_);
+  }
+  if (below) {
+    return range_.reverse_ ? 1 : -1;
+  }
+  if (above) {
+    return range_.reverse_ ? -1 : 1;
+  }
+  return 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Reposition() {
+  if (comparator_ == nullptr || !last_key_.has_value()) {
+    return;
+  }
+  index_ = range_.reverse_ ? leaf_->KeyIndex(*last_key_, *comparator_) - 1
+                           : leaf_->UpperKeyIndex(*last_key_, *comparator_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Relatch() {
+  page_->RLatch();
+  Reposition();
+  if (!range_.reverse_ || !last_key_.has_value() || index_ < leaf_->GetSize() - 1 ||
+      leaf_->GetNextPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  // Nothing is left in the leaf at or above the last key, so a split may have moved the keys right below it into the
+  // next leaf, which the prev links never lead back to.
+  const KeyType bound = *last_key_;
+  page_->RUnlatch();
+  Release();
+  SeekBelow(bound);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SeekBelow(const KeyType &bound) {
+  Page *page = find_leaf_(bound);
+  if (page == nullptr) {
+    return;
+  }
+  page_ = page;
+  leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
+  index_ = leaf_->KeyIndex(bound, *comparator_) - 1;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::StepToPrevLeaf() {
+  const page_id_t page_id = page_->GetPageId();
+  const page_id_t prev_page_id = leaf_->GetPrevPageId();
+  // every key the scan has yet to return is below this one
+  const std::optional<KeyType> bound = last_key_.has_value() ? last_key_ : range_.high_;
+  Page *page = prev_page_id == INVALID_PAGE_ID ? nullptr : bpm_->FetchPage(prev_page_id);
+  if (prev_page_id != INVALID_PAGE_ID && page == nullptr) {
+    page_->RUnlatch();
+    Release();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the previous leaf: all frames are pinned");
+  }
+  // Never wait for a latch on the left while holding one: writers latch leaves left to right. Holding both latches
+  // for a moment, no split, merge or redistribution can move keys between the two leaves as we step over.
+  const bool latched = page != nullptr && page->TryRLatch();
+  page_->RUnlatch();
+  Release();
+  if (latched) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->IsLeafPage() && leaf->GetNextPageId() == page_id) {
+      page_ = page;
+      leaf_ = leaf;
+      index_ = leaf->GetSize() - 1;
+      return;
+    }
+    // the leaf we were at had been merged away, its links left behind
+    page->RUnlatch();
+  }
+  if (page != nullptr) {
+    bpm_->UnpinPage(prev_page_id, false);
+  }
+  if (prev_page_id == INVALID_PAGE_ID || !bound.has_value()) {
+    // past the first leaf of the index, or nothing to seek by
+    return;
+  }
+  // a writer holds the previous leaf, or the link is stale: seek the largest key below the bound
+  SeekBelow(*bound);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::ReadAhead(page_id_t parent_page_id, page_id_t next_page_id) {
+  // forget the leaves we have reached
+  const page_id_t page_id = page_->GetPageId();
+  while (!prefetched_.empty()) {
+    const page_id_t front = prefetched_.front();
+    prefetched_.pop_front();
+    if (front == page_id) {
+      break;
+    }
+  }
+  // top the window up once half of it has been consumed, so prefetches go out in batches
+  if (prefetched_.size() > readahead_window_ / 2) {
+    return;
+  }
+
+  std::vector<page_id_t> page_ids;
+  const page_id_t last = prefetched_.empty() ? page_id : prefetched_.back();
+  Page *parent = parent_page_id == INVALID_PAGE_ID ? nullptr : bpm_->FetchPage(parent_page_id);
+  if (parent != nullptr) {
+    // Never wait for the parent: a writer holding it may be waiting for a leaf latch. The parent id read from the leaf
+    // is only a hint, so check that the page still looks like our parent before trusting its child pointers.
+    if (parent->TryRLatch()) {
+      auto *internal = reinterpret_cast<InternalPage *>(parent->GetData());
+      const int max_children = BUSTUB_PAGE_SIZE / sizeof(std::pair<KeyType, page_id_t>);
+      if (!internal->IsLeafPage() && internal->GetPageId() == parent_page_id && internal->GetSize() <= max_children) {
+        for (int i = internal->ValueIndex(last) + 1; i > 0 && i < internal->GetSize(); i++) {
+          if (prefetched_.size() + page_ids.size() >= readahead_window_) {
+            break;
+          }
+          page_ids.push_back(internal->ValueAt(i));
+        }
+      }
+      parent->RUnlatch();
+    }
+    bpm_->UnpinPage(parent_page_id, false);
+  }
+  if (page_ids.empty() && prefetched_.empty() && next_page_id != INVALID_PAGE_ID) {
+    // the current leaf is the last child of its parent: at least keep the next leaf in flight
+    page_ids.push_back(next_page_id);
+  }
+  prefetched_.insert(prefetched_.end(), page_ids.begin(), page_ids.end());
+  bpm_->PrefetchPages(page_ids);
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr uint64_t SIGN_BIT = 1ULL << 63;
+
+/** The bit that flips the sign of a width byte integer. */
+auto SignBit(int width) -> uint64_t { return 1ULL << (8 * width - 1); }
+
+auto PutByte(uint8_t byte, char *dst, size_t offset, size_t size) -> size_t {
+  if (offset < size) {
+    dst[offset] = static_cast<char>(byte);
+  }
+  return offset + 1;
+}
+
+}  // namespace
+
+auto KeyEncoder::Encode(const Tuple &key, const Schema *key_schema, char *dst, size_t size) -> size_t {
+  memset(dst, 0, size);
+  return EncodeColumns(key, key_schema, 0, key_schema->GetColumnCount(), dst, 0, size);
+}
+
+auto KeyEncoder::EncodeColumns(const Tuple &tuple, const Schema *schema, uint32_t begin, uint32_t end, char *dst,
+                               size_t offset, size_t size) -> size_t {
+  for (uint32_t i = begin; i < end; i++) {
+    offset = EncodeValue(tuple.GetValue(schema, i), dst, offset, size);
+  }
+  return offset;
+}
+
+auto KeyEncoder::EncodeRid(RID rid, char *dst, size_t offset, size_t size) -> size_t {
+  // page ids are never negative, so the bits of RID::Get() order as its value does
+  return PutBigEndian(static_cast<uint64_t>(rid.Get()), 8, dst, offset, size);
+}
+
+void KeyEncoder::EncodeBigInt(int64_t value, char *dst, size_t size) {
+  memset(dst, 0, size);
+  EncodeValue(ValueFactory::GetBigIntValue(value), dst, 0, size);
+}
+
+auto KeyEncoder::Decode(const char *src, size_t size, const Schema *key_schema, uint32_t column_idx) -> Value {
+  size_t offset = 0;
+  // varchars before the column make its offset vary, so walk the columns before it
+  for (uint32_t i = 0; i < column_idx; i++) {
+    DecodeValue(key_schema->GetColumn(i).GetType(), src, &offset, size);
+  }
+  return DecodeValue(key_schema->GetColumn(column_idx).GetType(), src, &offset, size);
+}
+
+void KeyEncoder::DecodeColumns(const char *src, size_t size, const Schema *schema, uint32_t begin, uint32_t end,
+                               size_t *offset, std::vector<Value> *values) {
+  for (uint32_t i = begin; i < end; i++) {
+    values->push_back(DecodeValue(schema->GetColumn(i).GetType(), src, offset, size));
+  }
+}
+
+auto KeyEncoder::DecodeBigInt(const char *src, size_t size) -> int64_t {
+  size_t offset = 0;
+  return DecodeValue(TypeId::BIGINT, src, &offset, size).GetAs<int64_t>();
+}
+
+auto KeyEncoder::EncodeValue(const Value &value, char *dst, size_t offset, size_t size) -> size_t {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return PutBigEndian(static_cast<uint64_t>(value.GetAs<int8_t>()) ^ SignBit(1), 1, dst, offset, size);
+    case TypeId::SMALLINT:
+      return PutBigEndian(static_cast<uint64_t>(value.GetAs<int16_t>()) ^ SignBit(2), 2, dst, offset, size);
+    case TypeId::INTEGER:
+      return PutBigEndian(static_cast<uint64_t>(value.GetAs<int32_t>()) ^ SignBit(4), 4, dst, offset, size);
+    case TypeId::BIGINT:
+      return PutBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SIGN_BIT, 8, dst, offset, size);
+    case TypeId::TIMESTAMP:
+      return PutBigEndian(value.GetAs<uint64_t>(), 8, dst, offset, size);
+    case TypeId::DECIMAL: {
+      // -0.0 equals 0.0, so it must encode the same
+      const double decimal = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      bits = (bits & SIGN_BIT) != 0 ? ~bits : bits ^ SIGN_BIT;
+      return PutBigEndian(bits, 8, dst, offset, size);
+    }
+    case TypeId::VARCHAR: {
+      if (value.IsNull()) {
+        return PutByte(0, dst, offset, size);
+      }
+      offset = PutByte(1, dst, offset, size);
+      const char *data = value.GetData();
+      // the stored length counts the terminating '\0'
+      const uint32_t length = value.GetLength() - 1;
+      for (uint32_t i = 0; i < length && offset < size; i++) {
+        offset = PutByte(static_cast<uint8_t>(data[i]), dst, offset, size);
+        if (data[i] == 0) {
+          offset = PutByte(0xFF, dst, offset, size);
+        }
+      }
+      offset = PutByte(0, dst, offset, size);
+      return PutByte(0, dst, offset, size);
+    }
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "type cannot be encoded in an index key");
+  }
+}
+
+auto KeyEncoder::DecodeValue(TypeId type, const char *src, size_t *offset, size_t size) -> Value {
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return {type, static_cast<int8_t>(GetBigEndian(1, src, offset, size) ^ SignBit(1))};
+    case TypeId::TINYINT:
+      return {type, static_cast<int8_t>(GetBigEndian(1, src, offset, size) ^ SignBit(1))};
+    case TypeId::SMALLINT:
+      return {type, static_cast<int16_t>(GetBigEndian(2, src, offset, size) ^ SignBit(2))};
+    case TypeId::INTEGER:
+      return {type, static_cast<int32_t>(GetBigEndian(4, src, offset, size) ^ SignBit(4))};
+    case TypeId::BIGINT:
+      return {type, static_cast<int64_t>(GetBigEndian(8, src, offset, size) ^ SIGN_BIT)};
+    case TypeId::TIMESTAMP:
+      return {type, GetBigEndian(8, src, offset, size)};
+    case TypeId::DECIMAL: {
+      uint64_t bits = GetBigEndian(8, src, offset, size);
+      bits = (bits & SIGN_BIT) != 0 ? bits ^ SIGN_BIT : ~bits;
+      double decimal;
+      memcpy(&decimal, &bits, sizeof(decimal));
+      return {type, decimal};
+    }
+    case TypeId::VARCHAR: {
+      if (*offset >= size || src[(*offset)++] == 0) {
+        return ValueFactory::GetNullValueByType(type);
+      }
+      std::string data;
+      while (*offset < size) {
+        const char byte = src[(*offset)++];
+        if (byte != 0) {
+          data.push_back(byte);
+          continue;
+        }
+        // an escaped 0, or the terminator
+        if (*offset >= size || src[(*offset)++] == 0) {
+          break;
+        }
+        data.push_back(0);
+      }
+      return {type, data};
+    }
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "type cannot be decoded from an index key");
+  }
+}
+
+auto KeyEncoder::PutBigEndian(uint64_t bits, int width, char *dst, size_t offset, size_t size) -> size_t {
+  for (int i = width - 1; i >= 0; i--) {
+    offset = PutByte(static_cast<uint8_t>(bits >> (8 * i)), dst, offset, size);
+  }
+  return offset;
+}
+
+auto KeyEncoder::GetBigEndian(int width, const char *src, size_t *offset, size_t size) -> uint64_t {
+  uint64_t bits = 0;
+  for (int i = 0; i < width; i++) {
+    const uint8_t byte = *offset < size ? static_cast<uint8_t>(src[*offset]) : 0;
+    bits = (bits << 8) | byte;
+    (*offset)++;
+  }
+  return bits;
+}
+
+}  // namespace bustub
@@ -0,0 +1,354 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_compressed_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_compressed_page.h"
+
+namespace bustub {
+
+namespace {
+
+template <typename KeyType>
+auto Bytes(const KeyType &key) -> const char * {
+  return reinterpret_cast<const char *>(&key);
+}
+
+template <typename KeyType>
+auto Bytes(KeyType *key) -> char * {
+  return reinterpret_cast<char *>(key);
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * SHARED BYTES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SharedBytes::Add(const KeyType &key) {
+  if (empty_) {
+    base_ = key;
+    prefix_ = KEY_SIZE;
+    suffix_ = 0;
+    empty_ = false;
+    return;
+  }
+  const char *lhs = Bytes(base_);
+  const char *rhs = Bytes(key);
+  int prefix = 0;
+  while (prefix < prefix_ && lhs[prefix] == rhs[prefix]) {
+    prefix++;
+  }
+  // With nothing stored per key, every byte is shared, suffix included.
+  const int max_suffix = Width() == 0 ? KEY_SIZE : suffix_;
+  int suffix = 0;
+  while (suffix < max_suffix && lhs[KEY_SIZE - 1 - suffix] == rhs[KEY_SIZE - 1 - suffix]) {
+    suffix++;
+  }
+  prefix_ = prefix;
+  suffix_ = std::min(suffix, KEY_SIZE - prefix);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SharedBytes::Add(const SharedBytes &other) {
+  if (other.empty_) {
+    return;
+  }
+  const int other_suffix = other.Width() == 0 ? KEY_SIZE : other.suffix_;
+  Add(other.base_);
+  const int suffix = Width() == 0 ? KEY_SIZE : suffix_;
+  prefix_ = std::min(prefix_, other.prefix_);
+  suffix_ = std::min({suffix, other_suffix, KEY_SIZE - prefix_});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SharedBytes::Width() const -> int { return KEY_SIZE - prefix_ - suffix_; }
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetHighKey() const -> KeyType { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  KeyType key = base_key_;
+  memcpy(Bytes(&key) + prefix_size_, EntryAt(index), GetKeyWidth());
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  ValueType value;
+  memcpy(&value, EntryAt(index) + GetKeyWidth(), sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  memcpy(EntryAt(index) + GetKeyWidth(), &value, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Fits(int count, int width, size_t data_size) -> bool {
+  return static_cast<size_t>(count) * (width + sizeof(ValueType)) <= data_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Shared() const -> SharedBytes {
+  SharedBytes shared;
+  if (GetSize() == 1) {
+    shared.Add(KeyAt(0));
+  } else if (GetSize() > 1) {
+    shared.base_ = base_key_;
+    shared.prefix_ = prefix_size_;
+    shared.suffix_ = suffix_size_;
+    shared.empty_ = false;
+  }
+  return shared;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::HasRoomFor(const KeyType &key, size_t data_size) const -> bool {
+  SharedBytes shared = Shared();
+  shared.Add(key);
+  return Fits(GetSize() + 1, shared.Width(), data_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::HasRoomForAnyKey() const -> bool { return Fits(GetSize() + 1, KEY_SIZE); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::CanReplaceKey(const KeyType &key) const -> bool {
+  SharedBytes shared = Shared();
+  shared.Add(key);
+  return Fits(GetSize(), shared.Width());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::CanAbsorb(const BPlusTreeCompressedPage *other, const KeyType *key) const
+    -> bool {
+  SharedBytes shared = Shared();
+  shared.Add(other->Shared());
+  if (key != nullptr) {
+    shared.Add(*key);
+  }
+  return Fits(GetSize() + other->GetSize(), shared.Width());
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Both searches decode a probe key in place: the shared bytes are copied into it once, and each step of the binary
+ * search only overwrites the bytes that the entries store. The prefix of the search key is read once too, so most
+ * steps compare two integers.
+ *
+ * The halving loop has no early exit and a single data dependent choice per step, which the compiler turns into a
+ * conditional move when the comparison is cheap.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Search(const KeyType &key, int begin, const KeyComparator &comparator,
+                                              bool upper) const -> int {
+  int count = GetSize() - begin;
+  if (count <= 0) {
+    return begin;
+  }
+  KeyType probe = base_key_;
+  const int width = GetKeyWidth();
+  const uint64_t key_prefix = comparator.Prefix(key);
+  // upper searches skip the entries equal to key as well
+  const int limit = upper ? 1 : 0;
+  auto before = [&](int index) {
+    memcpy(Bytes(&probe) + prefix_size_, EntryAt(index), width);
+    return comparator.Compare(probe, comparator.Prefix(probe), key, key_prefix) < limit;
+  };
+  int base = begin;
+  while (count > 1) {
+    const int half = count / 2;
+    base = before(base + half) ? base + half : base;
+    count -= half;
+  }
+  return base + (before(base) ? 1 : 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::LowerBound(const KeyType &key, int begin, const KeyComparator &comparator) const
+    -> int {
+  return Search(key, begin, comparator, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::UpperBound(const KeyType &key, int begin, const KeyComparator &comparator) const
+    -> int {
+  return Search(key, begin, comparator, true);
+}
+
+/*****************************************************************************
+ * MODIFICATION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ClearEntries() {
+  SetSize(0);
+  prefix_size_ = KEY_SIZE;
+  suffix_size_ = 0;
+}
+
+/*
+ * Re-encode every entry for the shared bytes of shared. Entries move up when they get wider and down when they get
+ * narrower, so walk them from the end in the first case and from the start in the second one, and each entry is read
+ * before anything overwrites it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Relayout(const SharedBytes &shared) {
+  if (shared.empty_) {
+    return;
+  }
+  if (shared.prefix_ == prefix_size_ && shared.suffix_ == suffix_size_) {
+    base_key_ = shared.base_;
+    return;
+  }
+  const KeyType old_base = base_key_;
+  const int old_prefix = prefix_size_;
+  const int old_width = GetKeyWidth();
+  const int old_entry_size = GetEntrySize();
+  base_key_ = shared.base_;
+  prefix_size_ = shared.prefix_;
+  suffix_size_ = shared.suffix_;
+
+  auto move_entry = [&](int index) {
+    KeyType key = old_base;
+    ValueType value;
+    const char *entry = Entries() + index * old_entry_size;
+    memcpy(Bytes(&key) + old_prefix, entry, old_width);
+    memcpy(&value, entry + old_width, sizeof(ValueType));
+    WriteEntry(index, key, value);
+  };
+  if (GetKeyWidth() > old_width) {
+    for (int i = GetSize() - 1; i >= 0; i--) {
+      move_entry(i);
+    }
+  } else {
+    for (int i = 0; i < GetSize(); i++) {
+      move_entry(i);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::WriteEntry(int index, const KeyType &key, const ValueType &value) {
+  char *entry = EntryAt(index);
+  memcpy(entry, Bytes(key) + prefix_size_, GetKeyWidth());
+  memcpy(entry + GetKeyWidth(), &value, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::InsertEntry(int index, const KeyType &key, const ValueType &value) {
+  SharedBytes shared = Shared();
+  shared.Add(key);
+  BUSTUB_ASSERT(Fits(GetSize() + 1, shared.Width()), "no room for the entry");
+  Relayout(shared);
+  memmove(EntryAt(index + 1), EntryAt(index), (GetSize() - index) * GetEntrySize());
+  WriteEntry(index, key, value);
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::RemoveEntry(int index) {
+  memmove(EntryAt(index), EntryAt(index + 1), (GetSize() - index - 1) * GetEntrySize());
+  IncreaseSize(-1);
+  if (GetSize() == 0) {
+    ClearEntries();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ReplaceKey(int index, const KeyType &key) {
+  SharedBytes shared = Shared();
+  shared.Add(key);
+  BUSTUB_ASSERT(Fits(GetSize(), shared.Width()), "no room for the key");
+  Relayout(shared);
+  memcpy(EntryAt(index), Bytes(key) + prefix_size_, GetKeyWidth());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::AppendEntries(const BPlusTreeCompressedPage *source, int begin, int end) {
+  SharedBytes shared = Shared();
+  for (int i = begin; i < end; i++) {
+    shared.Add(source->KeyAt(i));
+  }
+  BUSTUB_ASSERT(Fits(GetSize() + end - begin, shared.Width()), "no room for the entries");
+  Relayout(shared);
+  for (int i = begin; i < end; i++) {
+    WriteEntry(GetSize(), source->KeyAt(i), source->ValueAt(i));
+    IncreaseSize(1);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::AppendEntries(const MappingType *items, int count) {
+  SharedBytes shared = Shared();
+  for (int i = 0; i < count; i++) {
+    shared.Add(items[i].first);
+  }
+  BUSTUB_ASSERT(Fits(GetSize() + count, shared.Width()), "no room for the entries");
+  Relayout(shared);
+  for (int i = 0; i < count; i++) {
+    WriteEntry(GetSize(), items[i].first, items[i].second);
+    IncreaseSize(1);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Truncate(int size) {
+  SharedBytes shared;
+  for (int i = 0; i < size; i++) {
+    shared.Add(KeyAt(i));
+  }
+  SetSize(size);
+  if (size == 0) {
+    ClearEntries();
+    return;
+  }
+  Relayout(shared);
+}
+
+template class BPlusTreeCompressedPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeCompressedPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeCompressedPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeCompressedPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeCompressedPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeCompressedPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeCompressedPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeCompressedPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BPlusTreeCompressedPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BPlusTreeCompressedPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+}  // namespace bustub
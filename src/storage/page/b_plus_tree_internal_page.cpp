@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -25,29 +26,74 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->SetPageType(IndexPageType::INTERNAL_PAGE);
+  this->ClearEntries();
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->SetNextPageId(INVALID_PAGE_ID);
+  this->SetPrevPageId(INVALID_PAGE_ID);
+  this->SetMaxSize(max_size);
+}
+
 /*
- * Helper method to get/set the key associated with input "index"(a.k.a
+ * Helper method to set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { this->ReplaceKey(index, key); }
 
+/*
+ * Helper method to find the array offset of a child pointer, -1 if the child is not in this page
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (this->ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
+// valuetype for internalNode should be page id_t
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
 /*
- * Helper method to get the value associated with input "index"(a.k.a array
- * offset)
+ * Binary search for the last key not greater than key; the first key is
+ * skipped and acts as negative infinity
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  return this->ValueAt(this->UpperBound(key, 1, comparator) - 1);
+}
+
+/*****************************************************************************
+ * INSERTION / REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  this->ClearEntries();
+  this->InsertEntry(0, new_key, old_value);
+  this->InsertEntry(1, new_key, new_value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  this->InsertEntry(index, key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) { this->RemoveEntry(index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetEntries(const MappingType *items, int count) {
+  this->ClearEntries();
+  this->AppendEntries(items, count);
+}
 
-// valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
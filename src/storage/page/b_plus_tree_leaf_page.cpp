@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
@@ -24,29 +25,103 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page ids and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->SetPageType(IndexPageType::LEAF_PAGE);
+  this->ClearEntries();
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->SetNextPageId(INVALID_PAGE_ID);
+  this->SetPrevPageId(INVALID_PAGE_ID);
+  this->SetMaxSize(max_size);
+}
 
-/**
- * Helper methods to set/get next page id
+/*
+ * Helper method to find and return the key-value pair associated with input "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  return MappingType(this->KeyAt(index), this->ValueAt(index));
+}
 
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  return this->LowerBound(key, 0, comparator);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::UpperKeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  return this->UpperBound(key, 0, comparator);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index < this->GetSize() && comparator(this->KeyAt(index), key) == 0) {
+    *value = this->ValueAt(index);
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * INSERTION / REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index < this->GetSize() && comparator(this->KeyAt(index), key) == 0) {
+    return false;
+  }
+  this->InsertEntry(index, key, value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index >= this->GetSize() || comparator(this->KeyAt(index), key) != 0) {
+    return false;
+  }
+  this->RemoveEntry(index);
+  return true;
+}
+
+/*****************************************************************************
+ * SPLIT / MERGE / REDISTRIBUTE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = this->GetSize() / 2;
+  recipient->AppendEntries(this, keep, this->GetSize());
+  this->Truncate(keep);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->AppendEntries(this, 0, this->GetSize());
+  recipient->SetNextPageId(this->GetNextPageId());
+  this->ClearEntries();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->AppendEntries(this, 0, 1);
+  this->RemoveEntry(0);
+}
 
-/*
- * Helper method to find and return the key associated with input "index"(a.k.a
- * array offset)
- */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  int last = this->GetSize() - 1;
+  recipient->InsertEntry(0, this->KeyAt(last), this->ValueAt(last));
+  this->RemoveEntry(last);
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
@@ -25,8 +25,8 @@ auto HeaderPage::InsertRecord(const std::string &name, const page_id_t root_id)
 
   int record_num = GetRecordCount();
   int offset = 4 + record_num * 36;
-  // check for duplicate name
-  if (FindRecord(name) != -1) {
+  // check for duplicate name, and for room
+  if (FindRecord(name) != -1 || record_num == MAX_RECORD_COUNT) {
     return false;
   }
   // copy record content
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "common/logger.h"
@@ -23,7 +24,10 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  page_chain_.push_back(first_page_id_);
+  chain_positions_[first_page_id_] = 0;
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
@@ -34,15 +38,17 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  page_chain_.push_back(first_page_id_);
+  chain_positions_[first_page_id_] = 0;
 }
 
-auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferRing *ring) -> bool {
   if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto cur_page = static_cast<TablePage *>(FetchPage(first_page_id_, ring));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
@@ -56,7 +62,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      auto next_page = static_cast<TablePage *>(FetchPage(next_page_id, ring));
       next_page->WLatch();
       // Unlatch and unpin the current page.
       cur_page->WUnlatch();
@@ -64,7 +70,9 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       cur_page = next_page;
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(
+          ring == nullptr ? buffer_pool_manager_->NewPage(&next_page_id)
+                          : buffer_pool_manager_->NewPage(&next_page_id, AccessType::SCAN, ring));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -76,6 +84,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       // Otherwise we were able to create a new page. We initialize it now.
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
+      RememberNextPage(cur_page->GetTablePageId(), next_page_id);
       new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
@@ -156,9 +165,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock, BufferRing *ring)
+    -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(FetchPage(rid.GetPageId(), ring));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -176,13 +186,17 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   return res;
 }
 
-auto TableHeap::Begin(Transaction *txn) -> TableIterator {
+auto TableHeap::Begin(Transaction *txn, size_t readahead_window, BufferRing *ring) -> TableIterator {
   // Start an iterator from the first page.
+  return BeginAt(first_page_id_, txn, readahead_window, ring);
+}
+
+auto TableHeap::BeginAt(page_id_t page_id, Transaction *txn, size_t readahead_window, BufferRing *ring)
+    -> TableIterator {
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
-  auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(FetchPage(page_id, ring));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
@@ -193,9 +207,87 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
     }
     page_id = page->GetNextPageId();
   }
-  return {this, rid, txn};
+  return {this, rid, txn, readahead_window, ring};
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
+auto TableHeap::GetPageIds() -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::mutex> lock(chain_latch_);
+    page_ids = page_chain_;
+  }
+  // follow the chain from the last page we know of
+  while (true) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids.back()));
+    BUSTUB_ENSURE(page != nullptr, "BPM full");
+    page->RLatch();
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids.back(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return page_ids;
+    }
+    RememberNextPage(page_ids.back(), next_page_id);
+    page_ids.push_back(next_page_id);
+  }
+}
+
+auto TableHeap::GetChainPosition(page_id_t page_id) -> size_t {
+  std::scoped_lock<std::mutex> lock(chain_latch_);
+  auto it = chain_positions_.find(page_id);
+  // the pages the table does not know of yet are past those it does
+  return it == chain_positions_.end() ? page_chain_.size() : it->second;
+}
+
+void TableHeap::RememberNextPage(page_id_t page_id, page_id_t next_page_id) {
+  std::scoped_lock<std::mutex> lock(chain_latch_);
+  if (page_chain_.back() == page_id && chain_positions_.count(next_page_id) == 0) {
+    chain_positions_[next_page_id] = page_chain_.size();
+    page_chain_.push_back(next_page_id);
+  }
+}
+
+void TableHeap::ReadAhead(page_id_t page_id, size_t window, size_t *horizon, BufferRing *ring) {
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::mutex> lock(chain_latch_);
+    auto it = chain_positions_.find(page_id);
+    if (it == chain_positions_.end()) {
+      return;
+    }
+    // Issue the next chunk only once the scan has consumed half of the window, so prefetches go out in batches.
+    const size_t position = it->second;
+    if (*horizon > position + window / 2) {
+      return;
+    }
+    const size_t end = std::min(position + window + 1, page_chain_.size());
+    for (size_t i = std::max(position + 1, *horizon); i < end; i++) {
+      page_ids.push_back(page_chain_[i]);
+    }
+    *horizon = std::max(*horizon, end);
+  }
+  buffer_pool_manager_->PrefetchPages(page_ids, ring);
+}
+
+auto TableHeap::MakeScanRing() -> std::unique_ptr<BufferRing> {
+  size_t num_pages;
+  {
+    std::scoped_lock<std::mutex> lock(chain_latch_);
+    num_pages = page_chain_.size();
+  }
+  if (num_pages <= buffer_pool_manager_->GetPoolSize() / 4) {
+    return nullptr;
+  }
+  return std::make_unique<BufferRing>();
+}
+
+auto TableHeap::FetchPage(page_id_t page_id, BufferRing *ring) -> Page * {
+  if (ring == nullptr) {
+    return buffer_pool_manager_->FetchPage(page_id);
+  }
+  return buffer_pool_manager_->FetchPage(page_id, AccessType::SCAN, ring);
+}
+
 }  // namespace bustub
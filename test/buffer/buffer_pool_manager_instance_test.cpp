@@ -12,6 +12,8 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstring>
 #include <memory>
 #include <random>
@@ -21,6 +23,8 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "mock_buffer_pool_manager.h"  // NOLINT
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -948,4 +952,342 @@ TEST(BufferPoolManagerInstanceTest, HardTest_4) {  // NOLINT
   }
 }
 
+/** A disk manager whose reads of one page are slow, and which counts reads of that page. */
+class SlowReadDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit SlowReadDiskManager(page_id_t slow_page_id) : slow_page_id_(slow_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == slow_page_id_) {
+      slow_reads_++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> slow_reads_{0};
+
+ private:
+  page_id_t slow_page_id_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, IoOutsideLatch) {
+  const size_t buffer_pool_size = 4;
+  auto *disk_manager = new SlowReadDiskManager(0);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Page 0 is written out and evicted; page 1 stays resident.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+  }
+  auto *hot = bpm->FetchPage(1, nullptr);
+  ASSERT_NE(nullptr, hot);
+  ASSERT_TRUE(bpm->UnpinPage(1, false, nullptr));
+  ASSERT_TRUE(bpm->FlushPage(0, nullptr));
+  ASSERT_TRUE(bpm->DeletePage(0, nullptr));
+
+  // Scenario: two threads fetch page 0 at the same time. Only one of them reads it from disk, and both get the
+  // same frame with the right content.
+  std::vector<std::thread> readers;
+  std::vector<Page *> results(2, nullptr);
+  for (size_t i = 0; i < results.size(); i++) {
+    readers.emplace_back([&bpm, &results, i]() { results[i] = bpm->FetchPage(0, nullptr); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  // Scenario: while page 0 is being read, a cache hit on page 1 does not wait for that I/O.
+  auto start = std::chrono::steady_clock::now();
+  hot = bpm->FetchPage(1, nullptr);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_NE(nullptr, hot);
+  EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 150);
+  EXPECT_EQ(0, strcmp(hot->GetData(), "page-1"));
+  ASSERT_TRUE(bpm->UnpinPage(1, false, nullptr));
+
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(1, disk_manager->slow_reads_.load());
+  ASSERT_NE(nullptr, results[0]);
+  EXPECT_EQ(results[0], results[1]);
+  EXPECT_EQ(0, strcmp(results[0]->GetData(), "page-0"));
+  EXPECT_EQ(2, results[0]->GetPinCount());
+  ASSERT_TRUE(bpm->UnpinPage(0, false, nullptr));
+  ASSERT_TRUE(bpm->UnpinPage(0, false, nullptr));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleaner) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+  }
+  // Keep page 9 pinned: the cleaner only writes back unpinned pages.
+  ASSERT_NE(nullptr, bpm->FetchPage(9, nullptr));
+
+  // Scenario: the first round cleans half of the evictable frames, as adjacent pages in a single run.
+  bpm->StartPageCleaner({0.5, std::chrono::milliseconds(10000), 64});
+  bpm->StopPageCleaner();
+  auto stats = bpm->GetPageCleanerStats();
+  EXPECT_EQ(1, stats.rounds_);
+  EXPECT_EQ(5, stats.pages_cleaned_);
+  EXPECT_EQ(1, stats.write_runs_);
+  for (page_id_t i = 0; i < 5; i++) {
+    char data[BUSTUB_PAGE_SIZE];
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ("page-" + std::to_string(i), std::string(data));
+  }
+
+  // Scenario: nothing to do while enough frames are clean. Once page 0 is dirtied again, the next round continues
+  // after the pages the previous round cleaned.
+  EXPECT_EQ(0, bpm->CleanPages());
+  ASSERT_NE(nullptr, bpm->FetchPage(0, nullptr));
+  ASSERT_TRUE(bpm->UnpinPage(0, true, nullptr));
+  EXPECT_EQ(1, bpm->CleanPages());
+  stats = bpm->GetPageCleanerStats();
+  EXPECT_EQ(6, stats.pages_cleaned_);
+  char data[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(5, data);
+  EXPECT_EQ("page-5", std::string(data));
+
+  // Scenario: evicting the cleaned pages does not need a foreground write, evicting the others does.
+  for (size_t i = 0; i < buffer_pool_size - 1; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id, nullptr));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false, nullptr));
+  }
+  stats = bpm->GetPageCleanerStats();
+  EXPECT_EQ(5, stats.stalls_avoided_);
+  EXPECT_EQ(4, stats.dirty_evictions_);
+
+  ASSERT_TRUE(bpm->UnpinPage(9, false, nullptr));
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerWal) {
+  const size_t buffer_pool_size = 4;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, LRUK_REPLACER_K, log_manager);
+  enable_logging = true;
+  log_manager->SetPersistentLSN(10);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(static_cast<lsn_t>(i * 10));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+  }
+
+  // Scenario: pages whose log records are not yet persistent are not written back.
+  bpm->StartPageCleaner({1.0, std::chrono::milliseconds(10000), 64});
+  bpm->StopPageCleaner();
+  auto stats = bpm->GetPageCleanerStats();
+  EXPECT_EQ(2, stats.pages_cleaned_);
+  EXPECT_EQ(2, stats.wal_skipped_);
+
+  // Scenario: once the log has caught up, they are.
+  log_manager->SetPersistentLSN(30);
+  EXPECT_EQ(2, bpm->CleanPages());
+  EXPECT_EQ(0, bpm->CleanPages());
+
+  enable_logging = false;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerConcurrency) {
+  const size_t buffer_pool_size = 16;
+  const int num_threads = 4;
+  const int num_pages = 64;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->StartPageCleaner({0.5, std::chrono::milliseconds(1), 8});
+
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+  }
+
+  // Every thread keeps rewriting its own pages while the cleaner writes them back in the background.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, tid]() {
+      for (int round = 0; round < 20; round++) {
+        for (page_id_t pid = tid; pid < num_pages; pid += num_threads) {
+          auto *page = bpm->FetchPage(pid, nullptr);
+          if (page == nullptr) {
+            continue;
+          }
+          page->WLatch();
+          snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d-%d", pid, round);
+          page->WUnlatch();
+          EXPECT_TRUE(bpm->UnpinPage(pid, true, nullptr));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bpm->StopPageCleaner();
+  EXPECT_GT(bpm->GetPageCleanerStats().pages_cleaned_, 0);
+
+  for (page_id_t pid = 0; pid < num_pages; pid++) {
+    auto *page = bpm->FetchPage(pid, nullptr);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(pid) + "-19", std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(pid, false, nullptr));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, HitsDuringEviction) {
+  const size_t buffer_pool_size = 8;
+  const int num_threads = 4;
+  const int num_pages = 24;
+  for (const auto replacer_type : {ReplacerType::LRU_K, ReplacerType::CLOCK}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2, nullptr, replacer_type);
+
+    page_id_t page_id;
+    for (int i = 0; i < num_pages; i++) {
+      auto *page = bpm->NewPage(&page_id, nullptr);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+    }
+
+    // Hits take no latch, so they race with the misses that evict the frames they look up.
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&bpm, tid]() {
+        std::mt19937 gen(tid);
+        std::uniform_int_distribution<page_id_t> pages(0, num_pages - 1);
+        for (int i = 0; i < 5000; i++) {
+          // most fetches go to a few hot pages
+          const page_id_t pid = i % 4 == 0 ? pages(gen) : pages(gen) % 3;
+          auto *page = bpm->FetchPage(pid, nullptr);
+          if (page == nullptr) {
+            continue;
+          }
+          EXPECT_EQ(pid, page->GetPageId());
+          EXPECT_EQ("page-" + std::to_string(pid), std::string(page->GetData()));
+          EXPECT_TRUE(bpm->UnpinPage(pid, false, nullptr));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // No frame was left pinned or kept from the replacer, so the whole pool can be filled again.
+    const page_id_t first_page_id = num_pages - static_cast<page_id_t>(buffer_pool_size);
+    for (page_id_t pid = first_page_id; pid < num_pages; pid++) {
+      auto *page = bpm->FetchPage(pid, nullptr);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(1, page->GetPinCount());
+    }
+    for (page_id_t pid = first_page_id; pid < num_pages; pid++) {
+      ASSERT_TRUE(bpm->UnpinPage(pid, false, nullptr));
+    }
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+/** A disk manager that counts reads, and how many of them were issued off the calling thread. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_++;
+    if (std::this_thread::get_id() != owner_) {
+      background_reads_++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> reads_{0};
+  std::atomic<int> background_reads_{0};
+
+ private:
+  std::thread::id owner_{std::this_thread::get_id()};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchPages) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true, nullptr));
+  }
+  // Pages 10..19 are resident, 0..9 are on disk.
+  ASSERT_EQ(0, disk_manager->reads_.load());
+
+  // Scenario: resident and unallocated pages are skipped, and at most half of the evictable frames are used.
+  bpm->PrefetchPages({15, 0, 1, 2, 3, 4, 5, 6, 100});
+  for (page_id_t pid = 0; pid < 5; pid++) {
+    auto *page = bpm->FetchPage(pid, nullptr);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(pid), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(pid, false, nullptr));
+  }
+  EXPECT_EQ(5, disk_manager->reads_.load());
+  EXPECT_EQ(5, disk_manager->background_reads_.load());
+
+  // Scenario: pages that did not fit in the budget are read by FetchPage as usual.
+  auto *page = bpm->FetchPage(5, nullptr);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page-5", std::string(page->GetData()));
+  ASSERT_TRUE(bpm->UnpinPage(5, false, nullptr));
+  EXPECT_EQ(6, disk_manager->reads_.load());
+
+  // Scenario: nothing is prefetched while every frame is pinned.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id, nullptr));
+    pinned.push_back(page_id);
+  }
+  bpm->PrefetchPages({6, 7, 8});
+  EXPECT_EQ(nullptr, bpm->FetchPage(6, nullptr));
+  for (auto pid : pinned) {
+    ASSERT_TRUE(bpm->UnpinPage(pid, false, nullptr));
+  }
+
+  delete bpm;
+  EXPECT_EQ(6, disk_manager->reads_.load());
+  delete disk_manager;
+}
+
 }  // namespace bustub
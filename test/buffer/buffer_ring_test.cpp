@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_ring_test.cpp
+//
+// Identification: test/buffer/buffer_ring_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Threads that set this flag have their disk reads counted by CountingDiskManager. */
+thread_local bool count_reads = false;
+
+/** A disk manager that counts the reads issued by threads that asked for it. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (count_reads) {
+      reads_++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> reads_{0};
+};
+
+/**
+ * Create num_pages pages, then make the first num_hot of them resident and hot. Returns the number of disk reads it
+ * takes to fetch the hot pages again after scanning all the other pages, with or without a ring.
+ */
+auto HotReadsAfterScan(BufferPoolManager *bpm, CountingDiskManager *disk_manager, int num_pages, int num_hot,
+                       BufferRing *ring) -> int {
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (int round = 0; round < 3; round++) {
+    for (page_id_t pid = 0; pid < num_hot; pid++) {
+      EXPECT_NE(nullptr, bpm->FetchPage(pid));
+      EXPECT_TRUE(bpm->UnpinPage(pid, false));
+    }
+  }
+
+  for (page_id_t pid = num_hot; pid < num_pages; pid++) {
+    auto *page = bpm->FetchPage(pid, AccessType::SCAN, ring);
+    EXPECT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(pid), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(pid, false));
+  }
+
+  count_reads = true;
+  disk_manager->reads_ = 0;
+  for (page_id_t pid = 0; pid < num_hot; pid++) {
+    auto *page = bpm->FetchPage(pid);
+    EXPECT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(pid), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(pid, false));
+  }
+  count_reads = false;
+  return disk_manager->reads_.load();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferRingTest, ScanDoesNotFlushHotPages) {
+  const int pool_size = 20;
+  const int num_hot = 10;
+  const int num_pages = 100;
+
+  // Scenario: without a ring, the scan pushes all the hot pages out.
+  {
+    auto disk_manager = std::make_unique<CountingDiskManager>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    EXPECT_EQ(num_hot, HotReadsAfterScan(bpm.get(), disk_manager.get(), num_pages, num_hot, nullptr));
+  }
+
+  // Scenario: with a ring of 4 frames, the scan only recycles its own frames and every hot page survives.
+  {
+    auto disk_manager = std::make_unique<CountingDiskManager>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    BufferRing ring(4);
+    EXPECT_EQ(0, HotReadsAfterScan(bpm.get(), disk_manager.get(), num_pages, num_hot, &ring));
+  }
+
+  // Scenario: the same holds for a parallel buffer pool, where the ring keeps a share per instance.
+  {
+    auto disk_manager = std::make_unique<CountingDiskManager>();
+    auto bpm = std::make_unique<ParallelBufferPoolManager>(2, pool_size / 2, disk_manager.get());
+    BufferRing ring(4);
+    EXPECT_EQ(0, HotReadsAfterScan(bpm.get(), disk_manager.get(), num_pages, num_hot, &ring));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferRingTest, RingSkipsPinnedPages) {
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get());
+  BufferRing ring(2);
+
+  // Pages 0 and 1 fill the ring; page 0 stays pinned.
+  page_id_t page_id;
+  for (int i = 0; i < 2; i++) {
+    auto *page = bpm->NewPage(&page_id, AccessType::SCAN, &ring);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+  }
+  ASSERT_TRUE(bpm->UnpinPage(1, true));
+
+  // Scenario: the oldest page of the ring is pinned, so it leaves the ring and page 2 takes a frame from the pool.
+  auto *page = bpm->NewPage(&page_id, AccessType::SCAN, &ring);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(&bpm->GetPages()[2], page);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: the ring now holds pages 1 and 2, so page 3 recycles the frame of page 1.
+  page = bpm->NewPage(&page_id, AccessType::SCAN, &ring);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(&bpm->GetPages()[1], page);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_EQ("page-0", std::string(bpm->GetPages()[0].GetData()));
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+
+  // Scenario: the dirty page whose frame was recycled has been written back.
+  count_reads = true;
+  page = bpm->FetchPage(1);
+  count_reads = false;
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, disk_manager->reads_.load());
+  EXPECT_EQ("page-1", std::string(page->GetData()));
+  ASSERT_TRUE(bpm->UnpinPage(1, false));
+}
+
+/**
+ * One thread looks up rows of a small hot table at random while other threads scan a large table over and over.
+ * Prints the hit rate of the lookups with and without scan rings.
+ */
+// NOLINTNEXTLINE
+TEST(BufferRingTest, DISABLED_HitRateBenchmark) {
+  const size_t pool_size = 256;
+  const int num_hot_rows = 1000;
+  const int num_scan_rows = 3000;
+  const int num_scanners = 2;
+  const auto duration = std::chrono::seconds(3);
+
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 1500};
+  Schema schema{std::vector<Column>{col1, col2}};
+  // hot rows are small, scanned rows fill a page each
+  auto make_tuple = [&schema](int i, size_t length) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(length, 'x'))};
+    return Tuple(values, &schema);
+  };
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool use_ring : {false, true}) {
+    auto disk_manager = std::make_unique<CountingDiskManager>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    auto txn = std::make_unique<Transaction>(0);
+    auto hot_table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, txn.get());
+    auto scan_table = std::make_unique<TableHeap>(bpm.get(), nullptr, nullptr, txn.get());
+    std::vector<RID> hot_rids;
+    for (int i = 0; i < num_hot_rows; i++) {
+      RID rid;
+      ASSERT_TRUE(hot_table->InsertTuple(make_tuple(i, 100), &rid, txn.get()));
+      hot_rids.push_back(rid);
+    }
+    for (int i = 0; i < num_scan_rows; i++) {
+      RID rid;
+      ASSERT_TRUE(scan_table->InsertTuple(make_tuple(i, 1200), &rid, txn.get(), scan_table->MakeScanRing().get()));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> lookups{0};
+    std::atomic<int> scans{0};
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() {
+      count_reads = true;
+      std::mt19937 gen(42);
+      std::uniform_int_distribution<size_t> dist(0, hot_rids.size() - 1);
+      Tuple tuple;
+      while (!stop) {
+        EXPECT_TRUE(hot_table->GetTuple(hot_rids[dist(gen)], &tuple, txn.get()));
+        lookups++;
+      }
+    });
+    for (int i = 0; i < num_scanners; i++) {
+      threads.emplace_back([&]() {
+        while (!stop) {
+          auto ring = use_ring ? scan_table->MakeScanRing() : nullptr;
+          int count = 0;
+          for (auto itr = scan_table->Begin(txn.get(), SEQ_SCAN_READAHEAD_PAGES, ring.get());
+               itr != scan_table->End() && !stop; ++itr) {
+            count++;
+          }
+          scans++;
+        }
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    const double hit_rate = 1.0 - static_cast<double>(disk_manager->reads_) / lookups;
+    std::cout << (use_ring ? "with rings:    " : "without rings: ") << lookups << " lookups, " << scans
+              << " full scans, lookup hit rate " << hit_rate * 100 << "%" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -10,16 +10,27 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
 #include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +70,180 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrentEvict) {
+  const int num_frames = 1000;
+  const int num_threads = 4;
+  ClockReplacer clock_replacer(num_frames);
+  for (int i = 0; i < num_frames; i++) {
+    clock_replacer.RecordAccess(i);
+  }
+  // Odd frames are pinned.
+  for (int i = 1; i < num_frames; i += 2) {
+    clock_replacer.SetEvictable(i, false);
+  }
+  EXPECT_EQ(num_frames / 2, clock_replacer.Size());
+
+  // Scenario: threads evict concurrently while others keep hitting the pinned frames. Every even frame is evicted
+  // exactly once.
+  std::vector<std::vector<frame_id_t>> evicted(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      frame_id_t frame_id;
+      for (int i = 0; i < num_frames / 2 / num_threads; i++) {
+        ASSERT_TRUE(clock_replacer.Evict(&frame_id));
+        evicted[tid].push_back(frame_id);
+        clock_replacer.RecordAccess(tid * 2 + 1);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<int> times_evicted(num_frames, 0);
+  for (const auto &frames : evicted) {
+    for (auto frame_id : frames) {
+      times_evicted[frame_id]++;
+    }
+  }
+  for (int i = 0; i < num_frames; i++) {
+    EXPECT_EQ(i % 2 == 0 ? 1 : 0, times_evicted[i]) << "frame " << i;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+  frame_id_t frame_id;
+  EXPECT_FALSE(clock_replacer.Evict(&frame_id));
+}
+
+TEST(ClockReplacerTest, BufferPoolManager) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                         ReplacerType::CLOCK);
+
+  // Scenario: write more pages than fit in the pool, then read them all back.
+  page_id_t page_id;
+  for (int i = 0; i < 50; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t pid = 0; pid < 50; pid++) {
+    auto *page = bpm->FetchPage(pid);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(pid), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(pid, false));
+  }
+
+  // Scenario: with every frame pinned there is nothing to evict.
+  for (page_id_t pid = 0; pid < 10; pid++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(pid));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(nullptr, bpm->FetchPage(10));
+}
+
+namespace {
+
+/** Draws page ids from a Zipfian distribution with the given skew; page 0 is the most popular. */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t num_pages, double theta, uint64_t seed) : gen_(seed), cdf_(num_pages) {
+    double sum = 0;
+    for (size_t i = 0; i < num_pages; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+      cdf_[i] = sum;
+    }
+    for (auto &c : cdf_) {
+      c /= sum;
+    }
+  }
+
+  auto Next() -> page_id_t {
+    double u = std::uniform_real_distribution<double>(0, 1)(gen_);
+    return static_cast<page_id_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+  }
+
+ private:
+  std::mt19937_64 gen_;
+  std::vector<double> cdf_;
+};
+
+/**
+ * Replays a trace of page accesses against a replacer the way the buffer pool drives it, and returns the hit rate.
+ * Throughput (replayed accesses per second) is returned through ops_per_sec.
+ */
+auto ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace, double *ops_per_sec)
+    -> double {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(num_frames, INVALID_PAGE_ID);
+  size_t next_free = 0;
+  size_t hits = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : trace) {
+    frame_id_t frame_id;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      frame_id = it->second;
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, false);
+    } else {
+      if (next_free < num_frames) {
+        frame_id = static_cast<frame_id_t>(next_free++);
+      } else {
+        EXPECT_TRUE(replacer->Evict(&frame_id));
+        page_table.erase(frame_pages[frame_id]);
+      }
+      page_table[page_id] = frame_id;
+      frame_pages[frame_id] = page_id;
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, false);
+    }
+    replacer->SetEvictable(frame_id, true);
+  }
+  auto end = std::chrono::steady_clock::now();
+  *ops_per_sec = static_cast<double>(trace.size()) / std::chrono::duration<double>(end - start).count();
+  return static_cast<double>(hits) / static_cast<double>(trace.size());
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, DISABLED_ComparisonBenchmark) {
+  const size_t num_frames = 1000;
+  const size_t num_pages = 20000;
+  const size_t trace_length = 2000000;
+
+  // Zipfian point lookups.
+  std::vector<page_id_t> zipf_trace;
+  ZipfianGenerator zipf(num_pages, 0.99, 42);
+  for (size_t i = 0; i < trace_length; i++) {
+    zipf_trace.push_back(zipf.Next());
+  }
+  // The same lookups, with one sequential scan over a disjoint range of 5000 pages every 100000 accesses.
+  std::vector<page_id_t> scan_trace;
+  for (size_t i = 0; i < trace_length; i++) {
+    if (i % 100000 == 0) {
+      for (size_t j = 0; j < 5000; j++) {
+        scan_trace.push_back(static_cast<page_id_t>(num_pages + j));
+      }
+    }
+    scan_trace.push_back(zipf_trace[i]);
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (const auto &[name, trace] : {std::make_pair("zipfian", &zipf_trace), std::make_pair("scan-mixed", &scan_trace)}) {
+    double ops_per_sec;
+    LRUKReplacer lru_k(num_frames, LRUK_REPLACER_K);
+    double lru_k_hit_rate = ReplayTrace(&lru_k, num_frames, *trace, &ops_per_sec);
+    std::cout << name << " lru-k: hit rate " << lru_k_hit_rate << ", " << static_cast<size_t>(ops_per_sec)
+              << " accesses/sec" << std::endl;
+    ClockReplacer clock(num_frames);
+    double clock_hit_rate = ReplayTrace(&clock, num_frames, *trace, &ops_per_sec);
+    std::cout << name << " clock: hit rate " << clock_hit_rate << ", " << static_cast<size_t>(ops_per_sec)
+              << " accesses/sec" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -3,7 +3,9 @@
  */
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <memory>
 #include <random>
 #include <set>
@@ -565,4 +567,40 @@ TEST(LRUKReplacerTest, ConcurrencyTest) {  // NOLINT
     ASSERT_EQ(i, evicted_elements[i - 500]);
   }
 }
-}  // namespace bustub
\ No newline at end of file
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, DISABLED_ThroughputBenchmark) {
+  const size_t num_ops = 4000000;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_frames = 1000; num_frames <= 1000000; num_frames *= 10) {
+    LRUKReplacer lru_replacer(num_frames, 2);
+    for (size_t i = 0; i < num_frames; i++) {
+      lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    }
+
+    // Buffer pool traffic: a hit pins, re-accesses and unpins a frame; one access in eight misses and evicts.
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<frame_id_t> dist(0, static_cast<frame_id_t>(num_frames) - 1);
+    size_t ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (ops < num_ops) {
+      frame_id_t frame_id = dist(gen);
+      if ((ops & 7) == 0) {
+        ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+      } else {
+        lru_replacer.SetEvictable(frame_id, false);
+      }
+      lru_replacer.RecordAccess(frame_id);
+      lru_replacer.SetEvictable(frame_id, true);
+      ops += 3;
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << num_frames << " frames: " << static_cast<size_t>(static_cast<double>(ops) / seconds) << " ops/sec"
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
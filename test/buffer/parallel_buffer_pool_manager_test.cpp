@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  ASSERT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  ASSERT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = buffer_pool_size * num_instances; i < buffer_pool_size * num_instances * 2; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4}, we should be able to create 5 new pages.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  bpm->FlushPage(0);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PageIdRouting) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Round-robin allocation hands out every page id exactly once.
+  std::vector<bool> seen(buffer_pool_size * num_instances, false);
+  for (size_t i = 0; i < buffer_pool_size * num_instances; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_LT(static_cast<size_t>(page_id), seen.size());
+    ASSERT_FALSE(seen[page_id]);
+    seen[page_id] = true;
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Force every page out to disk and read it back through the owning instance.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size * num_instances); i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetPageId());
+    EXPECT_EQ("page-" + std::to_string(i), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+    ASSERT_TRUE(bpm->DeletePage(i));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const int num_threads = 8;
+  const int num_runs = 20;
+  for (int run = 0; run < num_runs; run++) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto bpm = std::make_shared<ParallelBufferPoolManager>(4, 50, disk_manager);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&bpm]() {
+        page_id_t temp_page_id;
+        std::vector<page_id_t> page_ids;
+        for (int i = 0; i < 10; i++) {
+          auto *new_page = bpm->NewPage(&temp_page_id);
+          EXPECT_NE(nullptr, new_page);
+          ASSERT_NE(nullptr, new_page);
+          strcpy(new_page->GetData(), std::to_string(temp_page_id).c_str());  // NOLINT
+          page_ids.push_back(temp_page_id);
+        }
+        for (int i = 0; i < 10; i++) {
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[i], true));
+        }
+        for (int j = 0; j < 10; j++) {
+          auto *page = bpm->FetchPage(page_ids[j]);
+          EXPECT_NE(nullptr, page);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(0, strcmp(page->GetData(), (std::to_string(page_ids[j])).c_str()));
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[j], true));
+        }
+        for (int j = 0; j < 10; j++) {
+          EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
+        }
+      });
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+
+    delete disk_manager;
+  }
+}
+
+namespace {
+
+/**
+ * Runs num_threads workers doing FetchPage/UnpinPage on a random page of a working set that fits in the pool,
+ * and returns the achieved throughput in operations per second.
+ */
+auto BufferPoolThroughput(BufferPoolManager *bpm, size_t num_pages, size_t num_threads, size_t ops_per_thread)
+    -> double {
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_ids[i]);
+    EXPECT_NE(nullptr, page);
+    bpm->UnpinPage(page_ids[i], true);
+  }
+
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &page_ids, tid, ops_per_thread]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_ids[dist(gen)];
+        auto *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, (i & 7) == 0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto seconds = std::chrono::duration<double>(end - start).count();
+  return static_cast<double>(num_threads * ops_per_thread) / seconds;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_ThroughputBenchmark) {
+  const size_t total_frames = 1024;
+  const size_t ops_per_thread = 200000;
+  const size_t num_instances = 16;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "threads\tsingle BPI (ops/s)\tsingle BPI, CLOCK (ops/s)\tparallel BPM x" << num_instances << " (ops/s)"
+            << std::endl;
+  for (size_t num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *single = new BufferPoolManagerInstance(total_frames, disk_manager);
+    auto single_ops = BufferPoolThroughput(single, total_frames / 2, num_threads, ops_per_thread);
+    delete single;
+    delete disk_manager;
+
+    disk_manager = new DiskManagerUnlimitedMemory();
+    auto *clock =
+        new BufferPoolManagerInstance(total_frames, disk_manager, LRUK_REPLACER_K, nullptr, ReplacerType::CLOCK);
+    auto clock_ops = BufferPoolThroughput(clock, total_frames / 2, num_threads, ops_per_thread);
+    delete clock;
+    delete disk_manager;
+
+    disk_manager = new DiskManagerUnlimitedMemory();
+    auto *parallel = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+    auto parallel_ops = BufferPoolThroughput(parallel, total_frames / 2, num_threads, ops_per_thread);
+    delete parallel;
+    delete disk_manager;
+
+    std::cout << num_threads << "\t" << static_cast<uint64_t>(single_ops) << "\t" << static_cast<uint64_t>(clock_ops)
+              << "\t" << static_cast<uint64_t>(parallel_ops) << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
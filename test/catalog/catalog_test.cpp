@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -17,6 +20,7 @@
 #include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
+#include "common/bustub_instance.h"
 #include "execution/executor_context.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
@@ -688,4 +692,53 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// The catalog and the index roots are kept in the database file, so a new instance opens it without rebuilding
+TEST(CatalogTest, ReopenDatabase) {
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  const auto execute = [](BustubInstance *bustub, const std::string &sql) {
+    std::stringstream result;
+    SimpleStreamWriter writer(result, true, ",");
+    bustub->ExecuteSql(sql, writer);
+    return result.str();
+  };
+
+  auto bustub = std::make_unique<BustubInstance>("catalog_test.db");
+  execute(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+  // enough rows for a table heap and an index of several pages
+  std::string rows;
+  for (int i = 0; i < 1000; i++) {
+    rows += (i == 0 ? "" : ", ") + fmt::format("({}, 'row {}')", i, i);
+  }
+  execute(bustub.get(), "INSERT INTO t VALUES " + rows + ";");
+  execute(bustub.get(), "CREATE INDEX t_a ON t (a);");
+  bustub.reset();
+
+  bustub = std::make_unique<BustubInstance>("catalog_test.db");
+  const auto *table_info = bustub->catalog_->GetTable("t");
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  EXPECT_EQ(table_info->schema_.ToString(), "(a:INTEGER, b:VARCHAR)");
+  const auto indexes = bustub->catalog_->GetTableIndexes("t");
+  ASSERT_EQ(indexes.size(), 1);
+  EXPECT_EQ(indexes[0]->name_, "t_a");
+  EXPECT_EQ(execute(bustub.get(), "SELECT b FROM t WHERE a = 777;"), "row 777,\n");
+
+  // the reopened database takes new tables, rows and indexes, which the next run finds as well
+  execute(bustub.get(), "INSERT INTO t VALUES (1000, 'row 1000');");
+  execute(bustub.get(), "CREATE TABLE u (c INTEGER);");
+  execute(bustub.get(), "INSERT INTO u VALUES (1), (2);");
+  execute(bustub.get(), "CREATE INDEX u_c ON u (c);");
+  bustub.reset();
+
+  bustub = std::make_unique<BustubInstance>("catalog_test.db");
+  EXPECT_EQ(execute(bustub.get(), "SELECT b FROM t WHERE a = 1000;"), "row 1000,\n");
+  EXPECT_EQ(execute(bustub.get(), "SELECT b FROM t WHERE a = 0;"), "row 0,\n");
+  EXPECT_EQ(execute(bustub.get(), "SELECT c FROM u WHERE c >= 2;"), "2,\n");
+  EXPECT_NE(bustub->catalog_->GetTable("u")->oid_, bustub->catalog_->GetTable("t")->oid_);
+  bustub.reset();
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
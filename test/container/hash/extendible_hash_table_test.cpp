@@ -2,8 +2,13 @@
   * extendible_hash_test.cpp
   */
  
+ #include <atomic>
+ #include <chrono>  // NOLINT
+ #include <iostream>
  #include <random>
+ #include <string>
  #include <thread>  // NOLINT
+ #include <vector>
  
  #include "container/hash/extendible_hash_table.h"
  #include "gtest/gtest.h"
@@ -683,4 +688,118 @@
      ASSERT_FALSE(table->Remove(i));
    }
  }
+ 
+ TEST(ExtendibleHashTableTest, ConcurrentMixed) {
+   const int num_threads = 8;
+   const int keys_per_thread = 2000;
+   auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+ 
+   // Scenario: every thread owns a key range and inserts, overwrites, removes and finds its keys, while the others
+   // split buckets under it.
+   std::vector<std::thread> threads;
+   for (int tid = 0; tid < num_threads; tid++) {
+     threads.emplace_back([&table, tid]() {
+       const int base = tid * keys_per_thread;
+       for (int i = base; i < base + keys_per_thread; i++) {
+         table->Insert(i, i);
+       }
+       for (int i = base; i < base + keys_per_thread; i += 2) {
+         table->Insert(i, -i);
+         ASSERT_TRUE(table->Remove(i + 1));
+       }
+       for (int i = base; i < base + keys_per_thread; i++) {
+         int value;
+         if (i % 2 == 0) {
+           ASSERT_TRUE(table->Find(i, value));
+           ASSERT_EQ(-i, value);
+         } else {
+           ASSERT_FALSE(table->Find(i, value));
+         }
+       }
+     });
+   }
+   for (auto &thread : threads) {
+     thread.join();
+   }
+   for (int i = 0; i < num_threads * keys_per_thread; i++) {
+     int value;
+     ASSERT_EQ(i % 2 == 0, table->Find(i, value));
+   }
+ }
+ 
+ TEST(ExtendibleHashTableTest, ConcurrentFindDuringSplits) {
+   const int num_stable = 1000;
+   auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+   for (int i = 0; i < num_stable; i++) {
+     table->Insert(i, i * 2);
+   }
+
+   // Scenario: a writer inserts and removes other keys, which splits buckets and grows the directory, while readers
+   // look up the stable keys without latches. A reader must never miss a stable key or see a wrong value.
+   std::atomic<bool> stop{false};
+   std::thread writer([&]() {
+     for (int round = 0; !stop; round++) {
+       const int base = num_stable * (1 + round % 16);
+       for (int i = base; i < base + num_stable; i++) {
+         table->Insert(i, -1);
+       }
+       for (int i = base; i < base + num_stable; i += 2) {
+         table->Remove(i);
+       }
+     }
+   });
+   std::vector<std::thread> readers;
+   for (int tid = 0; tid < 3; tid++) {
+     readers.emplace_back([&, tid]() {
+       std::mt19937 gen(tid);
+       std::uniform_int_distribution<int> dist(0, num_stable - 1);
+       for (int i = 0; i < 200000; i++) {
+         const int key = dist(gen);
+         int value;
+         ASSERT_TRUE(table->Find(key, value)) << "key " << key;
+         ASSERT_EQ(key * 2, value);
+       }
+     });
+   }
+   for (auto &reader : readers) {
+     reader.join();
+   }
+   stop = true;
+   writer.join();
+ }
+
+ // NOLINTNEXTLINE
+ TEST(ExtendibleHashTableTest, DISABLED_FindThroughputBenchmark) {
+   const int num_keys = 100000;
+   const size_t lookups_per_thread = 1000000;
+   auto table = std::make_unique<ExtendibleHashTable<int, int>>(16);
+   for (int i = 0; i < num_keys; i++) {
+     table->Insert(i, i);
+   }
+ 
+   std::cout << "<<< BEGIN" << std::endl;
+   for (size_t num_threads = 1; num_threads <= 32; num_threads *= 2) {
+     std::vector<std::thread> threads;
+     auto start = std::chrono::steady_clock::now();
+     for (size_t tid = 0; tid < num_threads; tid++) {
+       threads.emplace_back([&table, tid]() {
+         std::mt19937 gen(tid);
+         std::uniform_int_distribution<int> dist(0, num_keys - 1);
+         int value;
+         for (size_t i = 0; i < lookups_per_thread; i++) {
+           table->Find(dist(gen), value);
+         }
+       });
+     }
+     for (auto &thread : threads) {
+       thread.join();
+     }
+     auto end = std::chrono::steady_clock::now();
+     auto seconds = std::chrono::duration<double>(end - start).count();
+     std::cout << num_threads << " threads: "
+               << static_cast<size_t>(static_cast<double>(num_threads * lookups_per_thread) / seconds)
+               << " finds/sec" << std::endl;
+   }
+   std::cout << ">>> END" << std::endl;
+ }
  }  // namespace bustub
\ No newline at end of file
@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// open_addressing_hash_table_test.cpp
+//
+// Identification: test/container/hash/open_addressing_hash_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/open_addressing_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(OpenAddressingHashTableTest, SampleTest) {
+  OpenAddressingHashTable<page_id_t, frame_id_t> table(4);
+  int value;
+
+  table.Insert(1, 10);
+  table.Insert(2, 20);
+  table.Insert(3, 30);
+  EXPECT_EQ(3, table.Size());
+  ASSERT_TRUE(table.Find(2, value));
+  EXPECT_EQ(20, value);
+  EXPECT_FALSE(table.Find(4, value));
+
+  // Scenario: inserting an existing key overwrites its value.
+  table.Insert(2, 21);
+  EXPECT_EQ(3, table.Size());
+  ASSERT_TRUE(table.Find(2, value));
+  EXPECT_EQ(21, value);
+
+  // Scenario: the table refuses more entries than its capacity.
+  table.Insert(4, 40);
+  EXPECT_THROW(table.Insert(5, 50), Exception);
+
+  EXPECT_TRUE(table.Remove(1));
+  EXPECT_FALSE(table.Remove(1));
+  EXPECT_FALSE(table.Find(1, value));
+  EXPECT_EQ(3, table.Size());
+  table.Insert(5, 50);
+  ASSERT_TRUE(table.Find(5, value));
+  EXPECT_EQ(50, value);
+}
+
+TEST(OpenAddressingHashTableTest, MatchesReference) {
+  // A small table over a larger key space, so buckets overflow and removals shift keys back.
+  const size_t capacity = 64;
+  OpenAddressingHashTable<page_id_t, frame_id_t> table(capacity);
+  std::unordered_map<page_id_t, frame_id_t> reference;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> key_dist(0, 199);
+
+  for (int i = 0; i < 100000; i++) {
+    page_id_t key = key_dist(gen);
+    if (gen() % 2 == 0 && (reference.size() < capacity || reference.count(key) > 0)) {
+      table.Insert(key, i);
+      reference[key] = i;
+    } else {
+      EXPECT_EQ(reference.erase(key) > 0, table.Remove(key));
+    }
+    ASSERT_EQ(reference.size(), table.Size());
+  }
+  for (page_id_t key = 0; key < 200; key++) {
+    int value;
+    auto it = reference.find(key);
+    ASSERT_EQ(it != reference.end(), table.Find(key, value)) << "key " << key;
+    if (it != reference.end()) {
+      EXPECT_EQ(it->second, value);
+    }
+  }
+}
+
+TEST(OpenAddressingHashTableTest, ConcurrentReadersWithWriter) {
+  const int num_stable = 500;
+  const int num_readers = 3;
+  OpenAddressingHashTable<page_id_t, frame_id_t> table(1000);
+  for (int i = 0; i < num_stable; i++) {
+    table.Insert(i, i * 2);
+  }
+
+  // Scenario: one writer churns other keys, which constantly shifts entries around, while readers look up the stable
+  // keys. A reader must never miss a stable key or see a wrong value.
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(num_stable, 4 * num_stable);
+    while (!stop) {
+      page_id_t key = dist(gen);
+      if (!table.Remove(key) && table.Size() < 1000) {
+        table.Insert(key, -1);
+      }
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&, tid]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_stable - 1);
+      for (int i = 0; i < 200000; i++) {
+        page_id_t key = dist(gen);
+        int value;
+        ASSERT_TRUE(table.Find(key, value)) << "key " << key;
+        ASSERT_EQ(key * 2, value);
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  stop = true;
+  writer.join();
+}
+
+TEST(OpenAddressingHashTableTest, ConcurrentFindWithCollidingRemove) {
+  // Keys that share home bucket 0 of a table of 8 buckets, hashed the way the table hashes them, so that bucket 0 is
+  // full and keys overflow into bucket 1.
+  OpenAddressingHashTable<page_id_t, frame_id_t> table(16);
+  ASSERT_EQ(8, table.GetNumBuckets());
+  std::vector<page_id_t> keys;
+  for (page_id_t key = 0; keys.size() < OpenAddressingHashTable<page_id_t, frame_id_t>::SLOTS_PER_BUCKET + 2; key++) {
+    uint64_t hash = static_cast<uint64_t>(std::hash<page_id_t>()(key)) * 0x9E3779B97F4A7C15ULL;
+    if (((hash ^ (hash >> 32)) & 7) == 0) {
+      keys.push_back(key);
+    }
+  }
+  for (auto key : keys) {
+    table.Insert(key, key * 2);
+  }
+
+  // Scenario: one writer removes and reinserts the colliding keys in turn. Removing one from the full bucket 0 moves
+  // an overflowed key back, and a reader looking for that key must not stop at bucket 0 while it has a hole. Every
+  // key but the one the writer is on must always be found.
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> generation{0};
+  std::atomic<page_id_t> churned{INVALID_PAGE_ID};
+  std::thread writer([&]() {
+    for (size_t i = 0; !stop; i = (i + 1) % keys.size()) {
+      churned = keys[i];
+      generation++;
+      table.Remove(keys[i]);
+      table.Insert(keys[i], keys[i] * 2);
+      generation++;
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 3; tid++) {
+    readers.emplace_back([&, tid]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, keys.size() - 1);
+      for (int i = 0; i < 200000; i++) {
+        const page_id_t key = keys[dist(gen)];
+        const uint64_t before = generation;
+        int value;
+        const bool found = table.Find(key, value);
+        if (generation != before || ((before & 1) != 0 && churned == key)) {
+          continue;
+        }
+        ASSERT_TRUE(found) << "key " << key;
+        ASSERT_EQ(key * 2, value);
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  stop = true;
+  writer.join();
+}
+
+namespace {
+
+/** Returns lookups per second of num_threads threads looking up random resident keys. */
+auto LookupThroughput(HashTable<page_id_t, frame_id_t> *table, int num_keys, size_t num_threads,
+                      size_t lookups_per_thread) -> double {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([=]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_keys - 1);
+      int value;
+      for (size_t i = 0; i < lookups_per_thread; i++) {
+        table->Find(dist(gen), value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return static_cast<double>(num_threads * lookups_per_thread) / std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(OpenAddressingHashTableTest, DISABLED_LookupBenchmark) {
+  const size_t lookups_per_thread = 2000000;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_keys : {1024, 65536}) {
+    ExtendibleHashTable<page_id_t, frame_id_t> extendible(4);
+    OpenAddressingHashTable<page_id_t, frame_id_t> open_addressing(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+      extendible.Insert(i, i);
+      open_addressing.Insert(i, i);
+    }
+    for (size_t num_threads : {1, 2, 4, 8}) {
+      double extendible_rate = LookupThroughput(&extendible, num_keys, num_threads, lookups_per_thread);
+      double open_addressing_rate = LookupThroughput(&open_addressing, num_keys, num_threads, lookups_per_thread);
+      std::cout << num_keys << " keys, " << num_threads << " threads: extendible "
+                << static_cast<size_t>(extendible_rate) << " lookups/sec, open addressing "
+                << static_cast<size_t>(open_addressing_rate) << " lookups/sec" << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
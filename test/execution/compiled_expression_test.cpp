@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression_test.cpp
+//
+// Identification: test/execution/compiled_expression_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/compiled_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** The columns of the rows, a NULL in each one but the first */
+const Schema SCHEMA{std::vector<Column>{{"a", TypeId::INTEGER},
+                                        {"b", TypeId::BIGINT},
+                                        {"c", TypeId::DECIMAL},
+                                        {"d", TypeId::BOOLEAN},
+                                        {"e", TypeId::SMALLINT},
+                                        {"f", TypeId::VARCHAR, 16}}};
+constexpr int ROWS = 50;
+
+auto MakeRows() -> std::vector<Tuple> {
+  std::vector<Tuple> rows;
+  for (int i = 0; i < ROWS; i++) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i - ROWS / 2),
+                              ValueFactory::GetBigIntValue(static_cast<int64_t>(i) * 3 - 40),
+                              ValueFactory::GetDecimalValue(i / 4.0 - 5),
+                              ValueFactory::GetBooleanValue(i % 3 == 0),
+                              ValueFactory::GetSmallIntValue(static_cast<int16_t>(i % 7)),
+                              ValueFactory::GetVarcharValue(std::to_string(i))};
+    if (i > 0) {
+      const auto null_column = static_cast<uint32_t>(i % (SCHEMA.GetColumnCount() + 1));
+      if (null_column < SCHEMA.GetColumnCount()) {
+        values[null_column] = ValueFactory::GetNullValueByType(SCHEMA.GetColumn(null_column).GetType());
+      }
+    }
+    rows.emplace_back(values, &SCHEMA);
+  }
+  return rows;
+}
+
+auto MakeColumn(uint32_t column_idx, uint32_t tuple_idx = 0) -> AbstractExpressionRef {
+  return std::make_shared<ColumnValueExpression>(tuple_idx, column_idx, SCHEMA.GetColumn(column_idx).GetType());
+}
+
+auto MakeConstant(const Value &value) -> AbstractExpressionRef {
+  return std::make_shared<ConstantValueExpression>(value);
+}
+
+auto MakeComparison(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ComparisonType type)
+    -> AbstractExpressionRef {
+  return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto MakeLogic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) -> AbstractExpressionRef {
+  return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto MakeArithmetic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ArithmeticType type)
+    -> AbstractExpressionRef {
+  return std::make_shared<ArithmeticExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+/** The expressions that compile, each evaluated over the rows by both the tree and the program */
+auto MakeExpressions() -> std::vector<AbstractExpressionRef> {
+  const std::vector<ComparisonType> comparisons{ComparisonType::Equal,       ComparisonType::NotEqual,
+                                                ComparisonType::LessThan,    ComparisonType::LessThanOrEqual,
+                                                ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+  const auto null = MakeConstant(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  const auto zero = MakeConstant(ValueFactory::GetIntegerValue(0));
+  std::vector<AbstractExpressionRef> expressions{
+      MakeColumn(0),
+      MakeColumn(2),
+      MakeColumn(4),
+      MakeConstant(ValueFactory::GetDecimalValue(1.5)),
+      null,
+      MakeArithmetic(MakeColumn(0), MakeConstant(ValueFactory::GetIntegerValue(7)), ArithmeticType::Plus),
+      MakeArithmetic(MakeConstant(ValueFactory::GetIntegerValue(100)), MakeColumn(0), ArithmeticType::Minus),
+  };
+  for (const auto comparison : comparisons) {
+    // integers of different widths, an integer against a decimal, booleans and a NULL constant
+    expressions.push_back(MakeComparison(MakeColumn(0), MakeColumn(1), comparison));
+    expressions.push_back(MakeComparison(MakeColumn(4), MakeConstant(ValueFactory::GetIntegerValue(3)), comparison));
+    expressions.push_back(MakeComparison(MakeColumn(2), MakeColumn(0), comparison));
+    expressions.push_back(MakeComparison(MakeConstant(ValueFactory::GetIntegerValue(2)), MakeColumn(2), comparison));
+    expressions.push_back(MakeComparison(MakeColumn(3), MakeConstant(ValueFactory::GetBooleanValue(true)), comparison));
+    expressions.push_back(MakeComparison(MakeColumn(0), null, comparison));
+  }
+  for (const auto logic : {LogicType::And, LogicType::Or}) {
+    auto less = MakeComparison(MakeColumn(0), MakeColumn(4), ComparisonType::LessThan);
+    expressions.push_back(MakeLogic(MakeColumn(3), less, logic));
+    auto is_zero = MakeComparison(MakeColumn(2), zero, ComparisonType::Equal);
+    auto is_negative = MakeComparison(MakeColumn(1), zero, ComparisonType::LessThan);
+    expressions.push_back(MakeLogic(is_zero, is_negative, logic));
+  }
+  return expressions;
+}
+
+auto SameValue(const Value &expected, const Value &actual) -> bool {
+  if (expected.IsNull() || actual.IsNull()) {
+    return expected.IsNull() && actual.IsNull();
+  }
+  return expected.GetTypeId() == actual.GetTypeId() && expected.CompareEquals(actual) == CmpBool::CmpTrue;
+}
+
+}  // namespace
+
+TEST(CompiledExpressionTest, MatchesTreeOverTuples) {
+  const auto rows = MakeRows();
+  for (const auto &expr : MakeExpressions()) {
+    auto program = CompiledExpression::Compile(*expr, SCHEMA);
+    ASSERT_NE(program, nullptr) << expr->ToString();
+    EXPECT_EQ(program->GetReturnType(), expr->GetReturnType()) << expr->ToString();
+    for (const auto &row : rows) {
+      const Value expected = expr->Evaluate(&row, SCHEMA);
+      EXPECT_TRUE(SameValue(expected, program->Evaluate(row))) << expr->ToString() << " of " << row.ToString(&SCHEMA);
+      if (expr->GetReturnType() == TypeId::BOOLEAN) {
+        EXPECT_EQ(program->EvaluatePredicate(row), !expected.IsNull() && expected.GetAs<bool>()) << expr->ToString();
+      }
+    }
+  }
+}
+
+TEST(CompiledExpressionTest, MatchesTreeOverBatches) {
+  const auto rows = MakeRows();
+  TupleBatch batch;
+  batch.Reset(&SCHEMA);
+  for (uint32_t i = 0; i < rows.size(); i++) {
+    batch.AppendTuple(rows[i], RID(0, i));
+  }
+  // leave out some of the rows, whose results are then undefined
+  ColumnVector every_other(TypeId::BOOLEAN);
+  every_other.Resize(rows.size());
+  for (uint32_t i = 0; i < rows.size(); i++) {
+    every_other.SetValue(i, ValueFactory::GetBooleanValue(i % 2 == 0));
+  }
+  batch.Select(every_other);
+
+  for (const auto &expr : MakeExpressions()) {
+    auto program = CompiledExpression::Compile(*expr, SCHEMA);
+    ASSERT_NE(program, nullptr) << expr->ToString();
+    ColumnVector expected;
+    ColumnVector actual;
+    expr->EvaluateBatch(batch, &expected);
+    program->EvaluateBatch(batch, &actual);
+    ASSERT_EQ(actual.GetType(), expected.GetType());
+    for (const auto row : batch.GetSelection()) {
+      EXPECT_TRUE(SameValue(expected.GetValue(row), actual.GetValue(row)))
+          << expr->ToString() << " of " << rows[row].ToString(&SCHEMA);
+    }
+  }
+}
+
+TEST(CompiledExpressionTest, JoinPredicate) {
+  const auto rows = MakeRows();
+  auto less = MakeComparison(MakeColumn(0, 0), MakeColumn(4, 1), ComparisonType::LessThan);
+  auto greater_or_equal = MakeComparison(MakeColumn(2, 1), MakeColumn(1, 0), ComparisonType::GreaterThanOrEqual);
+  auto predicate = MakeLogic(less, greater_or_equal, LogicType::And);
+  auto program = CompiledExpression::CompileJoin(*predicate, SCHEMA, SCHEMA);
+  ASSERT_NE(program, nullptr);
+  for (const auto &left : rows) {
+    for (const auto &right : rows) {
+      const Value expected = predicate->EvaluateJoin(&left, SCHEMA, &right, SCHEMA);
+      EXPECT_EQ(program->EvaluateJoinPredicate(left, right), !expected.IsNull() && expected.GetAs<bool>());
+    }
+  }
+}
+
+TEST(CompiledExpressionTest, LeavesOtherExpressionsToTheTree) {
+  // VARCHAR columns are not held in registers
+  auto varchar_equal =
+      MakeComparison(MakeColumn(5), MakeConstant(ValueFactory::GetVarcharValue("7")), ComparisonType::Equal);
+  EXPECT_EQ(CompiledExpression::Compile(*MakeColumn(5), SCHEMA), nullptr);
+  EXPECT_EQ(CompiledExpression::Compile(*varchar_equal, SCHEMA), nullptr);
+  // nor is part of an expression compiled without the rest
+  auto integer_equal = MakeComparison(MakeColumn(0), MakeColumn(1), ComparisonType::Equal);
+  EXPECT_EQ(CompiledExpression::Compile(*MakeLogic(integer_equal, varchar_equal, LogicType::Or), SCHEMA), nullptr);
+}
+
+}  // namespace bustub
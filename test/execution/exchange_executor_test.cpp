@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor_test.cpp
+//
+// Identification: test/execution/exchange_executor_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_factory.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+
+namespace bustub {
+
+namespace {
+
+class ExchangeExecutorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("exchange_executor_test.db");
+    remove("exchange_executor_test.log");
+    bustub_ = std::make_unique<BustubInstance>("exchange_executor_test.db");
+    bustub_->GenerateMockTable();
+    Execute("CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+    Execute("CREATE TABLE u (c INTEGER, d INTEGER);");
+    for (int chunk = 0; chunk < 4; chunk++) {
+      std::string rows;
+      for (int i = chunk * 1000; i < (chunk + 1) * 1000; i++) {
+        rows += (i == chunk * 1000 ? "" : ", ") + fmt::format("({}, 'group {}')", i, i % 10);
+      }
+      Execute("INSERT INTO t VALUES " + rows + ";");
+    }
+    std::string rows;
+    for (int i = 0; i < 500; i++) {
+      rows += (i == 0 ? "" : ", ") + fmt::format("({}, {})", i * 13 % 4500, i);
+    }
+    Execute("INSERT INTO u VALUES " + rows + ";");
+    txn_ = bustub_->txn_manager_->Begin();
+  }
+
+  void TearDown() override {
+    bustub_->txn_manager_->Commit(txn_);
+    delete txn_;
+    bustub_.reset();
+    remove("exchange_executor_test.db");
+    remove("exchange_executor_test.log");
+  }
+
+  void Execute(const std::string &sql) {
+    std::stringstream result;
+    SimpleStreamWriter writer(result, true, ",");
+    bustub_->ExecuteSql(sql, writer);
+  }
+
+  /** @return the optimized plan of a query */
+  auto Plan(const std::string &sql) -> AbstractPlanNodeRef {
+    Binder binder(*bustub_->catalog_);
+    binder.ParseAndSave(sql);
+    auto statement = binder.BindStatement(binder.statement_nodes_[0]);
+    Planner planner(*bustub_->catalog_);
+    planner.PlanQuery(*statement);
+    Optimizer optimizer(*bustub_->catalog_, bustub_->IsForceStarterRule());
+    return optimizer.Optimize(planner.plan_);
+  }
+
+  auto MakeExecutorContext() -> std::unique_ptr<ExecutorContext> {
+    return std::make_unique<ExecutorContext>(txn_, bustub_->catalog_, bustub_->buffer_pool_manager_,
+                                             bustub_->txn_manager_, bustub_->lock_manager_);
+  }
+
+  /** @return the output rows of a plan in sorted order, as exchanges do not keep the order of their input */
+  auto Run(const AbstractPlanNodeRef &plan) -> std::vector<std::string> {
+    auto exec_ctx = MakeExecutorContext();
+    auto executor = ExecutorFactory::CreateExecutor(exec_ctx.get(), plan);
+    executor->Init();
+    std::vector<std::string> rows;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      rows.push_back(tuple.ToString(&plan->OutputSchema()));
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  std::unique_ptr<BustubInstance> bustub_;
+  Transaction *txn_{nullptr};
+};
+
+/** @return plan with rewrite applied to each of its nodes, after their children */
+auto Rewrite(const AbstractPlanNodeRef &plan,
+             const std::function<AbstractPlanNodeRef(const AbstractPlanNodeRef &)> &rewrite) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.push_back(Rewrite(child, rewrite));
+  }
+  return rewrite(plan->CloneWithChildren(std::move(children)));
+}
+
+auto MakeExchange(const AbstractPlanNodeRef &child, ExchangeType exchange_type,
+                  std::vector<AbstractExpressionRef> partition_keys, size_t parallelism) -> AbstractPlanNodeRef {
+  return std::make_shared<ExchangePlanNode>(child->output_schema_, child, exchange_type, std::move(partition_keys),
+                                            parallelism);
+}
+
+auto Gather(const AbstractPlanNodeRef &child, size_t parallelism) -> AbstractPlanNodeRef {
+  return MakeExchange(child, ExchangeType::Gather, {}, parallelism);
+}
+
+/** @return plan with both sides of its hash joins repartitioned on their keys, or the right one broadcast */
+auto PartitionJoins(const AbstractPlanNodeRef &plan, bool broadcast) -> AbstractPlanNodeRef {
+  return Rewrite(plan, [&](const AbstractPlanNodeRef &node) -> AbstractPlanNodeRef {
+    if (node->GetType() != PlanType::HashJoin) {
+      return node;
+    }
+    const auto &join = dynamic_cast<const HashJoinPlanNode &>(*node);
+    auto left = MakeExchange(join.GetLeftPlan(), ExchangeType::Repartition, {join.left_key_expression_}, 2);
+    auto right = broadcast ? MakeExchange(join.GetRightPlan(), ExchangeType::Broadcast, {}, 2)
+                           : MakeExchange(join.GetRightPlan(), ExchangeType::Repartition,
+                                          {join.right_key_expression_}, 3);
+    return join.CloneWithChildren({left, right});
+  });
+}
+
+}  // namespace
+
+// A gather exchange over a pipeline splits its scan between its producers
+TEST_F(ExchangeExecutorTest, GatherPipeline) {
+  for (const auto *sql : {"SELECT x, y FROM __mock_t2_100k WHERE x < 50000;", "SELECT a + 1, b FROM t WHERE a > 5;",
+                          "SELECT * FROM __mock_table_1;"}) {
+    const auto plan = Plan(sql);
+    const auto serial = Run(plan);
+    ASSERT_FALSE(serial.empty()) << sql;
+    for (const size_t parallelism : {1, 3, 8}) {
+      EXPECT_EQ(Run(Gather(plan, parallelism)), serial) << sql << " on " << parallelism;
+    }
+  }
+}
+
+// Copies of an aggregation each own the groups repartitioned to them
+TEST_F(ExchangeExecutorTest, RepartitionAggregation) {
+  for (const auto *sql : {"SELECT v1, COUNT(v2), SUM(v3) FROM __mock_agg_input_big GROUP BY v1;",
+                          "SELECT b, COUNT(*), MIN(a), MAX(a) FROM t WHERE a > 100 GROUP BY b;"}) {
+    const auto plan = Plan(sql);
+    const auto serial = Run(plan);
+    ASSERT_FALSE(serial.empty()) << sql;
+    const auto partitioned = Rewrite(plan, [](const AbstractPlanNodeRef &node) -> AbstractPlanNodeRef {
+      if (node->GetType() != PlanType::Aggregation) {
+        return node;
+      }
+      const auto &aggregation = dynamic_cast<const AggregationPlanNode &>(*node);
+      auto exchange =
+          MakeExchange(aggregation.GetChildPlan(), ExchangeType::Repartition, aggregation.GetGroupBys(), 3);
+      return aggregation.CloneWithChildren({exchange});
+    });
+    EXPECT_NE(partitioned->ToString().find("Exchange { type=Repartition, partition_keys="), std::string::npos);
+    for (const size_t parallelism : {1, 2, 5}) {
+      EXPECT_EQ(Run(Gather(partitioned, parallelism)), serial) << sql << " on " << parallelism;
+    }
+  }
+}
+
+// Copies of a hash join each join a partition of the left side with the matching partition of the right one, or
+// with all of it
+TEST_F(ExchangeExecutorTest, PartitionedHashJoin) {
+  for (const auto *sql :
+       {"SELECT t.a, u.d FROM t INNER JOIN u ON t.a = u.c;", "SELECT u.c, t.b FROM u LEFT JOIN t ON u.d = t.a;",
+        "SELECT t.b, COUNT(*) FROM t INNER JOIN u ON t.a = u.c GROUP BY t.b;"}) {
+    const auto plan = Plan(sql);
+    ASSERT_NE(plan->ToString().find("HashJoin"), std::string::npos) << plan->ToString();
+    const auto serial = Run(plan);
+    ASSERT_FALSE(serial.empty()) << sql;
+    for (const bool broadcast : {false, true}) {
+      // aggregations over the join run once, above the gather
+      const auto partitioned = Rewrite(plan, [&](const AbstractPlanNodeRef &node) -> AbstractPlanNodeRef {
+        if (node->GetType() == PlanType::Aggregation || node->GetType() == PlanType::Projection) {
+          if (node->GetChildAt(0)->GetType() == PlanType::HashJoin) {
+            return node->CloneWithChildren({Gather(PartitionJoins(node->GetChildAt(0), broadcast), 4)});
+          }
+        }
+        return node;
+      });
+      EXPECT_NE(partitioned->ToString().find("Exchange { type=Gather"), std::string::npos) << partitioned->ToString();
+      EXPECT_EQ(Run(partitioned), serial) << sql << (broadcast ? " broadcast" : " repartitioned");
+    }
+  }
+}
+
+// Without a gather above it, a repartition exchange has a single consumer
+TEST_F(ExchangeExecutorTest, RepartitionWithoutGather) {
+  const auto plan = Plan("SELECT x, y FROM __mock_t2_100k WHERE x < 50000;");
+  const auto partition_key = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  EXPECT_EQ(Run(MakeExchange(plan, ExchangeType::Repartition, {partition_key}, 4)), Run(plan));
+}
+
+// A gather exchange whose copies would each scan the whole table is refused, and one that is not read to the end
+// stops its producers
+TEST_F(ExchangeExecutorTest, RefusesUnpartitionedFragmentsAndStopsEarly) {
+  auto exec_ctx = MakeExecutorContext();
+  const auto aggregation = Gather(Plan("SELECT b, COUNT(*) FROM t GROUP BY b;"), 2);
+  auto executor = ExecutorFactory::CreateExecutor(exec_ctx.get(), aggregation);
+  EXPECT_THROW(executor->Init(), ExecutionException);
+
+  const auto scan = Gather(Plan("SELECT * FROM __mock_t2_100k;"), 4);
+  executor = ExecutorFactory::CreateExecutor(exec_ctx.get(), scan);
+  for (int run = 0; run < 2; run++) {
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(executor->Next(&tuple, &rid));
+    }
+  }
+  executor.reset();
+}
+
+}  // namespace bustub
@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels_test.cpp
+//
+// Identification: test/execution/filter_kernels_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/filter_kernels.h"
+#include "gtest/gtest.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+const std::vector<ComparisonType> COMPARISONS{ComparisonType::Equal,       ComparisonType::NotEqual,
+                                              ComparisonType::LessThan,    ComparisonType::LessThanOrEqual,
+                                              ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+
+/** @return the levels the CPU runs */
+auto SupportedLevels() -> std::vector<SimdLevel> {
+  std::vector<SimdLevel> levels{SimdLevel::Scalar};
+  if (BestSimdLevel() != SimdLevel::Scalar) {
+    levels.push_back(SimdLevel::Avx2);
+  }
+  if (BestSimdLevel() == SimdLevel::Avx512) {
+    levels.push_back(SimdLevel::Avx512);
+  }
+  return levels;
+}
+
+template <typename T>
+auto Matches(ComparisonType comparison, T lhs, T rhs) -> bool {
+  switch (comparison) {
+    case ComparisonType::Equal:
+      return lhs == rhs;
+    case ComparisonType::NotEqual:
+      return lhs != rhs;
+    case ComparisonType::LessThan:
+      return lhs < rhs;
+    case ComparisonType::LessThanOrEqual:
+      return lhs <= rhs;
+    case ComparisonType::GreaterThan:
+      return lhs > rhs;
+    default:
+      return lhs >= rhs;
+  }
+}
+
+/** Check the kernels of every level against the comparison of each row, for values in [-8, 8) and some NULLs */
+template <typename T>
+void CheckKernels(T null_value) {
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> distribution(-8, 8);
+  // rows that leave part of a word, of a register, or nothing to the rows past the last full word
+  for (const size_t rows : {1, 63, 64, 100, 1024}) {
+    std::vector<T> lhs(rows);
+    std::vector<T> rhs(rows);
+    for (size_t i = 0; i < rows; i++) {
+      const int l = distribution(generator);
+      const int r = distribution(generator);
+      lhs[i] = l == 8 ? null_value : static_cast<T>(l);
+      rhs[i] = r == 8 ? null_value : static_cast<T>(r);
+    }
+    const T constant = 3;
+
+    for (const auto level : SupportedLevels()) {
+      for (const auto comparison : COMPARISONS) {
+        for (const bool rhs_is_constant : {false, true}) {
+          std::vector<uint64_t> is_true(MaskWords(rows), ~uint64_t{0});
+          std::vector<uint64_t> is_false(MaskWords(rows), ~uint64_t{0});
+          CompareValues(comparison, lhs.data(), rhs_is_constant ? &constant : rhs.data(), rhs_is_constant, rows,
+                        is_true.data(), is_false.data(), level);
+          for (size_t i = 0; i < rows; i++) {
+            const T right = rhs_is_constant ? constant : rhs[i];
+            const bool is_null = lhs[i] == null_value || right == null_value;
+            const bool matches = !is_null && Matches(comparison, lhs[i], right);
+            ASSERT_EQ((is_true[i / 64] >> (i % 64) & 1) != 0, matches)
+                << "row " << i << " of " << rows << " at level " << static_cast<int>(level);
+            ASSERT_EQ((is_false[i / 64] >> (i % 64) & 1) != 0, !is_null && !matches)
+                << "row " << i << " of " << rows << " at level " << static_cast<int>(level);
+          }
+        }
+      }
+    }
+  }
+}
+
+const Schema SCHEMA{std::vector<Column>{
+    {"a", TypeId::INTEGER}, {"b", TypeId::BIGINT}, {"c", TypeId::DECIMAL}, {"d", TypeId::VARCHAR, 8}}};
+
+auto MakeColumn(uint32_t column_idx) -> AbstractExpressionRef {
+  return std::make_shared<ColumnValueExpression>(0, column_idx, SCHEMA.GetColumn(column_idx).GetType());
+}
+
+auto MakeConstant(const Value &value) -> AbstractExpressionRef {
+  return std::make_shared<ConstantValueExpression>(value);
+}
+
+auto MakeComparison(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ComparisonType type)
+    -> AbstractExpressionRef {
+  return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto MakeLogic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) -> AbstractExpressionRef {
+  return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+/** A batch of rows of SCHEMA with values in [-8, 8) and some NULLs, every third row left out */
+void MakeBatch(TupleBatch *batch) {
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> distribution(-8, 8);
+  auto value_of = [&](TypeId type) {
+    const int value = distribution(generator);
+    if (value == 8) {
+      return ValueFactory::GetNullValueByType(type);
+    }
+    return Value(TypeId::INTEGER, value).CastAs(type);
+  };
+  batch->Reset(&SCHEMA);
+  for (uint32_t i = 0; i < 1000; i++) {
+    std::vector<Value> values{value_of(TypeId::INTEGER), value_of(TypeId::BIGINT), value_of(TypeId::DECIMAL),
+                              ValueFactory::GetVarcharValue(std::to_string(i))};
+    batch->AppendTuple(Tuple(values, &SCHEMA), RID(0, i));
+  }
+  ColumnVector every_third(TypeId::BOOLEAN);
+  every_third.Resize(batch->GetRowCount());
+  for (uint32_t i = 0; i < batch->GetRowCount(); i++) {
+    every_third.SetValue(i, ValueFactory::GetBooleanValue(i % 3 != 0));
+  }
+  batch->Select(every_third);
+}
+
+}  // namespace
+
+TEST(FilterKernelsTest, CompareIntegers) { CheckKernels<int32_t>(BUSTUB_INT32_NULL); }
+
+TEST(FilterKernelsTest, CompareBigInts) { CheckKernels<int64_t>(BUSTUB_INT64_NULL); }
+
+TEST(FilterKernelsTest, CompareDecimals) { CheckKernels<double>(BUSTUB_DECIMAL_NULL); }
+
+TEST(FilterKernelsTest, PredicateMatchesTree) {
+  std::vector<AbstractExpressionRef> predicates;
+  for (const auto comparison : COMPARISONS) {
+    predicates.push_back(MakeComparison(MakeColumn(0), MakeConstant(ValueFactory::GetIntegerValue(2)), comparison));
+    // a constant on the left, of another type than the column
+    predicates.push_back(MakeComparison(MakeConstant(ValueFactory::GetIntegerValue(-1)), MakeColumn(1), comparison));
+    predicates.push_back(MakeComparison(MakeColumn(2), MakeConstant(ValueFactory::GetDecimalValue(0.5)), comparison));
+    predicates.push_back(MakeComparison(MakeColumn(0), MakeColumn(0), comparison));
+  }
+  // NULL AND false is false, NULL OR true is true
+  auto a_small =
+      MakeComparison(MakeColumn(0), MakeConstant(ValueFactory::GetIntegerValue(0)), ComparisonType::LessThan);
+  auto b_large =
+      MakeComparison(MakeColumn(1), MakeConstant(ValueFactory::GetIntegerValue(3)), ComparisonType::GreaterThan);
+  auto c_zero = MakeComparison(MakeColumn(2), MakeConstant(ValueFactory::GetIntegerValue(0)), ComparisonType::Equal);
+  predicates.push_back(MakeLogic(a_small, b_large, LogicType::And));
+  predicates.push_back(MakeLogic(a_small, b_large, LogicType::Or));
+  predicates.push_back(MakeLogic(MakeLogic(a_small, c_zero, LogicType::Or), b_large, LogicType::And));
+
+  TupleBatch batch;
+  MakeBatch(&batch);
+  for (const auto &predicate : predicates) {
+    auto kernels = KernelPredicate::Compile(*predicate, SCHEMA);
+    ASSERT_NE(kernels, nullptr) << predicate->ToString();
+
+    TupleBatch expected;
+    MakeBatch(&expected);
+    ColumnVector result;
+    predicate->EvaluateBatch(expected, &result);
+    expected.Select(result);
+
+    TupleBatch actual;
+    MakeBatch(&actual);
+    kernels->Select(&actual);
+    EXPECT_EQ(actual.GetSelection(), expected.GetSelection()) << predicate->ToString();
+  }
+}
+
+TEST(FilterKernelsTest, LeavesOtherPredicatesAlone) {
+  auto varchar_equal =
+      MakeComparison(MakeColumn(3), MakeConstant(ValueFactory::GetVarcharValue("7")), ComparisonType::Equal);
+  auto integer_to_decimal =
+      MakeComparison(MakeColumn(0), MakeConstant(ValueFactory::GetDecimalValue(1.5)), ComparisonType::Equal);
+  auto integer_to_bigint = MakeComparison(MakeColumn(0), MakeColumn(1), ComparisonType::Equal);
+  auto null_constant = MakeComparison(MakeColumn(0), MakeConstant(ValueFactory::GetNullValueByType(TypeId::INTEGER)),
+                                      ComparisonType::Equal);
+  for (const auto &predicate : {varchar_equal, integer_to_decimal, integer_to_bigint, null_constant}) {
+    EXPECT_EQ(KernelPredicate::Compile(*predicate, SCHEMA), nullptr) << predicate->ToString();
+  }
+  auto a_small =
+      MakeComparison(MakeColumn(0), MakeConstant(ValueFactory::GetIntegerValue(0)), ComparisonType::LessThan);
+  EXPECT_EQ(KernelPredicate::Compile(*MakeLogic(a_small, varchar_equal, LogicType::And), SCHEMA), nullptr);
+}
+
+}  // namespace bustub
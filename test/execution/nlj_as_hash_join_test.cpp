@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nlj_as_hash_join_test.cpp
+//
+// Identification: test/execution/nlj_as_hash_join_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/binder.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_factory.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+
+namespace bustub {
+
+namespace {
+
+class NLJAsHashJoinTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("nlj_as_hash_join_test.db");
+    remove("nlj_as_hash_join_test.log");
+    bustub_ = std::make_unique<BustubInstance>("nlj_as_hash_join_test.db");
+    Execute("CREATE TABLE t (a INTEGER, b INTEGER);");
+    Execute("CREATE TABLE u (c INTEGER, d INTEGER);");
+    std::string rows;
+    for (int i = 0; i < 300; i++) {
+      rows += (i == 0 ? "" : ", ") + fmt::format("({}, {})", i % 50, i);
+    }
+    Execute("INSERT INTO t VALUES " + rows + ";");
+    rows.clear();
+    for (int i = 0; i < 200; i++) {
+      rows += (i == 0 ? "" : ", ") + fmt::format("({}, {})", i % 70, i * 7 % 300);
+    }
+    Execute("INSERT INTO u VALUES " + rows + ";");
+    txn_ = bustub_->txn_manager_->Begin();
+  }
+
+  void TearDown() override {
+    bustub_->txn_manager_->Commit(txn_);
+    delete txn_;
+    bustub_.reset();
+    remove("nlj_as_hash_join_test.db");
+    remove("nlj_as_hash_join_test.log");
+  }
+
+  void Execute(const std::string &sql) {
+    std::stringstream result;
+    SimpleStreamWriter writer(result, true, ",");
+    bustub_->ExecuteSql(sql, writer);
+  }
+
+  /** @return the plan of a query as planned, and as optimized */
+  auto Plan(const std::string &sql) -> std::pair<AbstractPlanNodeRef, AbstractPlanNodeRef> {
+    Binder binder(*bustub_->catalog_);
+    binder.ParseAndSave(sql);
+    auto statement = binder.BindStatement(binder.statement_nodes_[0]);
+    Planner planner(*bustub_->catalog_);
+    planner.PlanQuery(*statement);
+    Optimizer optimizer(*bustub_->catalog_, false);
+    return {planner.plan_, optimizer.Optimize(planner.plan_)};
+  }
+
+  /** @return the output rows of a plan in sorted order, as a hash join does not keep the order of the NLJ */
+  auto Run(const AbstractPlanNodeRef &plan) -> std::vector<std::string> {
+    ExecutorContext exec_ctx(txn_, bustub_->catalog_, bustub_->buffer_pool_manager_, bustub_->txn_manager_,
+                             bustub_->lock_manager_);
+    auto executor = ExecutorFactory::CreateExecutor(&exec_ctx, plan);
+    executor->Init();
+    std::vector<std::string> rows;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      rows.push_back(tuple.ToString(&plan->OutputSchema()));
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  std::unique_ptr<BustubInstance> bustub_;
+  Transaction *txn_{nullptr};
+};
+
+/** @return the number of times text occurs in plan */
+auto Count(const AbstractPlanNodeRef &plan, const std::string &text) -> int {
+  const std::string plan_string = plan->ToString();
+  int count = 0;
+  for (auto pos = plan_string.find(text); pos != std::string::npos; pos = plan_string.find(text, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+}  // namespace
+
+// A join on one equi-condition becomes a hash join, whatever its type
+TEST_F(NLJAsHashJoinTest, EquiJoin) {
+  for (const auto *sql : {"SELECT * FROM t INNER JOIN u ON t.a = u.c;", "SELECT * FROM t LEFT JOIN u ON u.c = t.a;"}) {
+    const auto [planned, optimized] = Plan(sql);
+    ASSERT_EQ(1, Count(planned, "NestedLoopJoin")) << planned->ToString();
+    EXPECT_EQ(0, Count(optimized, "NestedLoopJoin")) << optimized->ToString();
+    EXPECT_EQ(1, Count(optimized, "HashJoin")) << optimized->ToString();
+    EXPECT_EQ(0, Count(optimized, "Filter")) << optimized->ToString();
+    const auto rows = Run(planned);
+    ASSERT_FALSE(rows.empty());
+    EXPECT_EQ(rows, Run(optimized)) << sql;
+  }
+}
+
+// An inner join keys the hash join on its first equi-conjunct, wherever it is, and checks the rest in a filter above
+// it, over the output of the join
+TEST_F(NLJAsHashJoinTest, InnerJoinResidualConjuncts) {
+  for (const auto *sql : {"SELECT * FROM t INNER JOIN u ON t.a = u.c AND t.b < u.d;",
+                          "SELECT * FROM t INNER JOIN u ON u.d > 100 AND t.a = u.c AND t.b + 1 < u.d;",
+                          "SELECT * FROM t INNER JOIN u ON t.b > 10 AND u.c = t.a AND t.a = u.c;"}) {
+    const auto [planned, optimized] = Plan(sql);
+    EXPECT_EQ(0, Count(optimized, "NestedLoopJoin")) << optimized->ToString();
+    EXPECT_EQ(1, Count(optimized, "HashJoin")) << optimized->ToString();
+    EXPECT_EQ(1, Count(optimized, "Filter")) << optimized->ToString();
+    const auto rows = Run(planned);
+    ASSERT_FALSE(rows.empty()) << sql;
+    EXPECT_EQ(rows, Run(optimized)) << sql;
+  }
+}
+
+// An outer join cannot filter its output, which would drop the unmatched rows it pads, so a join with any other
+// conjunct is left as it is; so is one without an equi-conjunct between its two sides
+TEST_F(NLJAsHashJoinTest, KeepsNestedLoopJoin) {
+  for (const auto *sql : {"SELECT * FROM t LEFT JOIN u ON t.a = u.c AND t.b < u.d;",
+                          "SELECT * FROM t INNER JOIN u ON t.a < u.c AND t.b = 7;",
+                          "SELECT * FROM t INNER JOIN u ON t.a = t.b AND u.c = 3;"}) {
+    const auto [planned, optimized] = Plan(sql);
+    EXPECT_EQ(1, Count(optimized, "NestedLoopJoin")) << optimized->ToString();
+    EXPECT_EQ(0, Count(optimized, "HashJoin")) << optimized->ToString();
+    const auto rows = Run(planned);
+    ASSERT_FALSE(rows.empty()) << sql;
+    EXPECT_EQ(rows, Run(optimized)) << sql;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_execution_test.cpp
+//
+// Identification: test/execution/parallel_execution_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/work_stealing_pool.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(WorkStealingPoolTest, RunsEachTaskOnce) {
+  WorkStealingPool pool(4);
+  ASSERT_EQ(pool.GetWorkerCount(), 4);
+  // several queries on the same workers, including one without tasks and one with fewer tasks than workers
+  for (const size_t task_count : {1000, 0, 3, 1000}) {
+    std::vector<std::atomic<int>> runs(task_count);
+    std::atomic<bool> bad_worker{false};
+    pool.Run(task_count, [&](size_t worker, size_t task) {
+      bad_worker = bad_worker || worker >= pool.GetWorkerCount();
+      runs[task]++;
+    });
+    EXPECT_FALSE(bad_worker);
+    for (size_t i = 0; i < task_count; i++) {
+      ASSERT_EQ(runs[i], 1) << "task " << i << " of " << task_count;
+    }
+  }
+}
+
+TEST(WorkStealingPoolTest, RethrowsTheErrorOfATask) {
+  WorkStealingPool pool(3);
+  std::atomic<int> runs{0};
+  EXPECT_THROW(pool.Run(100,
+                        [&](size_t /*worker*/, size_t task) {
+                          runs++;
+                          if (task == 10) {
+                            throw std::runtime_error("task failed");
+                          }
+                        }),
+               std::runtime_error);
+  EXPECT_LE(runs, 100);
+  // the pool is still usable
+  runs = 0;
+  pool.Run(10, [&](size_t /*worker*/, size_t /*task*/) { runs++; });
+  EXPECT_EQ(runs, 10);
+}
+
+namespace {
+
+auto Execute(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream result;
+  SimpleStreamWriter writer(result, true, ",");
+  bustub->ExecuteSql(sql, writer);
+  return result.str();
+}
+
+/** @return the rows of a result in sorted order, for queries whose order is not defined */
+auto Sorted(const std::string &result) -> std::vector<std::string> {
+  std::vector<std::string> rows;
+  std::stringstream stream(result);
+  for (std::string row; std::getline(stream, row);) {
+    rows.push_back(row);
+  }
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+}  // namespace
+
+// Queries give the same result on one thread and on several, over a table heap of many morsels and mock tables
+TEST(ParallelExecutionTest, MatchesSerialExecution) {
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+  auto bustub = std::make_unique<BustubInstance>("parallel_execution_test.db");
+  bustub->GenerateMockTable();
+  Execute(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+  Execute(bustub.get(), "CREATE TABLE u (c INTEGER, d INTEGER);");
+  Execute(bustub.get(), "CREATE TABLE empty (e INTEGER);");
+  for (int chunk = 0; chunk < 8; chunk++) {
+    std::string rows;
+    for (int i = chunk * 1000; i < (chunk + 1) * 1000; i++) {
+      rows += (i == chunk * 1000 ? "" : ", ") + fmt::format("({}, 'group {}')", i, i % 10);
+    }
+    Execute(bustub.get(), "INSERT INTO t VALUES " + rows + ";");
+  }
+  std::string rows;
+  for (int i = 0; i < 500; i++) {
+    rows += (i == 0 ? "" : ", ") + fmt::format("({}, {})", i * 13 % 9000, i);
+  }
+  Execute(bustub.get(), "INSERT INTO u VALUES " + rows + ";");
+
+  // scans and joins keep the order of a serial run, and aggregations without groups have a single row
+  const std::vector<std::string> ordered_queries{
+      "SELECT a, b FROM t WHERE a > 100 AND a < 7000;",
+      "SELECT a + 1 FROM t;",
+      "SELECT t.a, u.d FROM t INNER JOIN u ON t.a = u.c;",
+      "SELECT u.c, t.b FROM u LEFT JOIN t ON u.d = t.a;",
+      "SELECT COUNT(*), SUM(a), MIN(a), MAX(a) FROM t WHERE a > 10;",
+      "SELECT COUNT(*), MIN(x), MAX(y) FROM __mock_t2_100k WHERE x > 1000;",
+      "SELECT COUNT(e), SUM(e) FROM empty;",
+  };
+  // groups come out of a hash table in any order, and a serial scan of some mock tables shuffles their rows
+  const std::vector<std::string> unordered_queries{
+      "SELECT * FROM __mock_t2_100k WHERE x < 1000;",
+      "SELECT b, COUNT(*), SUM(a), MIN(a), MAX(a) FROM t GROUP BY b;",
+      "SELECT v1, COUNT(v2), SUM(v3) FROM __mock_agg_input_big GROUP BY v1;",
+      "SELECT b, COUNT(*) FROM t INNER JOIN u ON t.a = u.c GROUP BY b;",
+  };
+  std::vector<std::string> serial;
+  for (const auto &query : ordered_queries) {
+    serial.push_back(Execute(bustub.get(), query));
+  }
+  for (const auto &query : unordered_queries) {
+    serial.push_back(Execute(bustub.get(), query));
+  }
+  ASSERT_EQ(serial[0].substr(0, 15), "101,group 1,\n10");
+  ASSERT_EQ(serial[5], "98999,1001,9999900,\n");
+
+  for (const auto *threads : {"2", "4"}) {
+    Execute(bustub.get(), fmt::format("SET execution_threads={};", threads));
+    ASSERT_EQ(bustub->GetExecutionThreads(), std::stoul(threads));
+    for (size_t i = 0; i < ordered_queries.size(); i++) {
+      EXPECT_EQ(Execute(bustub.get(), ordered_queries[i]), serial[i]) << ordered_queries[i] << " on " << threads;
+    }
+    for (size_t i = 0; i < unordered_queries.size(); i++) {
+      EXPECT_EQ(Sorted(Execute(bustub.get(), unordered_queries[i])), Sorted(serial[ordered_queries.size() + i]))
+          << unordered_queries[i] << " on " << threads;
+    }
+  }
+  bustub.reset();
+
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+}
+
+// A morsel ends at its last page of the chain even if the pages after it have no live tuple, and so are skipped
+TEST(ParallelExecutionTest, MorselBoundaryOnEmptyPages) {
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+  auto bustub = std::make_unique<BustubInstance>("parallel_execution_test.db");
+  Execute(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+  for (int chunk = 0; chunk < 8; chunk++) {
+    std::string rows;
+    for (int i = chunk * 1000; i < (chunk + 1) * 1000; i++) {
+      rows += (i == chunk * 1000 ? "" : ", ") + fmt::format("({}, 'group {}')", i, i % 10);
+    }
+    Execute(bustub.get(), "INSERT INTO t VALUES " + rows + ";");
+  }
+
+  // empty the first page of the second morsel, and every page of the third one, as aborted inserts would
+  auto *table = bustub->catalog_->GetTable("t")->table_.get();
+  const auto page_ids = table->GetPageIds();
+  ASSERT_GT(page_ids.size(), 3 * MORSEL_PAGES);
+  auto *txn = bustub->txn_manager_->Begin();
+  std::vector<RID> rids;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    const size_t position = table->GetChainPosition(it->GetRid().GetPageId());
+    if (position == MORSEL_PAGES || (position >= 2 * MORSEL_PAGES && position < 3 * MORSEL_PAGES)) {
+      rids.push_back(it->GetRid());
+    }
+  }
+  ASSERT_FALSE(rids.empty());
+  for (const auto &rid : rids) {
+    table->ApplyDelete(rid, txn);
+  }
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+
+  const std::vector<std::string> queries{"SELECT COUNT(*), SUM(a) FROM t;", "SELECT a, b FROM t WHERE a > 10;"};
+  std::vector<std::string> serial;
+  for (const auto &query : queries) {
+    serial.push_back(Execute(bustub.get(), query));
+  }
+  ASSERT_EQ(serial[0].substr(0, serial[0].find(',')), std::to_string(8000 - rids.size()));
+  for (const auto *threads : {"2", "4"}) {
+    Execute(bustub.get(), fmt::format("SET execution_threads={};", threads));
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(Execute(bustub.get(), queries[i]), serial[i]) << queries[i] << " on " << threads;
+    }
+  }
+  bustub.reset();
+
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+}
+
+// Changing execution_threads starts a new pool for later queries, and leaves the one a running query uses alone
+TEST(ParallelExecutionTest, ThreadCountChangesDuringQueries) {
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+  auto bustub = std::make_unique<BustubInstance>("parallel_execution_test.db");
+  Execute(bustub.get(), "CREATE TABLE t (a INTEGER);");
+  std::string rows;
+  for (int i = 0; i < 4000; i++) {
+    rows += (i == 0 ? "" : ", ") + fmt::format("({})", i);
+  }
+  Execute(bustub.get(), "INSERT INTO t VALUES " + rows + ";");
+  const std::string query = "SELECT COUNT(*), SUM(a) FROM t WHERE a > 10;";
+  const std::string expected = Execute(bustub.get(), query);
+  ASSERT_EQ(expected, "3989,7997945,\n");
+
+  Execute(bustub.get(), "SET execution_threads=2;");
+  std::atomic<bool> done{false};
+  std::vector<std::thread> clients;
+  for (int client = 0; client < 2; client++) {
+    clients.emplace_back([&] {
+      for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(Execute(bustub.get(), query), expected);
+      }
+    });
+  }
+  std::thread setter([&] {
+    for (int i = 0; !done; i++) {
+      Execute(bustub.get(), fmt::format("SET execution_threads={};", 2 + i % 3));
+    }
+  });
+  for (auto &client : clients) {
+    client.join();
+  }
+  done = true;
+  setter.join();
+  bustub.reset();
+
+  remove("parallel_execution_test.db");
+  remove("parallel_execution_test.log");
+}
+
+}  // namespace bustub
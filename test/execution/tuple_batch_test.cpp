@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_test.cpp
+//
+// Identification: test/execution/tuple_batch_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/tuple_batch.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+const Schema SCHEMA({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::DECIMAL)});
+
+/** @return tuple i of the tests, whose columns are NULL now and then */
+auto MakeTuple(int i) -> Tuple {
+  std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("row " + std::to_string(i)),
+                            ValueFactory::GetDecimalValue(i / 4.0)};
+  if (i % 7 == 3) {
+    values[0] = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  }
+  if (i % 11 == 5) {
+    values[1] = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+  }
+  return {std::move(values), &SCHEMA};
+}
+
+/** Check that a row of a batch holds tuple i of the tests, and its RID */
+void CheckRow(const TupleBatch &batch, size_t row, int i) {
+  const Tuple tuple = batch.GetTuple(row);
+  EXPECT_EQ(MakeTuple(i).ToString(&SCHEMA), tuple.ToString(&SCHEMA)) << "row " << row;
+  EXPECT_EQ(RID(i, 0), batch.GetRid(row));
+}
+
+/** An executor that only implements Next(), yielding tuples [0, count) of the tests */
+class TupleAtATimeExecutor : public AbstractExecutor {
+ public:
+  explicit TupleAtATimeExecutor(int count) : AbstractExecutor(nullptr), count_(count) {}
+
+  void Init() override { next_ = 0; }
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override {
+    if (next_ == count_) {
+      return false;
+    }
+    *tuple = MakeTuple(next_);
+    *rid = RID(next_, 0);
+    next_++;
+    return true;
+  }
+
+  auto GetOutputSchema() const -> const Schema & override { return SCHEMA; }
+
+ private:
+  int count_;
+  int next_{0};
+};
+
+/**
+ * An executor that produces batches of tuples [0, count) of the tests, with the odd ones filtered out, as are all
+ * those of its second batch
+ */
+class BatchAtATimeExecutor : public AbstractExecutor {
+ public:
+  explicit BatchAtATimeExecutor(int count) : AbstractExecutor(nullptr), count_(count) {}
+
+  void Init() override {
+    next_ = 0;
+    ResetOutputBatch();
+  }
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override { return NextFromBatch(tuple, rid); }
+
+  auto NextBatch(TupleBatch *batch) -> bool override {
+    batch->Reset(&SCHEMA);
+    while (!batch->IsFull() && next_ < count_) {
+      batch->AppendTuple(MakeTuple(next_), RID(next_, 0));
+      next_++;
+    }
+    ColumnVector predicate(TypeId::BOOLEAN);
+    predicate.Resize(batch->GetRowCount());
+    for (size_t row = 0; row < batch->GetRowCount(); row++) {
+      predicate.SetValue(row, ValueFactory::GetBooleanValue(IsSelected(batch->GetRid(row).GetPageId())));
+    }
+    batch->Select(predicate);
+    return batch->GetRowCount() > 0;
+  }
+
+  auto GetOutputSchema() const -> const Schema & override { return SCHEMA; }
+
+  static auto IsSelected(int i) -> bool { return i % 2 == 0 && i / TUPLE_BATCH_SIZE != 1; }
+
+ private:
+  int count_;
+  int next_{0};
+};
+
+}  // namespace
+
+// A batch keeps its rows in columns, and gives them back as tuples
+TEST(TupleBatchTest, GetTuple) {
+  TupleBatch batch;
+  batch.Reset(&SCHEMA);
+  for (int i = 0; i < 100; i++) {
+    batch.AppendTuple(MakeTuple(i), RID(i, 0));
+  }
+  ASSERT_EQ(100U, batch.GetRowCount());
+  ASSERT_EQ(100U, batch.Size());
+  for (size_t row = 0; row < batch.GetRowCount(); row++) {
+    EXPECT_EQ(row, batch.GetSelection()[row]);
+    CheckRow(batch, row, static_cast<int>(row));
+  }
+  EXPECT_TRUE(batch.GetValue(3, 0).IsNull());
+  EXPECT_TRUE(batch.GetValue(5, 1).IsNull());
+
+  // a batch reset for the same schema is empty again
+  batch.Reset(&SCHEMA);
+  EXPECT_EQ(0U, batch.GetRowCount());
+  EXPECT_EQ(0U, batch.Size());
+}
+
+// Selecting narrows the selection in place and leaves the rows where they are
+TEST(TupleBatchTest, Select) {
+  TupleBatch batch;
+  batch.Reset(&SCHEMA);
+  for (int i = 0; i < 150; i++) {
+    batch.AppendTuple(MakeTuple(i), RID(i, 0));
+  }
+
+  // even rows are true and rows divisible by 3 are NULL, which is not true either
+  ColumnVector predicate(TypeId::BOOLEAN);
+  predicate.Resize(batch.GetRowCount());
+  for (size_t row = 0; row < batch.GetRowCount(); row++) {
+    if (row % 3 == 0) {
+      predicate.SetNull(row);
+    } else {
+      predicate.SetValue(row, ValueFactory::GetBooleanValue(row % 2 == 0));
+    }
+  }
+  batch.Select(predicate);
+  std::vector<uint32_t> expected;
+  for (uint32_t row = 0; row < 150; row++) {
+    if (row % 2 == 0 && row % 3 != 0) {
+      expected.push_back(row);
+    }
+  }
+  EXPECT_EQ(expected, batch.GetSelection());
+  EXPECT_EQ(150U, batch.GetRowCount());
+
+  // a mask over rows that are no longer selected does not bring them back; that of rows 64 and on is in word 1
+  std::vector<uint64_t> mask(3, 0);
+  for (uint32_t row = 0; row < 150; row++) {
+    if (row % 5 != 0) {
+      mask[row / 64] |= uint64_t{1} << (row % 64);
+    }
+  }
+  batch.Select(mask.data());
+  expected.clear();
+  for (uint32_t row = 0; row < 150; row++) {
+    if (row % 2 == 0 && row % 3 != 0 && row % 5 != 0) {
+      expected.push_back(row);
+    }
+  }
+  EXPECT_EQ(expected, batch.GetSelection());
+  EXPECT_EQ(expected.size(), batch.Size());
+  for (const auto row : batch.GetSelection()) {
+    CheckRow(batch, row, static_cast<int>(row));
+  }
+
+  batch.Select(std::vector<uint64_t>(3, 0).data());
+  EXPECT_EQ(0U, batch.Size());
+}
+
+// The default NextBatch() fills full batches from Next(), until the last one
+TEST(TupleBatchTest, NextBatchFromNext) {
+  const int count = TUPLE_BATCH_SIZE * 2 + TUPLE_BATCH_SIZE / 2;
+  TupleAtATimeExecutor executor(count);
+  for (int run = 0; run < 2; run++) {
+    executor.Init();
+    TupleBatch batch;
+    int next = 0;
+    while (executor.NextBatch(&batch)) {
+      EXPECT_EQ(static_cast<size_t>(std::min(TUPLE_BATCH_SIZE, count - next)), batch.Size());
+      for (const auto row : batch.GetSelection()) {
+        CheckRow(batch, row, next++);
+      }
+    }
+    EXPECT_EQ(count, next);
+    EXPECT_EQ(0U, batch.Size());
+  }
+}
+
+// Next() of an executor that produces batches yields their selected rows in order, skipping batches with none, and
+// Init() drops the rest of the batch it was reading
+TEST(TupleBatchTest, NextFromBatch) {
+  const int count = TUPLE_BATCH_SIZE * 2 + 3;
+  BatchAtATimeExecutor executor(count);
+  Tuple tuple;
+  RID rid;
+
+  executor.Init();
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(executor.Next(&tuple, &rid));
+  }
+  executor.Init();
+  std::vector<int> expected;
+  for (int i = 0; i < count; i++) {
+    if (BatchAtATimeExecutor::IsSelected(i)) {
+      expected.push_back(i);
+    }
+  }
+  std::vector<int> yielded;
+  while (executor.Next(&tuple, &rid)) {
+    EXPECT_EQ(MakeTuple(rid.GetPageId()).ToString(&SCHEMA), tuple.ToString(&SCHEMA));
+    yielded.push_back(rid.GetPageId());
+  }
+  EXPECT_EQ(expected, yielded);
+  EXPECT_FALSE(executor.Next(&tuple, &rid));
+}
+
+}  // namespace bustub
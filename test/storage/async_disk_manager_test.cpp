@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::TestWithParam<AsyncDiskManager::Backend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("async_test.db");
+    remove("async_test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("async_test.db");
+    remove("async_test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  AsyncDiskManager dm("async_test.db", GetParam());
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  dm.ReadPage(0, buf);  // tolerate empty read
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // pages in the hole are read back as zeros
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ManyInFlightTest) {
+  const int num_pages = 200;
+  AsyncDiskManager dm("async_test.db", GetParam(), 16);
+
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<void>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %d", i);
+    writes.emplace_back(dm.WritePageAsync(i, pages[i].data()));
+  }
+  for (auto &write : writes) {
+    write.get();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  std::vector<std::vector<char>> reads(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<void>> futures;
+  for (int i = num_pages - 1; i >= 0; i--) {
+    futures.emplace_back(dm.ReadPageAsync(i, reads[i].data()));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(pages[i], reads[i]);
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, VectoredTest) {
+  const int num_pages = 100;
+  AsyncDiskManager dm("async_test.db", GetParam(), 8);
+
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "vectored %d", i);
+    // every third page is left out, so runs of adjacent pages are broken up
+    if (i % 3 != 2) {
+      writes.emplace_back(i, pages[i].data());
+    }
+  }
+  dm.WritePages(writes);
+
+  std::vector<std::vector<char>> reads(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+  std::vector<std::pair<page_id_t, char *>> batch;
+  for (int i = 0; i < num_pages; i++) {
+    batch.emplace_back(i, reads[i].data());
+  }
+  dm.ReadPages(batch);
+  for (int i = 0; i < num_pages; i++) {
+    if (i % 3 != 2) {
+      EXPECT_EQ(pages[i], reads[i]);
+    } else if (i < num_pages - 1) {
+      EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), reads[i]);
+    }
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, BufferPoolTest) {
+  AsyncDiskManager dm("async_test.db", GetParam());
+  auto *bpm = new BufferPoolManagerInstance(8, &dm);
+
+  // Enough pages that most of them are evicted and read back through the async disk manager.
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 64; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    // frames are aligned for O_DIRECT, so they go to the kernel without a bounce buffer
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(page->GetData()) % DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "bpm %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("bpm " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  delete bpm;
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncDiskManagerTest,
+                         ::testing::Values(AsyncDiskManager::Backend::AUTO,
+                                           AsyncDiskManager::Backend::THREAD_POOL));  // NOLINT
+
+}  // namespace bustub
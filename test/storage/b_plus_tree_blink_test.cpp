@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_blink_test.cpp
+//
+// Identification: test/storage/b_plus_tree_blink_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BLinkTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(BPlusTreeBLinkTest, InsertLookupRemove) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so the tree is several levels deep
+  BLinkTree tree("foo_pk", bpm, comparator, 3, 4, BPlusTreeMode::B_LINK);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale = 1000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+  }
+  index_key.SetFromInteger(scale / 2);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0)));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  // Scenario: removing never merges pages, iteration skips the leaves that became empty.
+  for (int64_t key = 1; key <= scale; key++) {
+    if (key % 4 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  int64_t current_key = 4;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key += 4;
+  }
+  EXPECT_EQ(current_key, scale + 4);
+
+  index_key.SetFromInteger(101);
+  current_key = 104;
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key += 4;
+  }
+  EXPECT_EQ(current_key, scale + 4);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBLinkTest, ConcurrentInsertWithReaders) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BLinkTree tree("foo_pk", bpm, comparator, 3, 4, BPlusTreeMode::B_LINK);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the even keys are there from the start, writers fill in the odd ones
+  const int64_t scale = 2000;
+  const int num_writers = 4;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < scale; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+
+  // Scenario: readers must find every even key while writers keep splitting the pages around them.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_writers; tid++) {
+    threads.emplace_back([&tree, tid, scale]() {
+      GenericKey<8> key;
+      for (int64_t k = 2 * tid + 1; k < scale; k += 2 * num_writers) {
+        key.SetFromInteger(k);
+        tree.Insert(key, RID(k));
+      }
+    });
+  }
+  threads.emplace_back([&tree, scale]() {
+    GenericKey<8> key;
+    std::vector<RID> rids;
+    for (int round = 0; round < 2; round++) {
+      for (int64_t k = 0; k < scale; k += 2) {
+        rids.clear();
+        key.SetFromInteger(k);
+        ASSERT_TRUE(tree.GetValue(key, &rids)) << "key " << k;
+        ASSERT_EQ(rids[0].GetSlotNum(), k);
+      }
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
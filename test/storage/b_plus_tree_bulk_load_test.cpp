@@ -0,0 +1,268 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+
+/** Check that the tree holds exactly the given keys, each with a RID whose slot is the key. */
+void CheckContents(Tree *tree, const std::vector<int64_t> &keys) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree->GetValue(index_key, &rids)) << "key " << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  size_t i = 0;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator, ++i) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ((*iterator).first.ToString(), keys[i]);
+  }
+  EXPECT_EQ(i, keys.size());
+}
+
+}  // namespace
+
+TEST(BPlusTreeBulkLoadTest, SortedInput) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    for (double fill_factor : {0.0, 0.7, 1.0}) {
+      auto *disk_manager = new DiskManager("test.db");
+      // a small pool: the load must not keep more than a few pages pinned
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      // small pages, so the tree is several levels deep and every level has a partial last page
+      Tree tree("foo_pk", bpm, comparator, 4, 5, mode);
+
+      std::vector<int64_t> keys;
+      for (int64_t key = 1; key <= 2000; key++) {
+        keys.push_back(key * 2);
+      }
+      size_t next = 0;
+      auto source = [&](GenericKey<8> *key, RID *rid) {
+        if (next == keys.size()) {
+          return false;
+        }
+        key->SetFromInteger(keys[next]);
+        *rid = RID(keys[next]);
+        next++;
+        return true;
+      };
+      ASSERT_TRUE(tree.BulkLoad(source, fill_factor));
+      CheckContents(&tree, keys);
+
+      // Scenario: a loaded tree does not load again.
+      next = 0;
+      EXPECT_FALSE(tree.BulkLoad(source, fill_factor));
+
+      // Scenario: the loaded tree takes regular inserts and removes.
+      GenericKey<8> index_key;
+      for (int64_t key = 1; key <= 4001; key += 2) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+      }
+      for (int64_t key = 2; key <= 4000; key += 4) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      keys.clear();
+      for (int64_t key = 1; key <= 4001; key++) {
+        if (key % 2 == 1 || key % 4 == 0) {
+          keys.push_back(key);
+        }
+      }
+      CheckContents(&tree, keys);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+TEST(BPlusTreeBulkLoadTest, SmallInputs) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // Scenario: every size up to a few pages builds a valid tree, including the ones that merge the last two leaves.
+  for (int64_t size = 0; size <= 40; size++) {
+    Tree tree("index_" + std::to_string(size), bpm, comparator, 4, 5);
+    int64_t next = 1;
+    ASSERT_TRUE(tree.BulkLoad([&](GenericKey<8> *key, RID *rid) {
+      if (next > size) {
+        return false;
+      }
+      key->SetFromInteger(next);
+      *rid = RID(next);
+      next++;
+      return true;
+    }));
+    EXPECT_EQ(tree.IsEmpty(), size == 0);
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key <= size; key++) {
+      keys.push_back(key);
+    }
+    CheckContents(&tree, keys);
+    // removing everything exercises the merges of the pages at the right edge
+    GenericKey<8> index_key;
+    for (int64_t key = size; key >= 1; key--) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  // Scenario: input out of order is rejected and leaves the tree empty.
+  Tree tree("unsorted", bpm, comparator, 4, 5);
+  int64_t next = 0;
+  EXPECT_THROW(tree.BulkLoad([&](GenericKey<8> *key, RID *rid) {
+    next++;
+    key->SetFromInteger(next == 30 ? 1 : next);
+    *rid = RID(next);
+    return true;
+  }),
+               Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // Scenario: so is a key that repeats its predecessor.
+  Tree duplicates("duplicates", bpm, comparator, 4, 5);
+  next = 0;
+  EXPECT_THROW(duplicates.BulkLoad([&](GenericKey<8> *key, RID *rid) {
+    next++;
+    key->SetFromInteger(next == 30 ? next - 1 : next);
+    *rid = RID(next);
+    return true;
+  }),
+               Exception);
+  EXPECT_TRUE(duplicates.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSorterMergesRuns) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // one page per run and two runs per merge, so the sort takes several merge passes
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator, 1, 2);
+  const int64_t num_keys = 5000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_key.SetFromInteger(keys[i]);
+    sorter.Add(index_key, RID(static_cast<page_id_t>(i), keys[i]));
+  }
+  sorter.Finish();
+  EXPECT_GT(sorter.GetNumRuns(), 2U);
+
+  // Scenario: the output is sorted, and equal keys come out in the order they were added.
+  RID rid;
+  int64_t count = 0;
+  int64_t last_key = -1;
+  page_id_t last_position = -1;
+  while (sorter.Next(&index_key, &rid)) {
+    const int64_t key = index_key.ToString();
+    ASSERT_GE(key, last_key);
+    EXPECT_EQ(rid.GetSlotNum(), key);
+    if (key == last_key) {
+      EXPECT_GT(rid.GetPageId(), last_position);
+    }
+    last_key = key;
+    last_position = rid.GetPageId();
+    count++;
+  }
+  EXPECT_EQ(count, num_keys);
+
+  // Scenario: a sort dropped before its output, or part way through it, cleans up after itself.
+  for (const bool finish : {false, true}) {
+    ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> dropped(comparator, 1, 2);
+    for (size_t i = 0; i < keys.size(); i++) {
+      index_key.SetFromInteger(keys[i]);
+      dropped.Add(index_key, RID(static_cast<page_id_t>(i), keys[i]));
+    }
+    if (finish) {
+      ASSERT_TRUE(dropped.Next(&index_key, &rid));
+    }
+  }
+}
+
+TEST(BPlusTreeBulkLoadTest, UnsortedInput) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator);
+
+  // more entries than the sort keeps in memory, so runs are written out
+  const int64_t num_keys = 60000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  size_t next = 0;
+  ASSERT_TRUE(tree.BulkLoadUnsorted([&](GenericKey<8> *key, RID *rid) {
+    if (next == keys.size()) {
+      return false;
+    }
+    key->SetFromInteger(keys[next]);
+    *rid = RID(keys[next]);
+    next++;
+    return true;
+  }));
+
+  std::sort(keys.begin(), keys.end());
+  CheckContents(&tree, keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
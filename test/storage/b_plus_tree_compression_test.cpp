@@ -0,0 +1,251 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_compression_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using WideKey = GenericKey<64>;
+using WideComparator = GenericComparator<64>;
+using WideLeafPage = BPlusTreeLeafPage<WideKey, RID, WideComparator>;
+using WideInternalPage = BPlusTreeInternalPage<WideKey, page_id_t, WideComparator>;
+using WideTree = BPlusTree<WideKey, RID, WideComparator>;
+
+namespace {
+
+/** A key of the schema (a bigint, b bigint). */
+auto MakeKey(const Schema *key_schema, int64_t a, int64_t b) -> WideKey {
+  Tuple tuple({ValueFactory::GetBigIntValue(a), ValueFactory::GetBigIntValue(b)}, key_schema);
+  WideKey key;
+  key.SetFromKey(tuple, key_schema);
+  return key;
+}
+
+auto SameBytes(const WideKey &lhs, const WideKey &rhs) -> bool { return memcmp(lhs.data_, rhs.data_, 64) == 0; }
+
+}  // namespace
+
+TEST(BPlusTreeCompressionTest, LeafPageLayout) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  WideComparator comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  page_id_t page_id;
+  auto *leaf = reinterpret_cast<WideLeafPage *>(bpm->NewPage(&page_id)->GetData());
+  leaf->Init(page_id);
+
+  // Scenario: keys sharing the first column and the high bytes of the second store a single byte each, so the page
+  // holds many times more entries than it would uncompressed.
+  int64_t b = 0;
+  while (b < 200 && leaf->HasRoomFor(MakeKey(key_schema.get(), 1, b))) {
+    ASSERT_TRUE(leaf->Insert(MakeKey(key_schema.get(), 1, b), RID(b), comparator));
+    b++;
+  }
+  EXPECT_EQ(200, b);
+  EXPECT_EQ(1, leaf->GetKeyWidth());
+  EXPECT_GT(leaf->GetSize(), 3 * WideLeafPage::UNCOMPRESSED_CAPACITY);
+  RID rid;
+  for (b = 0; b < 200; b++) {
+    ASSERT_TRUE(leaf->Lookup(MakeKey(key_schema.get(), 1, b), &rid, comparator));
+    EXPECT_EQ(b, rid.GetSlotNum());
+  }
+  EXPECT_FALSE(leaf->Lookup(MakeKey(key_schema.get(), 2, 0), &rid, comparator));
+
+  // Scenario: a key that shares fewer bytes widens every entry, and they all still decode.
+  ASSERT_TRUE(leaf->Insert(MakeKey(key_schema.get(), 2, 1000), RID(1000), comparator));
+  EXPECT_GT(leaf->GetKeyWidth(), 1);
+  EXPECT_EQ(201, leaf->GetSize());
+  for (int64_t i = 0; i < 200; i++) {
+    EXPECT_TRUE(SameBytes(MakeKey(key_schema.get(), 1, i), leaf->KeyAt(i)));
+    EXPECT_EQ(i, leaf->ValueAt(i).GetSlotNum());
+  }
+  EXPECT_TRUE(SameBytes(MakeKey(key_schema.get(), 2, 1000), leaf->KeyAt(200)));
+
+  // Scenario: a split recompresses both halves as tightly as their own keys allow.
+  page_id_t new_page_id;
+  auto *new_leaf = reinterpret_cast<WideLeafPage *>(bpm->NewPage(&new_page_id)->GetData());
+  new_leaf->Init(new_page_id);
+  leaf->MoveHalfTo(new_leaf);
+  EXPECT_EQ(100, leaf->GetSize());
+  EXPECT_EQ(101, new_leaf->GetSize());
+  EXPECT_EQ(1, leaf->GetKeyWidth());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(SameBytes(MakeKey(key_schema.get(), 1, i), leaf->KeyAt(i)));
+    EXPECT_TRUE(SameBytes(MakeKey(key_schema.get(), 1, 100 + i), new_leaf->KeyAt(i)));
+  }
+
+  // Scenario: merging back needs the room of the wider of the two layouts, which the page has.
+  ASSERT_TRUE(leaf->CanAbsorb(new_leaf, nullptr));
+  new_leaf->MoveAllTo(leaf);
+  EXPECT_EQ(201, leaf->GetSize());
+  EXPECT_EQ(0, new_leaf->GetSize());
+  for (int64_t i = 0; i < 200; i++) {
+    ASSERT_TRUE(leaf->Lookup(MakeKey(key_schema.get(), 1, i), &rid, comparator));
+    EXPECT_EQ(i, rid.GetSlotNum());
+  }
+
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(new_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeCompressionTest, Separator) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  WideComparator comparator(key_schema.get());
+  const Schema *schema = key_schema.get();
+
+  // Scenario: the first column alone tells the keys apart, so the second one is dropped; zero bytes are its NULL.
+  EXPECT_TRUE(SameBytes(MakeKey(schema, 2, BUSTUB_INT64_NULL),
+                        comparator.Separator(MakeKey(schema, 1, 5), MakeKey(schema, 2, 3))));
+  // Scenario: the keys share the first column, so the separator is the right key itself.
+  EXPECT_TRUE(SameBytes(MakeKey(schema, 1, 9), comparator.Separator(MakeKey(schema, 1, 5), MakeKey(schema, 1, 9))));
+  // Scenario: a column is cut after the first byte that differs.
+  EXPECT_TRUE(SameBytes(MakeKey(schema, 1, 0x200),
+                        comparator.Separator(MakeKey(schema, 1, 0x1FF), MakeKey(schema, 1, 0x2FF))));
+  // Scenario: a truncated key must stay above the left key.
+  EXPECT_TRUE(
+      SameBytes(MakeKey(schema, 2, -1), comparator.Separator(MakeKey(schema, 2, -5), MakeKey(schema, 2, -1))));
+
+  auto single_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> single_comparator(single_schema.get());
+  GenericKey<8> lhs;
+  GenericKey<8> rhs;
+  lhs.SetFromInteger(10);
+  rhs.SetFromInteger(20);
+  EXPECT_EQ(20, single_comparator.Separator(lhs, rhs).ToString());
+}
+
+TEST(BPlusTreeCompressionTest, CompositeKeys) {
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  WideComparator comparator(key_schema.get());
+  const Schema *schema = key_schema.get();
+
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    // the default page sizes, so that splits are driven by the bytes the keys take
+    WideTree tree("foo_pk", bpm, comparator, 2 * WideLeafPage::UNCOMPRESSED_CAPACITY - 2,
+                  2 * WideInternalPage::UNCOMPRESSED_CAPACITY - 2, mode);
+
+    // a few values of the first column, and second columns of very different magnitudes
+    const int64_t scale = 20000;
+    std::vector<int64_t> ids;
+    for (int64_t i = 0; i < scale; i++) {
+      ids.push_back(i);
+    }
+    auto key_of = [schema](int64_t i) { return MakeKey(schema, i % 7, i % 3 == 0 ? i : i << 20); };
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+    for (auto i : ids) {
+      ASSERT_TRUE(tree.Insert(key_of(i), RID(i)));
+    }
+    EXPECT_FALSE(tree.Insert(key_of(42), RID(0)));
+
+    std::vector<RID> rids;
+    for (int64_t i = 0; i < scale; i++) {
+      rids.clear();
+      ASSERT_TRUE(tree.GetValue(key_of(i), &rids)) << "key " << i;
+      EXPECT_EQ(i, rids[0].GetSlotNum());
+    }
+    int64_t count = 0;
+    WideKey previous;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, ++count) {
+      if (count > 0) {
+        ASSERT_LT(comparator(previous, (*iterator).first), 0);
+      }
+      previous = (*iterator).first;
+    }
+    EXPECT_EQ(scale, count);
+
+    // Scenario: removing most keys merges pages back together in classic mode; the rest stays reachable.
+    for (auto i : ids) {
+      if (i % 10 != 0) {
+        tree.Remove(key_of(i));
+      }
+    }
+    for (int64_t i = 0; i < scale; i++) {
+      rids.clear();
+      EXPECT_EQ(i % 10 == 0, tree.GetValue(key_of(i), &rids)) << "key " << i;
+    }
+    count = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ(0U, (*iterator).second.GetSlotNum() % 10);
+      count++;
+    }
+    EXPECT_EQ(scale / 10, count);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeCompressionTest, NarrowKeys) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  using NarrowLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using NarrowInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+  // Scenario: keys a few bytes wide fill a leaf by bytes before it reaches its max size, so inserts that find a leaf
+  // with fewer entries than that still split it.
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator,
+                                                             2 * NarrowLeafPage::UNCOMPRESSED_CAPACITY - 2,
+                                                             2 * NarrowInternalPage::UNCOMPRESSED_CAPACITY - 2, mode);
+    const int64_t scale = 30000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < scale; key++) {
+      keys.push_back(key * 1000);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, RID(key)));
+    }
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids)) << "key " << key;
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
@@ -7,6 +7,7 @@
 #include <functional>
 #include <future>  // NOLINT
 #include <iostream>
+#include <random>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -154,4 +155,85 @@ TEST(BPlusTreeTest, DISABLED_BPlusTreeContentionBenchmark2) {  // NOLINT
             << std::endl;
 }
 
+/**
+ * Runs a mixed workload against a preloaded tree and returns the operations per second across all threads. Each
+ * thread owns a slice of the key space; 80% of its operations are point lookups, the rest alternate between inserting
+ * and removing keys of its slice, so leaves keep splitting and merging under the readers.
+ */
+auto BPlusTreeThroughputCall(size_t num_threads, int leaf_node_size, size_t ops_per_thread, BPlusTreeMode mode)
+    -> double {
+  const int64_t num_keys = 64000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerMemory(256 << 10);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_node_size, 64, mode);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  GenericKey<8> index_key;
+  auto *transaction = new Transaction(0);
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key), transaction);
+  }
+  delete transaction;
+
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&tree, tid, num_threads, num_keys, ops_per_thread]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<int64_t> any_key(0, num_keys - 1);
+      const int64_t slice = num_keys / static_cast<int64_t>(num_threads);
+      std::uniform_int_distribution<int64_t> own_key(slice * static_cast<int64_t>(tid),
+                                                     slice * static_cast<int64_t>(tid + 1) - 1);
+      GenericKey<8> key;
+      std::vector<RID> result;
+      Transaction txn(static_cast<txn_id_t>(tid + 1));
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        if (i % 10 < 8) {
+          key.SetFromInteger(any_key(gen));
+          result.clear();
+          tree.GetValue(key, &result, &txn);
+        } else {
+          int64_t k = own_key(gen);
+          key.SetFromInteger(k);
+          if (i % 10 == 8) {
+            tree.Insert(key, RID(k), &txn);
+          } else {
+            tree.Remove(key, &txn);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  return static_cast<double>(num_threads * ops_per_thread) / std::chrono::duration<double>(end - start).count();
+}
+
+TEST(BPlusTreeTest, DISABLED_BPlusTreeThroughputBenchmark) {  // NOLINT
+  const size_t total_ops = 640000;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int leaf_node_size : {16, 128}) {
+    for (size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+      double classic = BPlusTreeThroughputCall(num_threads, leaf_node_size, total_ops / num_threads,
+                                               BPlusTreeMode::CLASSIC);
+      double b_link = BPlusTreeThroughputCall(num_threads, leaf_node_size, total_ops / num_threads,
+                                              BPlusTreeMode::B_LINK);
+      std::cout << "leaf size " << leaf_node_size << ", " << num_threads << " threads: classic "
+                << static_cast<size_t>(classic) << " ops/sec, b-link " << static_cast<size_t>(b_link) << " ops/sec"
+                << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_index_test.cpp
+//
+// Identification: test/storage/b_plus_tree_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Rows (a, b) for a in [0, 10) and b in [0, 20), the RID of a row encoding its values. */
+constexpr int A_VALUES = 10;
+constexpr int B_VALUES = 20;
+
+auto RidOf(int a, int b) -> RID { return RID(a, b); }
+
+auto MakeIndex(BufferPoolManager *bpm, const Schema *table_schema, std::vector<uint32_t> key_attrs, bool is_unique,
+               std::vector<uint32_t> included_attrs = {}) -> std::unique_ptr<BPlusTreeIndexForFixedSizeKeys> {
+  // the header page, which keeps the root page id
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto metadata = std::make_unique<IndexMetadata>("index", "table", table_schema, std::move(key_attrs), is_unique,
+                                                 std::move(included_attrs));
+  return std::make_unique<BPlusTreeIndexForFixedSizeKeys>(std::move(metadata), bpm);
+}
+
+auto Bound(std::vector<int> values, bool inclusive) -> std::optional<IndexKeyBound> {
+  IndexKeyBound bound{{}, inclusive};
+  for (int value : values) {
+    bound.values_.push_back(ValueFactory::GetIntegerValue(value));
+  }
+  return bound;
+}
+
+auto ScanAll(BPlusTreeIndexForFixedSizeKeys *index, const std::optional<IndexKeyBound> &low,
+             const std::optional<IndexKeyBound> &high, bool reverse) -> std::vector<RID> {
+  std::vector<RID> rids;
+  auto iterator = index->GetRangeIterator(low, high, reverse);
+  while (iterator.NextBatch(&rids)) {
+  }
+  return rids;
+}
+
+}  // namespace
+
+TEST(BPlusTreeIndexTest, NonUniqueKeys) {
+  auto disk_manager = std::make_unique<DiskManager>("b_plus_tree_index_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Schema table_schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}});
+  auto index = MakeIndex(bpm.get(), &table_schema, {0}, false);
+  const Schema *key_schema = index->GetKeySchema();
+
+  for (int b = B_VALUES - 1; b >= 0; b--) {
+    for (int a = 0; a < A_VALUES; a++) {
+      index->InsertEntry(Tuple({ValueFactory::GetIntegerValue(a)}, key_schema), RidOf(a, b), nullptr);
+    }
+  }
+
+  // every row of a key comes back, in RID order
+  std::vector<RID> rids;
+  index->ScanKey(Tuple({ValueFactory::GetIntegerValue(3)}, key_schema), &rids, nullptr);
+  ASSERT_EQ(rids.size(), B_VALUES);
+  for (int b = 0; b < B_VALUES; b++) {
+    EXPECT_EQ(rids[b], RidOf(3, b));
+  }
+
+  // an entry is removed by its key and RID, leaving the other rows of the key
+  index->DeleteEntry(Tuple({ValueFactory::GetIntegerValue(3)}, key_schema), RidOf(3, 7), nullptr);
+  rids.clear();
+  index->ScanKey(Tuple({ValueFactory::GetIntegerValue(3)}, key_schema), &rids, nullptr);
+  EXPECT_EQ(rids.size(), B_VALUES - 1);
+  EXPECT_EQ(std::find(rids.begin(), rids.end(), RidOf(3, 7)), rids.end());
+
+  rids.clear();
+  index->ScanKey(Tuple({ValueFactory::GetIntegerValue(A_VALUES)}, key_schema), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+
+  remove("b_plus_tree_index_test.db");
+}
+
+TEST(BPlusTreeIndexTest, UniqueKeys) {
+  auto disk_manager = std::make_unique<DiskManager>("b_plus_tree_index_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Schema table_schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}});
+  auto index = MakeIndex(bpm.get(), &table_schema, {0}, true);
+  const Schema *key_schema = index->GetKeySchema();
+
+  EXPECT_TRUE(index->InsertEntry(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), RidOf(1, 0), nullptr));
+  EXPECT_FALSE(index->InsertEntry(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), RidOf(1, 1), nullptr));
+  std::vector<RID> rids;
+  index->ScanKey(Tuple({ValueFactory::GetIntegerValue(1)}, key_schema), &rids, nullptr);
+  EXPECT_EQ(rids, std::vector<RID>{RidOf(1, 0)});
+
+  remove("b_plus_tree_index_test.db");
+}
+
+TEST(BPlusTreeIndexTest, CompositeKeyPrefixRanges) {
+  auto disk_manager = std::make_unique<DiskManager>("b_plus_tree_index_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Schema table_schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}});
+  auto index = MakeIndex(bpm.get(), &table_schema, {0, 1}, false);
+  const Schema *key_schema = index->GetKeySchema();
+
+  for (int a = A_VALUES - 1; a >= 0; a--) {
+    for (int b = 0; b < B_VALUES; b++) {
+      index->InsertEntry(Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, key_schema),
+                         RidOf(a, b), nullptr);
+    }
+  }
+
+  const auto expect_rows = [](const std::vector<RID> &rids, int a_from, int b_from, int a_to, int b_to) {
+    std::vector<RID> expected;
+    for (int a = a_from; a <= a_to; a++) {
+      for (int b = (a == a_from ? b_from : 0); b <= (a == a_to ? b_to : B_VALUES - 1); b++) {
+        expected.push_back(RidOf(a, b));
+      }
+    }
+    EXPECT_EQ(rids, expected);
+  };
+
+  // a = 3
+  expect_rows(ScanAll(index.get(), Bound({3}, true), Bound({3}, true), false), 3, 0, 3, B_VALUES - 1);
+  // a = 3 AND b > 5
+  expect_rows(ScanAll(index.get(), Bound({3, 5}, false), Bound({3}, true), false), 3, 6, 3, B_VALUES - 1);
+  // a = 3 AND b <= 5
+  expect_rows(ScanAll(index.get(), Bound({3}, true), Bound({3, 5}, true), false), 3, 0, 3, 5);
+  // a >= 3 AND a < 5
+  expect_rows(ScanAll(index.get(), Bound({3}, true), Bound({5}, false), false), 3, 0, 4, B_VALUES - 1);
+  // a > 7
+  expect_rows(ScanAll(index.get(), Bound({7}, false), std::nullopt, false), 8, 0, A_VALUES - 1, B_VALUES - 1);
+  // a <= 1
+  expect_rows(ScanAll(index.get(), std::nullopt, Bound({1}, true), false), 0, 0, 1, B_VALUES - 1);
+
+  // a = 3 AND b >= 5, descending
+  std::vector<RID> rids = ScanAll(index.get(), Bound({3, 5}, true), Bound({3}, true), true);
+  std::reverse(rids.begin(), rids.end());
+  expect_rows(rids, 3, 5, 3, B_VALUES - 1);
+
+  // ranges past either end of the keys are empty
+  EXPECT_TRUE(ScanAll(index.get(), Bound({A_VALUES}, true), std::nullopt, false).empty());
+  EXPECT_TRUE(ScanAll(index.get(), std::nullopt, Bound({0}, false), false).empty());
+
+  remove("b_plus_tree_index_test.db");
+}
+
+TEST(BPlusTreeIndexTest, IncludedColumns) {
+  auto disk_manager = std::make_unique<DiskManager>("b_plus_tree_index_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Schema table_schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::BIGINT}});
+
+  for (bool is_unique : {true, false}) {
+    // an index over a that stores c, the entries of which are (a, c)
+    auto index = MakeIndex(bpm.get(), &table_schema, {0}, is_unique, {2});
+    EXPECT_EQ(index->GetEntryAttrs(), (std::vector<uint32_t>{0, 2}));
+    const Schema *entry_schema = index->GetEntrySchema();
+    const auto entry = [&](int a, int64_t c) {
+      return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetBigIntValue(c)}, entry_schema);
+    };
+    for (int a = A_VALUES - 1; a >= 0; a--) {
+      index->InsertEntry(entry(a, -a * 1000), RidOf(a, 0), nullptr);
+    }
+    // a unique index keeps the first entry of a key, whatever its included columns, and rejects the second
+    EXPECT_EQ(index->InsertEntry(entry(3, 7), RidOf(3, 1), nullptr), !is_unique);
+
+    // a key is looked up by its key columns alone
+    std::vector<RID> rids;
+    index->ScanKey(Tuple({ValueFactory::GetIntegerValue(3)}, index->GetKeySchema()), &rids, nullptr);
+    EXPECT_EQ(rids, is_unique ? std::vector<RID>{RidOf(3, 0)} : (std::vector<RID>{RidOf(3, 0), RidOf(3, 1)}));
+
+    // the entries come back in key order, with their included columns
+    std::vector<std::pair<IndexKeyType, RID>> entries;
+    auto iterator = index->GetRangeIterator(std::nullopt, std::nullopt, false);
+    while (iterator.NextBatch(&entries)) {
+    }
+    ASSERT_EQ(entries.size(), is_unique ? A_VALUES : A_VALUES + 1);
+    std::vector<int64_t> included;
+    for (const auto &[key, rid] : entries) {
+      std::vector<Value> values;
+      index->DecodeEntry(key, &values);
+      ASSERT_EQ(values.size(), 2);
+      EXPECT_EQ(values[0].GetAs<int32_t>(), rid.GetPageId());
+      included.push_back(values[1].GetAs<int64_t>());
+    }
+    EXPECT_EQ(included[3], -3000);
+    EXPECT_EQ(included[4], is_unique ? -4000 : 7);
+
+    // an entry is removed by its key and RID
+    index->DeleteEntry(entry(3, -3000), RidOf(3, 0), nullptr);
+    rids.clear();
+    index->ScanKey(Tuple({ValueFactory::GetIntegerValue(3)}, index->GetKeySchema()), &rids, nullptr);
+    EXPECT_EQ(rids, is_unique ? std::vector<RID>{} : std::vector<RID>{RidOf(3, 1)});
+  }
+
+  remove("b_plus_tree_index_test.db");
+}
+
+}  // namespace bustub
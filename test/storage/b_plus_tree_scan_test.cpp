@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using ScanTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+
+auto KeyOf(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+auto MakeRange(std::optional<int64_t> low, bool low_inclusive, std::optional<int64_t> high, bool high_inclusive,
+               bool reverse) -> IndexScanRange<GenericKey<8>> {
+  IndexScanRange<GenericKey<8>> range;
+  if (low.has_value()) {
+    range.low_ = KeyOf(*low);
+  }
+  if (high.has_value()) {
+    range.high_ = KeyOf(*high);
+  }
+  range.low_inclusive_ = low_inclusive;
+  range.high_inclusive_ = high_inclusive;
+  range.reverse_ = reverse;
+  return range;
+}
+
+/** @return the keys a scan of range over the sorted keys returns, in scan order */
+auto Expected(const std::vector<int64_t> &keys, const IndexScanRange<GenericKey<8>> &range,
+              const GenericComparator<8> &comparator) -> std::vector<int64_t> {
+  std::vector<int64_t> expected;
+  for (auto key : keys) {
+    if (range.low_.has_value()) {
+      const int cmp = comparator(KeyOf(key), *range.low_);
+      if (cmp < 0 || (cmp == 0 && !range.low_inclusive_)) {
+        continue;
+      }
+    }
+    if (range.high_.has_value()) {
+      const int cmp = comparator(KeyOf(key), *range.high_);
+      if (cmp > 0 || (cmp == 0 && !range.high_inclusive_)) {
+        continue;
+      }
+    }
+    expected.push_back(key);
+  }
+  if (range.reverse_) {
+    std::reverse(expected.begin(), expected.end());
+  }
+  return expected;
+}
+
+/** @return the keys of a scan, read one entry at a time */
+auto ScanKeys(ScanTree *tree, const IndexScanRange<GenericKey<8>> &range) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (auto iterator = tree->Scan(range); !iterator.IsEnd(); ++iterator) {
+    keys.push_back((*iterator).first.ToString());
+  }
+  return keys;
+}
+
+/** @return the keys of a scan, read a leaf at a time; the RIDs hold the keys */
+auto ScanBatches(ScanTree *tree, const IndexScanRange<GenericKey<8>> &range) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  std::vector<RID> rids;
+  auto iterator = tree->Scan(range);
+  while (iterator.NextBatch(&rids)) {
+  }
+  for (const auto &rid : rids) {
+    keys.push_back(rid.GetSlotNum());
+  }
+  return keys;
+}
+
+}  // namespace
+
+TEST(BPlusTreeScanTest, Bounds) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    ScanTree tree("foo_pk", bpm, comparator, 5, 5, mode);
+    // Scenario: an empty tree scans nothing, whatever the range.
+    EXPECT_TRUE(tree.Scan(MakeRange(std::nullopt, true, std::nullopt, true, true)).IsEnd());
+
+    // even keys over many small leaves, so bounds fall on keys and between them, in any leaf
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 400; key += 2) {
+      keys.push_back(key);
+    }
+    std::vector<int64_t> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+    for (auto key : shuffled) {
+      ASSERT_TRUE(tree.Insert(KeyOf(key), RID(key)));
+    }
+
+    // Scenario: a moved iterator carries on at the entry it was at.
+    auto moved = tree.Scan(MakeRange(7, true, std::nullopt, true, false));
+    moved = tree.Scan(MakeRange(101, true, std::nullopt, true, false));
+    auto iterator = std::move(moved);
+    ASSERT_FALSE(iterator.IsEnd());
+    EXPECT_EQ((*iterator).first.ToString(), 102);
+    EXPECT_EQ((*iterator).second, RID(102));
+
+    std::vector<std::optional<int64_t>> bounds{std::nullopt, -5, 0, 7, 8, 101, 398, 399, 500};
+    for (const auto &low : bounds) {
+      for (const auto &high : bounds) {
+        for (int flags = 0; flags < 8; flags++) {
+          auto range = MakeRange(low, (flags & 1) != 0, high, (flags & 2) != 0, (flags & 4) != 0);
+          const auto expected = Expected(keys, range, comparator);
+          EXPECT_EQ(expected, ScanKeys(&tree, range)) << "low " << low.value_or(-1) << " high " << high.value_or(-1)
+                                                      << " flags " << flags;
+          EXPECT_EQ(expected, ScanBatches(&tree, range)) << "low " << low.value_or(-1) << " high "
+                                                         << high.value_or(-1) << " flags " << flags;
+        }
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeScanTest, ReverseAfterMergesAndBulkLoad) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const auto everything = MakeRange(std::nullopt, true, std::nullopt, true, true);
+
+  // Scenario: merges relink the leaf after a merged one, so a reverse scan still sees every key left.
+  ScanTree tree("foo_pk", bpm, comparator, 4, 4);
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 1000; key++) {
+    ASSERT_TRUE(tree.Insert(KeyOf(key), RID(key)));
+    keys.push_back(key);
+  }
+  std::vector<int64_t> left;
+  for (auto key : keys) {
+    if (key % 3 == 0) {
+      left.push_back(key);
+    } else {
+      tree.Remove(KeyOf(key));
+    }
+  }
+  EXPECT_EQ(Expected(left, everything, comparator), ScanKeys(&tree, everything));
+
+  // Scenario: bulk loading links the leaves both ways too.
+  ScanTree loaded("foo_pk", bpm, comparator, 4, 4);
+  int64_t next = 0;
+  ASSERT_TRUE(loaded.BulkLoad([&](GenericKey<8> *key, RID *rid) {
+    if (next == 1000) {
+      return false;
+    }
+    *key = KeyOf(next);
+    *rid = RID(next);
+    next++;
+    return true;
+  }));
+  EXPECT_EQ(Expected(keys, everything, comparator), ScanBatches(&loaded, everything));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeScanTest, ConcurrentReverseScans) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const auto everything = MakeRange(std::nullopt, true, std::nullopt, true, true);
+
+  // Scenario: reverse scans run while a writer splits leaves and, in classic mode, merges them away again. Every scan
+  // comes out descending, and sees every key that was there all along.
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    ScanTree tree("foo_pk", bpm, comparator, 4, 4, mode);
+    std::vector<int64_t> stable;
+    for (int64_t key = 0; key < 2000; key += 2) {
+      ASSERT_TRUE(tree.Insert(KeyOf(key), RID(key)));
+      stable.push_back(key);
+    }
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 1; key < 2000; key += 2) {
+          tree.Insert(KeyOf(key), RID(key));
+        }
+        for (int64_t key = 1; key < 2000; key += 2) {
+          tree.Remove(KeyOf(key));
+        }
+      }
+      done = true;
+    });
+    int scans = 0;
+    bool descending = true;
+    bool complete = true;
+    while ((!done || scans == 0) && descending && complete) {
+      const auto scanned = scans % 2 == 0 ? ScanKeys(&tree, everything) : ScanBatches(&tree, everything);
+      for (size_t i = 1; i < scanned.size(); i++) {
+        descending = descending && scanned[i - 1] > scanned[i];
+      }
+      for (auto key : stable) {
+        complete = complete && std::binary_search(scanned.rbegin(), scanned.rend(), key);
+      }
+      scans++;
+    }
+    writer.join();
+    EXPECT_TRUE(descending) << "scan " << scans;
+    EXPECT_TRUE(complete) << "scan " << scans;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
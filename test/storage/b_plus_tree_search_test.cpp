@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_search_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeKey(const Schema *key_schema, std::vector<Value> values) -> GenericKey<16> {
+  Tuple tuple(std::move(values), key_schema);
+  GenericKey<16> key;
+  key.SetFromKey(tuple, key_schema);
+  return key;
+}
+
+/** Build a tree over num_keys keys of the schema (a integer, b bigint) and time random point lookups. */
+auto PointLookupCall(int64_t num_keys, int64_t keys_per_a, size_t num_lookups) -> double {
+  auto key_schema = ParseCreateStatement("a integer,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerMemory(32 << 10);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16 << 10, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", bpm, comparator);
+
+  auto key_of = [&](int64_t i) {
+    return MakeKey(key_schema.get(), {ValueFactory::GetIntegerValue(static_cast<int32_t>(i / keys_per_a)),
+                                      ValueFactory::GetBigIntValue(i)});
+  };
+  int64_t next = 0;
+  tree.BulkLoad([&](GenericKey<16> *key, RID *rid) {
+    if (next == num_keys) {
+      return false;
+    }
+    *key = key_of(next);
+    *rid = RID(next);
+    next++;
+    return true;
+  });
+
+  std::vector<GenericKey<16>> probes;
+  std::mt19937_64 rng(15445);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+  for (size_t i = 0; i < num_lookups; i++) {
+    probes.push_back(key_of(dist(rng)));
+  }
+  std::vector<RID> rids;
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &probe : probes) {
+    rids.clear();
+    found += tree.GetValue(probe, &rids) ? 1 : 0;
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(num_lookups, found);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  return static_cast<double>(num_lookups) / std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(BPlusTreeSearchTest, IntegerColumns) {
+  // Scenario: every integer width orders negative and positive values, whatever their bytes.
+  for (const auto *type : {"tinyint", "smallint", "integer", "bigint"}) {
+    auto key_schema = ParseCreateStatement(std::string("a ") + type + ",b bigint");
+    const TypeId type_id = key_schema->GetColumn(0).GetType();
+    GenericComparator<16> comparator(key_schema.get());
+    std::vector<GenericKey<16>> keys;
+    for (int32_t a : {-100, -2, -1, 0, 1, 2, 100}) {
+      for (int64_t b : {-1, 0, 1}) {
+        keys.push_back(MakeKey(key_schema.get(), {Value(type_id, a), ValueFactory::GetBigIntValue(b)}));
+      }
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+      for (size_t j = 0; j < keys.size(); j++) {
+        const int expected = i < j ? -1 : (i > j ? 1 : 0);
+        EXPECT_EQ(expected, comparator(keys[i], keys[j])) << type << " " << i << " " << j;
+      }
+    }
+  }
+
+  // Scenario: NULL sorts before every value of its column.
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  const Value null = ValueFactory::GetNullValueByType(TypeId::BIGINT);
+  auto key = [&](const Value &a, int64_t b) { return MakeKey(key_schema.get(), {a, ValueFactory::GetBigIntValue(b)}); };
+  EXPECT_EQ(-1, comparator(key(null, 1), key(ValueFactory::GetBigIntValue(-5), 2)));
+  EXPECT_EQ(1, comparator(key(ValueFactory::GetBigIntValue(-5), 2), key(null, 1)));
+  EXPECT_EQ(-1, comparator(key(null, 3), key(ValueFactory::GetBigIntValue(7), 3)));
+  EXPECT_EQ(0, comparator(key(null, 3), key(null, 3)));
+}
+
+TEST(BPlusTreeSearchTest, PageSearch) {
+  auto key_schema = ParseCreateStatement("a integer,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerMemory(1 << 10);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  for (auto mode : {BPlusTreeMode::CLASSIC, BPlusTreeMode::B_LINK}) {
+    BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", bpm, comparator, 7, 6, mode);
+    // runs of equal first columns, negative ones included, so searches tie on the first column often
+    auto key_of = [&](int64_t i) {
+      return MakeKey(key_schema.get(),
+                     {ValueFactory::GetIntegerValue(static_cast<int32_t>(i / 5 - 50)), ValueFactory::GetBigIntValue(i)});
+    };
+    std::vector<int64_t> ids;
+    for (int64_t i = 0; i < 500; i += 2) {
+      ids.push_back(i);
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+    for (auto i : ids) {
+      ASSERT_TRUE(tree.Insert(key_of(i), RID(i)));
+    }
+    std::vector<RID> rids;
+    for (int64_t i = 0; i < 500; i++) {
+      rids.clear();
+      ASSERT_EQ(i % 2 == 0, tree.GetValue(key_of(i), &rids)) << "key " << i;
+      if (i % 2 == 0) {
+        EXPECT_EQ(i, rids[0].GetSlotNum());
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BPlusTreeSearchTest, DISABLED_PointLookupBenchmark) {
+  // as many keys as __mock_t4_1m has rows
+  const int64_t num_keys = 1000000;
+  const size_t num_lookups = 1000000;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int64_t keys_per_a : {1, 1000}) {
+    double ops = PointLookupCall(num_keys, keys_per_a, num_lookups);
+    std::cout << num_keys << " keys, " << keys_per_a << " per first column value: " << static_cast<size_t>(ops)
+              << " lookups/sec" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
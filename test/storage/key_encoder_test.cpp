@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder_test.cpp
+//
+// Identification: test/storage/key_encoder_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeKey(const Schema *key_schema, std::vector<Value> values) -> GenericKey<32> {
+  Tuple tuple(std::move(values), key_schema);
+  GenericKey<32> key;
+  key.SetFromKey(tuple, key_schema);
+  return key;
+}
+
+/** Check that keys made of rows, which are in ascending SQL order, come out ascending and decode to the rows. */
+void CheckOrder(const std::string &sql, const std::vector<std::vector<Value>> &rows) {
+  auto key_schema = ParseCreateStatement(sql);
+  GenericComparator<32> comparator(key_schema.get());
+  std::vector<GenericKey<32>> keys;
+  for (const auto &row : rows) {
+    keys.push_back(MakeKey(key_schema.get(), row));
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      const int expected = i < j ? -1 : (i > j ? 1 : 0);
+      EXPECT_EQ(expected, comparator(keys[i], keys[j])) << sql << " " << i << " " << j;
+    }
+    for (uint32_t col = 0; col < key_schema->GetColumnCount(); col++) {
+      const Value value = keys[i].ToValue(key_schema.get(), col);
+      EXPECT_EQ(rows[i][col].IsNull(), value.IsNull()) << sql << " " << i;
+      if (!value.IsNull()) {
+        EXPECT_EQ(CmpBool::CmpTrue, value.CompareEquals(rows[i][col])) << sql << " " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(KeyEncoderTest, FixedLengthColumns) {
+  CheckOrder("a double", {{ValueFactory::GetNullValueByType(TypeId::DECIMAL)},
+                          {ValueFactory::GetDecimalValue(-1e10)},
+                          {ValueFactory::GetDecimalValue(-1.5)},
+                          {ValueFactory::GetDecimalValue(0)},
+                          {ValueFactory::GetDecimalValue(1e-9)},
+                          {ValueFactory::GetDecimalValue(2.5)},
+                          {ValueFactory::GetDecimalValue(1e10)}});
+  CheckOrder("a boolean,b smallint", {{ValueFactory::GetBooleanValue(false), ValueFactory::GetSmallIntValue(-300)},
+                                      {ValueFactory::GetBooleanValue(false), ValueFactory::GetSmallIntValue(300)},
+                                      {ValueFactory::GetBooleanValue(true), ValueFactory::GetSmallIntValue(-300)}});
+
+  // Scenario: -0.0 equals 0.0, so the two encode the same.
+  auto key_schema = ParseCreateStatement("a double");
+  GenericComparator<32> comparator(key_schema.get());
+  EXPECT_EQ(0, comparator(MakeKey(key_schema.get(), {ValueFactory::GetDecimalValue(-0.0)}),
+                          MakeKey(key_schema.get(), {ValueFactory::GetDecimalValue(0.0)})));
+}
+
+TEST(KeyEncoderTest, Varchars) {
+  const Value null = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+  auto str = [](const std::string &data) { return ValueFactory::GetVarcharValue(data); };
+  // Scenario: a string sorts before the strings it is a prefix of, embedded zeros included.
+  CheckOrder("a varchar(16)", {{null},
+                               {str("")},
+                               {str("a")},
+                               {str(std::string("a\0", 2))},
+                               {str(std::string("a\0b", 3))},
+                               {str("ab")},
+                               {str("b")}});
+  // Scenario: the columns after a varchar only decide between equal strings.
+  CheckOrder("a varchar(16),b integer", {{null, ValueFactory::GetIntegerValue(9)},
+                                         {str("a"), ValueFactory::GetIntegerValue(5)},
+                                         {str("a"), ValueFactory::GetIntegerValue(6)},
+                                         {str("ab"), ValueFactory::GetIntegerValue(1)}});
+
+  // Scenario: a string longer than the key is cut at the key size.
+  auto key_schema = ParseCreateStatement("a varchar(32)");
+  Tuple tuple({str("abcdefghij")}, key_schema.get());
+  GenericKey<8> key;
+  key.SetFromKey(tuple, key_schema.get());
+  EXPECT_EQ("abcdefg", key.ToValue(key_schema.get(), 0).ToString());
+}
+
+TEST(KeyEncoderTest, IntegerTestHelpers) {
+  // Scenario: the test helpers round trip, and order their keys as numbers.
+  GenericKey<8> lhs;
+  GenericKey<8> rhs;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  for (int64_t value : {-1000000000000LL, -1LL, 0LL, 1LL, 1000000000000LL}) {
+    lhs.SetFromInteger(value);
+    rhs.SetFromInteger(value + 1);
+    EXPECT_EQ(value, lhs.ToString());
+    EXPECT_EQ(value, lhs.ToValue(key_schema.get(), 0).GetAs<int64_t>());
+    EXPECT_EQ(-1, comparator(lhs, rhs));
+  }
+}
+
+}  // namespace bustub
@@ -14,13 +14,16 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +74,62 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+/** A disk manager that counts the reads issued off the calling thread, i.e. by the buffer pool's prefetcher. */
+class ReadAheadDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (std::this_thread::get_id() != owner_) {
+      background_reads_++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> background_reads_{0};
+
+ private:
+  std::thread::id owner_{std::this_thread::get_id()};
+};
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapReadAhead) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new ReadAheadDiskManager();
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(16, disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+
+  // About 20 tuples per page, so the table is many times larger than the buffer pool.
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(Tuple(values, &schema), &rid, transaction));
+  }
+
+  // Scenario: without read-ahead every page is read by the scanning thread.
+  int count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    EXPECT_EQ(count++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_EQ(0, disk_manager->background_reads_.load());
+
+  // Scenario: with read-ahead the scan returns the same tuples, and most pages are read in the background.
+  count = 0;
+  for (auto itr = table->Begin(transaction, 8); itr != table->End(); ++itr) {
+    EXPECT_EQ(count++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_GT(disk_manager->background_reads_.load(), 50);
+
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub
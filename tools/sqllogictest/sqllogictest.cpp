@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -176,6 +177,9 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   if (program.get<bool>("--in-memory")) {
     bustub = std::make_unique<bustub::BustubInstance>();
   } else {
+    // the catalog persists in the database file, so start from an empty one for the tables of the script
+    std::remove("test.db");
+    std::remove("test.log");
     bustub = std::make_unique<bustub::BustubInstance>("test.db");
   }
 